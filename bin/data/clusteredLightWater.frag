@@ -0,0 +1,89 @@
+#version 410
+
+// 클러스터드 포워드 라이팅용 물 셰이더
+// uber.frag 의 물(OCEAN) 디렉셔널 + 포인트라이트 변형을 라이트 개수만큼 반복해서 그리던 것을 한 패스로 합친 버전.
+
+// 디렉셔널 라이트 (DirectionalLight::apply() 로 전송됨)
+uniform vec3 lightDir; // 디렉셔널 라이트의 방향벡터
+uniform vec3 lightCol; // 조명색상
+uniform vec3 cameraPos; // 뷰 벡터 계산에 필요한 카메라 월드공간 좌표
+uniform vec3 ambientCol; // 앰비언트 라이트 색상
+uniform sampler2D oceanSlope; // OceanSimulation 의 기울기맵 (dh/dx, dh/dz)
+uniform samplerCube envMap; // 환경맵 반사에 사용할 큐브맵
+
+// 포인트라이트 데이터 (LightBuffer::bind() 로 전송됨)
+uniform samplerBuffer lightPosRadius; // 라이트당 1 텍셀. (xyz: 월드공간 위치, w: 반경)
+uniform samplerBuffer lightColor; // 라이트당 1 텍셀. (rgb: 색상 * 강도)
+
+// 포인트라이트 클러스터 데이터 (LightClusters::bind() 로 전송됨)
+uniform usamplerBuffer clusterGrid; // 클러스터당 (lightIndices 시작 오프셋, 라이트 개수)
+uniform usamplerBuffer lightIndices; // 클러스터별로 연속 저장된 라이트 인덱스
+uniform vec3 clusterDims; // 클러스터 그리드 크기 (x, y 타일 개수, z 슬라이스 개수)
+uniform vec2 screenSize; // 프레임버퍼 크기 (gl_FragCoord 를 타일 좌표로 바꾸는 데 사용)
+uniform vec2 clusterDepth; // (근평면 거리, log(원평면 / 근평면))
+uniform mat4 view; // 프래그먼트의 뷰 공간 깊이를 구하기 위한 뷰행렬
+
+in vec3 fragWorldPos;
+in vec2 fragUV; // 바다 텍스쳐 좌표 (월드공간 xz * oceanScale)
+
+out vec4 outCol;
+
+// 포인트라이트 그림자의 유니폼들과 pointShadow() 는 ShaderRegistry 가 '#version' 바로 뒤에 pointShadow.glsl 을 붙여서 넣어줌.
+
+float diffuse(vec3 lightDir, vec3 normal) {
+  float diffAmt = max(0.0, dot(normal, lightDir));
+  return diffAmt;
+}
+
+float specular(vec3 lightDir, vec3 viewDir, vec3 normal, float shininess) {
+  vec3 halfVec = normalize(viewDir + lightDir);
+  float specAmt = max(0.0, dot(halfVec, normal));
+  return pow(specAmt, shininess);
+}
+
+// 현재 프래그먼트가 속한 클러스터 인덱스를 계산함. (LightClusters.cpp 의 타일/슬라이스 계산과 동일해야 함)
+int clusterIndex() {
+  float viewZ = -(view * vec4(fragWorldPos, 1.0)).z;
+  int slice = int(floor(log(max(viewZ, clusterDepth.x) / clusterDepth.x) / clusterDepth.y * clusterDims.z));
+  ivec2 tile = ivec2(gl_FragCoord.xy / screenSize * clusterDims.xy);
+  ivec3 dims = ivec3(clusterDims);
+  ivec3 c = clamp(ivec3(tile, slice), ivec3(0), dims - 1);
+  return c.x + dims.x * (c.y + dims.y * c.z);
+}
+
+void main(){
+  vec2 slope = texture(oceanSlope, fragUV).xy; // 월드공간 높이장의 기울기로 노멀을 만듦. (uber.frag 와 동일)
+  vec3 normal = normalize(vec3(-slope.x, 1.0, -slope.y));
+
+  vec3 viewDir = normalize(cameraPos - fragWorldPos);
+  vec3 envSample = texture(envMap, reflect(-viewDir, normal)).xyz;
+
+  // 디렉셔널 라이트 계산 (uber.frag 의 물 LIGHT_DIRECTIONAL 변형과 동일)
+  float diffAmt = diffuse(lightDir, normal);
+  float specAmt = specular(lightDir, viewDir, normal, 512.0);
+  vec3 dirColor = envSample * lightCol * diffAmt + lightCol * specAmt;
+
+  // 멀티패스 방식의 패스별 0 ~ 1 clamp + 가산 블렌딩 결과를 맞추기 위해 라이트마다 따로 clamp 해서 더해줌.
+  vec3 finalColor = clamp(dirColor + ambientCol, 0.0, 1.0);
+
+  // 현재 클러스터에 할당된 포인트라이트들만 순회함. (uber.frag 의 물 LIGHT_POINT 변형과 동일한 계산)
+  uvec2 cluster = texelFetch(clusterGrid, clusterIndex()).xy;
+  for (uint i = 0u; i < cluster.y; ++i) {
+    int lightIndex = int(texelFetch(lightIndices, int(cluster.x + i)).x);
+    vec4 posRadius = texelFetch(lightPosRadius, lightIndex);
+    vec3 pointCol = texelFetch(lightColor, lightIndex).rgb;
+
+    vec3 toLight = posRadius.xyz - fragWorldPos;
+    vec3 pointDir = normalize(toLight);
+    float falloff = 1.0 - (length(toLight) / posRadius.w);
+    falloff *= pointShadow(lightIndex, posRadius.xyz, posRadius.w, fragWorldPos);
+
+    float pointDiff = diffuse(pointDir, normal) * falloff;
+    float pointSpec = specular(pointDir, viewDir, normal, 512.0) * falloff;
+
+    vec3 pointColor = envSample * pointCol * pointDiff + pointCol * pointSpec;
+    finalColor += clamp(pointColor + ambientCol, 0.0, 1.0);
+  }
+
+  outCol = vec4(finalColor, 1.0);
+}
@@ -0,0 +1,94 @@
+// 디퍼드 모드의 조명 패스 프래그먼트 셰이더. G-버퍼(gbuffer.frag 가 기록)에서 재질과 노멀을 읽어서 uber.frag 와 같은 조명식을 계산함.
+// 결과는 GBuffer 의 Light 타겟에 가산 블렌딩으로 누적됨. ('#version' 과 '#define' 은 ShaderRegistry 가 붙여줌)
+//
+// LIGHT_DIRECTIONAL : 화면 전체 사각형으로 디렉셔널 라이트 + 앰비언트를 계산함.
+// LIGHT_POINT       : 라이트 볼륨(구체)이 덮는 픽셀들에 대해서만 그 포인트라이트를 계산함.
+
+#ifdef LIGHT_POINT
+uniform samplerBuffer lightColor; // LightBuffer 의 라이트당 1 텍셀 (rgb: 조명 색상 * 강도)
+uniform samplerBuffer lightPosRadius;
+
+flat in int lightIndex;
+#else
+uniform vec3 lightDir; // 디렉셔널 라이트의 방향벡터
+uniform vec3 lightCol; // 조명색상
+uniform vec3 ambientCol; // 앰비언트 라이트 색상 (디렉셔널 패스에서 한 번만 더함)
+#endif
+
+uniform vec3 cameraPos;
+uniform mat4 invViewProj; // 깊이값에서 월드 위치를 복원하기 위한 (투영 * 뷰) 역행렬
+uniform vec2 screenSize; // G-버퍼 크기
+
+uniform sampler2D gAlbedo;
+uniform sampler2D gMaterial;
+uniform sampler2D gNormal;
+uniform sampler2D gDepth;
+
+out vec4 outCol;
+
+// 포인트라이트 그림자의 유니폼들과 pointShadow() 는 ShaderRegistry 가 '#version' 바로 뒤에 pointShadow.glsl 을 붙여서 넣어줌.
+
+vec3 decodeNormal(vec2 e) {
+  vec2 f = e * 2.0 - 1.0;
+  vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+  float t = max(-n.z, 0.0); // 아래쪽 반구에서 접혀있던 부분을 다시 펼침.
+  n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+  return normalize(n);
+}
+
+float diffuse(vec3 lightDir, vec3 normal) {
+  return max(0.0, dot(normal, lightDir));
+}
+
+float specular(vec3 lightDir, vec3 viewDir, vec3 normal, float shininess) {
+  vec3 halfVec = normalize(viewDir + lightDir);
+  float specAmt = max(0.0, dot(halfVec, normal));
+  return pow(specAmt, shininess);
+}
+
+void main() {
+  ivec2 pixel = ivec2(gl_FragCoord.xy);
+  float depth = texelFetch(gDepth, pixel, 0).r;
+  if (depth >= 1.0) {
+    discard; // 메쉬가 그려지지 않은 픽셀 (스카이박스는 조명 패스 뒤에 포워드로 그림)
+  }
+
+  // 화면 좌표 + 깊이값 -> 정규화 장치 좌표 -> 월드 좌표
+  vec4 ndc = vec4(gl_FragCoord.xy / screenSize * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+  vec4 world = invViewProj * ndc;
+  vec3 worldPos = world.xyz / world.w;
+
+  vec4 albedoSpec = texelFetch(gAlbedo, pixel, 0);
+  vec4 material = texelFetch(gMaterial, pixel, 0);
+  vec3 normal = decodeNormal(texelFetch(gNormal, pixel, 0).rg);
+  bool water = material.a > 0.5;
+
+#ifdef LIGHT_POINT
+  vec4 posRadius = texelFetch(lightPosRadius, lightIndex);
+  vec3 lightCol = texelFetch(lightColor, lightIndex).rgb;
+  vec3 toLight = posRadius.xyz - worldPos;
+  vec3 lightDir = normalize(toLight);
+  // 라이트 볼륨은 구체를 감싸도록 조금 크게 그려지므로, 반경 밖에서는 음수가 되지 않도록 0 으로 잘라줌.
+  float falloff = max(0.0, 1.0 - (length(toLight) / posRadius.w));
+  falloff *= pointShadow(lightIndex, posRadius.xyz, posRadius.w, worldPos);
+#else
+  float falloff = 1.0;
+#endif
+
+  vec3 viewDir = normalize(cameraPos - worldPos);
+  float diffAmt = diffuse(lightDir, normal) * falloff;
+  float specAmt = specular(lightDir, viewDir, normal, water ? 512.0 : 4.0) * falloff;
+
+  // uber.frag 의 두 재질을 하나로 정리한 식.
+  // 방패: sceneLight = mix(lightCol, envSample + lightCol * 0.5, 0.5), 물: sceneLight = lightCol (G-버퍼의 Material.rgb 가 0)
+  vec3 sceneLight = water ? lightCol : lightCol * 0.75 + material.rgb * 0.5;
+  vec3 specCol = albedoSpec.a * sceneLight * specAmt;
+#ifdef LIGHT_DIRECTIONAL
+  if (!water) {
+    specCol *= lightCol; // 디렉셔널 라이트는 방패의 스펙큘러에 조명색상을 한 번 더 곱함. (uber.frag 참고)
+  }
+  outCol = vec4(albedoSpec.rgb * diffAmt * sceneLight + specCol + ambientCol, 1.0);
+#else
+  outCol = vec4(albedoSpec.rgb * diffAmt * sceneLight + specCol, 1.0);
+#endif
+}
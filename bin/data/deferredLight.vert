@@ -0,0 +1,23 @@
+// 디퍼드 모드의 조명 패스 버텍스 셰이더. ('#version' 과 '#define' 은 ShaderRegistry 가 붙여줌)
+//
+// LIGHT_DIRECTIONAL : 정규화 장치 좌표(-1 ~ 1)로 만들어둔 사각형을 그대로 내보내서 화면 전체를 덮음.
+// LIGHT_POINT       : 단위 구체 메쉬를 인스턴스(= 포인트라이트)마다 라이트 위치로 옮기고 반경만큼 키워서 라이트 볼륨을 만듦.
+
+layout(location = 0) in vec3 pos;
+
+#ifdef LIGHT_POINT
+uniform mat4 viewProj; // 투영 * 뷰 행렬
+uniform samplerBuffer lightPosRadius; // LightBuffer 의 라이트당 1 텍셀 (xyz: 위치, w: 반경)
+
+flat out int lightIndex; // 인스턴스 번호가 곧 LightBuffer 안의 라이트 인덱스
+#endif
+
+void main() {
+#ifdef LIGHT_POINT
+  lightIndex = gl_InstanceID;
+  vec4 posRadius = texelFetch(lightPosRadius, gl_InstanceID);
+  gl_Position = viewProj * vec4(posRadius.xyz + pos * posRadius.w, 1.0);
+#else
+  gl_Position = vec4(pos.xy, 0.0, 1.0);
+#endif
+}
@@ -0,0 +1,5 @@
+// 깊이 프리패스용 프래그먼트 셰이더. 색상 쓰기는 glColorMask 로 꺼두고 깊이값만 기록하므로 아무것도 계산하지 않음.
+// ('#version' 과 '#define' 은 ShaderRegistry 가 붙여줌)
+
+void main() {
+}
@@ -0,0 +1,45 @@
+// 깊이 프리패스와 포인트라이트 셰도우맵(PointShadowCache)용 버텍스 셰이더. 위치만 변환하고 다른 값은 프래그먼트 셰이더로 넘기지 않음.
+// ('#version' 과 '#define' 은 ShaderRegistry 가 붙여줌)
+//
+// 이후의 셰이딩 패스는 GL_EQUAL 로 깊이를 비교하므로, gl_Position 은 uber.vert / mesh.vert / water.vert 와 정확히 같은 식으로 계산해야 함.
+// 'invariant' 는 같은 식과 같은 입력이면 셰이더가 달라도 같은 결과가 나오도록 컴파일러의 최적화를 제한함. (해당 셰이더들에도 모두 선언되어 있음)
+//
+// INSTANCED : 모델행렬을 인스턴스 속성(InstanceBuffer)에서 읽고, mvp 대신 viewProj 를 곱함.
+// OCEAN     : uber.vert / water.vert 와 같은 식으로 월드공간에서 바다 변위맵만큼 움직인 뒤 viewProj 를 곱함.
+
+layout(location = 0) in vec3 pos;
+
+// PackedMesh 로 올린 메쉬는 위치가 AABB 기준 16비트 정규화 정수(0 ~ 1)로 들어오므로, 오브젝트공간 위치로 되돌리는 변환. (float 메쉬는 기본값인 항등 변환)
+uniform vec3 positionScale = vec3(1.0);
+uniform vec3 positionOffset = vec3(0.0);
+
+#ifdef INSTANCED
+layout(location = 4) in mat4 instanceModel; // 인스턴스별 모델행렬 (4 ~ 7 번 로케이션)
+
+uniform mat4 viewProj; // 투영 * 뷰 행렬
+#elif defined(OCEAN)
+uniform mat4 model; // 모델행렬
+uniform mat4 viewProj; // 투영 * 뷰 행렬
+
+uniform sampler2D oceanDisplacement; // OceanSimulation 의 변위맵
+uniform float oceanScale; // 월드공간 xz 를 바다 텍스쳐 좌표로 바꾸는 배율
+#else
+uniform mat4 mvp; // 투영 * 뷰 * 모델 행렬
+#endif
+
+invariant gl_Position;
+
+void main() {
+  vec3 objPos = pos * positionScale + positionOffset; // 깊이 프리패스와 같은 깊이가 나오도록 모든 셰이더에서 같은 식으로 복원함.
+#ifdef INSTANCED
+  vec3 worldPos = (instanceModel * vec4(objPos, 1.0)).xyz; // uber.vert 의 fragWorldPos 와 같은 식
+  gl_Position = viewProj * vec4(worldPos, 1.0);
+#elif defined(OCEAN)
+  vec3 worldPos = (model * vec4(objPos, 1.0)).xyz; // uber.vert 의 fragWorldPos 와 같은 식
+  vec2 oceanUV = worldPos.xz * oceanScale;
+  worldPos += textureLod(oceanDisplacement, oceanUV, 0.0).xyz;
+  gl_Position = viewProj * vec4(worldPos, 1.0);
+#else
+  gl_Position = mvp * vec4(objPos, 1.0);
+#endif
+}
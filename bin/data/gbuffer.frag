@@ -0,0 +1,72 @@
+// 디퍼드 모드의 G-버퍼 패스 프래그먼트 셰이더. 버텍스 셰이더는 멀티패스와 같은 uber.vert 를 사용함.
+// 조명은 계산하지 않고, 조명 패스(deferredLight.frag)가 uber.frag 와 같은 결과를 낼 수 있도록 재질 값들만 기록함.
+// ('#version' 과 기능 '#define' 은 ShaderRegistry 가 붙여줌. 기능 비트의 의미는 uber.frag 와 같음)
+
+uniform vec3 cameraPos; // 환경맵 반사벡터 계산에 필요한 카메라 월드공간 좌표
+
+#ifdef OCEAN
+uniform sampler2D oceanSlope; // OceanSimulation 의 기울기맵 (dh/dx, dh/dz)
+#else
+uniform sampler2D diffuseTex; // 디퓨즈 라이팅 계산에 사용할 텍스쳐
+uniform sampler2D specTex; // 스펙큘러 라이팅 계산에 사용할 텍스쳐
+uniform sampler2D nrmTex; // 노말 매핑에 사용할 노말맵 텍스쳐
+#endif
+
+#ifdef ENV_REFLECTION
+uniform samplerCube envMap; // 환경광 반사에 필요한 큐브맵(환경맵)
+#endif
+
+in vec3 fragNrm;
+in vec3 fragWorldPos;
+in vec2 fragUV; // OCEAN 이면 바다 텍스쳐 좌표 (월드공간 xz * oceanScale)
+in mat3 TBN;
+
+// GBuffer::Attachment 순서와 같음.
+layout(location = 0) out vec4 gAlbedo; // rgb: 디퓨즈 색상 (물은 환경맵 반사 색상), a: 스펙큘러 마스크
+layout(location = 1) out vec4 gMaterial; // rgb: 방패의 sceneLight 에 섞을 환경맵 반사 색상, a: 재질 (0: 방패, 1: 물)
+layout(location = 2) out vec2 gNormal; // 팔면체 인코딩한 노멀 (0 ~ 1)
+
+// 노멀을 팔면체(|x| + |y| + |z| = 1)에 투영한 뒤, 아래쪽 반구는 바깥쪽 삼각형들로 접어서 2D 로 펼침.
+// RG16 두 채널(32 비트)만으로 RGB 10비트 이상의 정밀도를 얻을 수 있음.
+vec2 encodeNormal(vec3 n) {
+  n /= abs(n.x) + abs(n.y) + abs(n.z);
+  vec2 e = n.xy;
+  if (n.z < 0.0) {
+    e = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+  }
+  return e * 0.5 + 0.5;
+}
+
+// 조명계산에 사용할 월드공간 노멀벡터 (uber.frag 와 동일)
+vec3 surfaceNormal() {
+#if defined(OCEAN)
+  vec2 slope = texture(oceanSlope, fragUV).xy;
+  return normalize(vec3(-slope.x, 1.0, -slope.y));
+#elif defined(NORMAL_MAP)
+  vec3 normal = normalize(texture(nrmTex, fragUV).rgb * 2.0 - 1.0);
+  return normalize(TBN * normal);
+#else
+  return normalize(fragNrm);
+#endif
+}
+
+void main() {
+  vec3 normal = surfaceNormal();
+  vec3 viewDir = normalize(cameraPos - fragWorldPos);
+
+#ifdef ENV_REFLECTION
+  vec3 envSample = texture(envMap, reflect(-viewDir, normal)).xyz; // 환경맵 반사는 라이트와 상관없으므로 여기서 한 번만 샘플링함.
+#else
+  vec3 envSample = vec3(0.0);
+#endif
+
+#ifdef OCEAN
+  // 물 재질은 디퓨즈 색상 대신 환경맵 색상을 쓰고, 스펙큘러는 마스크 없이 전부 적용함.
+  gAlbedo = vec4(envSample, 1.0);
+  gMaterial = vec4(0.0, 0.0, 0.0, 1.0);
+#else
+  gAlbedo = vec4(texture(diffuseTex, fragUV).xyz, texture(specTex, fragUV).x);
+  gMaterial = vec4(envSample, 0.0);
+#endif
+  gNormal = encodeNormal(normal);
+}
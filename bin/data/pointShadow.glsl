@@ -0,0 +1,61 @@
+// 포인트라이트 그림자 계산. ShaderRegistry 가 모든 프래그먼트 셰이더의 '#version' 줄(우버 셰이더는 '#define' 줄들) 바로 뒤에 붙여줌.
+// 쓰지 않는 셰이더에서는 유니폼과 함수가 링크할 때 빠지므로 비용이 없음.
+
+// 포인트라이트 그림자 (PointShadowCache::bind() 로 전송됨)
+uniform sampler2DShadow shadowAtlas; // 모든 포인트라이트의 큐브 면 6 개를 타일로 모아둔 깊이 아틀라스
+uniform usamplerBuffer lightShadow; // 라이트당 2 텍셀. (면 0 ~ 3 타일 위치), (면 4 ~ 5 타일 위치, 타일 크기, 0). 위치는 x | y << 16
+uniform vec3 shadowParams; // (1 / 아틀라스 크기, 면 투영의 근평면, 그림자 사용 여부)
+
+// 큐브 면별 오른쪽/위 방향. (순서: +X, -X, +Y, -Y, +Z, -Z. PointShadowCache.cpp 의 면 방향과 같아야 함)
+const vec3 shadowFaceRight[6] = vec3[](vec3(0, 0, 1), vec3(0, 0, -1), vec3(1, 0, 0), vec3(-1, 0, 0), vec3(-1, 0, 0), vec3(1, 0, 0));
+const vec3 shadowFaceUp[6] = vec3[](vec3(0, 1, 0), vec3(0, 1, 0), vec3(0, 0, 1), vec3(0, 0, 1), vec3(0, 1, 0), vec3(0, 1, 0));
+
+// light 번째 포인트라이트가 worldPos 를 비추는 비율 (0: 그림자, 1: 비춤). 아직 타일이 없는 라이트는 1.
+float pointShadow(int light, vec3 lightPos, float radius, vec3 worldPos) {
+  if (shadowParams.z == 0.0) {
+    return 1.0;
+  }
+  uvec4 faces0 = texelFetch(lightShadow, light * 2);
+  uvec4 faces1 = texelFetch(lightShadow, light * 2 + 1);
+  float size = float(faces1.z);
+  if (size == 0.0) {
+    return 1.0;
+  }
+
+  // 라이트 -> 프래그먼트 벡터의 가장 큰 축으로 면을 고름.
+  vec3 d = worldPos - lightPos;
+  vec3 a = abs(d);
+  int face;
+  float ma;
+  if (a.x >= a.y && a.x >= a.z) {
+    face = d.x >= 0.0 ? 0 : 1;
+    ma = a.x;
+  } else if (a.y >= a.z) {
+    face = d.y >= 0.0 ? 2 : 3;
+    ma = a.y;
+  } else {
+    face = d.z >= 0.0 ? 4 : 5;
+    ma = a.z;
+  }
+
+  // 면 투영의 정규화 좌표 -> 아틀라스 텍셀 좌표. PCF 탭이 옆 타일을 읽지 않도록 가장자리 2 텍셀 안쪽으로 잘라줌.
+  uint packed = face < 4 ? faces0[face] : faces1[face - 4];
+  vec2 origin = vec2(float(packed & 0xffffu), float(packed >> 16));
+  vec2 st = vec2(dot(d, shadowFaceRight[face]), dot(d, shadowFaceUp[face])) / ma * 0.5 + 0.5;
+  vec2 texel = origin + clamp(st * size, 2.0, size - 2.0);
+
+  // 면의 뷰 공간 깊이(= ma)를 면 투영과 같은 식으로 깊이값으로 바꿈. 텍셀 크기에 비례하는 바이어스로 자기 그림자 얼룩을 막음.
+  float n = shadowParams.y;
+  float f = radius;
+  float z = max(ma * (1.0 - 3.0 / size) - 0.005, n);
+  float depth = ((f + n) / (f - n) - 2.0 * f * n / ((f - n) * z)) * 0.5 + 0.5;
+
+  // 3 x 3 PCF. (탭마다 하드웨어가 2 x 2 텍셀의 비교 결과를 보간해줌)
+  float lit = 0.0;
+  for (int y = -1; y <= 1; ++y) {
+    for (int x = -1; x <= 1; ++x) {
+      lit += texture(shadowAtlas, vec3((texel + vec2(x, y)) * shadowParams.x, depth));
+    }
+  }
+  return lit / 9.0;
+}
@@ -0,0 +1,144 @@
+// 멀티패스 조명 셰이더들이 공통으로 사용하는 우버(uber) 프래그먼트 셰이더.
+// 예전에는 dirLight.frag, pointLight.frag, dirLightWater.frag, pointLightWater.frag 가 diffuse() / specular() 를 각자 복사해서 갖고 있었는데,
+// 이제는 이 소스 하나에 기능 '#define' 을 붙여서 필요한 변형(variant)만 컴파일함. ('#version' 과 '#define' 은 ShaderRegistry 가 붙여줌)
+//
+// LIGHT_DIRECTIONAL / LIGHT_POINT : 조명 종류 (둘 중 하나만 정의됨)
+// NORMAL_MAP                      : 노말맵에서 샘플링한 노멀 사용 (정의되지 않으면 버텍스 노멀 사용)
+// ENV_REFLECTION                  : 큐브맵(환경맵) 반사 사용
+// OCEAN                           : 물 표면. OceanSimulation 의 기울기맵으로 노멀을 만들고, 물 재질로 조명을 계산함. (정의되지 않으면 방패 재질)
+
+// c++ 미리 계산된 후 받아온 조명연산에 필요한 유니폼 변수들
+#ifdef LIGHT_POINT
+// 포인트라이트 데이터는 라이트마다 유니폼 변수로 따로 받지 않고, LightBuffer 가 올려둔 텍스쳐 버퍼에서 라이트 인덱스로 읽어옴.
+uniform int lightIndex; // 이번 패스에서 계산할 포인트라이트의 인덱스
+uniform samplerBuffer lightPosRadius; // 라이트당 1 텍셀. (xyz: 포인트라이트 위치, w: 포인트라이트 조명의 반경(최대범위))
+uniform samplerBuffer lightColor; // 라이트당 1 텍셀. (rgb: 조명 색상 * 강도)
+#else
+uniform vec3 lightDir; // 디렉셔널 라이트의 방향벡터
+uniform vec3 lightCol; // 조명색상
+#endif
+uniform vec3 cameraPos; // 뷰 벡터 계산에 필요한 카메라 월드공간 좌표
+uniform vec3 ambientCol; // 앰비언트 라이트(환경광 또는 글로벌 조명(전역 조명))의 색상
+
+#ifdef OCEAN
+uniform sampler2D oceanSlope; // OceanSimulation 의 기울기맵 (dh/dx, dh/dz)
+#else
+uniform sampler2D diffuseTex; // 디퓨즈 라이팅 계산에 사용할 텍스쳐
+uniform sampler2D specTex; // 스펙큘러 라이팅 계산에 사용할 텍스쳐
+uniform sampler2D nrmTex; // 노말 매핑에 사용할 노말맵 텍스쳐
+#endif
+
+#ifdef ENV_REFLECTION
+uniform samplerCube envMap; // 환경광 반사에 필요한 큐브맵(환경맵)
+#endif
+
+in vec3 fragNrm; // 버텍스 셰이더에서 받아온 (월드공간) 노멀벡터가 보간되어 들어온 값
+in vec3 fragWorldPos; // 버텍스 셰이더에서 받아온 월드공간 위치 좌표가 보간되어 들어온 값
+in vec2 fragUV; // OCEAN 이면 바다 텍스쳐 좌표 (월드공간 xz * oceanScale)
+in mat3 TBN; // 탄젠트 공간의 노말벡터를 월드공간으로 변환하기 위한 TBN 행렬
+
+out vec4 outCol; // 최종 출력할 색상을 계산하여 다음 파이프라인으로 넘겨줄 변수
+
+// 포인트라이트 그림자의 유니폼들과 pointShadow() 는 ShaderRegistry 가 '#version' 바로 뒤에 pointShadow.glsl 을 붙여서 넣어줌.
+
+// 디퓨즈 라이팅 계산 (노멀벡터와 조명벡터를 내적)
+float diffuse(vec3 lightDir, vec3 normal) {
+  float diffAmt = max(0.0, dot(normal, lightDir)); // 정규화된 노멀벡터와 조명벡터의 내적값을 구한 뒤, max() 함수로 음수인 내적값 제거.
+  return diffAmt;
+}
+
+// Blinn-Phong 공식에서의 스펙큘러 라이팅 계산
+float specular(vec3 lightDir, vec3 viewDir, vec3 normal, float shininess) {
+  vec3 halfVec = normalize(viewDir + lightDir); // 뷰 벡터와 조명벡터 사이의 하프벡터를 구함
+  float specAmt = max(0.0, dot(halfVec, normal)); // 하프벡터와 노멀벡터의 내적값을 구한 뒤, max() 함수로 음수값 제거
+  return pow(specAmt, shininess);
+}
+
+// 조명계산에 사용할 월드공간 노멀벡터
+vec3 surfaceNormal() {
+#if defined(OCEAN)
+  // 높이장 y = h(x, z) 의 노멀은 (-dh/dx, 1, -dh/dz). 기울기맵은 월드공간 기준이므로 TBN 변환이 필요없음.
+  // (수평 변위로 인한 노멀 변화는 무시함. choppiness 가 크지 않으면 눈에 띄지 않음)
+  vec2 slope = texture(oceanSlope, fragUV).xy;
+  return normalize(vec3(-slope.x, 1.0, -slope.y));
+#elif defined(NORMAL_MAP)
+  // 노말맵에서 샘플링한 텍셀값(0 ~ 1)을 탄젠트 공간의 범위(-1 ~ 1)로 맵핑한 뒤, TBN 행렬로 월드공간으로 변환함.
+  vec3 normal = normalize(texture(nrmTex, fragUV).rgb * 2.0 - 1.0);
+  return normalize(TBN * normal);
+#else
+  return normalize(fragNrm);
+#endif
+}
+
+void main(){
+#ifdef LIGHT_POINT
+  // 텍스쳐 버퍼에서 이번 패스의 포인트라이트 데이터를 읽어옴.
+  vec4 posRadius = texelFetch(lightPosRadius, lightIndex);
+  vec3 lightCol = texelFetch(lightColor, lightIndex).rgb; // 조명 색상
+
+  vec3 toLight = posRadius.xyz - fragWorldPos; // 각 프래그먼트 -> 포인트라이트 위치까지의 벡터
+  vec3 lightDir = normalize(toLight); // 각 프래그먼트에 도달하는 포인트라이트 방향벡터
+  float falloff = 1.0 - (length(toLight) / posRadius.w); // 조명까지의 거리를 반경으로 나눈 뒤 1에서 빼서, 가까울수록 1에 가까운 감쇄값을 구함.
+  falloff *= pointShadow(lightIndex, posRadius.xyz, posRadius.w, fragWorldPos); // 그림자 안이면 감쇄값을 줄여줌.
+#else
+  float falloff = 1.0; // 디렉셔널 라이트는 감쇄가 없음.
+#endif
+
+  vec3 normal = surfaceNormal();
+  vec3 viewDir = normalize(cameraPos - fragWorldPos); // 각 프래그먼트 -> 카메라 방향의 뷰 벡터
+
+#ifdef ENV_REFLECTION
+  vec3 envSample = texture(envMap, reflect(-viewDir, normal)).xyz; // 큐브맵 텍스쳐로부터 반사벡터를 사용해 샘플링한 텍셀값
+#else
+  vec3 envSample = vec3(0.0);
+#endif
+
+  float diffAmt = diffuse(lightDir, normal) * falloff;
+  vec3 finalColor = vec3(0.0, 0.0, 0.0);
+
+#ifdef OCEAN
+  // 물 재질은 거울처럼 반사가 아주 세므로, 스펙큘러 광택지수를 512 처럼 높게 잡고, 디퓨즈 색상 대신 환경맵 색상을 사용함.
+  float specAmt = specular(lightDir, viewDir, normal, 512.0) * falloff;
+  finalColor += envSample * lightCol * diffAmt;
+  finalColor += lightCol * specAmt;
+#else
+  float specAmt = specular(lightDir, viewDir, normal, 4.0) * falloff;
+  float specMask = texture(specTex, fragUV).x; // 스펙큘러 맵에서 샘플링한 마스크
+  vec3 diffuseColor = texture(diffuseTex, fragUV).xyz; // 디퓨즈 텍스쳐에서 샘플링한 물체의 원색상
+
+  vec3 sceneLight = mix(lightCol, envSample + lightCol * 0.5, 0.5); // 환경맵 반사 및 cpp에서 전달해 준 조명색상이 반영된 sceneLight
+  vec3 specCol = specMask * sceneLight * specAmt; // specMask 를 곱해서 sceneLight 가 specMask 영역만큼만 적용되도록 함.
+
+  finalColor += diffuseColor * diffAmt * sceneLight;
+#ifdef LIGHT_POINT
+  finalColor += specCol;
+#else
+  finalColor += specCol * lightCol; // 예전 dirLight.frag 와 동일하게, 디렉셔널 라이트는 스펙큘러에 조명색상을 한 번 더 곱함.
+#endif
+#endif
+
+  outCol = vec4(finalColor + ambientCol, 1.0); // 최종 색상 + 앰비언트 라이트 색상
+}
+
+/*
+  texture()
+
+  원래 glsl 내장함수로 텍스쳐 샘플링할 때
+  texture2D() 함수를 사용했었는데,
+  현재 410 버전에서 사용하면 에러가 남.
+
+  아무래도 410 버전의 glsl 은 문법이 변경된 거 같음.
+*/
+
+/*
+  환경광 반사 계산에 필요한
+  환경맵 샘플링 시 카메라 벡터와 노말벡터로 구한 반사벡터를 사용하는 이유
+
+  원래 reflect() 함수는 조명의 반사벡터를 구하기 위해 첫 번째 인자로
+  조명벡터를 넣어주지만, 여기서는 카메라 벡터를 넣어주고 있지?
+
+  환경맵 전체에서 들어오는 빛을 계산하기 어려우니,
+  각각의 픽셀에서 반사되어 카메라로 들어오는
+  광선들을 '역추적'해서 큐브맵을 샘플링할 방향벡터를 구한다고 생각하면 됨.
+  ('레이 트레이싱'과 유사한 원리)
+*/
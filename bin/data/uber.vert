@@ -0,0 +1,75 @@
+// 멀티패스 조명 셰이더들이 공통으로 사용하는 우버(uber) 버텍스 셰이더.
+// '#version' 과 기능 '#define' 들은 ShaderRegistry 가 변형(variant)마다 소스 앞에 붙여서 컴파일함.
+//
+// OCEAN         : 물 표면. 월드공간 xz 로 OceanSimulation 의 변위맵을 샘플링해서 버텍스를 움직이고, 같은 좌표를 fragUV 로 내보냄.
+//                 (정의되지 않으면 방패처럼 uv 의 y 만 뒤집어서 fragUV 로 내보냄)
+// INSTANCED     : 모델행렬과 노말행렬을 유니폼 대신 인스턴스 속성(InstanceBuffer)에서 읽고, mvp 대신 viewProj 를 곱함.
+
+// layout 을 이용해서 버텍스 셰이더에서 각 버텍스 데이터가 저장된 순서를 알려줌. (오픈프레임웍스가 버텍스 데이터를 저장하는 순서는 p.74 참고)
+layout(location = 0) in vec3 pos;
+layout(location = 1) in vec4 tan; // 원래 오픈프레임웍스에서 1번 로케이션은 버텍스 컬러가 들어오는 위치지만, 탄젠트 벡터 지원이 안되서 임시로 여기다 탄젠트 벡터 데이터를 추가해서 쓸거임. (w: 바이탄젠트 방향 부호)
+layout(location = 2) in vec3 nrm;
+layout(location = 3) in vec2 uv;
+
+// PackedMesh 로 올린 메쉬는 위치가 AABB 기준 16비트 정규화 정수(0 ~ 1)로 들어오므로, 오브젝트공간 위치로 되돌리는 변환. (float 메쉬는 기본값인 항등 변환)
+uniform vec3 positionScale = vec3(1.0);
+uniform vec3 positionOffset = vec3(0.0);
+
+#ifdef INSTANCED
+layout(location = 4) in mat4 instanceModel; // 인스턴스별 모델행렬 (4 ~ 7 번 로케이션)
+layout(location = 8) in mat3 instanceNormalMatrix; // 인스턴스별 노말행렬 (8 ~ 10 번 로케이션, CPU 에서 미리 계산됨)
+#else
+uniform mat4 mvp; // c++ (오픈프레임웍스)에서 합쳐준 투영 * 뷰 * 모델 행렬을 전달받는 유니폼 변수
+uniform mat4 model; // 각 버텍스의 월드좌표를 구하기 위해 mvp 행렬과 별도로 전달받는 모델행렬을 저장할 유니폼 변수
+uniform mat3 normalMatrix; // 조명계산에 필요한 노멀벡터(즉, 월드공간으로 변환된 노멀벡터)를 계산하려면, 노말행렬을 따로 구해서 버텍스 셰이더에 가져옴.
+#endif
+
+#if defined(INSTANCED) || defined(OCEAN)
+uniform mat4 viewProj; // 투영 * 뷰 행렬 (모델행렬이 인스턴스마다 다르거나, 월드공간에서 변위를 더하므로 셰이더에서 곱함)
+#endif
+
+out vec3 fragNrm; // 프래그먼트 셰이더로 전송할 월드공간 노멀벡터
+out vec3 fragWorldPos; // 각 버텍스의 월드좌표를 구한 뒤 보간해서 프래그먼트 셰이더로 내보낼 때 사용할 out 변수
+out vec2 fragUV; // 텍스쳐 샘플링에 필요한 uv
+out mat3 TBN; // 노말맵에서 샘플링한 탄젠트 공간의 노멀벡터를 월드공간으로 변환하기 위한 행렬
+
+#ifdef OCEAN
+uniform sampler2D oceanDisplacement; // OceanSimulation 의 변위맵 (x: x 방향 변위, y: 높이, z: z 방향 변위)
+uniform float oceanScale; // 월드공간 xz 를 바다 텍스쳐 좌표로 바꾸는 배율 (1 / patchSize)
+#endif
+
+invariant gl_Position; // 깊이 프리패스(depthOnly.vert)와 비트 단위로 같은 깊이값이 나오도록 함. (셰이딩 패스는 GL_EQUAL 로 비교함)
+
+void main() {
+  vec3 objPos = pos * positionScale + positionOffset; // 깊이 프리패스와 같은 깊이가 나오도록 모든 셰이더에서 같은 식으로 복원함.
+#ifdef INSTANCED
+  mat4 modelMatrix = instanceModel;
+  mat3 nrmMatrix = instanceNormalMatrix;
+#else
+  mat4 modelMatrix = model;
+  mat3 nrmMatrix = normalMatrix;
+#endif
+
+  fragNrm = nrmMatrix * nrm; // 노말행렬과 오브젝트공간 기준의 노말벡터를 곱해서 월드공간으로 변환된 노말벡터를 구하고, 보간해서 프래그먼트 셰이더로 넘김.
+  fragWorldPos = (modelMatrix * vec4(objPos, 1.0)).xyz; // 버텍스 좌표를 동차좌표로 변환해서 모델행렬과 곱함으로써 월드좌표로 변환함.
+
+#ifdef OCEAN
+  // 변위 전의 격자 위치로 샘플링하므로, 같은 격자점은 항상 같은 텍셀을 따라다님. (프래그먼트의 기울기맵도 같은 좌표를 보간해서 사용함)
+  fragUV = fragWorldPos.xz * oceanScale;
+  fragWorldPos += textureLod(oceanDisplacement, fragUV, 0.0).xyz;
+#else
+  fragUV = vec2(uv.x, 1.0 - uv.y); // 이미지 파일들은 상단부터 이미지 데이터를 저장하지만, OpenGL 은 uv좌표계와 동일하게 좌하단부터 (0, 0)으로 시작되므로, y좌표값만 뒤집어준 것.
+#endif
+
+  // TBN 행렬 계산 및 프래그먼트로 보간
+  vec3 T = normalize(nrmMatrix * tan.xyz); // 탄젠트 벡터를 노말행렬과 곱해 월드공간으로 변환함
+  vec3 B = normalize(nrmMatrix * cross(tan.xyz, nrm.xyz) * (tan.w < 0.0 ? -1.0 : 1.0)); // 바이탄젠트 벡터. uv 가 뒤집힌(mirrored) 부분은 calcTangents() 에서 w 에 -1 을 넣어주므로 방향을 뒤집어줌. (압축 포맷의 2비트 w 는 -1 이 -1/3 로 복원될 수 있으므로 부호만 봄)
+  vec3 N = normalize(nrmMatrix * nrm.xyz); // 노말벡터를 노말행렬과 곱해 월드공간으로 변환함
+  TBN = mat3(T, B, N); // 행렬로 세 벡터를 묶을 때에는, 꼭 T, B, N 순서로 넣어줄 것!
+
+#if defined(INSTANCED) || defined(OCEAN)
+  gl_Position = viewProj * vec4(fragWorldPos, 1.0);
+#else
+  gl_Position = mvp * vec4(objPos, 1.0);
+#endif
+}
@@ -0,0 +1,30 @@
+#version 410
+
+// 업스케일 패스의 프래그먼트 셰이더. 씬 텍스쳐를 바이리니어 필터(GL_LINEAR)로 늘려서 샘플링하고,
+// sharpness 가 0 보다 크면 상하좌우 4 개 텍셀과의 차이를 더해서(언샤프 마스크) 늘리면서 흐려진 윤곽을 되살림.
+// 샤프닝 결과는 주변 5 개 텍셀의 최솟값 ~ 최댓값으로 잘라서, 윤곽 주변에 밝거나 어두운 테두리(링잉)가 생기지 않게 함.
+
+uniform sampler2D sceneColor; // 렌더 스케일로 줄여서 그린 씬 색상
+uniform float sharpness; // 0 ~ 1
+
+in vec2 uv;
+out vec4 outCol;
+
+void main() {
+  vec3 center = texture(sceneColor, uv).rgb;
+  if (sharpness <= 0.0) {
+    outCol = vec4(center, 1.0);
+    return;
+  }
+
+  vec2 texel = 1.0 / vec2(textureSize(sceneColor, 0));
+  vec3 up = texture(sceneColor, uv + vec2(0.0, texel.y)).rgb;
+  vec3 down = texture(sceneColor, uv - vec2(0.0, texel.y)).rgb;
+  vec3 left = texture(sceneColor, uv - vec2(texel.x, 0.0)).rgb;
+  vec3 right = texture(sceneColor, uv + vec2(texel.x, 0.0)).rgb;
+
+  vec3 minCol = min(center, min(min(up, down), min(left, right)));
+  vec3 maxCol = max(center, max(max(up, down), max(left, right)));
+  vec3 sharpened = center + (4.0 * center - up - down - left - right) * sharpness * 0.25;
+  outCol = vec4(clamp(sharpened, minCol, maxCol), 1.0);
+}
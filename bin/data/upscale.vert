@@ -0,0 +1,13 @@
+#version 410
+
+// 낮은 해상도로 그린 씬을 출력 크기로 늘려 그리는 업스케일 패스의 버텍스 셰이더. (DynamicResolution 참고)
+// 정규화 장치 좌표(-1 ~ 1)로 만들어둔 사각형을 그대로 내보내서 화면 전체를 덮고, 같은 위치로 씬 텍스쳐의 uv 를 만듦.
+
+layout(location = 0) in vec3 pos;
+
+out vec2 uv;
+
+void main() {
+  uv = pos.xy * 0.5 + 0.5; // 텍스쳐의 0 번 행이 화면 맨 아래이므로 뒤집지 않아도 됨.
+  gl_Position = vec4(pos.xy, 0.0, 1.0);
+}
@@ -1,59 +1,33 @@
 #version 410
 
+// 클러스터드 포워드 라이팅용 물 버텍스 셰이더. uber.vert 의 OCEAN 변형과 같은 식으로 격자 메쉬를 바다 변위맵만큼 움직임.
+// 노멀은 프래그먼트 셰이더에서 기울기맵으로 만들므로, 버텍스 노멀 / 탄젠트는 사용하지 않음.
+
 // layout 을 이용해서 버텍스 셰이더에서 각 버텍스 데이터가 저장된 순서를 알려줌. (오픈프레임웍스가 버텍스 데이터를 저장하는 순서는 p.74 참고)
 layout(location = 0) in vec3 pos;
-layout(location = 1) in vec4 tan; // 원래 오픈프레임웍스에서 1번 로케이션은 버텍스 컬러가 들어오는 위치지만, 탄젠트 벡터 지원이 안되서 임시로 여기다 탄젠트 벡터 데이터를 추가해서 쓸거임.
-layout(location = 2) in vec3 nrm;
-layout(location = 3) in vec2 uv;
 
-uniform mat4 mvp; // c++ (오픈프레임웍스)에서 합쳐준 투영 * 뷰 * 모델 행렬을 전달받는 유니폼 변수
-uniform mat4 model; // 각 버텍스의 월드좌표를 구하기 위해 mvp 행렬과 별도로 전달받는 모델행렬을 저장할 유니폼 변수
-uniform mat3 normalMatrix; // 조명계산에 필요한 노멀벡터(즉, 월드공간으로 변환된 노멀벡터)를 계산하려면, 노말행렬을 따로 구해서 버텍스 셰이더에 가져옴.
+// PackedMesh 로 올린 메쉬는 위치가 AABB 기준 16비트 정규화 정수(0 ~ 1)로 들어오므로, 오브젝트공간 위치로 되돌리는 변환. (float 메쉬는 기본값인 항등 변환)
+uniform vec3 positionScale = vec3(1.0);
+uniform vec3 positionOffset = vec3(0.0);
 
-out vec3 fragNrm; // 프래그먼트 셰이더로 전송할 water 모델의 노멀벡터
-out vec3 fragWorldPos; // 각 버텍스 셰이더의 월드좌표를 구한 뒤 보간해서 프래그먼트 셰이더로 내보낼 때 사용할 out 변수 -> 즉, 각 프래그먼트의 월드좌표를 구하려는 것
-out mat3 TBN; // 프래그먼트 셰이더에서 샘플링할 탄젠트 공간의 노멀벡터(노말맵에서 샘플링한 벡터)를 월드공간의 노멀벡터로 변환하기 위한 행렬. 보통 TBN 행렬이라고 부름.
+uniform mat4 model; // 격자의 월드좌표를 구하기 위한 모델행렬
+uniform mat4 viewProj; // 투영 * 뷰 행렬 (변위는 월드공간에서 더하므로 mvp 대신 사용함)
 
-// 마치 두 개의 노말맵을 적용한 효과를 내기 위해, 샘플링할 uv좌표값을 서로 다르게 계산하여 프래그먼트 셰이더로 보내려는 것. 
-// 샘플링하려는 uv좌표값을 각각 다르게 전달하면, 샘플링하는 값도 다를테니 결과적으로 서로 다른 노말맵을 사용한 것과 동일한 효과인 것!
-out vec2 fragUV;
-out vec2 fragUV2;
+uniform sampler2D oceanDisplacement; // OceanSimulation 의 변위맵 (x: x 방향 변위, y: 높이, z: z 방향 변위)
+uniform float oceanScale; // 월드공간 xz 를 바다 텍스쳐 좌표로 바꾸는 배율 (1 / patchSize)
 
-// uv 스크롤링을 하기 위해 필요한 시간값을 전달받는 유니폼 변수 (이걸로 현재 프레임의 uv좌표값을 매 프레임마다 갱신해줄거임)
-uniform float time;
+out vec3 fragWorldPos; // 변위까지 더한 월드좌표
+out vec2 fragUV; // 기울기맵을 샘플링할 텍스쳐 좌표
 
-void main() {
-  // 1. 각각 다른 상수로 시간값을 곱함으로써, (샘플링에 의한 가상의)두 노말맵의 uv 스크롤링 속도를 다르게 해주려는 것.
-  float t = time * 0.05;
-  float t2 = time * 0.02;
-
-  // 2. (샘플링에 의한 가상의)두 노말맵의 uv 스크롤링 방향을 다르게 하기 위해, fragUV는 uv.x 컴포넌트에만 시간값을 더해주고, fragUV2는 uv.x, y 모두에 시간값을 더하거나 빼줌.
-  // 방향을 다르게 하기 위해 어느 컴포넌트에 더해줄 지 뺄 지를 결정하는 것은 개발자 재량임. 비쥬얼적으로 좋은 결과가 나올때까지 여러 방향 조합을 시험해볼 것!
-  // 3. 또한, 두 노말맵에 서로 다른 스칼라값인 3.0과 2.0을 곱함으로써, (가상의)두 노말맵이 반복되는 느낌을 줄일 수 있음 -> 이때, 두 숫자는 가급적 최대공약수가 1인 서로소 (ex> 2, 3)으로 곱해주는 게 좋음.
-  fragUV = vec2(uv.x + t, uv.y) * 3.0f;
-  fragUV2 = vec2(uv.x + t2, uv.y - t2) * 2.0f;
-
-  fragNrm = normalMatrix * nrm; // 노말행렬과 오브젝트공간 기준의 노말벡터를 곱해서 월드공간으로 변환된 노말벡터를 구하고, 보간해서 프래그먼트 셰이더로 넘김.
-  fragWorldPos = (model * vec4(pos, 1.0)).xyz; // 버텍스 좌표를 동차좌표로 변환해서 모델행렬과 곱함으로써 월드좌표로 변환하고, vec4값의 xyz만 swizzle 하여 프래그먼트 셰이더로 보간해서 내보냄.
-
-  // TBN 행렬 계산 및 프래그먼트로 보간
-  vec3 T = normalize(normalMatrix * tan.xyz); // 탄젠트 벡터를 노말행렬과 곱해 월드공간으로 변환함 (.xyz로 swizzle 한 이유는, vec4 타입의 버텍스 색상 데이터로 가져왔기 때문)
-  vec3 B = normalize(normalMatrix * cross(tan.xyz, nrm.xyz)); // 바이탄젠트 벡터(탄젠트 벡터와 노말벡터의 외적)을 노말행렬과 곱해 월드공간으로 변환함.
-  vec3 N = normalize(normalMatrix * nrm.xyz); // 노말벡터를 노말행렬과 곱해 월드공간으로 변환함
-  TBN = mat3(T, B, N); // 위에 계산한 세 벡터(모두 변환 후 길이는 1로 정규화된 상태)를 3*3 행렬로 묶어 TBN 행렬로 만든 뒤, 프래그먼트 셰이더로 보간하여 전송 
-  // 행렬로 세 벡터를 묶을 때에는, 인자로 넣어주는 벡터의 순서가 매우 중요하다고 함. 꼭 T, B, N 순서로 넣어줄 것!
-
-  gl_Position = mvp * vec4(pos, 1.0); // 동차좌표계로 변환한 버텍스 위치좌표에 mvp 행렬을 곱해서 변환을 처리한 뒤, 최종 버텍스 위치값을 결정함.
-}
+invariant gl_Position; // 깊이 프리패스(depthOnly.vert)와 비트 단위로 같은 깊이값이 나오도록 함. (셰이딩 패스는 GL_EQUAL 로 비교함)
 
-/*
-  탄젠트 벡터
+void main() {
+  vec3 objPos = pos * positionScale + positionOffset; // 깊이 프리패스와 같은 깊이가 나오도록 모든 셰이더에서 같은 식으로 복원함.
+  vec3 worldPos = (model * vec4(objPos, 1.0)).xyz;
 
-  참고로, c++ 에서 저장한 탄젠트 벡터는
-  오브젝트 공간을 기준으로 계산되었던 것이라고 함.
-  (왜냐면 calcTangents() 함수에서 사용한 삼각형 버텍스들이 
-  오브젝트 공간을 기준으로 위치데이터가 저장되어있을 테니까!)
+  // 변위 전의 격자 위치로 샘플링하므로, 같은 격자점은 항상 같은 텍셀을 따라다님. (프래그먼트의 기울기맵도 같은 좌표를 보간해서 사용함)
+  fragUV = worldPos.xz * oceanScale;
+  fragWorldPos = worldPos + textureLod(oceanDisplacement, fragUV, 0.0).xyz;
 
-  따라서, 탄젠트 벡터도 월드공간으로 변환해야 하고,
-  오브젝트 공간의 탄젠트벡터와 노말벡터를 외적해서 얻은 바이탄젠트 벡터도 월드공간으로 변환해야 한다고 함.
-*/
\ No newline at end of file
+  gl_Position = viewProj * vec4(fragWorldPos, 1.0);
+}
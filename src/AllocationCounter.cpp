@@ -0,0 +1,40 @@
+#include "AllocationCounter.hpp"
+#include <cstdlib>
+#include <new>
+
+#ifdef ALLOCATION_COUNTER
+
+namespace {
+thread_local uint64_t threadAllocations = 0;
+}
+
+// operator new[] 및 nothrow 버전의 기본 구현은 모두 이 함수를 거치므로, 이것만 교체해도 배열 할당까지 세어짐.
+void* operator new(std::size_t size) {
+    threadAllocations++;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace AllocationCounter {
+    bool isEnabled() { return true; }
+    uint64_t getThreadAllocations() { return threadAllocations; }
+}
+
+#else
+
+namespace AllocationCounter {
+    bool isEnabled() { return false; }
+    uint64_t getThreadAllocations() { return 0; }
+}
+
+#endif
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+// 힙 할당 횟수를 세는 카운터.
+// ALLOCATION_COUNTER 매크로를 정의하고 빌드하면 전역 operator new 를 교체해서 스레드별로 할당 횟수를 셈.
+// (정의하지 않으면 operator new 를 건드리지 않고, 카운터는 항상 0 을 리턴함)
+//
+// draw() 앞뒤에서 getThreadAllocations() 값의 차이를 보면 렌더링 경로에서 힙 할당이 일어났는지 확인할 수 있음.
+// 스레드별로 세기 때문에 AssetLoader 워커 스레드 등의 할당은 섞이지 않음.
+namespace AllocationCounter {
+    bool isEnabled();
+    uint64_t getThreadAllocations(); // 현재 스레드에서 지금까지 호출된 operator new 횟수
+}
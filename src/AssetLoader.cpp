@@ -0,0 +1,124 @@
+#include "AssetLoader.hpp"
+#include <chrono>
+
+namespace {
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+}
+
+AssetLoader::AssetLoader(size_t numThreads)
+: pool(numThreads) {
+}
+
+void AssetLoader::loadTexture(const std::filesystem::path& path, ofTexture& texture, std::function<void(ofTexture&)> onLoaded) {
+    Request request;
+    request.path = path;
+    request.texture = &texture;
+    request.onTexture = std::move(onLoaded);
+    enqueue(std::move(request));
+}
+
+void AssetLoader::loadPixels(const std::filesystem::path& path, std::function<void(ofPixels&)> onDecoded) {
+    Request request;
+    request.path = path;
+    request.onPixels = std::move(onDecoded);
+    enqueue(std::move(request));
+}
+
+void AssetLoader::enqueue(Request request) {
+    if (requests.empty()) {
+        startMicros = ofGetElapsedTimeMicros();
+    }
+    size_t index = requests.size();
+    std::filesystem::path fullPath = ofToDataPath(request.path, true); // 워커 스레드에서는 경로만 값으로 복사해서 사용함.
+    requests.push_back(std::move(request));
+    timings.emplace_back();
+    timings.back().path = requests.back().path.string();
+
+    pool.submit([this, index, fullPath]() {
+        auto start = std::chrono::steady_clock::now();
+        Completed result;
+        result.request = index;
+        result.ok = ofLoadImage(result.pixels, fullPath);
+        result.decodeMs = elapsedMs(start);
+
+        std::lock_guard<std::mutex> lock(completedMutex);
+        completed.push_back(std::move(result));
+    });
+}
+
+void AssetLoader::uploadTexture(ofTexture& texture, const ofPixels& pixels) {
+    // 디코딩된 픽셀을 PBO 로 복사한 뒤 PBO 에서 텍스쳐로 업로드함.
+    // glBufferData 는 이전 저장공간을 버리고(orphaning) 새로 할당하므로, 이전 업로드를 기다리며 멈추지 않음.
+    ofBufferObject& pbo = uploadBuffers[uploadIndex];
+    uploadIndex = (uploadIndex + 1) % 2;
+    if (!pbo.isAllocated()) {
+        pbo.allocate();
+    }
+    pbo.setData(pixels.getTotalBytes(), pixels.getData(), GL_STREAM_DRAW);
+
+    texture.allocate(pixels.getWidth(), pixels.getHeight(), ofGetGLInternalFormat(pixels));
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // RGB 이미지는 한 줄의 바이트 수가 4의 배수가 아닐 수 있음.
+    texture.loadData(pbo, ofGetGLFormat(pixels), ofGetGLType(pixels));
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void AssetLoader::update(double uploadBudgetMs) {
+    auto frameStart = std::chrono::steady_clock::now();
+
+    // 예산 안에서 완료 큐를 하나씩 꺼내 처리함. (예산을 넘더라도 최소 하나는 처리해서 로딩이 멈추지 않도록 함)
+    while (!isDone()) {
+        Completed result;
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            if (completed.empty()) {
+                break;
+            }
+            result = std::move(completed.front());
+            completed.pop_front();
+        }
+
+        Request& request = requests[result.request];
+        Timing& timing = timings[result.request];
+        timing.decodeMs = result.decodeMs;
+
+        if (!result.ok) {
+            ofLogError("AssetLoader") << "failed to decode " << request.path;
+        } else {
+            auto uploadStart = std::chrono::steady_clock::now();
+            if (request.texture) {
+                uploadTexture(*request.texture, result.pixels);
+                if (request.onTexture) {
+                    request.onTexture(*request.texture);
+                }
+            } else if (request.onPixels) {
+                request.onPixels(result.pixels);
+            }
+            timing.uploadMs = elapsedMs(uploadStart);
+        }
+
+        numFinished++;
+        if (isDone()) {
+            logTimings();
+        }
+        if (elapsedMs(frameStart) > uploadBudgetMs) {
+            break;
+        }
+    }
+}
+
+void AssetLoader::logTimings() const {
+    double totalDecode = 0.0;
+    double totalUpload = 0.0;
+    for (const Timing& timing : timings) {
+        ofLogNotice("AssetLoader") << timing.path << ": decode " << ofToString(timing.decodeMs, 2) << " ms, upload " << ofToString(timing.uploadMs, 2) << " ms";
+        totalDecode += timing.decodeMs;
+        totalUpload += timing.uploadMs;
+    }
+    double wallMs = (ofGetElapsedTimeMicros() - startMicros) / 1000.0;
+    // 디코딩 시간의 합계는 예전처럼 메인 스레드에서 순서대로 로드했을 때 걸렸을 시간에 해당함.
+    ofLogNotice("AssetLoader") << timings.size() << " assets on " << pool.size() << " threads: "
+        << "serial decode " << ofToString(totalDecode, 2) << " ms + upload " << ofToString(totalUpload, 2) << " ms, "
+        << "wall clock " << ofToString(wallMs, 2) << " ms";
+}
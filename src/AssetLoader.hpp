@@ -0,0 +1,69 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ThreadPool.hpp"
+#include <deque>
+#include <mutex>
+#include <functional>
+
+// 이미지 디코딩은 워커 스레드 풀에서 병렬로 처리하고, GL 업로드만 메인(렌더) 스레드로 넘겨받아 처리하는 에셋 로더.
+//
+// 1. loadTexture() / loadPixels() 를 호출하면 디코딩 작업이 스레드 풀에 들어감.
+// 2. 워커 스레드가 디코딩을 끝내면 결과를 완료 큐(completion queue)에 넣어둠.
+// 3. 메인 스레드는 매 프레임 update() 에서 완료 큐를 꺼내서 PBO(픽셀 버퍼 객체)를 거쳐 텍스쳐로 업로드함.
+//    한 프레임에 업로드하는 시간이 예산(uploadBudgetMs)을 넘으면 나머지는 다음 프레임으로 미룸.
+class AssetLoader {
+public:
+    // 에셋 하나의 디코딩/업로드 시간 기록
+    struct Timing {
+        std::string path;
+        double decodeMs = 0.0; // 워커 스레드에서 이미지 파일을 ofPixels 로 디코딩하는 데 걸린 시간
+        double uploadMs = 0.0; // 메인 스레드에서 GPU 로 업로드하는 데 걸린 시간
+    };
+
+    explicit AssetLoader(size_t numThreads = 0);
+
+    // 디코딩이 끝나면 PBO 를 거쳐 texture 로 업로드하고, onLoaded 를 메인 스레드에서 호출해줌. (텍스쳐 랩 모드 설정 등)
+    void loadTexture(const std::filesystem::path& path, ofTexture& texture, std::function<void(ofTexture&)> onLoaded = nullptr);
+
+    // 디코딩된 픽셀을 메인 스레드에서 onDecoded 로 넘겨줌. (큐브맵처럼 직접 업로드 방식을 정해야 하는 에셋용)
+    void loadPixels(const std::filesystem::path& path, std::function<void(ofPixels&)> onDecoded);
+
+    void update(double uploadBudgetMs = 4.0); // 메인 스레드에서 매 프레임 호출
+
+    bool isDone() const { return numFinished == requests.size(); }
+    float getProgress() const { return requests.empty() ? 1.0f : float(numFinished) / requests.size(); }
+    const std::vector<Timing>& getTimings() const { return timings; }
+
+private:
+    struct Request {
+        std::filesystem::path path;
+        ofTexture* texture = nullptr;
+        std::function<void(ofTexture&)> onTexture;
+        std::function<void(ofPixels&)> onPixels;
+    };
+
+    struct Completed {
+        size_t request;
+        ofPixels pixels;
+        bool ok;
+        double decodeMs;
+    };
+
+    void enqueue(Request request);
+    void uploadTexture(ofTexture& texture, const ofPixels& pixels);
+    void logTimings() const;
+
+    std::vector<Request> requests; // 메인 스레드에서만 접근함.
+    std::vector<Timing> timings;
+    size_t numFinished = 0;
+    uint64_t startMicros = 0;
+
+    ofBufferObject uploadBuffers[2]; // 업로드용 PBO. 번갈아 사용해서 직전 업로드가 끝나기를 기다리지 않도록 함.
+    int uploadIndex = 0;
+
+    std::mutex completedMutex;
+    std::deque<Completed> completed; // 워커 스레드 -> 메인 스레드 완료 큐
+
+    ThreadPool pool; // 가장 마지막에 선언해서 가장 먼저 소멸되도록 함. (워커 스레드가 종료된 뒤에 완료 큐가 사라지도록)
+};
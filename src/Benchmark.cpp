@@ -0,0 +1,446 @@
+#include "Benchmark.hpp"
+#include "FragmentCounter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+struct Summary {
+    double mean = 0.0;
+    double median = 0.0;
+    double p95 = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    size_t count = 0;
+};
+
+// 음수(측정 실패) 값은 빼고 요약함.
+Summary summarize(std::vector<double> values) {
+    values.erase(std::remove_if(values.begin(), values.end(), [](double v) { return v < 0.0; }), values.end());
+    Summary s;
+    s.count = values.size();
+    if (values.empty()) {
+        return s;
+    }
+    std::sort(values.begin(), values.end());
+    for (double v : values) {
+        s.mean += v;
+    }
+    s.mean /= values.size();
+    s.median = values[values.size() / 2];
+    s.p95 = values[std::min(values.size() - 1, size_t(values.size() * 0.95))];
+    s.min = values.front();
+    s.max = values.back();
+    return s;
+}
+
+void writeSummary(std::ofstream& out, const char* name, const Summary& s) {
+    out << "    \"" << name << "\": { \"mean\": " << s.mean << ", \"median\": " << s.median << ", \"p95\": " << s.p95
+        << ", \"min\": " << s.min << ", \"max\": " << s.max << ", \"count\": " << s.count << " }";
+}
+}
+
+bool Benchmark::parseArgs(int argc, char* argv[], Settings& settings) {
+    int first = 1;
+    while (first < argc && std::string(argv[first]) != "--benchmark") {
+        ++first;
+    }
+    if (first == argc) {
+        return false;
+    }
+    settings.enabled = true;
+    for (int i = first + 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (eq == std::string::npos) {
+            ofLogWarning("Benchmark") << "ignoring argument " << arg << " (expected key=value)";
+            continue;
+        }
+        std::string key = arg.substr(0, eq);
+        std::string value = arg.substr(eq + 1);
+        if (key == "frames") {
+            settings.frames = std::max(1, ofToInt(value));
+        } else if (key == "warmup") {
+            settings.warmupFrames = std::max(0, ofToInt(value));
+        } else if (key == "width") {
+            settings.width = std::max(1, ofToInt(value));
+        } else if (key == "height") {
+            settings.height = std::max(1, ofToInt(value));
+        } else if (key == "fps") {
+            settings.timestep = 1.0f / std::max(1.0f, ofToFloat(value));
+        } else if (key == "mode") {
+            if (value == "multipass" || value == "clustered" || value == "deferred") {
+                settings.mode = value;
+            } else {
+                ofLogWarning("Benchmark") << "unknown mode " << value;
+            }
+        } else if (key == "lights") {
+            settings.extraLights = std::max(0, ofToInt(value));
+        } else if (key == "instances") {
+            settings.instances = std::max(0, ofToInt(value));
+        } else if (key == "naive") {
+            settings.naive = ofToInt(value) != 0;
+        } else if (key == "prepass") {
+            settings.prepass = ofToInt(value) != 0;
+        } else if (key == "dynres") {
+            settings.dynamicResolution = ofToInt(value) != 0;
+        } else if (key == "budget") {
+            settings.budgetMs = std::max(0.1f, ofToFloat(value));
+        } else if (key == "shadows") {
+            settings.shadows = ofToInt(value) != 0;
+        } else if (key == "shadowbudget") {
+            settings.shadowBudget = std::max(6, ofToInt(value));
+        } else if (key == "png") {
+            settings.pngInterval = std::max(0, ofToInt(value));
+        } else if (key == "out") {
+            settings.output = value;
+        } else if (key == "backend") {
+            if (value == "gl" || value == "software") {
+                settings.backend = value;
+            } else {
+                ofLogWarning("Benchmark") << "unknown backend " << value;
+            }
+        } else if (key == "threads") {
+            settings.threads = std::max(0, ofToInt(value));
+        } else if (key == "golden") {
+            settings.golden = value;
+        } else if (key == "psnr") {
+            settings.goldenPsnr = ofToFloat(value);
+        } else if (key == "tolerance") {
+            settings.goldenTolerance = std::max(0, ofToInt(value));
+        } else {
+            ofLogWarning("Benchmark") << "unknown option " << key;
+        }
+    }
+    if (settings.backend == "software" && settings.instances > 0) {
+        ofLogWarning("Benchmark") << "the software backend draws a single shield, ignoring instances=" << settings.instances;
+        settings.instances = 0;
+    }
+    if (!settings.golden.empty() && settings.pngInterval == 0) {
+        settings.pngInterval = 60; // 비교할 프레임은 저장하는 프레임과 같음.
+    }
+    return true;
+}
+
+void Benchmark::setup() {
+    frames.assign(settings.frames, Frame());
+    if (isSoftware()) {
+        ofLogNotice("Benchmark") << settings.frames << " frames (+" << settings.warmupFrames << " warmup) at "
+            << settings.width << "x" << settings.height << ", software backend, " << (3 + settings.extraLights) << " point lights";
+        return;
+    }
+
+    ofFboSettings fboSettings;
+    fboSettings.width = settings.width;
+    fboSettings.height = settings.height;
+    fboSettings.internalformat = GL_RGBA8;
+    fboSettings.useDepth = true;
+    fbo.allocate(fboSettings);
+
+    glGenQueries(NUM_QUERIES * 3, &queries[0][0]);
+    for (int i = 0; i < NUM_QUERIES; ++i) {
+        queryFrames[i] = -1;
+    }
+
+    ofLogNotice("Benchmark") << settings.frames << " frames (+" << settings.warmupFrames << " warmup) at "
+        << settings.width << "x" << settings.height << ", " << settings.mode
+        << ", " << (3 + settings.extraLights) << " point lights, " << settings.instances << " shield instances"
+        << (settings.naive ? " (naive)" : "") << (settings.prepass ? ", depth prepass" : "")
+        << (settings.dynamicResolution ? ", dynamic resolution (" + ofToString(settings.budgetMs, 2) + " ms budget)" : "")
+        << (settings.shadows ? ", point shadows (" + ofToString(settings.shadowBudget) + " faces/frame)" : "")
+        << ", counting " << FragmentCounter::getQueryName();
+}
+
+void Benchmark::beginFrame() {
+    frameStartMicros = ofGetElapsedTimeMicros();
+}
+
+void Benchmark::beginDraw() {
+    if (isSoftware()) {
+        drawing = true;
+        return;
+    }
+
+    // 이 슬롯의 쿼리는 NUM_QUERIES 프레임 전에 끝났으므로, 보통은 기다리지 않고 바로 결과를 읽을 수 있음.
+    int slot = frameIndex % NUM_QUERIES;
+    collectQuery(slot);
+
+    fbo.begin();
+    ofClear(0, 0, 0, 255);
+    glQueryCounter(queries[slot][0], GL_TIMESTAMP);
+    glBeginQuery(FragmentCounter::getQueryTarget(), queries[slot][2]);
+    queryFrames[slot] = frameIndex;
+    drawing = true;
+}
+
+void Benchmark::setLatency(double ms) {
+    int measured = frameIndex - settings.warmupFrames;
+    if (measured >= 0 && measured < settings.frames) {
+        frames[measured].latencyMs = ms;
+    }
+}
+
+void Benchmark::setRenderScale(double scale) {
+    int measured = frameIndex - settings.warmupFrames;
+    if (measured >= 0 && measured < settings.frames) {
+        frames[measured].renderScale = scale;
+    }
+}
+
+void Benchmark::setShadowFaces(int rendered, int cached) {
+    int measured = frameIndex - settings.warmupFrames;
+    if (measured >= 0 && measured < settings.frames) {
+        frames[measured].shadowFacesRendered = rendered;
+        frames[measured].shadowFacesCached = cached;
+    }
+}
+
+void Benchmark::endDraw() {
+    if (!drawing) {
+        return;
+    }
+    drawing = false;
+    glEndQuery(FragmentCounter::getQueryTarget());
+    glQueryCounter(queries[frameIndex % NUM_QUERIES][1], GL_TIMESTAMP);
+    fbo.end();
+
+    bool last = frameIndex - settings.warmupFrames + 1 == settings.frames;
+    finishFrame(nullptr);
+    if (last) {
+        for (int i = 0; i < NUM_QUERIES; ++i) {
+            collectQuery(i);
+        }
+        glDeleteQueries(NUM_QUERIES * 3, &queries[0][0]);
+    }
+}
+
+void Benchmark::endDraw(const ofPixels& frame, int64_t shadedPixels) {
+    if (!drawing) {
+        return;
+    }
+    drawing = false;
+    int measured = frameIndex - settings.warmupFrames;
+    if (measured >= 0) {
+        frames[measured].fragments = shadedPixels;
+    }
+    finishFrame(&frame);
+}
+
+void Benchmark::finishFrame(const ofPixels* frame) {
+    int measured = frameIndex - settings.warmupFrames;
+    if (measured >= 0) {
+        frames[measured].cpuMs = (ofGetElapsedTimeMicros() - frameStartMicros) / 1000.0;
+        // PNG 저장(GPU -> CPU 읽기)은 CPU 측정이 끝난 뒤에 함.
+        if (settings.pngInterval > 0 && measured % settings.pngInterval == 0) {
+            if (frame) {
+                saveFrame(measured, *frame);
+            } else {
+                ofPixels pixels;
+                fbo.readToPixels(pixels);
+                saveFrame(measured, pixels);
+            }
+        }
+    }
+
+    ++frameIndex;
+    if (measured + 1 == settings.frames) {
+        finished = true; // 결과는 ofApp 이 (software 백엔드는 처리량을 잰 뒤) writeResults() 로 저장함.
+    }
+}
+
+void Benchmark::addThroughput(size_t threads, double ms) {
+    Throughput t;
+    t.threads = threads;
+    t.ms = ms;
+    t.mpixelsPerSecond = ms > 0.0 ? double(settings.width) * settings.height / (ms * 1000.0) : 0.0;
+    throughput.push_back(t);
+    ofLogNotice("Benchmark") << threads << " threads: " << ofToString(ms, 3) << " ms, " << ofToString(t.mpixelsPerSecond, 2) << " Mpixels/s";
+}
+
+void Benchmark::collectQuery(int slot) {
+    int frame = queryFrames[slot];
+    if (frame < 0) {
+        return;
+    }
+    queryFrames[slot] = -1;
+
+    GLuint64 beginNs = 0;
+    GLuint64 endNs = 0;
+    glGetQueryObjectui64v(queries[slot][0], GL_QUERY_RESULT, &beginNs); // 결과가 아직 없으면 나올 때까지 기다림.
+    glGetQueryObjectui64v(queries[slot][1], GL_QUERY_RESULT, &endNs);
+    GLuint64 elapsedNs = endNs - beginNs;
+    GLuint64 fragments = 0;
+    glGetQueryObjectui64v(queries[slot][2], GL_QUERY_RESULT, &fragments);
+
+    int measured = frame - settings.warmupFrames;
+    if (measured >= 0 && measured < (int)frames.size()) {
+        frames[measured].gpuMs = elapsedNs / 1000000.0;
+        frames[measured].fragments = int64_t(fragments);
+    }
+}
+
+void Benchmark::saveFrame(int frame, const ofPixels& pixels) {
+    if (!settings.golden.empty()) {
+        compareGolden(frame, pixels);
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%05d.png", frame);
+    std::filesystem::path dir = ofToDataPath(settings.output + "_frames", true);
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    ofSaveImage(pixels, dir / name);
+}
+
+// 두 이미지 모두 같은 방향(0 번 행이 화면 맨 아래)으로 저장되므로 그대로 비교함. 알파는 비교하지 않음.
+void Benchmark::compareGolden(int frame, const ofPixels& pixels) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%05d.png", frame);
+    std::filesystem::path path = std::filesystem::path(ofToDataPath(settings.golden + "_frames", true)) / name;
+
+    GoldenResult result;
+    result.frame = frame;
+    ofPixels reference;
+    if (!ofLoadImage(reference, path) || reference.getWidth() != pixels.getWidth() || reference.getHeight() != pixels.getHeight()) {
+        ofLogError("Benchmark") << "missing or mismatched golden image " << path;
+        goldenResults.push_back(result);
+        return;
+    }
+
+    size_t count = pixels.getWidth() * pixels.getHeight();
+    size_t channels = pixels.getNumChannels();
+    size_t referenceChannels = reference.getNumChannels();
+    const uint8_t* a = pixels.getData();
+    const uint8_t* b = reference.getData();
+    double squared = 0.0;
+    size_t over = 0;
+    for (size_t i = 0; i < count; ++i) {
+        int worst = 0;
+        for (size_t c = 0; c < 3; ++c) {
+            int diff = std::abs(int(a[i * channels + std::min(c, channels - 1)]) - int(b[i * referenceChannels + std::min(c, referenceChannels - 1)]));
+            squared += double(diff) * diff;
+            worst = std::max(worst, diff);
+        }
+        result.maxError = std::max(result.maxError, worst);
+        over += worst > settings.goldenTolerance;
+    }
+    double mse = squared / (count * 3.0);
+    result.psnr = mse > 0.0 ? std::min(99.0, 10.0 * std::log10(255.0 * 255.0 / mse)) : 99.0;
+    result.overTolerance = double(over) / count;
+    result.passed = result.psnr >= settings.goldenPsnr;
+    goldenResults.push_back(result);
+    ofLogNotice("Benchmark") << "frame " << frame << " vs golden: PSNR " << ofToString(result.psnr, 2) << " dB, max error " << result.maxError
+        << ", " << ofToString(result.overTolerance * 100.0, 3) << "% over tolerance" << (result.passed ? "" : " (FAILED)");
+}
+
+bool Benchmark::writeResults() const {
+    std::filesystem::path base = ofToDataPath(settings.output, true);
+    std::error_code ec;
+    std::filesystem::create_directories(base.parent_path(), ec);
+
+    std::vector<double> cpu;
+    std::vector<double> gpu;
+    std::vector<double> fragments;
+    std::vector<double> latency;
+    std::vector<double> renderScale;
+    std::vector<double> shadowRendered;
+    std::vector<double> shadowCached;
+    for (const Frame& f : frames) {
+        cpu.push_back(f.cpuMs);
+        gpu.push_back(f.gpuMs);
+        fragments.push_back(double(f.fragments));
+        latency.push_back(f.latencyMs);
+        renderScale.push_back(f.renderScale);
+        shadowRendered.push_back(f.shadowFacesRendered);
+        shadowCached.push_back(f.shadowFacesCached);
+    }
+    Summary cpuSummary = summarize(cpu);
+    Summary gpuSummary = summarize(gpu);
+    Summary fragmentSummary = summarize(fragments);
+    Summary latencySummary = summarize(latency);
+    Summary renderScaleSummary = summarize(renderScale);
+    Summary shadowRenderedSummary = summarize(shadowRendered);
+    Summary shadowCachedSummary = summarize(shadowCached);
+
+    std::filesystem::path csvPath = base;
+    csvPath += ".csv";
+    std::ofstream csv(csvPath);
+    csv << "frame,time,cpu_ms,gpu_ms,fragments,latency_ms,render_scale,shadow_faces_rendered,shadow_faces_cached\n";
+    for (size_t i = 0; i < frames.size(); ++i) {
+        csv << i << "," << (settings.warmupFrames + i) * settings.timestep << "," << frames[i].cpuMs << "," << frames[i].gpuMs
+            << "," << frames[i].fragments << "," << frames[i].latencyMs << "," << frames[i].renderScale
+            << "," << frames[i].shadowFacesRendered << "," << frames[i].shadowFacesCached << "\n";
+    }
+
+    std::filesystem::path jsonPath = base;
+    jsonPath += ".json";
+    std::ofstream json(jsonPath);
+    json << "{\n";
+    json << "  \"settings\": { \"frames\": " << settings.frames << ", \"warmup\": " << settings.warmupFrames
+        << ", \"width\": " << settings.width << ", \"height\": " << settings.height << ", \"timestep\": " << settings.timestep
+        << ", \"mode\": \"" << settings.mode << "\", \"pointLights\": " << (3 + settings.extraLights)
+        << ", \"instances\": " << settings.instances << ", \"naive\": " << (settings.naive ? "true" : "false")
+        << ", \"prepass\": " << (settings.prepass ? "true" : "false") << ", \"dynres\": " << (settings.dynamicResolution ? "true" : "false")
+        << ", \"budget\": " << settings.budgetMs << ", \"shadows\": " << (settings.shadows ? "true" : "false")
+        << ", \"shadowBudget\": " << settings.shadowBudget << ", \"backend\": \"" << settings.backend << "\" },\n";
+    if (isSoftware()) {
+        json << "  \"renderer\": \"software\",\n";
+        json << "  \"fragmentQuery\": \"shaded pixels\",\n";
+    } else {
+        const GLubyte* renderer = glGetString(GL_RENDERER);
+        json << "  \"renderer\": \"" << (renderer ? reinterpret_cast<const char*>(renderer) : "") << "\",\n";
+        json << "  \"fragmentQuery\": \"" << FragmentCounter::getQueryName() << "\",\n";
+    }
+    json << "  \"summary\": {\n";
+    writeSummary(json, "cpu_ms", cpuSummary);
+    json << ",\n";
+    writeSummary(json, "gpu_ms", gpuSummary);
+    json << ",\n";
+    writeSummary(json, "fragments", fragmentSummary);
+    json << ",\n";
+    writeSummary(json, "latency_ms", latencySummary);
+    json << ",\n";
+    writeSummary(json, "render_scale", renderScaleSummary);
+    json << ",\n";
+    writeSummary(json, "shadow_faces_rendered", shadowRenderedSummary);
+    json << ",\n";
+    writeSummary(json, "shadow_faces_cached", shadowCachedSummary);
+    json << "\n  },\n";
+    bool goldenPassed = true;
+    if (!settings.golden.empty()) {
+        json << "  \"golden\": { \"reference\": \"" << settings.golden << "\", \"minPsnr\": " << settings.goldenPsnr
+            << ", \"tolerance\": " << settings.goldenTolerance << ", \"frames\": [\n";
+        for (size_t i = 0; i < goldenResults.size(); ++i) {
+            const GoldenResult& g = goldenResults[i];
+            goldenPassed = goldenPassed && g.passed;
+            json << "    { \"frame\": " << g.frame << ", \"psnr\": " << g.psnr << ", \"max_error\": " << g.maxError
+                << ", \"over_tolerance\": " << g.overTolerance << ", \"passed\": " << (g.passed ? "true" : "false") << " }"
+                << (i + 1 < goldenResults.size() ? ",\n" : "\n");
+        }
+        json << "  ], \"passed\": " << (goldenPassed ? "true" : "false") << " },\n";
+    }
+    if (!throughput.empty()) {
+        json << "  \"throughput\": [\n";
+        for (size_t i = 0; i < throughput.size(); ++i) {
+            json << "    { \"threads\": " << throughput[i].threads << ", \"ms\": " << throughput[i].ms
+                << ", \"mpixels_per_s\": " << throughput[i].mpixelsPerSecond << " }" << (i + 1 < throughput.size() ? ",\n" : "\n");
+        }
+        json << "  ],\n";
+    }
+    json << "  \"frames\": [\n";
+    for (size_t i = 0; i < frames.size(); ++i) {
+        json << "    { \"cpu_ms\": " << frames[i].cpuMs << ", \"gpu_ms\": " << frames[i].gpuMs << ", \"fragments\": " << frames[i].fragments
+            << ", \"latency_ms\": " << frames[i].latencyMs << ", \"render_scale\": " << frames[i].renderScale
+            << ", \"shadow_faces_rendered\": " << frames[i].shadowFacesRendered << ", \"shadow_faces_cached\": " << frames[i].shadowFacesCached << " }"
+            << (i + 1 < frames.size() ? ",\n" : "\n");
+    }
+    json << "  ]\n}\n";
+
+    if (!csv || !json) {
+        ofLogError("Benchmark") << "can't write results to " << base;
+        return false;
+    }
+    ofLogNotice("Benchmark") << "cpu " << ofToString(cpuSummary.mean, 3) << " ms mean / " << ofToString(cpuSummary.p95, 3) << " ms p95, "
+        << "gpu " << ofToString(gpuSummary.mean, 3) << " ms mean / " << ofToString(gpuSummary.p95, 3) << " ms p95, "
+        << ofToString(int64_t(fragmentSummary.mean)) << " " << (isSoftware() ? "shaded pixels" : FragmentCounter::getQueryName()) << " mean -> " << csvPath;
+    return goldenPassed;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "ofMain.h"
+#include <string>
+#include <vector>
+
+// 윈도우 없이(숨겨진 윈도우의 GL 컨텍스트에서) FBO 로 씬을 그리면서 프레임 시간을 재는 벤치마크 모드.
+//
+// 'variableMultiLight --benchmark frames=600 lights=256 mode=clustered out=bench/run' 처럼 실행하면
+// (인스턴싱 비교는 'instances=10000 naive=1', 깊이 프리패스 비교는 'prepass=1', 동적 해상도는 'dynres=1 budget=8', 포인트라이트 그림자는 'shadows=1 shadowbudget=12' 처럼 실행)
+// 1. 에셋 로드가 끝난 뒤 워밍업 프레임(셰이더 변형 컴파일 등)을 먼저 그리고,
+// 2. 고정된 타임스텝으로 카메라/라이트를 정해진 경로대로 움직이면서 frames 개의 프레임을 그림.
+// 3. 프레임마다 CPU 시간(update() 시작 ~ draw() 끝)과 GPU 시간(draw() 앞뒤의 GL_TIMESTAMP 쿼리 차이)을 기록해서
+//    프래그먼트 수(FragmentCounter 와 같은 쿼리)와 스냅샷 지연시간도 함께 <out>.csv 와 <out>.json 으로 저장하고 종료함. (png=N 을 주면 N 프레임마다 <out>_frames/ 에 PNG 도 저장함)
+// 시간값이 벽시계가 아닌 프레임 번호로만 정해지므로, 같은 설정이면 매번 같은 이미지를 그림.
+// (시뮬레이션 스레드는 렌더링보다 앞서가지만, 스냅샷을 만든 순서대로 빠짐없이 그리므로 frame 번째 스냅샷이 항상 frame 번째로 그려짐)
+//
+// 'backend=software threads=8' 을 주면 GL 컨텍스트 없이(ofAppNoWindow) SoftwareRenderer 로 그리며, GPU 시간 대신 셰이딩한 픽셀 수를 기록함.
+// 이 때는 측정이 끝난 뒤 마지막 프레임을 스레드 수 1, 2, 4, ... 로 다시 그려서 코어 수에 따른 처리량(Mpixels/s)도 함께 저장함.
+// 'golden=bench/gl' 을 주면 저장하는 PNG 마다 bench/gl_frames/ 의 같은 번호 이미지(예: GL 경로로 저장해둔 결과)와 비교해서
+// PSNR 이 goldenPsnr 보다 낮은 프레임이 있으면 실패(종료 코드 1)로 처리함.
+class Benchmark {
+public:
+    struct Settings {
+        bool enabled = false;
+        int frames = 300; // 측정할 프레임 수
+        int warmupFrames = 30; // 측정 전에 버리는 프레임 수
+        int width = 1024;
+        int height = 768;
+        float timestep = 1.0f / 60.0f; // 프레임당 진행시킬 고정 시간값 (초)
+        std::string mode = "multipass"; // 측정할 렌더링 방식 (multipass, clustered, deferred)
+        int extraLights = 0; // 기본 포인트라이트 3개에 추가할 무작위 포인트라이트 개수 (고정 시드)
+        int instances = 0; // 방패 메쉬 인스턴스 개수 (0 이면 방패 1개만 그림)
+        bool naive = false; // 인스턴싱 대신 인스턴스마다 드로우콜을 하나씩 호출할지 여부 (비교용)
+        bool prepass = false; // 깊이 프리패스를 켤지 여부
+        bool dynamicResolution = false; // GPU 시간에 맞춰 렌더 스케일을 조절할지 여부 (켜면 프레임마다 그리는 크기가 달라질 수 있음)
+        float budgetMs = 1000.0f / 60.0f; // 동적 해상도의 GPU 프레임 시간 목표
+        bool shadows = false; // 포인트라이트 그림자를 켤지 여부
+        int shadowBudget = 36; // 프레임당 다시 그릴 수 있는 셰도우맵 면 수 (PointShadowCache::Settings::faceBudget)
+        int pngInterval = 0; // 0 이면 PNG 를 저장하지 않음
+        std::string output = "benchmark"; // 결과 파일 경로 (확장자 제외, data 폴더 기준)
+        std::string backend = "gl"; // gl 또는 software (GPU 없는 노드)
+        int threads = 0; // software 백엔드의 스레드 수 (0 이면 CPU 코어 개수만큼)
+        std::string golden; // 비교할 기준 이미지들의 결과 파일 경로 (<golden>_frames/frame_XXXXX.png, 비어있으면 비교하지 않음)
+        float goldenPsnr = 30.0f; // 기준 이미지와의 PSNR(dB) 이 이보다 낮으면 실패
+        int goldenTolerance = 16; // 채널 차이가 이보다 큰 픽셀 비율도 함께 기록함. (밉맵 유무 같은 필터링 차이는 이 정도 안에 들어옴)
+    };
+
+    // 한 프레임의 측정값
+    struct Frame {
+        double cpuMs = 0.0;
+        double gpuMs = -1.0; // 쿼리 결과를 아직 못 읽었거나 실패하면 음수
+        int64_t fragments = -1; // 프래그먼트 셰이더 호출 수 (또는 깊이 테스트를 통과한 샘플 수, FragmentCounter 참고)
+        double latencyMs = -1.0; // 시뮬레이션 스레드가 이 프레임의 스냅샷을 만들기 시작한 뒤 draw() 가 끝날 때까지 걸린 시간
+        double renderScale = 1.0; // 씬을 그린 해상도 / 출력 해상도 (가로, 세로 각각)
+        int shadowFacesRendered = 0; // 이번 프레임에 다시 그린 셰도우맵 면 수
+        int shadowFacesCached = 0; // 보이는 라이트의 면 중 캐시된 타일을 그대로 쓴 면 수
+    };
+
+    // 기준 이미지와 비교한 결과 (PNG 를 저장하는 프레임마다)
+    struct GoldenResult {
+        int frame = 0;
+        double psnr = 0.0; // 완전히 같으면 무한대 대신 99 로 기록함.
+        int maxError = 0; // 채널 차이의 최댓값 (0 ~ 255)
+        double overTolerance = 0.0; // 채널 차이가 goldenTolerance 보다 큰 픽셀 비율 (0 ~ 1)
+        bool passed = false;
+    };
+
+    // 스레드 수별 처리량 (software 백엔드)
+    struct Throughput {
+        size_t threads = 0;
+        double ms = 0.0; // 한 프레임을 그리는 데 걸린 시간 (반복 중 최솟값)
+        double mpixelsPerSecond = 0.0;
+    };
+
+    // main() 의 인자 중 '--benchmark' 와 그 뒤의 key=value 들을 읽음. '--benchmark' 가 없으면 false
+    static bool parseArgs(int argc, char* argv[], Settings& settings);
+
+    void configure(const Settings& settings) { this->settings = settings; }
+    void setup(); // GL 컨텍스트가 만들어진 뒤(ofApp::setup) 호출
+
+    bool isEnabled() const { return settings.enabled; }
+    bool isSoftware() const { return settings.backend == "software"; }
+    const Settings& getSettings() const { return settings; }
+    float getTime(int frame) const { return frame * settings.timestep; } // frame 번째로 그릴 프레임의 스크립트(카메라/라이트 경로) 시간값
+    bool isFinished() const { return finished; }
+
+    void beginFrame(); // update() 맨 앞에서 호출
+    void beginDraw(); // draw() 에서 씬을 그리기 전에 호출 (FBO 바인딩 및 GPU 타이머 시작, software 백엔드는 아무것도 하지 않음)
+    void setLatency(double ms); // endDraw() 전에 호출해서 이번 프레임의 스냅샷 지연시간을 기록함.
+    void setRenderScale(double scale); // endDraw() 전에 호출해서 이번 프레임의 렌더 스케일을 기록함.
+    void setShadowFaces(int rendered, int cached); // endDraw() 전에 호출해서 이번 프레임에 다시 그린 / 캐시에서 쓴 셰도우맵 면 수를 기록함.
+    void endDraw(); // draw() 맨 끝에서 호출. 마지막 프레임이면 isFinished() 가 true 가 됨.
+    void endDraw(const ofPixels& frame, int64_t shadedPixels); // software 백엔드에서 endDraw() 대신 호출 (0 번 행이 화면 맨 아래인 RGBA8 결과)
+
+    void addThroughput(size_t threads, double ms); // isFinished() 이후, 결과를 저장하기 전에 스레드 수별 측정값을 추가함.
+    bool writeResults() const; // 측정 결과를 저장함. 기준 이미지와 다르거나 저장에 실패하면 false
+
+private:
+    static const int NUM_QUERIES = 3; // 쿼리 결과를 기다리지 않도록 몇 프레임 뒤에 읽음.
+
+    void collectQuery(int slot); // 이 슬롯의 쿼리 결과를 읽어서 해당 프레임 기록에 저장함.
+    void finishFrame(const ofPixels* frame); // 프레임 기록을 마무리함. (frame 이 없으면 FBO 에서 읽음)
+    void saveFrame(int frame, const ofPixels& pixels);
+    void compareGolden(int frame, const ofPixels& pixels);
+
+    Settings settings;
+    ofFbo fbo;
+    GLuint queries[NUM_QUERIES][3] = {}; // 프레임 시작/끝 타임스탬프 (GL_TIME_ELAPSED 와 달리 프로파일러의 구간 쿼리와 겹쳐도 됨) + 프래그먼트 수
+    int queryFrames[NUM_QUERIES]; // 각 쿼리가 측정 중인 프레임 번호 (-1: 비어있음)
+    std::vector<Frame> frames; // 측정 프레임 기록 (setup 에서 미리 할당)
+    std::vector<GoldenResult> goldenResults;
+    std::vector<Throughput> throughput;
+    int frameIndex = 0; // 워밍업을 포함해서 지금까지 그린 프레임 수
+    uint64_t frameStartMicros = 0;
+    bool drawing = false;
+    bool finished = false;
+};
@@ -0,0 +1,262 @@
+#include "CubemapBuilder.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+namespace {
+
+// ofxEasyCubemap::loadKTX() 가 읽는 KTX 1.1 헤더와 같은 구조
+struct KTXHeader {
+    unsigned char identifier[12];
+    uint32_t endianness;
+    uint32_t glType;
+    uint32_t glTypeSize;
+    uint32_t glFormat;
+    uint32_t glInternalFormat;
+    uint32_t glBaseInternalFormat;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t numberOfArrayElements;
+    uint32_t numberOfFaces;
+    uint32_t numberOfMipmapLevels;
+    uint32_t bytesOfKeyValueData;
+};
+
+// 한 밉 레벨의 RGB8 픽셀 (행 순서는 ofPixels 그대로: 기존 load() 와 같은 방향으로 보이도록 위쪽 행부터 저장함)
+struct Image {
+    int size = 0;
+    std::vector<uint8_t> rgb;
+};
+
+// 2x2 박스 필터로 다음 밉 레벨을 만듦. (glGenerateMipmap 과 같은 방식)
+Image downsample(const Image& src) {
+    Image dst;
+    dst.size = std::max(1, src.size / 2);
+    dst.rgb.resize(size_t(dst.size) * dst.size * 3);
+    for (int y = 0; y < dst.size; ++y) {
+        for (int x = 0; x < dst.size; ++x) {
+            int x0 = std::min(x * 2, src.size - 1), x1 = std::min(x * 2 + 1, src.size - 1);
+            int y0 = std::min(y * 2, src.size - 1), y1 = std::min(y * 2 + 1, src.size - 1);
+            for (int c = 0; c < 3; ++c) {
+                int sum = src.rgb[(size_t(y0) * src.size + x0) * 3 + c] + src.rgb[(size_t(y0) * src.size + x1) * 3 + c]
+                        + src.rgb[(size_t(y1) * src.size + x0) * 3 + c] + src.rgb[(size_t(y1) * src.size + x1) * 3 + c];
+                dst.rgb[(size_t(y) * dst.size + x) * 3 + c] = uint8_t((sum + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+uint16_t packRGB565(const glm::vec3& c) {
+    int r = int(glm::clamp(c.x, 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+    int g = int(glm::clamp(c.y, 0.0f, 255.0f) * 63.0f / 255.0f + 0.5f);
+    int b = int(glm::clamp(c.z, 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+    return uint16_t((r << 11) | (g << 5) | b);
+}
+
+glm::vec3 unpackRGB565(uint16_t c) {
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    return glm::vec3((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2));
+}
+
+// 4x4 블록 하나를 BC1(DXT1) 8 바이트로 압축함.
+// 블록 색상들의 주성분 축(principal axis)을 따라 양 끝점을 잡고, 각 픽셀을 4단계 팔레트 중 가장 가까운 색으로 매핑함.
+void encodeBlockBC1(const glm::vec3 block[16], uint8_t out[8]) {
+    glm::vec3 mean(0.0f);
+    for (int i = 0; i < 16; ++i) {
+        mean += block[i];
+    }
+    mean /= 16.0f;
+
+    // 공분산 행렬의 주성분 축을 거듭제곱법(power iteration)으로 구함.
+    float cov[6] = { 0, 0, 0, 0, 0, 0 };
+    for (int i = 0; i < 16; ++i) {
+        glm::vec3 d = block[i] - mean;
+        cov[0] += d.x * d.x; cov[1] += d.x * d.y; cov[2] += d.x * d.z;
+        cov[3] += d.y * d.y; cov[4] += d.y * d.z; cov[5] += d.z * d.z;
+    }
+    glm::vec3 axis(1.0f, 1.0f, 1.0f);
+    for (int iter = 0; iter < 4; ++iter) {
+        glm::vec3 next(cov[0] * axis.x + cov[1] * axis.y + cov[2] * axis.z,
+                       cov[1] * axis.x + cov[3] * axis.y + cov[4] * axis.z,
+                       cov[2] * axis.x + cov[4] * axis.y + cov[5] * axis.z);
+        float len = glm::length(next);
+        if (len < 1e-6f) {
+            break; // 단색 블록
+        }
+        axis = next / len;
+    }
+
+    float minT = 0.0f, maxT = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+        float t = glm::dot(block[i] - mean, axis);
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    // 양 끝점을 살짝 안쪽으로 당기면(inset) 565 양자화 오차가 줄어듦.
+    float inset = (maxT - minT) / 32.0f;
+    uint16_t c0 = packRGB565(mean + axis * (maxT - inset));
+    uint16_t c1 = packRGB565(mean + axis * (minT + inset));
+    if (c0 < c1) {
+        std::swap(c0, c1); // c0 > c1 이어야 4색 모드로 해석됨.
+    }
+
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        glm::vec3 palette[4];
+        palette[0] = unpackRGB565(c0);
+        palette[1] = unpackRGB565(c1);
+        palette[2] = (palette[0] * 2.0f + palette[1]) / 3.0f;
+        palette[3] = (palette[0] + palette[1] * 2.0f) / 3.0f;
+        for (int i = 0; i < 16; ++i) {
+            int best = 0;
+            float bestDist = std::numeric_limits<float>::max();
+            for (int p = 0; p < 4; ++p) {
+                glm::vec3 d = block[i] - palette[p];
+                float dist = glm::dot(d, d);
+                if (dist < bestDist) {
+                    bestDist = dist;
+                    best = p;
+                }
+            }
+            indices |= uint32_t(best) << (i * 2);
+        }
+    }
+
+    out[0] = uint8_t(c0); out[1] = uint8_t(c0 >> 8);
+    out[2] = uint8_t(c1); out[3] = uint8_t(c1 >> 8);
+    for (int i = 0; i < 4; ++i) {
+        out[4 + i] = uint8_t(indices >> (i * 8));
+    }
+}
+
+// 밉 레벨 하나를 BC1 블록들로 압축함. 4x4 보다 작은 레벨은 가장자리 픽셀을 반복해서 블록을 채움.
+std::vector<uint8_t> encodeBC1(const Image& image) {
+    int blocks = std::max(1, (image.size + 3) / 4);
+    std::vector<uint8_t> out(size_t(blocks) * blocks * 8);
+    glm::vec3 block[16];
+    for (int by = 0; by < blocks; ++by) {
+        for (int bx = 0; bx < blocks; ++bx) {
+            for (int i = 0; i < 16; ++i) {
+                int x = std::min(bx * 4 + i % 4, image.size - 1);
+                int y = std::min(by * 4 + i / 4, image.size - 1);
+                const uint8_t* p = &image.rgb[(size_t(y) * image.size + x) * 3];
+                block[i] = glm::vec3(p[0], p[1], p[2]);
+            }
+            encodeBlockBC1(block, &out[(size_t(by) * blocks + bx) * 8]);
+        }
+    }
+    return out;
+}
+
+}
+
+namespace CubemapBuilder {
+
+bool buildKTX(const std::filesystem::path& output, const std::filesystem::path faces[6]) {
+    // 각 면을 디코딩 -> 밉 체인 생성 -> BC1 압축까지 면마다 별도 스레드에서 처리함.
+    // levels[face][level] = 압축된 블록 데이터
+    std::vector<std::vector<uint8_t>> levels[6];
+    int sizes[6] = { 0, 0, 0, 0, 0, 0 };
+    bool ok[6] = { false, false, false, false, false, false };
+
+    std::vector<std::thread> threads;
+    for (int face = 0; face < 6; ++face) {
+        std::filesystem::path path = ofToDataPath(faces[face], true);
+        threads.emplace_back([&, face, path]() {
+            ofPixels pixels;
+            if (!ofLoadImage(pixels, path) || pixels.getWidth() != pixels.getHeight()) {
+                return;
+            }
+            pixels.setImageType(OF_IMAGE_COLOR);
+
+            Image image;
+            image.size = int(pixels.getWidth());
+            image.rgb.assign(pixels.getData(), pixels.getData() + pixels.getTotalBytes());
+            sizes[face] = image.size;
+
+            // 1x1 까지의 전체 밉 체인
+            while (true) {
+                levels[face].push_back(encodeBC1(image));
+                if (image.size == 1) {
+                    break;
+                }
+                image = downsample(image);
+            }
+            ok[face] = true;
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (int face = 0; face < 6; ++face) {
+        if (!ok[face]) {
+            ofLogError("CubemapBuilder") << "failed to load " << faces[face] << " (faces must be square)";
+            return false;
+        }
+        if (sizes[face] != sizes[0]) {
+            ofLogError("CubemapBuilder") << "not all faces are the same size";
+            return false;
+        }
+    }
+
+    KTXHeader header;
+    const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    std::memcpy(header.identifier, identifier, sizeof(identifier));
+    header.endianness = 0x04030201;
+    header.glType = 0; // 압축 포맷
+    header.glTypeSize = 1;
+    header.glFormat = 0;
+    header.glInternalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    header.glBaseInternalFormat = GL_RGB;
+    header.pixelWidth = sizes[0];
+    header.pixelHeight = sizes[0];
+    header.pixelDepth = 0;
+    header.numberOfArrayElements = 0;
+    header.numberOfFaces = 6;
+    header.numberOfMipmapLevels = uint32_t(levels[0].size());
+    header.bytesOfKeyValueData = 0;
+
+    // 쓰는 도중에 실패해도 기존 파일이 깨지지 않도록, 임시 파일에 쓴 뒤 이름을 바꿈.
+    std::filesystem::path outPath = ofToDataPath(output, true);
+    std::filesystem::path tmpPath = outPath;
+    tmpPath += ".tmp";
+    size_t totalBytes = 0;
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        // KTX 레이아웃: 레벨마다 [한 면의 바이트 수] + 6개 면 데이터 (BC1 블록은 8 바이트 단위라 4 바이트 패딩이 필요없음)
+        for (size_t level = 0; level < levels[0].size(); ++level) {
+            uint32_t imageSize = uint32_t(levels[0][level].size());
+            out.write(reinterpret_cast<const char*>(&imageSize), sizeof(imageSize));
+            for (int face = 0; face < 6; ++face) {
+                out.write(reinterpret_cast<const char*>(levels[face][level].data()), imageSize);
+                totalBytes += imageSize;
+            }
+        }
+        if (!out) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, outPath, ec);
+    if (ec) {
+        return false;
+    }
+
+    ofLogNotice("CubemapBuilder") << output << ": " << sizes[0] << "x" << sizes[0] << " BC1, "
+        << levels[0].size() << " mip levels, " << totalBytes / 1024 << " KB";
+    return true;
+}
+
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "ofMain.h"
+
+// 큐브맵 6면 이미지(JPG 등)를 미리 밉맵 체인까지 만들어 둔 블록 압축(BC1) KTX 파일로 변환하는 오프라인 변환기.
+// (main.cpp 의 --build-cubemap 옵션에서 사용)
+//
+// 런타임에는 ofxEasyCubemap::loadKTX() 가 이 파일을 glCompressedTexImage2D 로 그대로 업로드하므로,
+// 이미지 디코딩과 glGenerateMipmap 이 사라지고 VRAM 사용량도 RGB8 대비 1/6 로 줄어듦.
+namespace CubemapBuilder {
+
+    // faces 는 GL 큐브맵 순서 (right, left, top, bottom, front, back)
+    bool buildKTX(const std::filesystem::path& output, const std::filesystem::path faces[6]);
+}
@@ -0,0 +1,87 @@
+#include "DynamicResolution.hpp"
+
+void DynamicResolution::setup() {
+    glGenQueries(NUM_QUERIES * 2, &queries[0][0]);
+}
+
+void DynamicResolution::setEnabled(bool enable) {
+    enabled = enable;
+    if (!enabled) {
+        setScale(settings.maxScale);
+    }
+}
+
+void DynamicResolution::beginFrame() {
+    // 이 슬롯의 쿼리는 NUM_QUERIES 프레임 전에 끝났지만, 결과가 아직 없으면 기다리지 않고 이번 프레임은 건너뜀.
+    int slot = frame % NUM_QUERIES;
+    if (pending[slot]) {
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 beginNs = 0;
+            GLuint64 endNs = 0;
+            glGetQueryObjectui64v(queries[slot][0], GL_QUERY_RESULT, &beginNs);
+            glGetQueryObjectui64v(queries[slot][1], GL_QUERY_RESULT, &endNs);
+            pending[slot] = false;
+            adjust((endNs - beginNs) / 1000000.0f);
+        }
+    }
+    if (pending[slot]) {
+        active = false;
+        return;
+    }
+    glQueryCounter(queries[slot][0], GL_TIMESTAMP);
+    active = true;
+}
+
+void DynamicResolution::endFrame() {
+    if (active) {
+        glQueryCounter(queries[frame % NUM_QUERIES][1], GL_TIMESTAMP);
+        pending[frame % NUM_QUERIES] = true;
+        active = false;
+    }
+    ++frame;
+}
+
+void DynamicResolution::adjust(float gpuMs) {
+    stats.gpuMs = gpuMs;
+    if (cooldown > 0) {
+        --cooldown; // 이전 스케일로 그린 프레임의 측정값
+        return;
+    }
+    stats.averageMs = stats.averageMs < 0.0f ? gpuMs : stats.averageMs + (gpuMs - stats.averageMs) * settings.smoothing;
+    if (!enabled) {
+        return;
+    }
+
+    if (stats.averageMs > settings.targetMs) {
+        underBudget = 0;
+        if (++overBudget >= settings.downFrames && scale > settings.minScale) {
+            // 픽셀 수(= scale^2)에 시간이 비례한다고 보고 목표에 맞는 스케일을 추정한 뒤, step 단위로 내림.
+            float estimate = scale * std::sqrt(settings.targetMs / stats.averageMs);
+            float next = std::floor(estimate / settings.step + 1e-3f) * settings.step;
+            setScale(std::min(next, scale - settings.step));
+        }
+    } else if (stats.averageMs < settings.targetMs * settings.headroom) {
+        overBudget = 0;
+        if (++underBudget >= settings.upFrames && scale < settings.maxScale) {
+            setScale(scale + settings.step);
+        }
+    } else {
+        overBudget = 0;
+        underBudget = 0;
+    }
+}
+
+void DynamicResolution::setScale(float next) {
+    next = ofClamp(std::round(next / settings.step) * settings.step, settings.minScale, settings.maxScale);
+    overBudget = 0;
+    underBudget = 0;
+    if (next == scale) {
+        return;
+    }
+    scale = next;
+    stats.changes++;
+    stats.averageMs = -1.0f;
+    cooldown = NUM_QUERIES;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "ofMain.h"
+#include <cstdint>
+
+// 측정한 GPU 프레임 시간에 맞춰서 씬을 그리는 해상도(렌더 스케일)를 조절하는 컨트롤러.
+//
+// - 씬 렌더링 앞뒤에 GL_TIMESTAMP 쿼리를 넣고, NUM_QUERIES 프레임 뒤에 결과가 나와 있을 때만 읽음. (GPU 를 기다리지 않음)
+// - 측정값의 지수이동평균(EMA)이 목표 시간보다 downFrames 프레임 연속으로 크면 스케일을 내리고,
+//   목표 시간 * headroom 보다 upFrames 프레임 연속으로 작으면 한 단계 올림. (내릴 때는 빨리, 올릴 때는 천천히 움직이는 히스테리시스)
+// - 내릴 때는 픽셀 수가 시간에 비례한다고 보고 scale * sqrt(목표 / 평균) 까지 한 번에 내림. (최소 한 단계)
+// - 스케일은 step 단위로만 움직이므로 렌더 타겟은 스케일이 바뀐 프레임에만 다시 할당됨.
+//   바뀐 직후 NUM_QUERIES 프레임은 이전 스케일로 그린 결과가 나오므로 측정값을 버리고, 평균도 새로 시작함.
+class DynamicResolution {
+public:
+    struct Settings {
+        float targetMs = 1000.0f / 60.0f; // GPU 프레임 시간 목표
+        float minScale = 0.5f; // 가로/세로 각각에 곱하는 값의 범위
+        float maxScale = 1.0f;
+        float step = 0.05f;
+        float headroom = 0.85f; // 평균이 목표 * headroom 보다 작아야 스케일을 올림.
+        int downFrames = 3;
+        int upFrames = 30;
+        float smoothing = 0.2f; // EMA 에서 새 측정값의 비중
+        float sharpness = 0.5f; // 업스케일할 때 샤프닝 세기 (0 이면 바이리니어만)
+    };
+
+    struct Stats {
+        float gpuMs = -1.0f; // 가장 최근에 읽은 측정값 (아직 없으면 음수)
+        float averageMs = -1.0f; // 현재 스케일에서의 EMA
+        int changes = 0; // 지금까지 스케일을 바꾼 횟수
+    };
+
+    void setup(); // 쿼리 객체 생성 (GL 컨텍스트 생성 이후 호출)
+
+    // 끄면 스케일을 settings.maxScale 로 되돌림. (측정은 계속함)
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled; }
+    void setTargetMs(float ms) { settings.targetMs = ms; }
+    const Settings& getSettings() const { return settings; }
+
+    // 씬 렌더링 앞뒤에 호출. beginFrame() 이 이전 프레임들의 결과를 읽어서 이번 프레임의 스케일을 정함.
+    void beginFrame();
+    void endFrame();
+
+    float getScale() const { return scale; }
+    int getRenderWidth(int width) const { return scaled(width); } // 출력 크기를 스케일에 맞춰 줄인 렌더 타겟 크기
+    int getRenderHeight(int height) const { return scaled(height); }
+    const Stats& getStats() const { return stats; }
+
+private:
+    static const int NUM_QUERIES = 3;
+
+    int scaled(int size) const { return std::max(1, int(size * scale + 0.5f)); }
+    void adjust(float gpuMs);
+    void setScale(float next);
+
+    Settings settings;
+    GLuint queries[NUM_QUERIES][2] = {}; // [슬롯][시작, 끝]
+    bool pending[NUM_QUERIES] = {};
+    int frame = 0;
+    bool active = false;
+    bool enabled = false;
+
+    float scale = 1.0f;
+    int overBudget = 0; // 목표보다 느린 프레임이 연속된 수
+    int underBudget = 0; // 여유가 있는 프레임이 연속된 수
+    int cooldown = 0; // 스케일을 바꾼 뒤 버릴 남은 측정값 수
+    Stats stats;
+};
@@ -0,0 +1,41 @@
+#include "FragmentCounter.hpp"
+
+#ifndef GL_FRAGMENT_SHADER_INVOCATIONS_ARB
+#define GL_FRAGMENT_SHADER_INVOCATIONS_ARB 0x82F4 // GL_ARB_pipeline_statistics_query (OpenGL 4.1 헤더에는 없음)
+#endif
+
+GLenum FragmentCounter::getQueryTarget() {
+    static const GLenum target = ofGLCheckExtension("GL_ARB_pipeline_statistics_query") ? GL_FRAGMENT_SHADER_INVOCATIONS_ARB : GL_SAMPLES_PASSED;
+    return target;
+}
+
+const char* FragmentCounter::getQueryName() {
+    return getQueryTarget() == GL_SAMPLES_PASSED ? "samples passed" : "fragment shader invocations";
+}
+
+void FragmentCounter::setup() {
+    glGenQueries(NUM_QUERIES, queries);
+}
+
+void FragmentCounter::begin() {
+    // 이 슬롯의 쿼리는 NUM_QUERIES 프레임 전에 끝났으므로, 보통은 기다리지 않고 바로 결과를 읽을 수 있음.
+    int slot = frame % NUM_QUERIES;
+    if (pending[slot]) {
+        GLuint64 count = 0;
+        glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &count);
+        lastResult = int64_t(count);
+        pending[slot] = false;
+    }
+    glBeginQuery(getQueryTarget(), queries[slot]);
+    active = true;
+}
+
+void FragmentCounter::end() {
+    if (!active) {
+        return;
+    }
+    glEndQuery(getQueryTarget());
+    pending[frame % NUM_QUERIES] = true;
+    active = false;
+    ++frame;
+}
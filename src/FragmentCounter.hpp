@@ -0,0 +1,32 @@
+#pragma once
+
+#include "ofMain.h"
+#include <cstdint>
+
+// 한 프레임 동안 실행된 프래그먼트 셰이더 수를 GPU 쿼리로 세는 클래스. (깊이 프리패스로 줄어든 오버드로우를 숫자로 확인하기 위함)
+//
+// GL_ARB_pipeline_statistics_query 가 있으면 GL_FRAGMENT_SHADER_INVOCATIONS_ARB 로 실제 호출 수를 세고,
+// 없으면 (macOS 의 OpenGL 4.1 처럼) GL_SAMPLES_PASSED 로 깊이 테스트를 통과한 샘플 수를 셈.
+// 후자는 깊이 테스트에서 버려진 프래그먼트를 세지 않으므로, early-Z 로 셰이더 실행 전에 버려지는 경우에만 호출 수와 같아짐.
+// 결과는 NUM_QUERIES 프레임 뒤에 읽으므로 보통은 GPU 를 기다리지 않음. (Benchmark 의 타임스탬프 쿼리와 같은 방식)
+// 같은 종류의 쿼리는 동시에 둘 이상 열 수 없으므로, 벤치마크 모드에서는 이 클래스 대신 Benchmark 가 프레임마다 같은 쿼리를 직접 사용함.
+class FragmentCounter {
+public:
+    static GLenum getQueryTarget(); // 이 드라이버에서 사용할 쿼리 종류
+    static const char* getQueryName(); // 통계에 표시할 쿼리 이름
+
+    void setup(); // 쿼리 객체 생성 (GL 컨텍스트 생성 이후 호출)
+    void begin();
+    void end();
+
+    int64_t getLastResult() const { return lastResult; } // 가장 최근에 읽은 프레임의 결과 (아직 없으면 -1)
+
+private:
+    static const int NUM_QUERIES = 3;
+
+    GLuint queries[NUM_QUERIES] = {};
+    bool pending[NUM_QUERIES] = {};
+    int frame = 0;
+    bool active = false;
+    int64_t lastResult = -1;
+};
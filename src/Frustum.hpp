@@ -0,0 +1,33 @@
+#pragma once
+
+#include "ofMain.h"
+
+// 투영 * 뷰 행렬에서 뽑아낸 카메라 프러스텀 6개 평면. (LightCulling, InstanceBuffer 에서 구체 컬링에 사용)
+struct Frustum {
+    glm::vec4 planes[6]; // xyz: 프러스텀 안쪽을 향하는 단위 법선, w: 원점으로부터의 거리
+
+    // 투영 * 뷰 행렬의 네 번째 행에 나머지 행들을 더하고 빼서 좌/우/하/상/근/원 평면을 구함.
+    void setFromMatrix(const glm::mat4& viewProj) {
+        glm::vec4 rows[4];
+        for (int r = 0; r < 4; ++r) {
+            rows[r] = glm::vec4(viewProj[0][r], viewProj[1][r], viewProj[2][r], viewProj[3][r]);
+        }
+        for (int i = 0; i < 3; ++i) {
+            planes[i * 2 + 0] = rows[3] + rows[i];
+            planes[i * 2 + 1] = rows[3] - rows[i];
+        }
+        for (glm::vec4& plane : planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+    }
+
+    // 구체가 어느 한 평면의 바깥쪽에 완전히 있으면 false (보수적인 검사라서 모서리 근처는 true 가 나올 수 있음)
+    bool intersectsSphere(const glm::vec3& center, float radius) const {
+        for (const glm::vec4& plane : planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
@@ -0,0 +1,46 @@
+#include "GBuffer.hpp"
+
+void GBuffer::allocate(int width, int height) {
+    if (fbo.isAllocated() && width == this->width && height == this->height) {
+        return;
+    }
+    this->width = width;
+    this->height = height;
+
+    ofFboSettings settings;
+    settings.width = width;
+    settings.height = height;
+    settings.colorFormats = { GL_RGBA8, GL_RGBA8, GL_RG16, GL_RGBA8 }; // Attachment 순서와 같아야 함.
+    settings.useDepth = true;
+    settings.depthStencilAsTexture = true;
+    settings.depthStencilInternalFormat = GL_DEPTH_COMPONENT24;
+    settings.minFilter = GL_NEAREST; // 조명 패스는 texelFetch 로 픽셀 단위로만 읽음.
+    settings.maxFilter = GL_NEAREST;
+    fbo.allocate(settings);
+    fbo.getTexture(Light).setTextureMinMagFilter(GL_LINEAR, GL_LINEAR); // 동적 해상도에서는 업스케일 패스가 Light 를 늘려서 샘플링함.
+}
+
+void GBuffer::beginGeometryPass(GLbitfield clearMask) {
+    fbo.begin();
+    fbo.activateAllDrawBuffers();
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(clearMask);
+    fbo.activateDrawBuffers({ Albedo, Material, Normal });
+}
+
+void GBuffer::beginLightingPass() {
+    fbo.begin();
+    fbo.setActiveDrawBuffer(Light); // 조명 셰이더의 출력(location 0)이 Light 에 기록됨.
+}
+
+void GBuffer::end() {
+    fbo.end();
+}
+
+void GBuffer::bind(MaterialBinding& mat) const {
+    mat.setTexture(MaterialBinding::GAlbedo, fbo.getTexture(Albedo));
+    mat.setTexture(MaterialBinding::GMaterial, fbo.getTexture(Material));
+    mat.setTexture(MaterialBinding::GNormal, fbo.getTexture(Normal));
+    mat.setTexture(MaterialBinding::GDepth, fbo.getDepthTexture());
+    mat.set(MaterialBinding::ScreenSize, glm::vec2(width, height));
+}
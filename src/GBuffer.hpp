@@ -0,0 +1,45 @@
+#pragma once
+
+#include "ofMain.h"
+#include "MaterialBinding.hpp"
+
+// 디퍼드 모드에서 사용하는 G-버퍼. 방패/물 메쉬를 한 번만 그려서 재질과 노멀을 기록해두고, 조명 패스들이 픽셀마다 읽어감.
+//
+// 대역폭을 아끼기 위해 픽셀당 12 바이트 + 깊이만 사용함. (월드 위치는 깊이값에서 복원)
+//   Albedo   (RGBA8) : rgb 디퓨즈 색상 (물은 환경맵 반사 색상), a 스펙큘러 마스크
+//   Material (RGBA8) : rgb 방패의 sceneLight 에 섞을 환경맵 반사 색상, a 재질 (0: 방패, 1: 물)
+//   Normal   (RG16)  : 팔면체(octahedral) 인코딩한 월드공간 노멀
+//   Light    (RGBA8) : 조명 패스들이 가산 블렌딩으로 누적하는 최종 색상 (스카이박스도 여기에 포워드로 그림)
+// 깊이는 텍스쳐로 붙여서 조명 패스에서 위치 복원 및 라이트 볼륨의 깊이 테스트에 함께 사용함.
+class GBuffer {
+public:
+    enum Attachment {
+        Albedo,
+        Material,
+        Normal,
+        Light,
+        NUM_ATTACHMENTS
+    };
+
+    // 크기가 바뀌었을 때만 다시 할당함. (MaterialBinding::beginFrame() 전에 호출해야 텍스쳐 유닛 캐시가 어긋나지 않음)
+    void allocate(int width, int height);
+
+    // FBO 바인딩 후 clearMask 에 해당하는 버퍼들을 지우고, Albedo / Material / Normal 에만 그리도록 함.
+    // 깊이 프리패스를 쓰면 프리패스가 깊이만, 지오메트리 패스가 색상만 지움. (glClear 도 깊이/색상 쓰기 마스크를 따르므로 나눠서 지워야 함)
+    void beginGeometryPass(GLbitfield clearMask = GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    void beginLightingPass(); // FBO 바인딩 후 Light 에만 그리도록 함. (블렌딩, 깊이 상태는 렌더 그래프의 패스 선언에서 지정)
+    void end();
+
+    // 조명 셰이더의 G-버퍼 샘플러 및 화면 크기 유니폼 전송
+    void bind(MaterialBinding& mat) const;
+
+    const ofTexture& getLightTexture() const { return fbo.getTexture(Light); }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    static int getBytesPerPixel() { return 4 + 4 + 4 + 4; } // Albedo + Material + Normal + 깊이 (Light 제외)
+
+private:
+    ofFbo fbo;
+    int width = 0;
+    int height = 0;
+};
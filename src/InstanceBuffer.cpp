@@ -0,0 +1,98 @@
+#include "InstanceBuffer.hpp"
+
+void InstanceBuffer::setup(PackedMesh& mesh) {
+    this->mesh = &mesh;
+
+    // 오브젝트 공간 경계구: AABB 중심을 중심으로, 가장 먼 버텍스까지의 거리를 반경으로 잡음.
+    glm::vec3 lo(std::numeric_limits<float>::max());
+    glm::vec3 hi(-std::numeric_limits<float>::max());
+    for (const glm::vec3& v : mesh.getMesh().getVertices()) {
+        lo = glm::min(lo, v);
+        hi = glm::max(hi, v);
+    }
+    localCenter = (lo + hi) * 0.5f;
+    localRadius = 0.0f;
+    for (const glm::vec3& v : mesh.getMesh().getVertices()) {
+        localRadius = std::max(localRadius, glm::length(v - localCenter));
+    }
+
+    // 처음에는 인스턴스 1개 분량만 할당해두고, cull() 에서 부족하면 늘림.
+    capacity = 1;
+    buffer.allocate();
+    buffer.setData(sizeof(Instance) * capacity, nullptr, GL_STREAM_DRAW);
+
+    // 인스턴스 속성은 버텍스마다가 아니라 인스턴스마다 한 칸씩 넘어가도록 divisor 를 1로 지정함.
+    for (int column = 0; column < 4; ++column) {
+        mesh.setInstanceAttribute(MODEL_LOCATION + column, buffer, 4, sizeof(Instance), offsetof(Instance, model) + column * sizeof(glm::vec4));
+    }
+    for (int column = 0; column < 3; ++column) {
+        mesh.setInstanceAttribute(NORMAL_MATRIX_LOCATION + column, buffer, 3, sizeof(Instance), offsetof(Instance, normalMatrix) + column * sizeof(glm::vec3));
+    }
+}
+
+void InstanceBuffer::setTransforms(const std::vector<glm::mat4>& transforms) {
+    instances.resize(transforms.size());
+    spheres.resize(transforms.size());
+    for (size_t i = 0; i < transforms.size(); ++i) {
+        const glm::mat4& model = transforms[i];
+        instances[i].model = model;
+        instances[i].normalMatrix = glm::mat3(glm::transpose(glm::inverse(model))); // 노말행렬은 '모델행렬의 상단 3*3 역행렬의 전치행렬'
+
+        // 비균등 스케일이 있을 수 있으므로, 가장 많이 늘어나는 축의 스케일로 반경을 키움.
+        float scale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) });
+        spheres[i] = glm::vec4(glm::vec3(model * glm::vec4(localCenter, 1.0f)), localRadius * scale);
+    }
+    visible.reserve(instances.size());
+}
+
+void InstanceBuffer::clear() {
+    instances.clear();
+    spheres.clear();
+    visible.clear();
+}
+
+bool InstanceBuffer::getBounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const {
+    if (spheres.empty()) {
+        return false;
+    }
+    boundsMin = glm::vec3(std::numeric_limits<float>::max());
+    boundsMax = glm::vec3(-std::numeric_limits<float>::max());
+    for (const glm::vec4& sphere : spheres) {
+        boundsMin = glm::min(boundsMin, glm::vec3(sphere) - sphere.w);
+        boundsMax = glm::max(boundsMax, glm::vec3(sphere) + sphere.w);
+    }
+    return true;
+}
+
+size_t InstanceBuffer::cull(const glm::mat4& viewProj) {
+    frustum.setFromMatrix(viewProj);
+
+    // 보이는 인스턴스만 앞에서부터 채워서 GPU 로 올릴 구간을 연속으로 만듦.
+    visible.clear();
+    for (size_t i = 0; i < instances.size(); ++i) {
+        if (frustum.intersectsSphere(glm::vec3(spheres[i]), spheres[i].w)) {
+            visible.push_back(instances[i]);
+        }
+    }
+
+    stats.total = uint32_t(instances.size());
+    stats.visible = uint32_t(visible.size());
+    stats.uploadBytes = visible.size() * sizeof(Instance);
+    if (visible.empty()) {
+        return 0;
+    }
+
+    // 용량이 부족하면 2배씩 늘려서 새로 할당(orphaning)하고, 아니면 필요한 구간만 덮어씀.
+    if (visible.size() > capacity) {
+        capacity = std::max(visible.size(), capacity * 2);
+        buffer.setData(sizeof(Instance) * capacity, nullptr, GL_STREAM_DRAW);
+    }
+    buffer.updateData(0, stats.uploadBytes, visible.data());
+    return visible.size();
+}
+
+void InstanceBuffer::draw(MaterialBinding& mat) const {
+    if (!visible.empty()) {
+        mat.drawInstanced(*mesh, int(visible.size()));
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Frustum.hpp"
+#include "MaterialBinding.hpp"
+#include "PackedMesh.hpp"
+#include <cstdint>
+#include <vector>
+
+// 같은 메쉬를 여러 개 그릴 때, 인스턴스별 변환행렬을 GPU 버퍼(인스턴스 버퍼)에 담아서 드로우콜 한 번으로 그리는 클래스.
+//
+// - 앱은 setTransforms() 로 인스턴스별 모델행렬을 넘겨줌. 노말행렬은 행렬이 바뀔 때 CPU 에서 미리 계산해둠.
+// - 매 프레임 cull() 에서 인스턴스의 경계구를 프러스텀과 검사하고, 보이는 인스턴스만 앞쪽으로 모아서(compaction) 업로드함.
+// - draw() 는 모아둔 인스턴스 수만큼 glDrawElementsInstanced 로 한 번에 그림.
+//   버텍스 셰이더에서는 location 4 ~ 7 (모델행렬), 8 ~ 10 (노말행렬) 의 인스턴스 속성으로 읽어감. (uber.vert 의 INSTANCED 참고)
+class InstanceBuffer {
+public:
+    static const int MODEL_LOCATION = 4; // mat4 이므로 4 ~ 7 번 로케이션을 차지함.
+    static const int NORMAL_MATRIX_LOCATION = 8; // mat3 이므로 8 ~ 10 번 로케이션을 차지함.
+
+    // GPU 로 올리는 인스턴스 하나의 데이터 (100 바이트)
+    struct Instance {
+        glm::mat4 model;
+        glm::mat3 normalMatrix;
+    };
+
+    struct Stats {
+        uint32_t total = 0;
+        uint32_t visible = 0;
+        size_t uploadBytes = 0;
+    };
+
+    // 인스턴스 속성을 mesh 의 VAO 에 연결함. (GL 컨텍스트 생성 이후, 메쉬 로드가 끝난 뒤 호출)
+    void setup(PackedMesh& mesh);
+
+    void setTransforms(const std::vector<glm::mat4>& transforms);
+    void clear();
+    size_t size() const { return instances.size(); }
+
+    // 모든 인스턴스를 감싸는 월드공간 AABB (인스턴스가 없으면 false)
+    bool getBounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const;
+
+    // 프러스텀 밖의 인스턴스를 걸러내고, 보이는 인스턴스들만 인스턴스 버퍼로 올림. 보이는 인스턴스 수를 리턴함.
+    size_t cull(const glm::mat4& viewProj);
+
+    // 직전 cull() 에서 보이는 인스턴스들을 한 번에 그림.
+    void draw(MaterialBinding& mat) const;
+
+    // 직전 cull() 에서 살아남은 인스턴스들 (인스턴싱 없이 하나씩 그리는 비교용 경로에서 사용)
+    const std::vector<Instance>& getVisible() const { return visible; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    PackedMesh* mesh = nullptr;
+    glm::vec3 localCenter; // 메쉬 오브젝트 공간 경계구
+    float localRadius = 0.0f;
+
+    std::vector<Instance> instances;
+    std::vector<glm::vec4> spheres; // 인스턴스별 월드공간 경계구 (xyz: 중심, w: 반경)
+    std::vector<Instance> visible; // 프러스텀을 통과한 인스턴스들을 앞에서부터 채운 배열 (용량은 유지함)
+
+    ofBufferObject buffer;
+    size_t capacity = 0; // 인스턴스 버퍼에 할당된 인스턴스 수
+    Frustum frustum;
+    Stats stats;
+};
@@ -0,0 +1,63 @@
+#include "LightBuffer.hpp"
+
+void LightBuffer::setup(size_t initialCapacity) {
+    posRadiusBuffer.allocate();
+    colorBuffer.allocate();
+    reserve(std::max<size_t>(initialCapacity, 1));
+
+    // 텍스쳐 버퍼는 버퍼 객체의 이름(id)을 참조하므로, 나중에 버퍼를 다시 할당해도 텍스쳐 버퍼를 새로 만들 필요는 없음.
+    posRadiusTex.allocateAsBufferTexture(posRadiusBuffer, GL_RGBA32F);
+    colorTex.allocateAsBufferTexture(colorBuffer, GL_RGB32F);
+}
+
+void LightBuffer::reserve(size_t newCapacity) {
+    // glBufferData(nullptr) 로 새 저장공간을 할당받음(orphaning). 이전 저장공간은 GPU 가 다 쓰고 나면 드라이버가 알아서 해제함.
+    capacity = newCapacity;
+    posRadiusBuffer.setData(capacity * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+    colorBuffer.setData(capacity * sizeof(glm::vec3), nullptr, GL_DYNAMIC_DRAW);
+}
+
+void LightBuffer::sync(const LightSystem& lights) {
+    using namespace glm;
+
+    lastUploadBytes = 0;
+
+    bool reallocated = false;
+    if (lights.size() > capacity) {
+        reserve(std::max(lights.size(), capacity * 2)); // 용량이 부족하면 2배씩 늘림.
+        reallocated = true;
+    }
+
+    count = lights.size();
+    posRadius.resize(count);
+
+    // 바뀐 라이트들의 인덱스 범위 [dirtyBegin, dirtyEnd). 라이트가 지워져서 배열이 줄었다면 남은 개수까지만 올림.
+    const LightSystem::DirtyRange& dirty = lights.getDirtyRange();
+    size_t dirtyBegin = dirty.begin;
+    size_t dirtyEnd = std::min<size_t>(dirty.end, count);
+
+    // 버퍼를 새로 할당했다면 이전 내용이 사라졌으므로 전체를 다시 올려야 함.
+    if (reallocated) {
+        dirtyBegin = 0;
+        dirtyEnd = count;
+    }
+    if (dirtyBegin >= dirtyEnd) {
+        return; // 바뀐 라이트가 없으면 업로드할 것도 없음.
+    }
+
+    const std::vector<vec3>& positions = lights.getPositions();
+    const std::vector<float>& radii = lights.getRadii();
+    for (size_t i = dirtyBegin; i < dirtyEnd; ++i) {
+        posRadius[i] = vec4(positions[i], radii[i]);
+    }
+
+    size_t n = dirtyEnd - dirtyBegin;
+    posRadiusBuffer.updateData(dirtyBegin * sizeof(vec4), n * sizeof(vec4), &posRadius[dirtyBegin]);
+    colorBuffer.updateData(dirtyBegin * sizeof(vec3), n * sizeof(vec3), &lights.getColors()[dirtyBegin]);
+    lastUploadBytes = n * (sizeof(vec4) + sizeof(vec3));
+}
+
+void LightBuffer::bind(MaterialBinding& mat) const {
+    mat.setTexture(MaterialBinding::LightPosRadius, posRadiusTex);
+    mat.setTexture(MaterialBinding::LightColor, colorTex);
+}
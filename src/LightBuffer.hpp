@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ofMain.h"
+#include "MaterialBinding.hpp"
+#include "LightSystem.hpp"
+#include <vector>
+
+// 포인트라이트 데이터를 GPU 버퍼에 촘촘하게(struct-of-arrays) 저장해두고, 셰이더에서는 라이트 인덱스로 읽어가도록 하는 클래스.
+// 라이트마다 setUniform3f/1f 를 이름으로 호출하는 대신, LightSystem 이 모아둔 바뀐 구간(dirty range)만 glBufferSubData 로 다시 올려줌.
+// 버퍼 안의 라이트 인덱스는 LightSystem 배열의 인덱스와 같음.
+//
+// OpenGL 4.1 (macOS) 에는 SSBO 와 persistent mapping 이 없으므로, 텍스쳐 버퍼(samplerBuffer)로 읽어가고,
+// 용량이 부족해질 때는 버퍼를 새로 할당(orphaning)해서 드라이버가 이전 프레임 데이터와 동기화하지 않도록 함.
+class LightBuffer {
+public:
+    void setup(size_t initialCapacity = 256); // 버퍼 객체 및 텍스쳐 버퍼 생성 (GL 컨텍스트 생성 이후 호출)
+
+    // LightSystem 의 dirty range 만 GPU 로 업로드함. (버퍼를 새로 할당한 경우에는 전체)
+    void sync(const LightSystem& lights);
+
+    // 셰이더의 lightPosRadius, lightColor 텍스쳐 버퍼 유니폼에 바인딩함.
+    void bind(MaterialBinding& mat) const;
+
+    size_t size() const { return count; }
+    size_t getLastUploadBytes() const { return lastUploadBytes; } // 직전 sync() 에서 실제로 업로드한 바이트 수
+
+private:
+    void reserve(size_t capacity);
+
+    size_t count = 0;
+    size_t capacity = 0;
+    size_t lastUploadBytes = 0;
+
+    // 위치와 반경을 텍스쳐 버퍼 한 텍셀(GL_RGBA32F, 16 바이트)로 묶어두는 패킹 배열. 바뀐 구간만 다시 채움.
+    // 색상 * 강도(GL_RGB32F, 12 바이트)는 LightSystem 의 배열을 그대로 업로드함.
+    std::vector<glm::vec4> posRadius;
+
+    ofBufferObject posRadiusBuffer;
+    ofBufferObject colorBuffer;
+    ofTexture posRadiusTex;
+    ofTexture colorTex;
+};
@@ -0,0 +1,153 @@
+#include "LightClusters.hpp"
+
+// 버퍼 객체에 데이터를 업로드하는 보조함수
+// 기존 버퍼 크기보다 큰 데이터가 들어오면 glBufferData 로 새로 할당(orphaning)하고, 아니면 glBufferSubData 로 필요한 범위만 덮어씀.
+static void uploadBuffer(ofBufferObject& buffer, const void* data, size_t bytes) {
+    if (bytes == 0) {
+        return;
+    }
+    if (bytes > buffer.size()) {
+        buffer.setData(bytes * 2, nullptr, GL_STREAM_DRAW); // 매 프레임 재할당하지 않도록 여유분을 두고 2배로 할당함.
+    }
+    buffer.updateData(0, bytes, data);
+}
+
+void LightClusters::setup() {
+    // 텍스쳐 버퍼는 할당된 버퍼 객체가 있어야 생성할 수 있으므로, 적당한 초기 크기로 미리 할당해 둠.
+    clusterGridBuffer.allocate();
+    clusterGridBuffer.setData(sizeof(unsigned int) * 2 * NUM_CLUSTERS, nullptr, GL_STREAM_DRAW);
+    lightIndexBuffer.allocate();
+    lightIndexBuffer.setData(sizeof(unsigned int) * NUM_CLUSTERS * 4, nullptr, GL_STREAM_DRAW);
+
+    clusterGridTex.allocateAsBufferTexture(clusterGridBuffer, GL_RG32UI);
+    lightIndexTex.allocateAsBufferTexture(lightIndexBuffer, GL_R32UI);
+
+    clusterGrid.resize(NUM_CLUSTERS * 2);
+}
+
+// 뷰 공간 구체(포인트라이트 영향범위)가 걸치는 클러스터 범위를 보수적(conservative)으로 계산함.
+// 화면 영역에 전혀 걸치지 않거나 깊이 범위를 벗어나면 false 를 리턴함.
+bool LightClusters::computeRange(const glm::vec3& viewPos, float radius, const glm::mat4& proj, ClusterRange& range) const {
+    using namespace glm;
+
+    // 뷰 공간은 카메라가 -z 방향을 바라보므로, 깊이(카메라로부터의 거리)는 -z 로 계산함.
+    float zMin = -viewPos.z - radius;
+    float zMax = -viewPos.z + radius;
+    if (zMax < nearClip || zMin > farClip) {
+        return false;
+    }
+
+    // 깊이 슬라이스는 지수 분할을 사용함. slice = log(z / near) / log(far / near) * GRID_Z
+    float logRatio = log(farClip / nearClip);
+    auto sliceOf = [&](float z) {
+        z = clamp(z, nearClip, farClip);
+        return clamp(int(floor(log(z / nearClip) / logRatio * GRID_Z)), 0, GRID_Z - 1);
+    };
+    range.minZ = sliceOf(zMin);
+    range.maxZ = sliceOf(zMax);
+
+    // 구체가 카메라 앞쪽 근평면에 걸쳐있으면 투영 결과가 뒤집힐 수 있으므로, 화면 전체 타일을 범위로 잡음.
+    if (zMin <= nearClip) {
+        range.minX = 0; range.maxX = GRID_X - 1;
+        range.minY = 0; range.maxY = GRID_Y - 1;
+        return true;
+    }
+
+    // 구체를 감싸는 뷰 공간 AABB 의 8개 꼭지점을 투영해서 NDC 상의 사각형 범위를 구함.
+    // (AABB 의 투영 범위는 항상 구체의 투영 범위를 포함하므로 보수적인 결과가 나옴.)
+    vec2 ndcMin(1.0f);
+    vec2 ndcMax(-1.0f);
+    for (int i = 0; i < 8; ++i) {
+        vec3 corner = viewPos + vec3((i & 1) ? radius : -radius,
+                                     (i & 2) ? radius : -radius,
+                                     (i & 4) ? radius : -radius);
+        vec4 clip = proj * vec4(corner, 1.0f);
+        vec2 ndc = vec2(clip.x, clip.y) / clip.w;
+        ndcMin = min(ndcMin, ndc);
+        ndcMax = max(ndcMax, ndc);
+    }
+    if (ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f) {
+        return false; // 화면 밖
+    }
+
+    // NDC(-1 ~ 1) -> 타일 인덱스로 변환. 셰이더의 gl_FragCoord 와 동일하게 좌하단이 (0, 0) 타일임.
+    range.minX = clamp(int(floor((ndcMin.x * 0.5f + 0.5f) * GRID_X)), 0, GRID_X - 1);
+    range.maxX = clamp(int(floor((ndcMax.x * 0.5f + 0.5f) * GRID_X)), 0, GRID_X - 1);
+    range.minY = clamp(int(floor((ndcMin.y * 0.5f + 0.5f) * GRID_Y)), 0, GRID_Y - 1);
+    range.maxY = clamp(int(floor((ndcMax.y * 0.5f + 0.5f) * GRID_Y)), 0, GRID_Y - 1);
+    return true;
+}
+
+void LightClusters::update(const LightSystem& lights, const glm::mat4& view, const glm::mat4& proj, float nearClip, float farClip) {
+    using namespace glm;
+
+    this->nearClip = nearClip;
+    this->farClip = farClip;
+
+    // 1. 각 라이트가 걸치는 클러스터 범위를 구함.
+    const std::vector<vec3>& positions = lights.getPositions();
+    const std::vector<float>& radii = lights.getRadii();
+    ranges.resize(lights.size());
+    std::fill(clusterGrid.begin(), clusterGrid.end(), 0u);
+
+    for (size_t i = 0; i < lights.size(); ++i) {
+        vec3 viewPos = vec3(view * vec4(positions[i], 1.0f));
+        ClusterRange& r = ranges[i];
+        if (!computeRange(viewPos, radii[i], proj, r)) {
+            r.minX = 1; r.maxX = 0; // 빈 범위로 만들어서 아래 루프에서 건너뛰도록 함.
+            r.minY = r.maxY = r.minZ = r.maxZ = 0;
+            continue;
+        }
+
+        // 2. 클러스터마다 몇 개의 라이트가 들어가는지 먼저 세어둠. (clusterGrid 의 홀수 칸을 카운터로 사용)
+        for (int z = r.minZ; z <= r.maxZ; ++z) {
+            for (int y = r.minY; y <= r.maxY; ++y) {
+                for (int x = r.minX; x <= r.maxX; ++x) {
+                    int cluster = x + GRID_X * (y + GRID_Y * z);
+                    clusterGrid[cluster * 2 + 1]++;
+                }
+            }
+        }
+    }
+
+    // 3. 누적합(prefix sum)으로 각 클러스터의 시작 오프셋을 구함. 이렇게 하면 클러스터별 동적배열을 따로 만들지 않아도 됨.
+    unsigned int offset = 0;
+    maxLightsPerCluster = 0;
+    for (int c = 0; c < NUM_CLUSTERS; ++c) {
+        clusterGrid[c * 2 + 0] = offset;
+        offset += clusterGrid[c * 2 + 1];
+        maxLightsPerCluster = std::max(maxLightsPerCluster, clusterGrid[c * 2 + 1]);
+        clusterGrid[c * 2 + 1] = 0; // 아래 채우기 단계에서 다시 카운터로 사용하기 위해 0으로 초기화
+    }
+
+    // 4. 각 클러스터 구간에 라이트 인덱스를 채워넣음.
+    lightIndices.resize(offset);
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        const ClusterRange& r = ranges[i];
+        for (int z = r.minZ; z <= r.maxZ; ++z) {
+            for (int y = r.minY; y <= r.maxY; ++y) {
+                for (int x = r.minX; x <= r.maxX; ++x) {
+                    int cluster = x + GRID_X * (y + GRID_Y * z);
+                    unsigned int& count = clusterGrid[cluster * 2 + 1];
+                    lightIndices[clusterGrid[cluster * 2 + 0] + count] = (unsigned int)i;
+                    count++;
+                }
+            }
+        }
+    }
+
+    // 5. GPU 로 업로드
+    uploadBuffer(clusterGridBuffer, clusterGrid.data(), clusterGrid.size() * sizeof(unsigned int));
+    uploadBuffer(lightIndexBuffer, lightIndices.data(), lightIndices.size() * sizeof(unsigned int));
+}
+
+void LightClusters::bind(MaterialBinding& mat) const {
+    mat.setTexture(MaterialBinding::ClusterGrid, clusterGridTex);
+    mat.setTexture(MaterialBinding::LightIndices, lightIndexTex);
+
+    // 셰이더는 gl_FragCoord 로 타일을 찾으므로, 실제 프레임버퍼(뷰포트) 크기를 넘겨줘야 함. (레티나 디스플레이에서는 윈도우 크기와 다름)
+    ofRectangle viewport = ofGetNativeViewport(); // glGetIntegerv(GL_VIEWPORT) 와 달리 GL 상태 조회 없이 오픈프레임웍스가 기억해둔 값을 가져옴.
+    mat.set(MaterialBinding::ClusterDims, glm::vec3(GRID_X, GRID_Y, GRID_Z)); // 값이 그대로면 MaterialBinding 이 GL 호출을 생략함.
+    mat.set(MaterialBinding::ScreenSize, glm::vec2(viewport.width, viewport.height));
+    mat.set(MaterialBinding::ClusterDepth, glm::vec2(nearClip, log(farClip / nearClip)));
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ofMain.h"
+#include "MaterialBinding.hpp"
+#include "LightSystem.hpp"
+#include <vector>
+
+// 클러스터드 포워드 라이팅에 필요한 CPU 측 클러스터 할당 + GPU 버퍼 업로드를 담당하는 클래스
+// 화면을 GRID_X * GRID_Y 타일로, 뷰 공간 깊이를 GRID_Z 개의 지수(exponential) 슬라이스로 쪼갠 뒤,
+// 각 클러스터(3차원 셀)에 영향을 주는 포인트라이트 인덱스 목록을 매 프레임 CPU 에서 만들어서 텍스쳐 버퍼로 올려줌.
+// 라이트 데이터 자체(위치, 반경, 색상)는 LightBuffer 가 관리하고, 셰이더에서는 여기서 만든 인덱스로 LightBuffer 를 읽어감.
+class LightClusters {
+public:
+    static const int GRID_X = 16;
+    static const int GRID_Y = 9;
+    static const int GRID_Z = 24;
+    static const int NUM_CLUSTERS = GRID_X * GRID_Y * GRID_Z;
+
+    void setup(); // 텍스쳐 버퍼로 사용할 버퍼 객체들을 생성함. (GL 컨텍스트가 생성된 이후 ofApp::setup() 에서 호출)
+
+    // 매 프레임 포인트라이트들을 클러스터에 할당하고 GPU 로 업로드함. (lights 의 인덱스가 곧 LightBuffer 의 인덱스)
+    void update(const LightSystem& lights, const glm::mat4& view, const glm::mat4& proj, float nearClip, float farClip);
+
+    // 클러스터드 셰이더에 필요한 텍스쳐 버퍼 및 그리드 파라미터들을 유니폼 변수로 전송함.
+    void bind(MaterialBinding& mat) const;
+
+    size_t getNumLightIndices() const { return lightIndices.size(); } // 모든 클러스터에 할당된 라이트 인덱스 총 개수
+    unsigned int getMaxLightsPerCluster() const { return maxLightsPerCluster; } // 가장 많은 라이트가 몰린 클러스터의 라이트 개수
+
+private:
+    // 각 라이트가 차지하는 클러스터 범위 (min 포함, max 포함)
+    struct ClusterRange {
+        int minX, maxX, minY, maxY, minZ, maxZ;
+    };
+
+    bool computeRange(const glm::vec3& viewPos, float radius, const glm::mat4& proj, ClusterRange& range) const;
+
+    float nearClip = 0.01f;
+    float farClip = 10.0f;
+    unsigned int maxLightsPerCluster = 0;
+
+    std::vector<ClusterRange> ranges; // 라이트별 클러스터 범위 (매 프레임 재사용)
+    std::vector<unsigned int> clusterGrid; // 클러스터당 2 정수 (lightIndices 내의 시작 오프셋, 라이트 개수)
+    std::vector<unsigned int> lightIndices; // 클러스터별로 연속해서 저장된 라이트 인덱스 목록
+
+    ofBufferObject clusterGridBuffer;
+    ofBufferObject lightIndexBuffer;
+
+    ofTexture clusterGridTex; // usamplerBuffer (GL_RG32UI)
+    ofTexture lightIndexTex; // usamplerBuffer (GL_R32UI)
+};
@@ -0,0 +1,151 @@
+#include "LightCulling.hpp"
+
+namespace {
+const int MAX_GRID_DIM = 64; // 축마다 최대 셀 개수 (라이트가 아주 넓게 퍼져있으면 셀을 키움)
+
+// 구체와 AABB 의 교차 검사. AABB 위에서 구체 중심과 가장 가까운 점까지의 거리를 반경과 비교함.
+bool sphereTouchesBox(const glm::vec3& center, float radius, const glm::vec3& boxMin, const glm::vec3& boxMax) {
+    glm::vec3 closest = glm::clamp(center, boxMin, boxMax);
+    glm::vec3 d = center - closest;
+    return glm::dot(d, d) <= radius * radius;
+}
+}
+
+void LightCulling::computeBounds(const ofMesh& mesh, const glm::mat4& model, glm::vec3& boundsMin, glm::vec3& boundsMax) {
+    boundsMin = glm::vec3(std::numeric_limits<float>::max());
+    boundsMax = glm::vec3(-std::numeric_limits<float>::max());
+    for (const glm::vec3& v : mesh.getVertices()) {
+        glm::vec3 world = glm::vec3(model * glm::vec4(v, 1.0f));
+        boundsMin = glm::min(boundsMin, world);
+        boundsMax = glm::max(boundsMax, world);
+    }
+}
+
+int LightCulling::addReceiver(const ofMesh& mesh, const glm::mat4& model) {
+    Receiver receiver;
+    computeBounds(mesh, model, receiver.boundsMin, receiver.boundsMax);
+    receivers.push_back(std::move(receiver));
+    return int(receivers.size()) - 1;
+}
+
+void LightCulling::setReceiverBounds(int receiver, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    receivers[receiver].boundsMin = boundsMin;
+    receivers[receiver].boundsMax = boundsMax;
+}
+
+bool LightCulling::needsRebuild(const LightSystem& lights) {
+    // LightSystem 의 dirty range 는 멀티패스가 아닌 모드에서도 매 프레임 비워지므로, 여기서는 자체 사본과 비교함.
+    const std::vector<glm::vec3>& positions = lights.getPositions();
+    const std::vector<float>& radii = lights.getRadii();
+    bool changed = lights.size() != posRadius.size();
+    posRadius.resize(lights.size());
+    for (size_t i = 0; i < lights.size(); ++i) {
+        glm::vec4 pr = glm::vec4(positions[i], radii[i]);
+        if (pr != posRadius[i]) {
+            posRadius[i] = pr;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void LightCulling::rebuildGrid() {
+    using namespace glm;
+
+    // 격자 범위는 라이트 중심점들의 AABB. 셀 크기는 가장 큰 라이트 반경 정도로 잡아서, 리시버 하나가 훑는 셀 수가 적당하도록 함.
+    vec3 lo(std::numeric_limits<float>::max());
+    vec3 hi(-std::numeric_limits<float>::max());
+    maxRadius = 0.0f;
+    for (const vec4& pr : posRadius) {
+        lo = min(lo, vec3(pr));
+        hi = max(hi, vec3(pr));
+        maxRadius = std::max(maxRadius, pr.w);
+    }
+    if (posRadius.empty()) {
+        lo = hi = vec3(0.0f);
+    }
+    vec3 extent = hi - lo;
+    cellSize = std::max({ maxRadius, extent.x / MAX_GRID_DIM, extent.y / MAX_GRID_DIM, extent.z / MAX_GRID_DIM, 0.01f });
+    gridMin = lo;
+    for (int a = 0; a < 3; ++a) {
+        gridDims[a] = std::min(MAX_GRID_DIM, int(extent[a] / cellSize) + 1);
+    }
+    int numCells = gridDims[0] * gridDims[1] * gridDims[2];
+
+    // 카운팅 정렬: 셀마다 라이트 수를 센 뒤 누적합으로 시작 오프셋을 구하고, 라이트 인덱스를 채워넣음. (LightClusters 와 같은 방식)
+    cellStart.assign(numCells + 1, 0);
+    lightCells.resize(posRadius.size());
+    for (size_t i = 0; i < posRadius.size(); ++i) {
+        ivec3 cell = clamp(ivec3((vec3(posRadius[i]) - gridMin) / cellSize), ivec3(0), ivec3(gridDims[0] - 1, gridDims[1] - 1, gridDims[2] - 1));
+        lightCells[i] = uint32_t(cell.x + gridDims[0] * (cell.y + gridDims[1] * cell.z));
+        cellStart[lightCells[i] + 1]++;
+    }
+    for (int c = 0; c < numCells; ++c) {
+        cellStart[c + 1] += cellStart[c];
+    }
+    cellLights.resize(posRadius.size());
+    for (size_t i = 0; i < posRadius.size(); ++i) {
+        cellLights[cellStart[lightCells[i]]++] = uint32_t(i); // cellStart 를 채우기 커서로 사용함.
+    }
+    // 채우면서 cellStart 가 한 칸씩 밀렸으므로 되돌림.
+    for (int c = numCells; c > 0; --c) {
+        cellStart[c] = cellStart[c - 1];
+    }
+    cellStart[0] = 0;
+}
+
+bool LightCulling::inFrustum(uint32_t light) {
+    if (frustumState[light] == 0) {
+        const glm::vec4& pr = posRadius[light];
+        frustumState[light] = frustum.intersectsSphere(glm::vec3(pr), pr.w) ? 1 : 2;
+    }
+    return frustumState[light] == 1;
+}
+
+void LightCulling::update(const LightSystem& lights, const glm::mat4& viewProj) {
+    using namespace glm;
+
+    stats = Stats();
+    stats.lights = uint32_t(lights.size());
+    stats.rebuilt = needsRebuild(lights);
+    if (stats.rebuilt) {
+        rebuildGrid();
+    }
+
+    frustum.setFromMatrix(viewProj);
+    frustumState.assign(lights.size(), 0);
+
+    for (Receiver& receiver : receivers) {
+        receiver.lights.clear();
+        if (lights.empty()) {
+            continue;
+        }
+
+        // 리시버 AABB 를 가장 큰 라이트 반경만큼 넓힌 범위에 중심점이 있는 라이트만 닿을 수 있음.
+        ivec3 gridMax(gridDims[0] - 1, gridDims[1] - 1, gridDims[2] - 1);
+        ivec3 lo = clamp(ivec3(floor((receiver.boundsMin - maxRadius - gridMin) / cellSize)), ivec3(0), gridMax);
+        ivec3 hi = clamp(ivec3(floor((receiver.boundsMax + maxRadius - gridMin) / cellSize)), ivec3(0), gridMax);
+
+        for (int z = lo.z; z <= hi.z; ++z) {
+            for (int y = lo.y; y <= hi.y; ++y) {
+                for (int x = lo.x; x <= hi.x; ++x) {
+                    int cell = x + gridDims[0] * (y + gridDims[1] * z);
+                    for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                        uint32_t light = cellLights[k];
+                        stats.tested++;
+                        if (!inFrustum(light)) {
+                            continue;
+                        }
+                        stats.visible++;
+                        const vec4& pr = posRadius[light];
+                        if (!sphereTouchesBox(vec3(pr), pr.w, receiver.boundsMin, receiver.boundsMax)) {
+                            continue;
+                        }
+                        stats.affecting++;
+                        receiver.lights.push_back(light);
+                    }
+                }
+            }
+        }
+    }
+}
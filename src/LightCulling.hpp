@@ -0,0 +1,67 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Frustum.hpp"
+#include "LightSystem.hpp"
+#include <cstdint>
+#include <vector>
+
+// 멀티패스 모드에서 포인트라이트마다 모든 메쉬를 다시 그리지 않도록, 메쉬(리시버)별로 실제로 영향을 주는 라이트 목록을 만드는 클래스.
+//
+// 1. 라이트 중심점을 균일 격자(uniform grid)에 카운팅 정렬로 넣어둠. 라이트의 위치나 반경이 바뀐 프레임에만 다시 만듦.
+// 2. 리시버마다 월드공간 AABB 를 (가장 큰 라이트 반경만큼) 넓힌 범위의 격자 셀들만 훑어서 후보 라이트를 찾음.
+// 3. 후보 라이트의 구체(위치 + 반경)를 카메라 프러스텀과 리시버 AABB 에 대해 검사해서 통과한 라이트만 리시버 목록에 넣음.
+// 라이트 인덱스는 LightSystem 배열의 인덱스이며, 목록은 인덱스 오름차순이 아닐 수 있음.
+class LightCulling {
+public:
+    // 직전 update() 의 컬링 통계
+    struct Stats {
+        uint32_t lights = 0; // 전체 포인트라이트 개수
+        uint32_t tested = 0; // 격자에서 찾은 (라이트, 리시버) 후보 쌍의 개수
+        uint32_t visible = 0; // 후보 쌍 중 라이트가 프러스텀 안에 있는 쌍의 개수
+        uint32_t affecting = 0; // 라이트 구체가 리시버 AABB 에 닿는 쌍의 개수 (= 포인트라이트 패스 드로우콜 수)
+        bool rebuilt = false; // 이번 프레임에 격자를 다시 만들었는지 여부
+    };
+
+    // 컬링 대상 메쉬를 등록하고 리시버 번호를 리턴함. 메쉬는 움직이지 않는다고 가정하고 월드공간 AABB 를 여기서 한 번만 계산함.
+    int addReceiver(const ofMesh& mesh, const glm::mat4& model);
+    void setReceiverBounds(int receiver, const glm::vec3& boundsMin, const glm::vec3& boundsMax); // 인스턴싱처럼 리시버가 차지하는 범위가 바뀌었을 때 호출
+
+    // 메쉬의 버텍스들을 모델행렬로 변환해서 월드공간 AABB 를 구함.
+    static void computeBounds(const ofMesh& mesh, const glm::mat4& model, glm::vec3& boundsMin, glm::vec3& boundsMax);
+
+    // 매 프레임 라이트 목록과 투영 * 뷰 행렬로 리시버별 라이트 목록을 갱신함.
+    void update(const LightSystem& lights, const glm::mat4& viewProj);
+
+    const std::vector<uint32_t>& getLights(int receiver) const { return receivers[receiver].lights; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct Receiver {
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+        std::vector<uint32_t> lights;
+    };
+
+    bool needsRebuild(const LightSystem& lights);
+    void rebuildGrid();
+    bool inFrustum(uint32_t light);
+
+    std::vector<Receiver> receivers;
+    Stats stats;
+
+    // 라이트 데이터 사본. 이전 프레임과 비교해서 바뀐 게 없으면 격자를 다시 만들지 않음.
+    std::vector<glm::vec4> posRadius;
+    float maxRadius = 0.0f;
+
+    // 균일 격자. cellStart[c] ~ cellStart[c + 1] 구간의 cellLights 가 셀 c 에 중심점이 들어있는 라이트들임.
+    glm::vec3 gridMin;
+    float cellSize = 1.0f;
+    int gridDims[3] = { 0, 0, 0 };
+    std::vector<uint32_t> cellStart;
+    std::vector<uint32_t> cellLights;
+    std::vector<uint32_t> lightCells; // 라이트별 셀 번호 (카운팅 정렬용)
+
+    Frustum frustum;
+    std::vector<uint8_t> frustumState; // 라이트별 프러스텀 검사 결과 캐시 (0: 아직 검사 안함, 1: 보임, 2: 안보임)
+};
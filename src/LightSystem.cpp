@@ -0,0 +1,173 @@
+#include "LightSystem.hpp"
+
+namespace {
+// 마지막 원소를 index 자리로 옮기고 배열을 하나 줄임.
+template <typename T>
+void swapRemove(std::vector<T>& values, size_t index) {
+    values[index] = values.back();
+    values.pop_back();
+}
+
+// 정수 해시로 만든 0 ~ 1 범위의 값 노이즈. 정수 구간마다 무작위 값을 두고 그 사이를 부드럽게 보간함.
+float hashToUnit(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return (x & 0xffffff) / float(0xffffff);
+}
+
+float valueNoise(float x) {
+    float cell = std::floor(x);
+    float t = x - cell;
+    t = t * t * (3.0f - 2.0f * t);
+    uint32_t i = uint32_t(int32_t(cell));
+    return hashToUnit(i) + (hashToUnit(i + 1) - hashToUnit(i)) * t;
+}
+}
+
+LightSystem::Handle LightSystem::add(const Desc& desc) {
+    uint32_t slot;
+    if (freeSlots.empty()) {
+        slot = uint32_t(slotToIndex.size());
+        slotToIndex.push_back(0);
+        slotGenerations.push_back(0);
+    } else {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    uint32_t index = uint32_t(positions.size());
+    slotToIndex[slot] = index;
+    indexToSlot.push_back(slot);
+
+    glm::vec3 color = desc.color * desc.intensity;
+    positions.push_back(desc.position);
+    colors.push_back(color);
+    radii.push_back(desc.radius);
+    basePositions.push_back(desc.position);
+    baseColors.push_back(color);
+    orbitSpeeds.push_back(desc.animation.orbitSpeed);
+    pulseAmounts.push_back(desc.animation.pulseAmount);
+    pulseRates.push_back(desc.animation.pulseRate);
+    flickerAmounts.push_back(desc.animation.flickerAmount);
+    flickerRates.push_back(desc.animation.flickerRate);
+    phases.push_back(desc.animation.phase);
+
+    dirty.add(index, index + 1);
+    return { slot, slotGenerations[slot] };
+}
+
+bool LightSystem::remove(Handle handle) {
+    if (!isValid(handle)) {
+        return false;
+    }
+    uint32_t index = slotToIndex[handle.slot];
+    uint32_t last = uint32_t(positions.size()) - 1;
+
+    // 마지막 라이트를 지워진 자리로 옮겨서 배열에 빈틈이 생기지 않도록 함. (옮겨진 라이트의 슬롯이 가리키는 인덱스도 갱신)
+    if (index != last) {
+        uint32_t movedSlot = indexToSlot[last];
+        slotToIndex[movedSlot] = index;
+        dirty.add(index, index + 1);
+    }
+    swapRemove(indexToSlot, index);
+    swapRemove(positions, index);
+    swapRemove(colors, index);
+    swapRemove(radii, index);
+    swapRemove(basePositions, index);
+    swapRemove(baseColors, index);
+    swapRemove(orbitSpeeds, index);
+    swapRemove(pulseAmounts, index);
+    swapRemove(pulseRates, index);
+    swapRemove(flickerAmounts, index);
+    swapRemove(flickerRates, index);
+    swapRemove(phases, index);
+
+    slotGenerations[handle.slot]++; // 이 슬롯을 가리키던 핸들들을 무효화함.
+    freeSlots.push_back(handle.slot);
+    return true;
+}
+
+bool LightSystem::isValid(Handle handle) const {
+    return handle.slot < slotGenerations.size() && slotGenerations[handle.slot] == handle.generation;
+}
+
+int LightSystem::getIndex(Handle handle) const {
+    return isValid(handle) ? int(slotToIndex[handle.slot]) : -1;
+}
+
+LightSystem::Handle LightSystem::getHandle(size_t index) const {
+    uint32_t slot = indexToSlot[index];
+    return { slot, slotGenerations[slot] };
+}
+
+void LightSystem::setBasePosition(Handle handle, const glm::vec3& position) {
+    int index = getIndex(handle);
+    if (index >= 0) {
+        basePositions[index] = position;
+        positions[index] = position; // 다음 update() 전에도 바뀐 위치가 보이도록 함.
+        dirty.add(index, index + 1);
+    }
+}
+
+void LightSystem::setAnimation(Handle handle, const Animation& animation) {
+    int index = getIndex(handle);
+    if (index >= 0) {
+        orbitSpeeds[index] = animation.orbitSpeed;
+        pulseAmounts[index] = animation.pulseAmount;
+        pulseRates[index] = animation.pulseRate;
+        flickerAmounts[index] = animation.flickerAmount;
+        flickerRates[index] = animation.flickerRate;
+        phases[index] = animation.phase;
+    }
+}
+
+void LightSystem::update(float time, ThreadPool* pool) {
+    size_t count = positions.size();
+    if (!pool || pool->getNumChunks(count, MIN_CHUNK_SIZE) <= 1) {
+        updateRange(time, 0, count, dirty);
+        return;
+    }
+
+    chunkRanges.assign(pool->getNumChunks(count, MIN_CHUNK_SIZE), DirtyRange());
+    pool->parallelFor(count, MIN_CHUNK_SIZE, [this, time](size_t chunk, size_t begin, size_t end) {
+        updateRange(time, begin, end, chunkRanges[chunk]);
+    });
+    for (const DirtyRange& range : chunkRanges) {
+        if (!range.empty()) {
+            dirty.add(range.begin, range.end);
+        }
+    }
+}
+
+void LightSystem::copyRenderData(LightSystem& target) const {
+    target.positions.assign(positions.begin(), positions.end());
+    target.colors.assign(colors.begin(), colors.end());
+    target.radii.assign(radii.begin(), radii.end());
+    target.dirty = dirty;
+}
+
+void LightSystem::updateRange(float time, size_t begin, size_t end, DirtyRange& range) {
+    const float twoPi = glm::two_pi<float>();
+    for (size_t i = begin; i < end; ++i) {
+        // 공전: 기준 위치를 월드 y축 둘레로 orbitSpeed * time 만큼 회전 (glm::rotate(angle, vec3(0, 1, 0)) 와 같은 식)
+        float angle = orbitSpeeds[i] * time;
+        float c = std::cos(angle);
+        float s = std::sin(angle);
+        const glm::vec3& base = basePositions[i];
+        glm::vec3 position(base.x * c + base.z * s, base.y, -base.x * s + base.z * c);
+
+        // 강도 곡선: sin 맥동 * 값 노이즈 깜빡임
+        float t = time + phases[i];
+        float pulse = 1.0f + pulseAmounts[i] * std::sin(twoPi * pulseRates[i] * t);
+        float flicker = 1.0f - flickerAmounts[i] * valueNoise(flickerRates[i] * t);
+        glm::vec3 color = baseColors[i] * (pulse * flicker);
+
+        if (position != positions[i] || color != colors[i]) {
+            positions[i] = position;
+            colors[i] = color;
+            range.add(uint32_t(i), uint32_t(i) + 1);
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ThreadPool.hpp"
+#include <cstdint>
+#include <vector>
+
+// 포인트라이트들을 종류별 배열(SoA)로 촘촘하게 저장하고, 매 프레임 애니메이션(공전, 강도 맥동, 깜빡임)을 계산하는 클래스.
+//
+// - 위치, 색상 * 강도, 반경은 각각 따로 연속된 배열에 들어있어서, 렌더러(LightBuffer, LightCulling, LightClusters)가 필요한 배열만 읽어감.
+// - 라이트는 add() 가 돌려주는 핸들(슬롯 번호 + 세대)로 가리킴. remove() 하면 마지막 라이트를 빈 자리로 옮겨서(swap-remove)
+//   배열을 항상 빈틈없이 유지하고, 슬롯의 세대를 올려서 이미 지워진 라이트의 핸들은 더 이상 유효하지 않게 함.
+//   배열 안의 인덱스(= LightBuffer 안의 라이트 인덱스)는 remove() 로 바뀔 수 있으므로 프레임을 넘겨서 들고 있으면 안 됨.
+// - update() 는 분기 없는 같은 계산을 배열 전체에 적용하므로 컴파일러가 벡터화하기 쉽고, 라이트가 많으면 스레드 풀로 나눠서 계산함.
+// - 값이 바뀐 라이트들의 인덱스 범위(dirty range)를 모아두고, 렌더러는 그 구간만 GPU 로 올린 뒤 clearDirty() 로 비움.
+class LightSystem {
+public:
+    struct Handle {
+        uint32_t slot = UINT32_MAX;
+        uint32_t generation = 0;
+    };
+
+    // 라이트 애니메이션 파라미터. 0 이면 해당 효과가 꺼짐. (모든 효과를 항상 같은 식으로 계산하므로 라이트마다 분기하지 않음)
+    struct Animation {
+        float orbitSpeed = 0.0f; // 월드 y축 둘레 공전 각속도 (rad/s)
+        float pulseAmount = 0.0f; // 강도를 sin 곡선으로 흔드는 비율 (0 ~ 1)
+        float pulseRate = 0.0f; // 맥동 주파수 (Hz)
+        float flickerAmount = 0.0f; // 불규칙하게 어두워지는 최대 비율 (0 ~ 1)
+        float flickerRate = 0.0f; // 깜빡임 값이 바뀌는 빈도 (Hz)
+        float phase = 0.0f; // 라이트마다 맥동/깜빡임이 겹치지 않도록 주는 시간 오프셋 (초)
+    };
+
+    struct Desc {
+        glm::vec3 position; // 애니메이션의 기준 위치 (공전은 이 위치를 y축 둘레로 돌림)
+        glm::vec3 color = glm::vec3(1.0f);
+        float intensity = 1.0f;
+        float radius = 1.0f;
+        Animation animation;
+    };
+
+    // 값이 바뀐 라이트 인덱스 구간 [begin, end)
+    struct DirtyRange {
+        uint32_t begin = UINT32_MAX;
+        uint32_t end = 0;
+        bool empty() const { return begin >= end; }
+        void add(uint32_t first, uint32_t last) {
+            begin = std::min(begin, first);
+            end = std::max(end, last);
+        }
+    };
+
+    Handle add(const Desc& desc);
+    bool remove(Handle handle); // 이미 지워진 핸들이면 false
+    bool isValid(Handle handle) const;
+    int getIndex(Handle handle) const; // 배열 안의 현재 인덱스 (유효하지 않으면 -1)
+    Handle getHandle(size_t index) const;
+
+    void setBasePosition(Handle handle, const glm::vec3& position);
+    void setAnimation(Handle handle, const Animation& animation);
+
+    // time(초) 기준으로 모든 라이트의 위치와 색상을 다시 계산함. pool 이 있으면 라이트가 많을 때 워커 스레드들로 나눠서 계산함.
+    void update(float time, ThreadPool* pool = nullptr);
+
+    size_t size() const { return positions.size(); }
+    bool empty() const { return positions.empty(); }
+    const std::vector<glm::vec3>& getPositions() const { return positions; }
+    const std::vector<glm::vec3>& getColors() const { return colors; } // 색상 * 강도
+    const std::vector<float>& getRadii() const { return radii; }
+
+    // 마지막 clearDirty() 이후 바뀐 구간. 렌더러가 프레임마다 업로드를 끝낸 뒤 clearDirty() 를 호출함.
+    const DirtyRange& getDirtyRange() const { return dirty; }
+    void clearDirty() { dirty = DirtyRange(); }
+
+    // 렌더러가 읽어가는 결과 배열(위치, 색상, 반경)과 dirty range 만 target 으로 복사함. (시뮬레이션 스레드가 프레임 스냅샷을 만들 때 사용)
+    // target 은 렌더러에 넘기는 읽기 전용 사본이므로 핸들, 애니메이션 관련 함수는 쓸 수 없음. 배열 용량은 재사용하므로 라이트 수가 늘 때만 할당함.
+    void copyRenderData(LightSystem& target) const;
+
+private:
+    static const size_t MIN_CHUNK_SIZE = 4096; // 이보다 적은 라이트는 스레드로 나누는 비용이 더 큼.
+
+    void updateRange(float time, size_t begin, size_t end, DirtyRange& range);
+
+    // 렌더러가 읽어가는 결과 배열
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> colors;
+    std::vector<float> radii;
+
+    // 애니메이션 입력 배열 (결과 배열과 같은 인덱스)
+    std::vector<glm::vec3> basePositions;
+    std::vector<glm::vec3> baseColors; // 색상 * 강도
+    std::vector<float> orbitSpeeds;
+    std::vector<float> pulseAmounts;
+    std::vector<float> pulseRates;
+    std::vector<float> flickerAmounts;
+    std::vector<float> flickerRates;
+    std::vector<float> phases;
+
+    // 핸들 <-> 인덱스 변환
+    std::vector<uint32_t> indexToSlot;
+    std::vector<uint32_t> slotToIndex;
+    std::vector<uint32_t> slotGenerations;
+    std::vector<uint32_t> freeSlots;
+
+    DirtyRange dirty;
+    std::vector<DirtyRange> chunkRanges; // 스레드별로 따로 모은 뒤 합침. (같은 변수를 여러 스레드가 쓰지 않도록)
+};
@@ -0,0 +1,177 @@
+#include "MaterialBinding.hpp"
+#include "PackedMesh.hpp"
+#include <cstring>
+
+namespace {
+const char* uniformNames[MaterialBinding::NUM_UNIFORMS] = {
+    "mvp", "model", "view", "normalMatrix", "meshSpecCol", "ambientCol", "cameraPos", "oceanScale",
+    "lightDir", "lightCol", "lightIndex", "clusterDims", "screenSize", "clusterDepth", "viewProj",
+    "invViewProj", "positionScale", "positionOffset", "sharpness", "shadowParams"
+};
+
+const char* samplerNames[MaterialBinding::NUM_SAMPLERS] = {
+    "oceanSlope", "envMap", "diffuseTex", "specTex", "nrmTex", "lightPosRadius", "lightColor", "clusterGrid", "lightIndices",
+    "gAlbedo", "gMaterial", "gNormal", "gDepth", "oceanDisplacement", "sceneColor", "shadowAtlas",
+    "lightShadow"
+};
+}
+
+uint64_t MaterialBinding::currentFrame = 1;
+GLuint MaterialBinding::boundTextures[MaterialBinding::NUM_SAMPLERS] = {};
+MaterialBinding::Stats MaterialBinding::frameStats;
+MaterialBinding::Stats MaterialBinding::lastFrameStats;
+
+void MaterialBinding::setup(ofShader& shd) {
+    shader = &shd;
+    GLuint program = shd.getProgram();
+    for (int i = 0; i < NUM_UNIFORMS; ++i) {
+        locations[i] = glGetUniformLocation(program, uniformNames[i]);
+        valid[i] = false;
+    }
+    for (int i = 0; i < NUM_FREQUENCIES; ++i) {
+        keys[i] = nullptr;
+    }
+    frame = 0;
+
+    // 샘플러 -> 텍스쳐 유닛 배정은 프로그램 상태이므로 링크 직후 한 번만 설정해두면 됨.
+    shd.begin();
+    for (int i = 0; i < NUM_SAMPLERS; ++i) {
+        GLint location = glGetUniformLocation(program, samplerNames[i]);
+        if (location != -1) {
+            glUniform1i(location, i + 1);
+        }
+    }
+    shd.end();
+}
+
+void MaterialBinding::begin() {
+    shader->begin();
+    frameStats.programBinds++;
+}
+
+void MaterialBinding::end() {
+    shader->end();
+}
+
+bool MaterialBinding::update(Frequency frequency, const void* key) {
+    if (frame != currentFrame) {
+        frame = currentFrame;
+        for (int i = 0; i < NUM_FREQUENCIES; ++i) {
+            keys[i] = nullptr;
+        }
+        keys[frequency] = key;
+        return true;
+    }
+    if (frequency == PerFrame) {
+        return false;
+    }
+    if (keys[frequency] == key) {
+        return false;
+    }
+    keys[frequency] = key;
+    for (int i = frequency + 1; i < NUM_FREQUENCIES; ++i) {
+        keys[i] = nullptr; // 오브젝트가 바뀌면 라이트별 값도 다시 보내야 함.
+    }
+    return true;
+}
+
+bool MaterialBinding::changed(Uniform uniform, const void* data, size_t bytes) {
+    if (locations[uniform] == -1) {
+        return false;
+    }
+    if (valid[uniform] && std::memcmp(values[uniform], data, bytes) == 0) {
+        frameStats.skipped++;
+        return false;
+    }
+    std::memcpy(values[uniform], data, bytes);
+    valid[uniform] = true;
+    frameStats.uniformCalls++;
+    return true;
+}
+
+void MaterialBinding::set(Uniform uniform, int value) {
+    if (changed(uniform, &value, sizeof(value))) {
+        glUniform1i(locations[uniform], value);
+    }
+}
+
+void MaterialBinding::set(Uniform uniform, float value) {
+    if (changed(uniform, &value, sizeof(value))) {
+        glUniform1f(locations[uniform], value);
+    }
+}
+
+void MaterialBinding::set(Uniform uniform, const glm::vec2& value) {
+    if (changed(uniform, &value, sizeof(value))) {
+        glUniform2fv(locations[uniform], 1, glm::value_ptr(value));
+    }
+}
+
+void MaterialBinding::set(Uniform uniform, const glm::vec3& value) {
+    if (changed(uniform, &value, sizeof(value))) {
+        glUniform3fv(locations[uniform], 1, glm::value_ptr(value));
+    }
+}
+
+void MaterialBinding::set(Uniform uniform, const glm::mat3& value) {
+    if (changed(uniform, &value, sizeof(value))) {
+        glUniformMatrix3fv(locations[uniform], 1, GL_FALSE, glm::value_ptr(value));
+    }
+}
+
+void MaterialBinding::set(Uniform uniform, const glm::mat4& value) {
+    if (changed(uniform, &value, sizeof(value))) {
+        glUniformMatrix4fv(locations[uniform], 1, GL_FALSE, glm::value_ptr(value));
+    }
+}
+
+void MaterialBinding::setTexture(Sampler sampler, const ofTexture& texture) {
+    const ofTextureData& data = texture.getTextureData();
+    if (boundTextures[sampler] == data.textureID) {
+        frameStats.skipped++;
+        return;
+    }
+    glActiveTexture(GL_TEXTURE1 + sampler);
+    glBindTexture(data.textureTarget, data.textureID);
+    glActiveTexture(GL_TEXTURE0); // 다른 오픈프레임웍스 코드는 0번 유닛이 활성화되어 있다고 가정함.
+    boundTextures[sampler] = data.textureID;
+    frameStats.textureCalls += 3;
+}
+
+// float 버텍스 메쉬는 역양자화가 항등 변환이 되도록 맞춰둠. (같은 프로그램으로 압축 메쉬를 먼저 그렸을 수 있으므로)
+void MaterialBinding::draw(const ofVboMesh& mesh) {
+    set(PositionScale, glm::vec3(1.0f));
+    set(PositionOffset, glm::vec3(0.0f));
+    mesh.draw();
+    frameStats.drawCalls++;
+}
+
+void MaterialBinding::drawInstanced(const ofVboMesh& mesh, int instances) {
+    set(PositionScale, glm::vec3(1.0f));
+    set(PositionOffset, glm::vec3(0.0f));
+    mesh.drawInstanced(OF_MESH_FILL, instances);
+    frameStats.drawCalls++;
+}
+
+void MaterialBinding::draw(const PackedMesh& mesh) {
+    set(PositionScale, mesh.getPositionScale());
+    set(PositionOffset, mesh.getPositionOffset());
+    mesh.draw();
+    frameStats.drawCalls++;
+}
+
+void MaterialBinding::drawInstanced(const PackedMesh& mesh, int instances) {
+    set(PositionScale, mesh.getPositionScale());
+    set(PositionOffset, mesh.getPositionOffset());
+    mesh.drawInstanced(instances);
+    frameStats.drawCalls++;
+}
+
+void MaterialBinding::beginFrame() {
+    currentFrame++;
+    lastFrameStats = frameStats;
+    frameStats = Stats();
+    for (GLuint& texture : boundTextures) {
+        texture = 0;
+    }
+}
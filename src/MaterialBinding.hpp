@@ -0,0 +1,126 @@
+#pragma once
+
+#include "ofMain.h"
+#include <cstdint>
+
+class PackedMesh;
+
+// 셰이더 프로그램 하나에 대한 유니폼/텍스쳐 바인딩 상태를 관리하는 클래스 (일종의 파이프라인 상태 객체)
+//
+// - 유니폼 위치(location)는 셰이더 링크 직후 setup() 에서 한 번만 조회해두고, 이후에는 이름 문자열로 찾지 않음.
+// - 유니폼마다 마지막으로 보낸 값을 기억해두고, 값이 바뀌었을 때만 glUniform* 을 호출함. (유니폼 값은 프로그램 객체에 그대로 남아있으므로)
+// - 파라미터를 갱신 빈도(프레임 / 오브젝트 / 라이트)별로 묶어서, update() 가 true 를 리턴할 때만 해당 묶음의 값을 계산해서 넘기도록 함.
+// - 샘플러마다 고정된 텍스쳐 유닛을 배정해두고, 유닛에 이미 같은 텍스쳐가 바인딩되어 있으면 다시 바인딩하지 않음.
+//   (모든 프로그램이 같은 샘플러에 같은 유닛을 쓰므로, 프로그램이 바뀌어도 큐브맵 같은 공용 텍스쳐는 프레임당 한 번만 바인딩됨)
+// - 이 클래스를 거쳐서 나간 GL 호출 수를 프레임 단위로 세서 getStats() 로 보여줌.
+class MaterialBinding {
+public:
+    // 이 예제의 셰이더들이 사용하는 유니폼 목록. (셰이더에 없는 유니폼은 위치가 -1 이 되어 GL 호출 없이 무시됨)
+    enum Uniform {
+        Mvp,
+        Model,
+        View,
+        NormalMatrix,
+        MeshSpecCol,
+        AmbientCol,
+        CameraPos,
+        OceanScale,
+        LightDir,
+        LightCol,
+        LightIndex,
+        ClusterDims,
+        ScreenSize,
+        ClusterDepth,
+        ViewProj,
+        InvViewProj,
+        PositionScale,
+        PositionOffset,
+        Sharpness,
+        ShadowParams,
+        NUM_UNIFORMS
+    };
+
+    // 샘플러 목록. (enum 값 + 1) 이 그 샘플러에 고정 배정되는 텍스쳐 유닛 번호임.
+    // 0번 유닛은 오픈프레임웍스가 텍스쳐 업로드나 비트맵 폰트 등에 쓰면서 바인딩을 바꾸므로 비워둠.
+    enum Sampler {
+        OceanSlope,
+        EnvMap,
+        DiffuseTex,
+        SpecTex,
+        NrmTex,
+        LightPosRadius,
+        LightColor,
+        ClusterGrid,
+        LightIndices,
+        GAlbedo,
+        GMaterial,
+        GNormal,
+        GDepth,
+        OceanDisplacement,
+        SceneColor,
+        ShadowAtlas,
+        LightShadow,
+        NUM_SAMPLERS
+    };
+
+    // 파라미터 갱신 빈도
+    enum Frequency {
+        PerFrame, // 카메라 위치, 뷰-투영 행렬 등 프레임 안에서 바뀌지 않는 값
+        PerObject, // 모델행렬, mvp 등 그리는 오브젝트마다 바뀌는 값
+        PerLight, // 멀티패스에서 패스(라이트)마다 바뀌는 값
+        NUM_FREQUENCIES
+    };
+
+    // GL 호출 수 통계
+    struct Stats {
+        uint32_t programBinds = 0;
+        uint32_t uniformCalls = 0;
+        uint32_t textureCalls = 0; // glActiveTexture + glBindTexture
+        uint32_t skipped = 0; // 값이나 바인딩이 같아서 생략한 호출 수
+        uint32_t drawCalls = 0; // draw() 로 호출한 드로우콜 수 (상태 변경이 아니므로 total() 에는 포함하지 않음)
+        uint32_t total() const { return programBinds + uniformCalls + textureCalls; }
+    };
+
+    void setup(ofShader& shader); // 셰이더 로드(링크) 직후 한 번 호출
+
+    void begin(); // 프로그램 바인딩 (ofShader::begin)
+    void end();
+    GLuint getProgram() const { return shader->getProgram(); } // 드로우콜을 프로그램 순으로 정렬할 때 사용
+
+    // key(오브젝트나 라이트의 주소)가 이 빈도에서 마지막으로 넘겨받은 key 와 다르면 true 를 리턴함.
+    // 새 프레임이 시작되면 모든 빈도가 다시 true 를 리턴하고, 상위 빈도가 바뀌면 하위 빈도도 함께 무효화됨.
+    bool update(Frequency frequency, const void* key = nullptr);
+
+    void set(Uniform uniform, int value);
+    void set(Uniform uniform, float value);
+    void set(Uniform uniform, const glm::vec2& value);
+    void set(Uniform uniform, const glm::vec3& value);
+    void set(Uniform uniform, const glm::mat3& value);
+    void set(Uniform uniform, const glm::mat4& value);
+    void setTexture(Sampler sampler, const ofTexture& texture);
+    void draw(const ofVboMesh& mesh); // 드로우콜도 통계에 포함되도록 이 객체를 거쳐서 호출함.
+    void drawInstanced(const ofVboMesh& mesh, int instances); // glDrawElementsInstanced 로 instances 개를 한 번에 그림.
+    // 압축 버텍스 메쉬는 위치 역양자화 유니폼(positionScale, positionOffset)을 메쉬에 맞춰 설정한 뒤 그림.
+    void draw(const PackedMesh& mesh);
+    void drawInstanced(const PackedMesh& mesh, int instances);
+
+    // 매 프레임 draw() 시작 시 호출. 통계를 넘기고, 프레임 밖에서 다른 코드(ofDrawBitmapString 등)가 바꿨을 수 있는 텍스쳐 유닛 캐시를 비움.
+    static void beginFrame();
+    static const Stats& getStats() { return lastFrameStats; } // 직전 프레임 통계
+    static const Stats& getFrameStats() { return frameStats; } // 현재 프레임에서 지금까지 누적된 통계 (프로파일러 구간별 집계용)
+
+private:
+    bool changed(Uniform uniform, const void* data, size_t bytes);
+
+    ofShader* shader = nullptr;
+    GLint locations[NUM_UNIFORMS];
+    float values[NUM_UNIFORMS][16]; // 마지막으로 보낸 값 (mat4 까지 담을 수 있는 크기)
+    bool valid[NUM_UNIFORMS];
+    const void* keys[NUM_FREQUENCIES];
+    uint64_t frame = 0;
+
+    static uint64_t currentFrame;
+    static GLuint boundTextures[NUM_SAMPLERS]; // 유닛별로 현재 바인딩된 텍스쳐 (모든 프로그램이 공유하는 GL 상태)
+    static Stats frameStats;
+    static Stats lastFrameStats;
+};
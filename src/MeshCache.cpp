@@ -0,0 +1,272 @@
+#include "MeshCache.hpp"
+#include "MeshOptimizer.hpp"
+#include "TangentGenerator.hpp"
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 파일 전체를 읽기 전용으로 메모리 매핑하는 RAII 객체. 소멸될 때 매핑을 해제함.
+class MappedFile {
+public:
+    explicit MappedFile(const std::filesystem::path& path) {
+#ifdef _WIN32
+        file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return;
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            return;
+        }
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            return;
+        }
+        data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        size = data ? size_t(fileSize.QuadPart) : 0;
+#else
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            return;
+        }
+        void* ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED) {
+            return;
+        }
+        data = ptr;
+        size = st.st_size;
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (data) munmap(data, size);
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* bytes() const { return static_cast<const unsigned char*>(data); }
+    size_t getSize() const { return size; }
+
+private:
+    void* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+// FNV-1a 64비트 해시. 암호학적 해시는 아니지만 원본 파일이 바뀌었는지 확인하는 용도로는 충분함.
+uint64_t hashBytes(const unsigned char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool hashFile(const std::filesystem::path& path, uint64_t& hash) {
+    MappedFile file(path);
+    if (!file.bytes()) {
+        return false;
+    }
+    hash = hashBytes(file.bytes(), file.getSize()) ^ MeshCache::VERSION;
+    return true;
+}
+
+uint64_t alignUp(uint64_t offset) {
+    return (offset + 15) & ~uint64_t(15);
+}
+
+// 헤더의 오프셋/크기가 파일 안에 들어가는지 확인함. (잘리거나 손상된 캐시를 걸러내기 위함)
+bool streamFits(uint64_t offset, uint64_t bytes, size_t fileSize) {
+    return offset % 16 == 0 && offset <= fileSize && bytes <= fileSize - offset;
+}
+
+template<typename T>
+void copyStream(std::vector<T>& dst, const unsigned char* base, uint64_t offset, size_t count) {
+    const T* src = reinterpret_cast<const T*>(base + offset);
+    dst.assign(src, src + count); // 파싱 없이 스트림 단위로 한 번에 복사함.
+}
+
+bool writeCache(const std::filesystem::path& cachePath, uint64_t sourceHash, const ofMesh& mesh) {
+    size_t numVertices = mesh.getNumVertices();
+    size_t numIndices = mesh.getNumIndices();
+    bool hasTangents = mesh.getNumColors() == numVertices;
+
+    MeshCache::Header header = {};
+    std::memcpy(header.magic, "MSHC", 4);
+    header.version = MeshCache::VERSION;
+    header.sourceHash = sourceHash;
+    header.numVertices = uint32_t(numVertices);
+    header.numIndices = uint32_t(numIndices);
+
+    // 스트림이 없는 경우(노말, uv 가 없는 메쉬 등)는 오프셋 0 으로 표시함.
+    uint64_t offset = alignUp(sizeof(MeshCache::Header));
+    auto place = [&](uint64_t& field, size_t bytes, bool present) {
+        field = present ? offset : 0;
+        if (present) {
+            offset = alignUp(offset + bytes);
+        }
+    };
+    place(header.positionOffset, numVertices * sizeof(glm::vec3), true);
+    place(header.normalOffset, numVertices * sizeof(glm::vec3), mesh.getNumNormals() == numVertices);
+    place(header.texCoordOffset, numVertices * sizeof(glm::vec2), mesh.getNumTexCoords() == numVertices);
+    place(header.tangentOffset, numVertices * sizeof(ofFloatColor), hasTangents);
+    place(header.indexOffset, numIndices * sizeof(uint32_t), numIndices > 0);
+
+    std::vector<unsigned char> blob(offset, 0);
+    std::memcpy(blob.data(), &header, sizeof(header));
+    auto put = [&](uint64_t at, const void* src, size_t bytes) {
+        if (at != 0 && bytes > 0) {
+            std::memcpy(blob.data() + at, src, bytes);
+        }
+    };
+    put(header.positionOffset, mesh.getVerticesPointer(), numVertices * sizeof(glm::vec3));
+    put(header.normalOffset, mesh.getNormalsPointer(), numVertices * sizeof(glm::vec3));
+    put(header.texCoordOffset, mesh.getTexCoordsPointer(), numVertices * sizeof(glm::vec2));
+    put(header.tangentOffset, mesh.getColorsPointer(), numVertices * sizeof(ofFloatColor));
+    if (header.indexOffset != 0) {
+        std::vector<uint32_t> indices(mesh.getIndexPointer(), mesh.getIndexPointer() + numIndices);
+        put(header.indexOffset, indices.data(), numIndices * sizeof(uint32_t));
+    }
+
+    // 쓰는 도중에 실패해도 기존 캐시가 깨지지 않도록, 임시 파일에 쓴 뒤 이름을 바꿈.
+    std::filesystem::path tmpPath = cachePath;
+    tmpPath += ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(blob.data()), blob.size());
+        if (!out) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, cachePath, ec);
+    return !ec;
+}
+
+bool loadFromSource(const std::filesystem::path& source, ofMesh& mesh, bool withTangents, ThreadPool* pool) {
+    if (!mesh.load(source)) {
+        return false;
+    }
+
+    // 탄젠트는 합쳐진 버텍스 기준으로 계산하도록 최적화를 먼저 함. (삼각형 순서가 바뀌어도 탄젠트 결과는 같음)
+    MeshOptimizer::Report report = MeshOptimizer::optimize(mesh);
+    if (withTangents) {
+        calcTangents(mesh, pool);
+    }
+    ofLogNotice("MeshCache") << source << ": vertices " << report.verticesBefore << " -> " << report.verticesAfter
+                             << ", ACMR " << report.acmrBefore << " -> " << report.acmrAfter
+                             << ", bytes/vertex " << MeshOptimizer::getFloatBytesPerVertex(mesh)
+                             << " -> " << MeshOptimizer::getPackedLayout(mesh, true).stride << " (packed)";
+    return true;
+}
+
+} // namespace
+
+std::filesystem::path MeshCache::getCachePath(const std::filesystem::path& source) {
+    std::filesystem::path cachePath = ofToDataPath(source, true);
+    cachePath += ".meshcache";
+    return cachePath;
+}
+
+bool MeshCache::build(const std::filesystem::path& source, ThreadPool* pool) {
+    uint64_t hash = 0;
+    if (!hashFile(ofToDataPath(source, true), hash)) {
+        ofLogError("MeshCache") << "can't read " << source;
+        return false;
+    }
+    ofMesh mesh;
+    if (!loadFromSource(source, mesh, true, pool)) {
+        ofLogError("MeshCache") << "can't parse " << source;
+        return false;
+    }
+    if (!writeCache(getCachePath(source), hash, mesh)) {
+        ofLogError("MeshCache") << "can't write cache for " << source;
+        return false;
+    }
+    return true;
+}
+
+bool MeshCache::load(const std::filesystem::path& source, ofMesh& mesh, bool withTangents, ThreadPool* pool) {
+    uint64_t hash = 0;
+    if (!hashFile(ofToDataPath(source, true), hash)) {
+        ofLogError("MeshCache") << "can't read " << source;
+        return false;
+    }
+
+    std::filesystem::path cachePath = getCachePath(source);
+    {
+        MappedFile cache(cachePath);
+        const unsigned char* base = cache.bytes();
+        size_t size = cache.getSize();
+
+        Header header;
+        bool valid = base && size >= sizeof(Header);
+        if (valid) {
+            std::memcpy(&header, base, sizeof(Header));
+            uint64_t nv = header.numVertices;
+            valid = std::memcmp(header.magic, "MSHC", 4) == 0
+                && header.version == VERSION
+                && header.sourceHash == hash
+                && streamFits(header.positionOffset, nv * sizeof(glm::vec3), size)
+                && (header.normalOffset == 0 || streamFits(header.normalOffset, nv * sizeof(glm::vec3), size))
+                && (header.texCoordOffset == 0 || streamFits(header.texCoordOffset, nv * sizeof(glm::vec2), size))
+                && (header.tangentOffset == 0 || streamFits(header.tangentOffset, nv * sizeof(ofFloatColor), size))
+                && (header.indexOffset == 0 || streamFits(header.indexOffset, uint64_t(header.numIndices) * sizeof(uint32_t), size));
+        }
+
+        if (valid) {
+            mesh.clear();
+            copyStream(mesh.getVertices(), base, header.positionOffset, header.numVertices);
+            if (header.normalOffset) copyStream(mesh.getNormals(), base, header.normalOffset, header.numVertices);
+            if (header.texCoordOffset) copyStream(mesh.getTexCoords(), base, header.texCoordOffset, header.numVertices);
+            if (header.tangentOffset && withTangents) copyStream(mesh.getColors(), base, header.tangentOffset, header.numVertices);
+            if (header.indexOffset) copyStream(mesh.getIndices(), base, header.indexOffset, header.numIndices);
+            return true;
+        }
+    }
+
+    // 캐시가 없거나 원본이 바뀌었으면 원본을 파싱해서 로드하고 캐시를 새로 만듦.
+    ofLogNotice("MeshCache") << "rebuilding cache for " << source;
+    if (!loadFromSource(source, mesh, true, pool)) {
+        ofLogError("MeshCache") << "can't parse " << source;
+        return false;
+    }
+    if (!writeCache(cachePath, hash, mesh)) {
+        ofLogWarning("MeshCache") << "can't write cache for " << source;
+    }
+    if (!withTangents) {
+        mesh.getColors().clear();
+    }
+    return true;
+}
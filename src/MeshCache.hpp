@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ThreadPool.hpp"
+#include <cstdint>
+
+// 텍스트(ASCII) PLY 파일을 매번 파싱하지 않도록, 파싱 + 메쉬 최적화(MeshOptimizer) + 탄젠트 계산까지 끝난 메쉬를 바이너리 캐시 파일로 저장해두고
+// 다음 실행부터는 캐시 파일을 메모리 매핑(mmap)해서 버텍스 스트림을 통째로 복사해오는 모듈.
+//
+// 캐시 파일은 원본 파일 옆에 "<원본 파일 이름>.meshcache" 로 저장되며,
+// 헤더에 원본 파일 내용의 해시값을 저장해두고 로드할 때 비교해서 원본이 바뀌었으면 자동으로 다시 만듦.
+namespace MeshCache {
+
+    const uint32_t VERSION = 2; // 파일 구조나 탄젠트 계산, 메쉬 최적화 방식이 바뀌면 올려서 기존 캐시를 무효화함.
+
+    // 캐시 파일 헤더. 헤더 뒤에 각 스트림이 16 바이트 정렬된 오프셋에 SoA 형태로 이어서 저장됨.
+    struct Header {
+        char magic[4]; // "MSHC"
+        uint32_t version;
+        uint64_t sourceHash; // 원본 파일 내용의 FNV-1a 64비트 해시
+        uint32_t numVertices;
+        uint32_t numIndices;
+        uint64_t positionOffset; // vec3 * numVertices
+        uint64_t normalOffset; // vec3 * numVertices
+        uint64_t texCoordOffset; // vec2 * numVertices
+        uint64_t tangentOffset; // vec4 * numVertices (w: 바이탄젠트 방향 부호)
+        uint64_t indexOffset; // uint32 * numIndices
+    };
+
+    std::filesystem::path getCachePath(const std::filesystem::path& source);
+
+    // 원본 PLY 를 파싱하고 최적화, 탄젠트 계산을 거쳐서 캐시 파일을 만듦. (오프라인 변환기: main.cpp 의 --build-mesh-cache 옵션에서도 사용)
+    // pool 을 주면 탄젠트 계산을 그 워커 스레드들과 나눠서 함.
+    bool build(const std::filesystem::path& source, ThreadPool* pool = nullptr);
+
+    // 캐시가 최신이면 캐시에서, 아니면 원본에서 로드한 뒤 캐시를 다시 만듦.
+    // 탄젠트는 버텍스 컬러 자리에 들어있으므로 따로 calcTangents() 를 호출할 필요가 없음.
+    // withTangents 가 false 면 탄젠트 스트림을 채우지 않음. (스카이박스 큐브처럼 노말맵을 쓰지 않는 메쉬)
+    bool load(const std::filesystem::path& source, ofMesh& mesh, bool withTangents = true, ThreadPool* pool = nullptr);
+}
@@ -0,0 +1,472 @@
+#include "MeshOptimizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace {
+
+// Forsyth 알고리즘의 점수 계산에 쓰는 LRU 캐시 크기와 가중치 (원 논문의 기본값)
+const int SCORE_CACHE_SIZE = 32;
+const float LAST_TRIANGLE_SCORE = 0.75f;
+const float CACHE_DECAY_POWER = 1.5f;
+const float VALENCE_BOOST_SCALE = 2.0f;
+const float VALENCE_BOOST_POWER = 0.5f;
+
+float vertexScore(int cachePosition, uint32_t remainingTriangles) {
+    if (remainingTriangles == 0) {
+        return -1.0f; // 더 이상 쓰이지 않는 버텍스
+    }
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            score = LAST_TRIANGLE_SCORE; // 직전 삼각형의 버텍스는 점수를 조금 낮춰서, 한 방향으로만 길게 이어지는 순서를 피함.
+        } else {
+            float scale = 1.0f / (SCORE_CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scale, CACHE_DECAY_POWER);
+        }
+    }
+    // 남은 삼각형이 적은 버텍스를 먼저 끝내서, 나중에 혼자 남은 삼각형 때문에 캐시 미스가 나지 않도록 함.
+    score += VALENCE_BOOST_SCALE * std::pow(float(remainingTriangles), -VALENCE_BOOST_POWER);
+    return score;
+}
+
+// 버텍스 하나의 모든 속성. 바이트 단위로 비교/해시하므로 패딩이 없어야 함. (12 + 12 + 8 + 16 바이트)
+struct WeldKey {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoord;
+    ofFloatColor color;
+};
+
+struct WeldKeyHash {
+    size_t operator()(const WeldKey& key) const {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&key);
+        uint64_t hash = 14695981039346656037ull; // FNV-1a
+        for (size_t i = 0; i < sizeof(WeldKey); ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return size_t(hash);
+    }
+};
+
+struct WeldKeyEqual {
+    bool operator()(const WeldKey& a, const WeldKey& b) const {
+        return std::memcmp(&a, &b, sizeof(WeldKey)) == 0;
+    }
+};
+
+// values 를 order 순서대로 다시 모음. (스트림이 없거나 길이가 다르면 그대로 둠)
+template<typename T>
+void gather(std::vector<T>& values, size_t numVertices, const std::vector<ofIndexType>& order) {
+    if (values.size() != numVertices) {
+        return;
+    }
+    std::vector<T> result(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        result[i] = values[order[i]];
+    }
+    values.swap(result);
+}
+
+void gatherVertices(ofMesh& mesh, size_t numVertices, const std::vector<ofIndexType>& order) {
+    gather(mesh.getVertices(), numVertices, order);
+    gather(mesh.getNormals(), numVertices, order);
+    gather(mesh.getTexCoords(), numVertices, order);
+    gather(mesh.getColors(), numVertices, order);
+}
+
+// 부호 있는 정규화 10:10:10:2 (GL_INT_2_10_10_10_REV). x 가 최하위 비트.
+uint32_t packSnorm1010102(const glm::vec4& v) {
+    auto quantize = [](float x, float maxValue, uint32_t mask) {
+        int32_t i = int32_t(std::round(glm::clamp(x, -1.0f, 1.0f) * maxValue));
+        return uint32_t(i) & mask;
+    };
+    return quantize(v.x, 511.0f, 0x3ff) | (quantize(v.y, 511.0f, 0x3ff) << 10) | (quantize(v.z, 511.0f, 0x3ff) << 20)
+        | (quantize(v.w, 1.0f, 0x3) << 30);
+}
+
+// 32비트 float -> 16비트 half float (반올림). uv 에서는 의미 없는 비정규 수는 0 으로 버림.
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = int32_t((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+    if (exponent <= 0) {
+        return uint16_t(sign);
+    }
+    if (exponent >= 31) {
+        return uint16_t(sign | 0x7c00);
+    }
+    uint32_t half = sign | (uint32_t(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000) {
+        ++half; // 자리올림이 지수로 넘어가도 올바른 값이 됨.
+    }
+    return uint16_t(half);
+}
+
+} // namespace
+
+size_t MeshOptimizer::weld(ofMesh& mesh) {
+    size_t numVertices = mesh.getNumVertices();
+    bool hasNormals = mesh.getNumNormals() == numVertices;
+    bool hasTexCoords = mesh.getNumTexCoords() == numVertices;
+    bool hasColors = mesh.getNumColors() == numVertices;
+
+    std::vector<ofIndexType>& indices = mesh.getIndices();
+    if (indices.empty()) {
+        indices.resize(numVertices);
+        for (size_t i = 0; i < numVertices; ++i) {
+            indices[i] = ofIndexType(i);
+        }
+    }
+
+    std::unordered_map<WeldKey, ofIndexType, WeldKeyHash, WeldKeyEqual> unique;
+    unique.reserve(numVertices);
+    std::vector<ofIndexType> remap(numVertices);
+    std::vector<ofIndexType> order; // 새 버텍스 번호 -> 원래 버텍스 번호
+    order.reserve(numVertices);
+    for (size_t i = 0; i < numVertices; ++i) {
+        WeldKey key = { glm::vec3(0.0f), glm::vec3(0.0f), glm::vec2(0.0f), ofFloatColor(0.0f, 0.0f, 0.0f, 0.0f) }; // 없는 스트림은 0 으로 비교함.
+        key.position = mesh.getVertices()[i];
+        if (hasNormals) key.normal = mesh.getNormals()[i];
+        if (hasTexCoords) key.texCoord = mesh.getTexCoords()[i];
+        if (hasColors) key.color = mesh.getColors()[i];
+        auto result = unique.emplace(key, ofIndexType(order.size()));
+        if (result.second) {
+            order.push_back(ofIndexType(i));
+        }
+        remap[i] = result.first->second;
+    }
+
+    gatherVertices(mesh, numVertices, order);
+    for (ofIndexType& index : indices) {
+        index = remap[index];
+    }
+    return numVertices - order.size();
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<ofIndexType>& indices, size_t numVertices) {
+    size_t numTriangles = indices.size() / 3;
+    if (numTriangles == 0) {
+        return;
+    }
+    indices.resize(numTriangles * 3); // 삼각형을 이루지 못하는 나머지 인덱스는 버림.
+
+    // 버텍스마다 그 버텍스를 쓰는 삼각형 목록. adjacency[offsets[v]] 부터 remaining[v] 개가 아직 그리지 않은 삼각형임.
+    std::vector<uint32_t> remaining(numVertices, 0);
+    for (ofIndexType index : indices) {
+        remaining[index]++;
+    }
+    std::vector<uint32_t> offsets(numVertices + 1, 0);
+    for (size_t v = 0; v < numVertices; ++v) {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < numTriangles; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            adjacency[fill[indices[t * 3 + k]]++] = uint32_t(t);
+        }
+    }
+
+    std::vector<int> cachePositions(numVertices, -1);
+    std::vector<float> vertexScores(numVertices);
+    for (size_t v = 0; v < numVertices; ++v) {
+        vertexScores[v] = vertexScore(-1, remaining[v]);
+    }
+    std::vector<float> triangleScores(numTriangles);
+    std::vector<bool> emitted(numTriangles, false);
+    int best = 0;
+    for (size_t t = 0; t < numTriangles; ++t) {
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+        if (triangleScores[t] > triangleScores[best]) {
+            best = int(t);
+        }
+    }
+
+    std::vector<ofIndexType> result;
+    result.reserve(indices.size());
+    std::vector<ofIndexType> cache; // 최근에 쓴 버텍스가 앞쪽
+    std::vector<ofIndexType> nextCache;
+    while (result.size() < indices.size()) {
+        if (best < 0) {
+            // 캐시 안의 버텍스들에 붙은 삼각형을 모두 그렸으면, 아직 그리지 않은 삼각형 중 점수가 가장 높은 것부터 다시 시작함.
+            float bestScore = -std::numeric_limits<float>::max();
+            for (size_t t = 0; t < numTriangles; ++t) {
+                if (!emitted[t] && triangleScores[t] > bestScore) {
+                    best = int(t);
+                    bestScore = triangleScores[t];
+                }
+            }
+        }
+
+        uint32_t triangle = uint32_t(best);
+        emitted[triangle] = true;
+        nextCache.clear();
+        for (int k = 0; k < 3; ++k) {
+            ofIndexType v = indices[triangle * 3 + k];
+            result.push_back(v);
+            uint32_t* list = &adjacency[offsets[v]];
+            for (uint32_t i = 0; i < remaining[v]; ++i) {
+                if (list[i] == triangle) {
+                    list[i] = list[remaining[v] - 1];
+                    break;
+                }
+            }
+            remaining[v]--;
+            if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end()) {
+                nextCache.push_back(v); // 방금 그린 삼각형의 버텍스들이 캐시 맨 앞으로 옴.
+            }
+        }
+        size_t fresh = nextCache.size();
+        for (ofIndexType v : cache) {
+            if (std::find(nextCache.begin(), nextCache.begin() + fresh, v) == nextCache.begin() + fresh) {
+                nextCache.push_back(v);
+            }
+        }
+
+        // 캐시 안의 버텍스(와 이번에 밀려나는 버텍스)의 점수가 바뀐 만큼, 그 버텍스를 쓰는 남은 삼각형들의 점수도 바꿈.
+        for (size_t i = 0; i < nextCache.size(); ++i) {
+            ofIndexType v = nextCache[i];
+            cachePositions[v] = i < SCORE_CACHE_SIZE ? int(i) : -1;
+            float score = vertexScore(cachePositions[v], remaining[v]);
+            float delta = score - vertexScores[v];
+            vertexScores[v] = score;
+            for (uint32_t j = 0; j < remaining[v]; ++j) {
+                triangleScores[adjacency[offsets[v] + j]] += delta;
+            }
+        }
+        if (nextCache.size() > SCORE_CACHE_SIZE) {
+            nextCache.resize(SCORE_CACHE_SIZE);
+        }
+        cache.swap(nextCache);
+
+        // 다음 삼각형은 캐시 안의 버텍스에 붙은 삼각형들 중에서만 고름. (없으면 위에서 전체를 훑음)
+        best = -1;
+        float bestScore = -std::numeric_limits<float>::max();
+        for (ofIndexType v : cache) {
+            for (uint32_t j = 0; j < remaining[v]; ++j) {
+                uint32_t t = adjacency[offsets[v] + j];
+                if (triangleScores[t] > bestScore) {
+                    best = int(t);
+                    bestScore = triangleScores[t];
+                }
+            }
+        }
+    }
+    indices.swap(result);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<ofIndexType>& indices, const std::vector<glm::vec3>& positions) {
+    size_t numTriangles = indices.size() / 3;
+    if (numTriangles < 2) {
+        return;
+    }
+
+    // 1. 세 버텍스가 모두 캐시 미스인 삼각형(= 캐시 순서가 새로 시작되는 지점)마다 클러스터를 나눔.
+    //    클러스터 안의 순서는 그대로 두므로, 클러스터끼리 순서를 바꿔도 ACMR 은 거의 변하지 않음.
+    std::vector<uint32_t> clusterStarts;
+    std::vector<uint32_t> cacheTimes(positions.size(), 0);
+    uint32_t time = CACHE_SIZE + 1;
+    for (size_t t = 0; t < numTriangles; ++t) {
+        int misses = 0;
+        for (int k = 0; k < 3; ++k) {
+            ofIndexType v = indices[t * 3 + k];
+            if (time - cacheTimes[v] > CACHE_SIZE) {
+                cacheTimes[v] = time++;
+                misses++;
+            }
+        }
+        if (t == 0 || misses == 3) {
+            clusterStarts.push_back(uint32_t(t));
+        }
+    }
+    if (clusterStarts.size() < 2) {
+        return;
+    }
+    clusterStarts.push_back(uint32_t(numTriangles));
+
+    // 2. 메쉬 전체와 클러스터별 넓이 가중 중심, 클러스터의 평균 노멀을 구함.
+    struct Cluster {
+        uint32_t begin;
+        uint32_t end;
+        float sortKey;
+    };
+    std::vector<Cluster> clusters;
+    std::vector<glm::vec3> centroids;
+    std::vector<glm::vec3> normals;
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (size_t c = 0; c + 1 < clusterStarts.size(); ++c) {
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+        for (uint32_t t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t) {
+            const glm::vec3& p0 = positions[indices[t * 3]];
+            const glm::vec3& p1 = positions[indices[t * 3 + 1]];
+            const glm::vec3& p2 = positions[indices[t * 3 + 2]];
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0); // 길이 = 넓이 * 2
+            float a = glm::length(n);
+            centroid += (p0 + p1 + p2) * (a / 3.0f);
+            normal += n;
+            area += a;
+        }
+        meshCentroid += centroid;
+        meshArea += area;
+        centroids.push_back(area > 0.0f ? centroid / area : centroid);
+        normals.push_back(glm::length(normal) > 0.0f ? glm::normalize(normal) : normal);
+        clusters.push_back({ clusterStarts[c], clusterStarts[c + 1], 0.0f });
+    }
+    if (meshArea > 0.0f) {
+        meshCentroid /= meshArea;
+    }
+
+    // 3. 바깥을 향하는 클러스터일수록 먼저 그림. (중심에서 멀리, 바깥쪽을 보는 면이 보통 앞쪽 면을 가림)
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        clusters[c].sortKey = glm::dot(centroids[c] - meshCentroid, normals[c]);
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    std::vector<ofIndexType> result;
+    result.reserve(indices.size());
+    for (const Cluster& cluster : clusters) {
+        result.insert(result.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+    }
+    indices.swap(result);
+}
+
+void MeshOptimizer::optimizeVertexFetch(ofMesh& mesh) {
+    size_t numVertices = mesh.getNumVertices();
+    const ofIndexType unused = std::numeric_limits<ofIndexType>::max();
+    std::vector<ofIndexType> remap(numVertices, unused);
+    std::vector<ofIndexType> order;
+    order.reserve(numVertices);
+    for (ofIndexType& index : mesh.getIndices()) {
+        if (remap[index] == unused) {
+            remap[index] = ofIndexType(order.size());
+            order.push_back(index);
+        }
+        index = remap[index];
+    }
+    gatherVertices(mesh, numVertices, order);
+}
+
+// FIFO 캐시: 버텍스가 마지막으로 캐시에 들어간 시각을 기록해두고, 그 뒤로 cacheSize 개 넘게 새로 들어왔으면 밀려난 것으로 봄.
+float MeshOptimizer::analyzeVertexCache(const std::vector<ofIndexType>& indices, size_t numVertices, unsigned cacheSize) {
+    size_t numTriangles = indices.size() / 3;
+    if (numTriangles == 0) {
+        return 0.0f;
+    }
+    std::vector<uint32_t> cacheTimes(numVertices, 0);
+    uint32_t time = cacheSize + 1;
+    size_t misses = 0;
+    for (ofIndexType index : indices) {
+        if (time - cacheTimes[index] > cacheSize) {
+            cacheTimes[index] = time++;
+            misses++;
+        }
+    }
+    return float(misses) / numTriangles;
+}
+
+MeshOptimizer::Report MeshOptimizer::optimize(ofMesh& mesh) {
+    Report report;
+    report.verticesBefore = mesh.getNumVertices();
+    report.verticesAfter = report.verticesBefore;
+    if (mesh.getMode() != OF_PRIMITIVE_TRIANGLES || mesh.getNumVertices() == 0) {
+        return report;
+    }
+    // 인덱스가 없으면 모든 버텍스가 따로 변환되므로 삼각형당 3번 미스임.
+    report.acmrBefore = mesh.getNumIndices() > 0 ? analyzeVertexCache(mesh.getIndices(), mesh.getNumVertices()) : 3.0f;
+
+    weld(mesh);
+    optimizeVertexCache(mesh.getIndices(), mesh.getNumVertices());
+    optimizeOverdraw(mesh.getIndices(), mesh.getVertices());
+    optimizeVertexFetch(mesh);
+
+    report.verticesAfter = mesh.getNumVertices();
+    report.acmrAfter = analyzeVertexCache(mesh.getIndices(), mesh.getNumVertices());
+    return report;
+}
+
+size_t MeshOptimizer::getFloatBytesPerVertex(const ofMesh& mesh) {
+    size_t numVertices = mesh.getNumVertices();
+    size_t bytes = sizeof(glm::vec3);
+    if (mesh.getNumNormals() == numVertices) bytes += sizeof(glm::vec3);
+    if (mesh.getNumTexCoords() == numVertices) bytes += sizeof(glm::vec2);
+    if (mesh.getNumColors() == numVertices) bytes += sizeof(ofFloatColor);
+    return bytes;
+}
+
+MeshOptimizer::PackedLayout MeshOptimizer::getPackedLayout(const ofMesh& mesh, bool quantizePositions) {
+    size_t numVertices = mesh.getNumVertices();
+    PackedLayout layout;
+    layout.quantizedPositions = quantizePositions && numVertices > 0;
+    if (layout.quantizedPositions) {
+        // 오브젝트공간 AABB 를 0 ~ 65535 로 나눔. (방패 크기 1 기준 오차 약 0.015mm)
+        glm::vec3 lo(std::numeric_limits<float>::max());
+        glm::vec3 hi(-std::numeric_limits<float>::max());
+        for (const glm::vec3& v : mesh.getVertices()) {
+            lo = glm::min(lo, v);
+            hi = glm::max(hi, v);
+        }
+        layout.positionOffset = lo;
+        layout.positionScale = hi - lo;
+        layout.stride = 4 * sizeof(uint16_t); // xyz + 4 바이트 정렬용 패딩
+    } else {
+        layout.stride = sizeof(glm::vec3);
+    }
+    if (mesh.getNumNormals() == numVertices) {
+        layout.normalOffset = int(layout.stride);
+        layout.stride += sizeof(uint32_t);
+    }
+    if (mesh.getNumColors() == numVertices) {
+        layout.tangentOffset = int(layout.stride);
+        layout.stride += sizeof(uint32_t);
+    }
+    if (mesh.getNumTexCoords() == numVertices) {
+        layout.texCoordOffset = int(layout.stride);
+        layout.stride += 2 * sizeof(uint16_t);
+    }
+    return layout;
+}
+
+void MeshOptimizer::pack(const ofMesh& mesh, const PackedLayout& layout, std::vector<uint8_t>& out) {
+    size_t numVertices = mesh.getNumVertices();
+    out.assign(numVertices * layout.stride, 0);
+    for (size_t i = 0; i < numVertices; ++i) {
+        uint8_t* vertex = out.data() + i * layout.stride;
+        const glm::vec3& position = mesh.getVertices()[i];
+        if (layout.quantizedPositions) {
+            uint16_t q[4] = { 0, 0, 0, 0 };
+            for (int c = 0; c < 3; ++c) {
+                float extent = layout.positionScale[c];
+                float t = extent > 0.0f ? (position[c] - layout.positionOffset[c]) / extent : 0.0f;
+                q[c] = uint16_t(std::round(glm::clamp(t, 0.0f, 1.0f) * 65535.0f));
+            }
+            std::memcpy(vertex, q, sizeof(q));
+        } else {
+            std::memcpy(vertex, &position, sizeof(glm::vec3));
+        }
+        if (layout.normalOffset >= 0) {
+            uint32_t packed = packSnorm1010102(glm::vec4(mesh.getNormals()[i], 0.0f));
+            std::memcpy(vertex + layout.normalOffset, &packed, sizeof(packed));
+        }
+        if (layout.tangentOffset >= 0) {
+            const ofFloatColor& tangent = mesh.getColors()[i];
+            uint32_t packed = packSnorm1010102(glm::vec4(tangent.r, tangent.g, tangent.b, tangent.a < 0.0f ? -1.0f : 1.0f));
+            std::memcpy(vertex + layout.tangentOffset, &packed, sizeof(packed));
+        }
+        if (layout.texCoordOffset >= 0) {
+            const glm::vec2& uv = mesh.getTexCoords()[i];
+            uint16_t half[2] = { floatToHalf(uv.x), floatToHalf(uv.y) };
+            std::memcpy(vertex + layout.texCoordOffset, half, sizeof(half));
+        }
+    }
+}
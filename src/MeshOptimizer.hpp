@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ofMain.h"
+#include <cstdint>
+#include <vector>
+
+// 모델링 파일을 불러온 직후(MeshCache 가 캐시를 만들 때) 한 번 적용하는 메쉬 최적화 단계들과, GPU 로 올릴 압축 버텍스 포맷 변환.
+//
+// 1. weld()                : 모든 속성(위치, 노멀, uv, 컬러 자리의 탄젠트)이 완전히 같은 버텍스들을 하나로 합침.
+// 2. optimizeVertexCache() : 방금 변환된 버텍스를 다시 쓰는 삼각형부터 그리도록 삼각형 순서를 바꿈. (Forsyth 의 선형 시간 알고리즘)
+// 3. optimizeOverdraw()    : 캐시 순서가 끊기는 지점마다 삼각형들을 클러스터로 나누고, 바깥을 향하는 클러스터부터 그리도록 정렬함.
+//                            (안쪽/뒤쪽 면이 나중에 그려지면 깊이 테스트에서 먼저 버려지므로 오버드로우가 줄어듦)
+// 4. optimizeVertexFetch() : 버텍스 배열을 인덱스 버퍼에서 처음 쓰이는 순서대로 재배치해서, 버텍스 fetch 가 메모리를 앞에서부터 차례로 읽게 함.
+// 5. pack()                : 위치(선택: 16비트 + 역양자화 변환), 노멀/탄젠트(10:10:10:2), uv(half float) 로 압축한 인터리브 버텍스 데이터를 만듦.
+//
+// analyzeVertexCache() 는 FIFO 버텍스 캐시를 흉내내서 ACMR(삼각형당 캐시 미스 수)을 계산함. (최악은 3, 일반적인 메쉬의 하한은 0.5 정도)
+namespace MeshOptimizer {
+
+    const unsigned CACHE_SIZE = 16; // ACMR 을 잴 때 흉내내는 FIFO 버텍스 캐시 크기
+
+    // optimize() 전후 비교 결과
+    struct Report {
+        size_t verticesBefore = 0;
+        size_t verticesAfter = 0;
+        float acmrBefore = 0.0f;
+        float acmrAfter = 0.0f;
+    };
+
+    // pack() 이 만드는 인터리브 버텍스 한 개의 구성. 오프셋이 -1 이면 그 스트림이 없는 것.
+    // 로케이션은 기존 셰이더와 같음: 0 위치, 1 탄젠트(w: 바이탄젠트 방향 부호), 2 노멀, 3 uv
+    struct PackedLayout {
+        size_t stride = 0;
+        bool quantizedPositions = false; // true 면 위치가 GL_UNSIGNED_SHORT x 3 (정규화), 아니면 GL_FLOAT x 3
+        int normalOffset = -1; // GL_INT_2_10_10_10_REV (정규화)
+        int tangentOffset = -1; // GL_INT_2_10_10_10_REV (정규화, w 2비트에 방향 부호)
+        int texCoordOffset = -1; // GL_HALF_FLOAT x 2
+        // 셰이더에서 pos * positionScale + positionOffset 으로 오브젝트공간 위치를 복원함. (양자화하지 않으면 scale 1, offset 0)
+        glm::vec3 positionScale = glm::vec3(1.0f);
+        glm::vec3 positionOffset = glm::vec3(0.0f);
+    };
+
+    // 합쳐서 줄어든 버텍스 수를 리턴함. 인덱스가 없는 메쉬는 인덱스 버퍼를 새로 만듦.
+    size_t weld(ofMesh& mesh);
+
+    void optimizeVertexCache(std::vector<ofIndexType>& indices, size_t numVertices);
+    void optimizeOverdraw(std::vector<ofIndexType>& indices, const std::vector<glm::vec3>& positions);
+    void optimizeVertexFetch(ofMesh& mesh); // 인덱스 버퍼가 쓰지 않는 버텍스는 버림.
+
+    float analyzeVertexCache(const std::vector<ofIndexType>& indices, size_t numVertices, unsigned cacheSize = CACHE_SIZE);
+
+    // 삼각형 메쉬에 1 ~ 4 단계를 순서대로 적용함. (삼각형 메쉬가 아니면 아무것도 하지 않음)
+    Report optimize(ofMesh& mesh);
+
+    size_t getFloatBytesPerVertex(const ofMesh& mesh); // 오픈프레임웍스 기본 float 스트림 기준 버텍스당 바이트 수
+    PackedLayout getPackedLayout(const ofMesh& mesh, bool quantizePositions);
+    void pack(const ofMesh& mesh, const PackedLayout& layout, std::vector<uint8_t>& out);
+}
@@ -0,0 +1,551 @@
+#include "OceanSimulation.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define OCEAN_USE_SSE 1
+#endif
+
+namespace {
+
+const float GRAVITY = 9.81f;
+const float TWO_PI = 6.28318530718f;
+const int MIN_RESOLUTION = 4; // radix-2 FFT 와 SSE 버터플라이(4 개씩)가 동작하는 최소 격자 크기
+const int MAX_RESOLUTION = 4096;
+const float AGAINST_WIND = 0.07f; // 바람 반대 방향으로 진행하는 파동의 에너지 비율
+const size_t ROWS_PER_CHUNK = 16; // 행 FFT 를 스레드로 나눌 때 한 구간의 최소 행 수
+const size_t COLUMN_GROUPS_PER_CHUNK = 4; // 열 FFT 를 스레드로 나눌 때 한 구간의 최소 열 묶음(4열) 수
+
+// 시뮬레이션 스레드와 메인 스레드를 뺀 나머지 코어만 사용함.
+size_t defaultWorkerCount() {
+    unsigned cores = std::thread::hardware_concurrency();
+    return cores > 2 ? cores - 2 : 1;
+}
+
+float elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 크기 m 인 단계의 버터플라이 j 개를 계산함: t = w * b, b = a - t, a = a + t
+inline void butterflies(float* ar, float* ai, float* br, float* bi, const float* wr, const float* wi, int count) {
+    int j = 0;
+#ifdef OCEAN_USE_SSE
+    for (; j + 4 <= count; j += 4) {
+        __m128 wRe = _mm_loadu_ps(wr + j), wIm = _mm_loadu_ps(wi + j);
+        __m128 bRe = _mm_loadu_ps(br + j), bIm = _mm_loadu_ps(bi + j);
+        __m128 tRe = _mm_sub_ps(_mm_mul_ps(wRe, bRe), _mm_mul_ps(wIm, bIm));
+        __m128 tIm = _mm_add_ps(_mm_mul_ps(wRe, bIm), _mm_mul_ps(wIm, bRe));
+        __m128 aRe = _mm_loadu_ps(ar + j), aIm = _mm_loadu_ps(ai + j);
+        _mm_storeu_ps(br + j, _mm_sub_ps(aRe, tRe));
+        _mm_storeu_ps(bi + j, _mm_sub_ps(aIm, tIm));
+        _mm_storeu_ps(ar + j, _mm_add_ps(aRe, tRe));
+        _mm_storeu_ps(ai + j, _mm_add_ps(aIm, tIm));
+    }
+#endif
+    for (; j < count; ++j) {
+        float tRe = wr[j] * br[j] - wi[j] * bi[j];
+        float tIm = wr[j] * bi[j] + wi[j] * br[j];
+        br[j] = ar[j] - tRe;
+        bi[j] = ai[j] - tIm;
+        ar[j] += tRe;
+        ai[j] += tIm;
+    }
+}
+
+// 두 행 a, b 의 [x0, x1) 구간에 같은 회전인자 w 로 버터플라이를 계산함. (열 방향 FFT 에서 열 여러 개를 한꺼번에 처리)
+inline void rowButterflies(float* ar, float* ai, float* br, float* bi, float wr, float wi, int x0, int x1) {
+    int x = x0;
+#ifdef OCEAN_USE_SSE
+    __m128 wRe = _mm_set1_ps(wr), wIm = _mm_set1_ps(wi);
+    for (; x + 4 <= x1; x += 4) {
+        __m128 bRe = _mm_loadu_ps(br + x), bIm = _mm_loadu_ps(bi + x);
+        __m128 tRe = _mm_sub_ps(_mm_mul_ps(wRe, bRe), _mm_mul_ps(wIm, bIm));
+        __m128 tIm = _mm_add_ps(_mm_mul_ps(wRe, bIm), _mm_mul_ps(wIm, bRe));
+        __m128 aRe = _mm_loadu_ps(ar + x), aIm = _mm_loadu_ps(ai + x);
+        _mm_storeu_ps(br + x, _mm_sub_ps(aRe, tRe));
+        _mm_storeu_ps(bi + x, _mm_sub_ps(aIm, tIm));
+        _mm_storeu_ps(ar + x, _mm_add_ps(aRe, tRe));
+        _mm_storeu_ps(ai + x, _mm_add_ps(aIm, tIm));
+    }
+#endif
+    for (; x < x1; ++x) {
+        float tRe = wr * br[x] - wi * bi[x];
+        float tIm = wr * bi[x] + wi * br[x];
+        br[x] = ar[x] - tRe;
+        bi[x] = ai[x] - tIm;
+        ar[x] += tRe;
+        ai[x] += tIm;
+    }
+}
+
+// 길이 n 인 복소수 배열 하나를 제자리에서 역 FFT 함. (정규화하지 않음: x[m] = sum_k X[k] e^(+2 pi i k m / n))
+void inverseFft(float* re, float* im, int n, const int* bitReverse, const float* twRe, const float* twIm) {
+    for (int i = 0; i < n; ++i) {
+        int j = bitReverse[i];
+        if (j > i) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+    for (int m = 1; m < n; m *= 2) {
+        for (int start = 0; start < n; start += 2 * m) {
+            butterflies(re + start, im + start, re + start + m, im + start + m, twRe + m - 1, twIm + m - 1, m);
+        }
+    }
+}
+
+// n * n 행렬의 [x0, x1) 열들을 제자리에서 역 FFT 함. 버터플라이가 행 단위로 이뤄지므로 안쪽 루프가 연속된 메모리를 읽음.
+void inverseFftColumns(float* re, float* im, int n, int x0, int x1, const int* bitReverse, const float* twRe, const float* twIm) {
+    for (int z = 0; z < n; ++z) {
+        int r = bitReverse[z];
+        if (r > z) {
+            std::swap_ranges(re + size_t(z) * n + x0, re + size_t(z) * n + x1, re + size_t(r) * n + x0);
+            std::swap_ranges(im + size_t(z) * n + x0, im + size_t(z) * n + x1, im + size_t(r) * n + x0);
+        }
+    }
+    for (int m = 1; m < n; m *= 2) {
+        for (int start = 0; start < n; start += 2 * m) {
+            for (int j = 0; j < m; ++j) {
+                size_t a = size_t(start + j) * n;
+                size_t b = a + size_t(m) * n;
+                rowButterflies(re + a, im + a, re + b, im + b, twRe[m - 1 + j], twIm[m - 1 + j], x0, x1);
+            }
+        }
+    }
+}
+
+// float -> half float (가장 가까운 값으로 반올림, 표현 범위를 넘으면 최댓값으로 자르고, 정규화 범위보다 작은 값은 0 으로 만듦)
+inline uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t absBits = bits & 0x7fffffff;
+    uint32_t half;
+    if (absBits < (113u << 23)) {
+        half = 0;
+    } else if (absBits > 0x477fefffu) {
+        half = 0x7bff;
+    } else {
+        half = (absBits - (112u << 23) + 0x1000) >> 13;
+    }
+    return uint16_t(half | sign);
+}
+
+#ifdef OCEAN_USE_SSE
+// floatToHalf() 를 4개씩 계산함. 결과는 하위 64비트에 들어있음.
+inline __m128i floatToHalf4(__m128 value) {
+    __m128i bits = _mm_castps_si128(value);
+    __m128i sign = _mm_and_si128(_mm_srli_epi32(bits, 16), _mm_set1_epi32(0x8000));
+    __m128i absBits = _mm_and_si128(bits, _mm_set1_epi32(0x7fffffff));
+    __m128i half = _mm_srli_epi32(_mm_add_epi32(_mm_sub_epi32(absBits, _mm_set1_epi32(112 << 23)), _mm_set1_epi32(0x1000)), 13);
+    __m128i tooSmall = _mm_cmplt_epi32(absBits, _mm_set1_epi32(113 << 23));
+    __m128i tooLarge = _mm_cmpgt_epi32(absBits, _mm_set1_epi32(0x477fefff));
+    half = _mm_andnot_si128(tooSmall, half);
+    half = _mm_or_si128(_mm_andnot_si128(tooLarge, half), _mm_and_si128(tooLarge, _mm_set1_epi32(0x7bff)));
+    half = _mm_or_si128(half, sign);
+    // packs 는 부호 있는 포화 변환이므로, 0x8000 만큼 옮겨서 16비트로 묶은 뒤 되돌림.
+    __m128i biased = _mm_sub_epi32(half, _mm_set1_epi32(0x8000));
+    return _mm_add_epi16(_mm_packs_epi32(biased, biased), _mm_set1_epi16(short(0x8000)));
+}
+#endif
+
+} // namespace
+
+OceanSimulation::OceanSimulation() : workers(defaultWorkerCount()) {
+    thread = std::thread(&OceanSimulation::simulationLoop, this);
+}
+
+OceanSimulation::~OceanSimulation() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    thread.join();
+
+    if (mapped && pboMapped) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffers[writeBuffer]);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    if (pixelBuffers[0]) {
+        glDeleteBuffers(2, pixelBuffers);
+    }
+}
+
+void OceanSimulation::setup(const Settings& newSettings) {
+    // 진행 중인 시뮬레이션이 예전 크기의 배열과 PBO 에 쓰고 있을 수 있으므로 먼저 끝냄.
+    if (started) {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return !busy; });
+    }
+    if (mapped && pboMapped) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffers[writeBuffer]);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    mapped = nullptr;
+    started = false;
+
+    settings = newSettings;
+    // radix-2 FFT 는 2 의 거듭제곱 크기에서만 맞으므로, 그 외의 값은 가장 가까운 큰 2 의 거듭제곱으로 올림. (SSE 버터플라이가 4 개씩 묶으므로 최소 4)
+    int rounded = MIN_RESOLUTION;
+    while (rounded < settings.resolution && rounded < MAX_RESOLUTION) {
+        rounded *= 2;
+    }
+    if (rounded != settings.resolution) {
+        ofLogWarning("OceanSimulation") << "resolution " << settings.resolution << " is not a power of two in [" << MIN_RESOLUTION << ", " << MAX_RESOLUTION << "], using " << rounded;
+        settings.resolution = rounded;
+    }
+    int n = settings.resolution;
+    size_t count = size_t(n) * n;
+
+    // FFT 테이블: 비트 반전 순서와, 크기 m 인 단계의 회전인자 e^(+pi i j / m) (j = 0 ~ m - 1)
+    int bits = 0;
+    while ((1 << bits) < n) {
+        ++bits;
+    }
+    bitReverse.resize(n);
+    for (int i = 0; i < n; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bitReverse[i] = r;
+    }
+    twiddleRe.resize(std::max(n - 1, 1));
+    twiddleIm.resize(std::max(n - 1, 1));
+    for (int m = 1; m < n; m *= 2) {
+        for (int j = 0; j < m; ++j) {
+            float angle = TWO_PI * 0.5f * float(j) / float(m);
+            twiddleRe[m - 1 + j] = std::cos(angle);
+            twiddleIm[m - 1 + j] = std::sin(angle);
+        }
+    }
+
+    for (ComplexField& field : fields) {
+        field.re.assign(count, 0.0f);
+        field.im.assign(count, 0.0f);
+    }
+    chunkMax.assign(workers.size() + 1, 0.0f);
+    buildSpectrum();
+
+    // PBO 하나에 변위맵(텍셀당 8 바이트)과 기울기맵(텍셀당 4 바이트)을 이어서 담음.
+    stats.uploadBytes = count * 12;
+    writeBuffer = 0;
+    if (!useTextures) {
+        // GL 없이 쓰는 경우(SoftwareRenderer)에는 같은 배치의 CPU 버퍼 두 개를 번갈아 씀.
+        for (std::vector<uint8_t>& buffer : cpuBuffers) {
+            buffer.assign(stats.uploadBytes, 0);
+        }
+        return;
+    }
+
+    displacementTex.allocate(n, n, GL_RGBA16F);
+    displacementTex.setTextureWrap(GL_REPEAT, GL_REPEAT);
+    displacementTex.setTextureMinMagFilter(GL_LINEAR, GL_LINEAR);
+    slopeTex.allocate(n, n, GL_RG16F);
+    slopeTex.setTextureWrap(GL_REPEAT, GL_REPEAT);
+    slopeTex.setTextureMinMagFilter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR); // 멀리서 반복되는 무늬가 지글거리지 않도록 밉맵을 씀.
+
+    if (!pixelBuffers[0]) {
+        glGenBuffers(2, pixelBuffers);
+    }
+    for (GLuint buffer : pixelBuffers) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, stats.uploadBytes, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+// 초기 파동 진폭 h0(k) = (가우스 난수 + i 가우스 난수) * sqrt(P(k) / 2) 를 FFT 결과 순서(0, 1, ..., n/2 - 1, -n/2, ..., -1)로 채움.
+void OceanSimulation::buildSpectrum() {
+    int n = settings.resolution;
+    size_t count = size_t(n) * n;
+    h0Re.resize(count);
+    h0Im.resize(count);
+    h0MinusRe.resize(count);
+    h0MinusIm.resize(count);
+    omega.resize(count);
+    kx.resize(count);
+    kz.resize(count);
+
+    glm::vec2 wind = glm::length(settings.windDirection) > 0.0f ? glm::normalize(settings.windDirection) : glm::vec2(1.0f, 0.0f);
+    float dk = TWO_PI / settings.patchSize;
+    float windSpeed = std::max(settings.windSpeed, 0.1f);
+    float largestWave = windSpeed * windSpeed / GRAVITY; // Phillips 스펙트럼의 L
+    float peakOmega = 22.0f * std::cbrt(GRAVITY * GRAVITY / (windSpeed * std::max(settings.fetch, 1.0f))); // JONSWAP 피크 각주파수
+
+    std::mt19937 rng(settings.seed);
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    for (int z = 0; z < n; ++z) {
+        for (int x = 0; x < n; ++x) {
+            size_t i = size_t(z) * n + x;
+            int nx = x < n / 2 ? x : x - n;
+            int nz = z < n / 2 ? z : z - n;
+            kx[i] = nx * dk;
+            kz[i] = nz * dk;
+            float k = std::sqrt(kx[i] * kx[i] + kz[i] * kz[i]);
+            omega[i] = std::sqrt(GRAVITY * k);
+
+            // 난수는 항상 같은 순서로 뽑아서, 설정을 바꿔도 같은 시드면 같은 무늬가 나오도록 함.
+            float r0 = gauss(rng);
+            float r1 = gauss(rng);
+
+            // k = 0 과 나이퀴스트 파수(-n/2)는 짝이 되는 -k 가 없으므로 비워둠.
+            float power = 0.0f;
+            if (k > 0.0f && nx != -n / 2 && nz != -n / 2) {
+                float cosine = (kx[i] * wind.x + kz[i] * wind.y) / k;
+                float spreading = cosine * cosine * (cosine < 0.0f ? AGAINST_WIND : 1.0f);
+                if (settings.spectrum == Spectrum::Phillips) {
+                    float kl = k * largestWave;
+                    float smallWave = largestWave * 0.001f; // 파장이 아주 짧은 파동은 억제함.
+                    power = std::exp(-1.0f / (kl * kl)) / (k * k * k * k) * spreading * std::exp(-k * k * smallWave * smallWave);
+                } else {
+                    // S(w) 를 파수 공간으로 옮김: P(k) = S(w) * D(theta) * (dw/dk) / k
+                    float w = omega[i];
+                    float sigma = w <= peakOmega ? 0.07f : 0.09f;
+                    float d = (w - peakOmega) / (sigma * peakOmega);
+                    float peak = std::pow(settings.peakEnhancement, std::exp(-0.5f * d * d));
+                    float ratio = peakOmega / w;
+                    float s = GRAVITY * GRAVITY / std::pow(w, 5.0f) * std::exp(-1.25f * ratio * ratio * ratio * ratio) * peak;
+                    power = s * spreading * (GRAVITY / (2.0f * w)) / k;
+                }
+            }
+            float amplitude = std::sqrt(power * 0.5f);
+            h0Re[i] = r0 * amplitude;
+            h0Im[i] = r1 * amplitude;
+        }
+    }
+
+    // conj(h0(-k)) 와 높이의 분산. (역 FFT 를 정규화하지 않으므로 높이의 평균 제곱은 sum |h(k, t)|^2 와 같음)
+    double variance = 0.0;
+    for (int z = 0; z < n; ++z) {
+        for (int x = 0; x < n; ++x) {
+            size_t i = size_t(z) * n + x;
+            size_t minus = size_t((n - z) % n) * n + (n - x) % n;
+            h0MinusRe[i] = h0Re[minus];
+            h0MinusIm[i] = -h0Im[minus];
+            variance += double(h0Re[i]) * h0Re[i] + double(h0Im[i]) * h0Im[i] + double(h0Re[minus]) * h0Re[minus] + double(h0Im[minus]) * h0Im[minus];
+        }
+    }
+
+    // 높이 표준편차가 유의파고의 1/4 이 되도록 진폭을 맞춤.
+    float scale = variance > 0.0 ? float(settings.significantWaveHeight * 0.25 / std::sqrt(variance)) : 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        h0Re[i] *= scale;
+        h0Im[i] *= scale;
+        h0MinusRe[i] *= scale;
+        h0MinusIm[i] *= scale;
+    }
+}
+
+void OceanSimulation::update(float time) {
+    if (!started) {
+        // 첫 프레임은 기다릴 결과가 없으므로 이 스레드에서 바로 계산함.
+        auto begin = std::chrono::steady_clock::now();
+        mapped = mapBuffer(writeBuffer);
+        if (mapped) {
+            simulate(time, mapped);
+        }
+        lastSimulateMs = elapsedMs(begin);
+        lastTime = time;
+        started = true;
+    }
+    finish();
+
+    // 다음 프레임도 이번 프레임과 같은 간격만큼 지난다고 보고 미리 계산해둠. (고정 타임스텝인 벤치마크 모드에서는 정확히 맞음)
+    float next = time + (time - lastTime);
+    lastTime = time;
+    start(next);
+}
+
+void OceanSimulation::start(float time) {
+    mapped = mapBuffer(writeBuffer);
+    if (!mapped) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requestedTime = time;
+        requested = true;
+        busy = true;
+    }
+    condition.notify_all();
+}
+
+void OceanSimulation::finish() {
+    auto waitBegin = std::chrono::steady_clock::now();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return !busy; });
+        stats.simulateMs = lastSimulateMs;
+    }
+    stats.waitMs = elapsedMs(waitBegin);
+    if (!mapped) {
+        return;
+    }
+
+    auto uploadBegin = std::chrono::steady_clock::now();
+    maxDisplacement = *std::max_element(chunkMax.begin(), chunkMax.end());
+    if (!pboMapped) {
+        // CPU 버퍼는 올릴 필요 없이 버퍼만 바꿈. (getCpuData() 가 방금 끝난 버퍼를 돌려줌)
+        mapped = nullptr;
+        writeBuffer ^= 1;
+        stats.uploadMs = 0.0f;
+        return;
+    }
+
+    int n = settings.resolution;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffers[writeBuffer]);
+    bool intact = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE; // 매핑 중에 버퍼 내용이 사라졌으면(화면 모드 변경 등) 이번 프레임은 건너뜀.
+    mapped = nullptr;
+    if (intact) {
+        // PBO 가 바인딩되어 있으므로 마지막 인자는 포인터가 아니라 PBO 안의 오프셋임. 복사는 드라이버가 비동기로 처리함.
+        glBindTexture(GL_TEXTURE_2D, displacementTex.getTextureData().textureID);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, n, n, GL_RGBA, GL_HALF_FLOAT, nullptr);
+        glBindTexture(GL_TEXTURE_2D, slopeTex.getTextureData().textureID);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, n, n, GL_RG, GL_HALF_FLOAT, reinterpret_cast<const void*>(size_t(n) * n * 8));
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    writeBuffer ^= 1; // 다음 결과는 다른 PBO 에 써서, 방금 시작한 업로드와 겹치지 않도록 함.
+    stats.uploadMs = elapsedMs(uploadBegin);
+}
+
+// PBO 를 통째로 무효화(orphaning)하면서 매핑하므로, GPU 가 아직 이전 내용을 읽고 있어도 기다리지 않음.
+uint8_t* OceanSimulation::mapBuffer(int index) {
+    pboMapped = useTextures;
+    if (!useTextures) {
+        return cpuBuffers[index].data();
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffers[index]);
+    void* ptr = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, stats.uploadBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return static_cast<uint8_t*>(ptr);
+}
+
+void OceanSimulation::simulationLoop() {
+    while (true) {
+        float time;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return requested || stopping; });
+            if (stopping) {
+                return;
+            }
+            requested = false;
+            time = requestedTime;
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        simulate(time, mapped);
+        float ms = elapsedMs(begin);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            lastSimulateMs = ms;
+            busy = false;
+        }
+        condition.notify_all();
+    }
+}
+
+void OceanSimulation::simulate(float time, uint8_t* output) {
+    PROFILE_ZONE("ocean simulation");
+    int n = settings.resolution;
+    const int* reverse = bitReverse.data();
+    const float* twRe = twiddleRe.data();
+    const float* twIm = twiddleIm.data();
+
+    // 1. 행마다 h(k, t) = h0(k) e^(iwt) + conj(h0(-k)) e^(-iwt) 로 세 필드의 스펙트럼을 채우고 바로 행 방향 FFT 를 함.
+    workers.parallelFor(n, ROWS_PER_CHUNK, [&](size_t, size_t begin, size_t end) {
+        for (size_t z = begin; z < end; ++z) {
+            size_t row = z * n;
+            for (int x = 0; x < n; ++x) {
+                size_t i = row + x;
+                float c = std::cos(omega[i] * time);
+                float s = std::sin(omega[i] * time);
+                float hRe = (h0Re[i] + h0MinusRe[i]) * c + (h0MinusIm[i] - h0Im[i]) * s;
+                float hIm = (h0Re[i] - h0MinusRe[i]) * s + (h0Im[i] + h0MinusIm[i]) * c;
+
+                // 높이 + i * (x 기울기 = i kx h) -> h * (1 - kx)
+                fields[0].re[i] = hRe * (1.0f - kx[i]);
+                fields[0].im[i] = hIm * (1.0f - kx[i]);
+
+                // x 변위(-i kx/k h) + i * z 변위(-i kz/k h) -> h * (kz - i kx) / k
+                float k = std::sqrt(kx[i] * kx[i] + kz[i] * kz[i]);
+                float ax = k > 0.0f ? kx[i] / k : 0.0f;
+                float az = k > 0.0f ? kz[i] / k : 0.0f;
+                fields[1].re[i] = hRe * az + hIm * ax;
+                fields[1].im[i] = hIm * az - hRe * ax;
+
+                // z 기울기 (i kz h)
+                fields[2].re[i] = -kz[i] * hIm;
+                fields[2].im[i] = kz[i] * hRe;
+            }
+            for (ComplexField& field : fields) {
+                inverseFft(field.re.data() + row, field.im.data() + row, n, reverse, twRe, twIm);
+            }
+        }
+    });
+
+    // 2. 4열 단위로 나눈 열 구간마다 열 방향 FFT 를 한 뒤, 끝난 구간을 half float 텍셀로 바꿔서 PBO 에 씀.
+    float choppiness = settings.choppiness;
+    std::fill(chunkMax.begin(), chunkMax.end(), 0.0f);
+    workers.parallelFor(n / 4, COLUMN_GROUPS_PER_CHUNK, [&](size_t chunk, size_t begin, size_t end) {
+        int x0 = int(begin * 4);
+        int x1 = int(end * 4);
+        for (ComplexField& field : fields) {
+            inverseFftColumns(field.re.data(), field.im.data(), n, x0, x1, reverse, twRe, twIm);
+        }
+
+        uint8_t* displacement = output;
+        uint8_t* slope = output + size_t(n) * n * 8;
+        float maxSquared = 0.0f;
+        for (int z = 0; z < n; ++z) {
+            size_t row = size_t(z) * n;
+            const float* height = fields[0].re.data() + row;
+            const float* slopeX = fields[0].im.data() + row;
+            const float* dispX = fields[1].re.data() + row;
+            const float* dispZ = fields[1].im.data() + row;
+            const float* slopeZ = fields[2].re.data() + row;
+            for (int x = x0; x < x1; x += 2) {
+                for (int t = 0; t < 2; ++t) {
+                    float dx = dispX[x + t] * choppiness;
+                    float dz = dispZ[x + t] * choppiness;
+                    maxSquared = std::max(maxSquared, dx * dx + height[x + t] * height[x + t] + dz * dz);
+#ifdef OCEAN_USE_SSE
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(displacement + (row + x + t) * 8), floatToHalf4(_mm_set_ps(0.0f, dz, height[x + t], dx)));
+#else
+                    uint16_t texel[4] = { floatToHalf(dx), floatToHalf(height[x + t]), floatToHalf(dz), 0 };
+                    std::memcpy(displacement + (row + x + t) * 8, texel, sizeof(texel));
+#endif
+                }
+#ifdef OCEAN_USE_SSE
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(slope + (row + x) * 4), floatToHalf4(_mm_set_ps(slopeZ[x + 1], slopeX[x + 1], slopeZ[x], slopeX[x])));
+#else
+                uint16_t texels[4] = { floatToHalf(slopeX[x]), floatToHalf(slopeZ[x]), floatToHalf(slopeX[x + 1]), floatToHalf(slopeZ[x + 1]) };
+                std::memcpy(slope + (row + x) * 4, texels, sizeof(texels));
+#endif
+            }
+        }
+        chunkMax[chunk] = std::sqrt(maxSquared);
+    });
+}
+
+const uint8_t* OceanSimulation::getCpuData() const {
+    return useTextures || !started ? nullptr : cpuBuffers[writeBuffer ^ 1].data();
+}
+
+void OceanSimulation::bind(MaterialBinding& mat) const {
+    mat.setTexture(MaterialBinding::OceanDisplacement, displacementTex);
+    mat.setTexture(MaterialBinding::OceanSlope, slopeTex);
+    mat.set(MaterialBinding::OceanScale, 1.0f / settings.patchSize);
+}
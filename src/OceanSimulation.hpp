@@ -0,0 +1,132 @@
+#pragma once
+
+#include "ofMain.h"
+#include "MaterialBinding.hpp"
+#include "ThreadPool.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 스펙트럼 기반(Tessendorf) 바다 시뮬레이션. 물 표면의 변위맵과 기울기맵을 매 프레임 CPU 에서 FFT 로 만들어서 텍스쳐로 올림.
+//
+// - setup() 에서 Phillips 또는 JONSWAP 스펙트럼으로 초기 파동 진폭 h0(k) 를 한 번 만들어둠.
+//   진폭은 설정한 유의파고(significantWaveHeight)에 맞춰 정규화하므로, 스펙트럼 종류와 상관없이 씬 크기에 맞는 높이가 나옴.
+// - 매 프레임 h(k, t) 를 계산한 뒤, 높이 / 수평 변위(choppy) / 기울기 다섯 가지 실수 필드를 복소 2D 역 FFT 세 번으로 구함.
+//   (결과가 실수인 두 필드를 실수부/허수부에 함께 넣어서 FFT 한 번으로 계산함)
+// - FFT 는 radix-2 이고, 행 방향 FFT 는 행 단위로, 열 방향 FFT 는 열 구간 단위로 나눠서 워커 스레드들이 처리함.
+//   버터플라이의 안쪽 루프는 연속된 메모리를 4개씩 SSE 로 계산함. (SSE 를 지원하지 않으면 스칼라 코드)
+// - 시뮬레이션은 전용 스레드에서 렌더링보다 한 프레임 앞서서 돌아감. update() 는 직전 프레임에 시작한 결과를 기다려서 올리고,
+//   다음 프레임 시간값으로 새 시뮬레이션을 시작시킨 뒤 바로 리턴함.
+// - 결과는 PBO 에 half float 로 바로 써넣음(중간 복사 없음). PBO 는 시뮬레이션을 시작할 때마다 glMapBufferRange(GL_MAP_INVALIDATE_BUFFER_BIT) 로
+//   새로 매핑하고 업로드 전에 언매핑함. (GL 4.1 에는 영구 매핑이 없음) PBO 두 개를 번갈아 써서 이전 프레임 업로드가 끝나기 전에도 다음 결과를 쓸 수 있음.
+//
+// setUseTextures(false) 로 설정하면 GL 을 전혀 쓰지 않고 CPU 버퍼 두 개에 같은 배치로 써서, getCpuData() 로 읽어가게 함. (GPU 없는 노드의 SoftwareRenderer 용)
+//
+// 텍스쳐는 월드공간 xz 기준으로 patchSize 마다 반복(GL_REPEAT)되며, 셰이더에서는 worldPos.xz * oceanScale 로 샘플링함. (OCEAN 셰이더 기능)
+//   oceanDisplacement : RGBA16F (x: x 방향 변위, y: 높이, z: z 방향 변위)
+//   oceanSlope        : RG16F (dh/dx, dh/dz) 밉맵 포함. 노멀은 normalize(-dh/dx, 1, -dh/dz)
+class OceanSimulation {
+public:
+    enum class Spectrum { Phillips, Jonswap };
+
+    struct Settings {
+        int resolution = 256; // 시뮬레이션 격자 크기 (2의 거듭제곱, 256 ~ 1024 권장). 2 의 거듭제곱이 아니면 setup() 이 올림해서(4 ~ 4096) getSettings() 에 반영함.
+        float patchSize = 4.0f; // 텍스쳐 한 장이 덮는 월드공간 크기
+        Spectrum spectrum = Spectrum::Jonswap;
+        float windSpeed = 4.0f; // m/s
+        glm::vec2 windDirection = glm::vec2(1.0f, 0.3f);
+        float fetch = 200.0f; // 바람이 불어온 거리 (m, JONSWAP 의 피크 주파수 계산에 사용)
+        float peakEnhancement = 3.3f; // JONSWAP 의 gamma
+        float significantWaveHeight = 0.08f; // 유의파고 (높이 표준편차의 4배)
+        float choppiness = 0.8f; // 수평 변위 배율 (0 이면 높이만 움직임)
+        uint32_t seed = 1;
+    };
+
+    struct Stats {
+        float simulateMs = 0.0f; // 시뮬레이션 스레드에서 FFT + 변환에 걸린 시간 (렌더링과 겹쳐서 실행됨)
+        float waitMs = 0.0f; // update() 가 시뮬레이션이 끝나길 기다린 시간 (0 보다 크면 시뮬레이션이 프레임보다 느린 것)
+        float uploadMs = 0.0f; // PBO -> 텍스쳐 업로드 명령과 밉맵 생성에 걸린 CPU 시간
+        size_t uploadBytes = 0;
+    };
+
+    OceanSimulation();
+    ~OceanSimulation();
+    OceanSimulation(const OceanSimulation&) = delete;
+    OceanSimulation& operator=(const OceanSimulation&) = delete;
+
+    // 텍스쳐, PBO 를 할당하고 h0 를 만듦. 다시 호출하면 진행 중인 시뮬레이션을 기다린 뒤 설정을 바꿈. (GL 컨텍스트 생성 이후)
+    void setup(const Settings& settings);
+
+    // false 면 텍스쳐와 PBO 를 만들지 않고 CPU 버퍼에만 씀. 다음 setup() 부터 적용됨. (ofImage::setUseTexture() 와 같은 용도)
+    void setUseTextures(bool use) { useTextures = use; }
+    bool isUsingTextures() const { return useTextures; }
+
+    // 직전 프레임에 시작한 결과(time 시점)를 텍스쳐로 올리고, 다음 프레임 시점의 시뮬레이션을 시작시킴. (update() 에서 프레임마다 한 번)
+    void update(float time);
+
+    // 텍스쳐와 샘플링 배율을 셰이더로 전송함.
+    void bind(MaterialBinding& mat) const;
+
+    const Settings& getSettings() const { return settings; }
+    const Stats& getStats() const { return stats; }
+    float getMaxDisplacement() const { return maxDisplacement; } // 현재 텍스쳐의 변위 크기 최댓값 (라이트 컬링 경계를 넓히는 데 사용)
+
+    // setUseTextures(false) 일 때 현재 결과. resolution^2 개의 RGBA half 변위 텍셀 뒤에 RG half 기울기 텍셀이 이어짐. (텍스쳐를 쓰거나 첫 update() 전이면 nullptr)
+    // 다음 update() 까지 유효함.
+    const uint8_t* getCpuData() const;
+
+private:
+    // 복소 필드 하나 (실수부, 허수부를 따로 둔 SoA. 행 우선 resolution * resolution)
+    struct ComplexField {
+        std::vector<float> re;
+        std::vector<float> im;
+    };
+
+    void buildSpectrum();
+    void simulate(float time, uint8_t* output); // 시뮬레이션 스레드에서 호출
+    void simulationLoop();
+    void start(float time); // 매핑한 PBO 에 쓸 시뮬레이션을 시작시킴.
+    void finish(); // 진행 중인 시뮬레이션을 기다린 뒤 PBO 를 언매핑하고 텍스쳐로 올림.
+    uint8_t* mapBuffer(int index);
+
+    Settings settings;
+    Stats stats;
+    float maxDisplacement = 0.0f;
+
+    // 스펙트럼 (setup() 에서 한 번 계산)
+    std::vector<float> h0Re, h0Im; // h0(k)
+    std::vector<float> h0MinusRe, h0MinusIm; // conj(h0(-k))
+    std::vector<float> omega; // 분산 관계 w(k) = sqrt(g|k|)
+    std::vector<float> kx, kz; // 파수 벡터 (FFT 결과 순서)
+
+    // FFT 작업 공간: (높이 + i * x 기울기), (x 변위 + i * z 변위), (z 기울기)
+    ComplexField fields[3];
+    std::vector<int> bitReverse;
+    std::vector<float> twiddleRe, twiddleIm; // 단계별 회전인자. 크기 m 인 단계는 [m - 1, 2m - 1) 구간
+    std::vector<float> chunkMax; // 청크별 변위 크기 최댓값
+
+    ofTexture displacementTex;
+    ofTexture slopeTex;
+    GLuint pixelBuffers[2] = { 0, 0 };
+    int writeBuffer = 0; // 시뮬레이션이 쓰고 있는(또는 마지막으로 쓴) PBO
+    uint8_t* mapped = nullptr;
+    bool pboMapped = false; // mapped 가 PBO 를 매핑한 포인터인지 (false 면 cpuBuffers 중 하나)
+    bool useTextures = true;
+    std::vector<uint8_t> cpuBuffers[2]; // useTextures 가 false 일 때 PBO 대신 쓰는 버퍼
+    float lastTime = 0.0f;
+    bool started = false;
+
+    // 시뮬레이션 스레드와의 동기화
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool requested = false;
+    bool busy = false;
+    bool stopping = false;
+    float requestedTime = 0.0f;
+    float lastSimulateMs = 0.0f; // 시뮬레이션 스레드가 기록하고 finish() 에서 stats 로 옮김.
+
+    ThreadPool workers; // FFT 를 나눠서 계산하는 워커 스레드들 (시뮬레이션 스레드도 첫 구간을 직접 처리함)
+};
@@ -0,0 +1,98 @@
+#include "PackedMesh.hpp"
+#include <cstdint>
+#include <vector>
+
+PackedMesh::~PackedMesh() {
+    release();
+}
+
+void PackedMesh::release() {
+    if (indexBuffer) glDeleteBuffers(1, &indexBuffer);
+    if (vertexBuffer) glDeleteBuffers(1, &vertexBuffer);
+    if (vao) glDeleteVertexArrays(1, &vao);
+    vao = vertexBuffer = indexBuffer = 0;
+    numIndices = 0;
+}
+
+void PackedMesh::setupCpu(const ofMesh& source, bool quantizePositions) {
+    release();
+    mesh = source;
+    layout = MeshOptimizer::getPackedLayout(mesh, quantizePositions);
+    floatBytesPerVertex = MeshOptimizer::getFloatBytesPerVertex(mesh);
+    acmr = mesh.getNumIndices() > 0 ? MeshOptimizer::analyzeVertexCache(mesh.getIndices(), mesh.getNumVertices()) : 3.0f;
+    numIndices = GLsizei(mesh.getNumIndices());
+}
+
+void PackedMesh::setup(const ofMesh& source, bool quantizePositions) {
+    setupCpu(source, quantizePositions);
+
+    std::vector<uint8_t> vertices;
+    MeshOptimizer::pack(mesh, layout, vertices);
+
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    glGenBuffers(1, &vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size(), vertices.data(), GL_STATIC_DRAW);
+
+    GLsizei stride = GLsizei(layout.stride);
+    auto attribute = [&](GLuint location, GLint size, GLenum type, GLboolean normalized, int offset) {
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, size, type, normalized, stride, reinterpret_cast<const void*>(intptr_t(offset)));
+    };
+    if (layout.quantizedPositions) {
+        attribute(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, 0);
+    } else {
+        attribute(0, 3, GL_FLOAT, GL_FALSE, 0);
+    }
+    if (layout.tangentOffset >= 0) {
+        attribute(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, layout.tangentOffset);
+    }
+    if (layout.normalOffset >= 0) {
+        attribute(2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, layout.normalOffset);
+    }
+    if (layout.texCoordOffset >= 0) {
+        attribute(3, 2, GL_HALF_FLOAT, GL_FALSE, layout.texCoordOffset);
+    }
+
+    // 인덱스는 버텍스 수가 허용하는 가장 작은 타입으로 올림. (VAO 가 바인딩된 상태에서 올려야 VAO 에 기록됨)
+    const std::vector<ofIndexType>& indices = mesh.getIndices();
+    numIndices = GLsizei(indices.size());
+    glGenBuffers(1, &indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    if (mesh.getNumVertices() <= 0xffff) {
+        std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+        indexType = GL_UNSIGNED_SHORT;
+    } else {
+        std::vector<uint32_t> intIndices(indices.begin(), indices.end());
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, intIndices.size() * sizeof(uint32_t), intIndices.data(), GL_STATIC_DRAW);
+        indexType = GL_UNSIGNED_INT;
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void PackedMesh::setInstanceAttribute(GLuint location, const ofBufferObject& buffer, GLint numCoords, GLsizei stride, size_t offset) {
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.getId());
+    glEnableVertexAttribArray(location);
+    glVertexAttribPointer(location, numCoords, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(offset));
+    glVertexAttribDivisor(location, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void PackedMesh::draw() const {
+    glBindVertexArray(vao);
+    glDrawElements(GL_TRIANGLES, numIndices, indexType, nullptr);
+    glBindVertexArray(0);
+}
+
+void PackedMesh::drawInstanced(int instances) const {
+    glBindVertexArray(vao);
+    glDrawElementsInstanced(GL_TRIANGLES, numIndices, indexType, nullptr, instances);
+    glBindVertexArray(0);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ofMain.h"
+#include "MeshOptimizer.hpp"
+
+// MeshOptimizer::pack() 로 압축한 버텍스 데이터를 GPU 에 올려두고 그리는 메쉬. (방패, 물 평면)
+//
+// ofVbo 는 모든 버텍스 속성을 GL_FLOAT 로만 연결하므로, 정규화 정수 / half float 속성을 쓰기 위해 VAO 를 직접 만듦.
+// 속성 로케이션은 ofVboMesh 와 같으므로(0 위치, 1 탄젠트, 2 노멀, 3 uv), 셰이더는 위치 역양자화(positionScale, positionOffset)만 더하면 됨.
+// 버텍스가 65536 개 미만이면 인덱스 버퍼도 16비트로 올림.
+// CPU 쪽 float 메쉬(getMesh())는 라이트 컬링, 인스턴스 컬링에서 경계를 계산할 때 쓰도록 그대로 들고 있음.
+class PackedMesh {
+public:
+    PackedMesh() = default;
+    ~PackedMesh();
+    PackedMesh(const PackedMesh&) = delete;
+    PackedMesh& operator=(const PackedMesh&) = delete;
+
+    // GL 컨텍스트 생성 이후 호출. quantizePositions 가 false 면 위치는 float 그대로 올림.
+    void setup(const ofMesh& mesh, bool quantizePositions = true);
+
+    // GL 없이 CPU 메쉬와 통계만 준비함. (GPU 없는 노드에서 SoftwareRenderer 로만 그릴 때, draw() 는 호출하지 말 것)
+    void setupCpu(const ofMesh& mesh, bool quantizePositions = true);
+
+    // 인스턴스 속성(divisor 1)을 이 메쉬의 VAO 에 연결함. (InstanceBuffer 에서 사용)
+    void setInstanceAttribute(GLuint location, const ofBufferObject& buffer, GLint numCoords, GLsizei stride, size_t offset);
+
+    void draw() const;
+    void drawInstanced(int instances) const;
+
+    const ofMesh& getMesh() const { return mesh; }
+    const glm::vec3& getPositionScale() const { return layout.positionScale; }
+    const glm::vec3& getPositionOffset() const { return layout.positionOffset; }
+    size_t getBytesPerVertex() const { return layout.stride; }
+    size_t getFloatBytesPerVertex() const { return floatBytesPerVertex; } // 같은 메쉬를 ofVboMesh 로 올렸을 때의 버텍스당 바이트 수
+    float getAcmr() const { return acmr; } // 현재 인덱스 순서의 ACMR (MeshOptimizer::CACHE_SIZE 기준)
+    size_t getNumVertices() const { return mesh.getNumVertices(); }
+    size_t getNumIndices() const { return numIndices; }
+
+private:
+    void release();
+
+    ofMesh mesh;
+    MeshOptimizer::PackedLayout layout;
+    size_t floatBytesPerVertex = 0;
+    float acmr = 0.0f;
+
+    GLuint vao = 0;
+    GLuint vertexBuffer = 0;
+    GLuint indexBuffer = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    GLsizei numIndices = 0;
+};
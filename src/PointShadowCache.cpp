@@ -0,0 +1,522 @@
+#include "PointShadowCache.hpp"
+#include <algorithm>
+
+namespace {
+// 큐브 면별 앞 방향과 위 방향 (오른쪽 = cross(앞, 위)). pointShadow.glsl 의 shadowFaceRight / shadowFaceUp 과 같은 순서와 방향이어야 함.
+const glm::vec3 faceForward[PointShadowCache::NUM_FACES] = {
+    { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+};
+const glm::vec3 faceUp[PointShadowCache::NUM_FACES] = {
+    { 0, 1, 0 }, { 0, 1, 0 }, { 0, 0, 1 }, { 0, 0, 1 }, { 0, 1, 0 }, { 0, 1, 0 }
+};
+const uint8_t ALL_FACES = (1 << PointShadowCache::NUM_FACES) - 1;
+
+// 후보 종류별 우선순위. 같은 종류 안에서는 화면 크기 * 밀린 프레임 수로 정렬함.
+const float PRIORITY_NEW = 4e8f; // 타일이 없거나 아직 6 면이 다 그려지지 않은 라이트
+const float PRIORITY_MOVED = 3e8f; // 라이트 이동 또는 정적 caster 변경 (정적 타일부터 다시 구움)
+const float PRIORITY_DYNAMIC = 2e8f; // 동적 caster 변경
+const float PRIORITY_RESIZE = 1e8f; // 이미 그림자가 있는 라이트의 타일 크기 변경 (바뀐 면 갱신이 모두 끝나고 예산이 남을 때만)
+const float PRIORITY_CONTINUOUS = 0.0f; // 매 프레임 움직이는 caster 만 바뀐 면 (남는 예산으로 오래된 면부터 돌아가며 갱신)
+const float PRIORITY_RANGE = 0.99e8f;
+}
+
+//--------------------------------------------------------------
+void PointShadowCache::TileAllocator::setup(int atlasSize, int minTileSize) {
+    size_t count = 0;
+    for (size_t level = 1; atlasSize / int(level) >= minTileSize; level *= 2) {
+        count += level * level;
+    }
+    states.assign(count, Free);
+    origins.assign(count, glm::ivec2(0));
+    sizes.assign(count, atlasSize);
+    for (size_t i = 0; 4 * i + 4 < count; ++i) {
+        int half = sizes[i] / 2;
+        for (int c = 0; c < 4; ++c) {
+            origins[4 * i + 1 + c] = origins[i] + glm::ivec2((c & 1) * half, (c >> 1) * half);
+            sizes[4 * i + 1 + c] = half;
+        }
+    }
+    usedTexels = 0;
+}
+
+int PointShadowCache::TileAllocator::allocate(int size) {
+    // 이미 나눠진 노드 안에서 먼저 찾고, 없을 때만 큰 빈 노드를 나눠서 큰 타일 자리를 최대한 남겨둠.
+    int node = find(0, size, false);
+    if (node < 0) {
+        node = find(0, size, true);
+    }
+    if (node >= 0) {
+        states[node] = Used;
+        usedTexels += size * size;
+    }
+    return node;
+}
+
+void PointShadowCache::TileAllocator::release(int node) {
+    states[node] = Free;
+    usedTexels -= sizes[node] * sizes[node];
+    // 형제 노드 4 개가 모두 비면 부모 노드로 합침.
+    while (node > 0) {
+        int parent = (node - 1) / 4;
+        for (int c = 1; c <= 4; ++c) {
+            if (states[4 * parent + c] != Free) {
+                return;
+            }
+        }
+        states[parent] = Free;
+        node = parent;
+    }
+}
+
+int PointShadowCache::TileAllocator::find(int node, int size, bool allowSplit) {
+    if (states[node] == Used || sizes[node] < size) {
+        return -1;
+    }
+    if (sizes[node] == size) {
+        return states[node] == Free ? node : -1;
+    }
+    if (states[node] == Free) {
+        if (!allowSplit) {
+            return -1;
+        }
+        states[node] = Split;
+        for (int c = 1; c <= 4; ++c) {
+            states[4 * node + c] = Free;
+        }
+    }
+    for (int c = 1; c <= 4; ++c) {
+        int found = find(4 * node + c, size, allowSplit);
+        if (found >= 0) {
+            return found;
+        }
+    }
+    return -1;
+}
+
+//--------------------------------------------------------------
+void PointShadowCache::setup(const Settings& newSettings, DrawCasters draw) {
+    settings = newSettings;
+    drawCasters = std::move(draw);
+    allocator.setup(settings.atlasSize, settings.minTileSize);
+
+    // 색상 없이 깊이 텍스쳐만 붙인 FBO. 정적 아틀라스는 복사 원본으로만 쓰므로 깊이 비교 모드는 최종 아틀라스에만 켬.
+    ofFboSettings fboSettings;
+    fboSettings.width = settings.atlasSize;
+    fboSettings.height = settings.atlasSize;
+    fboSettings.numColorbuffers = 0;
+    fboSettings.useDepth = true;
+    fboSettings.depthStencilAsTexture = true;
+    fboSettings.depthStencilInternalFormat = GL_DEPTH_COMPONENT16; // 반경 1 안팎의 짧은 거리만 담으므로 16비트로 충분함.
+    atlas.allocate(fboSettings);
+    staticAtlas.allocate(fboSettings);
+
+    // sampler2DShadow 로 샘플링하면 GL_LINEAR 필터가 주변 2 x 2 텍셀의 비교 결과를 보간해줌. (하드웨어 PCF)
+    ofTexture& depth = atlas.getDepthTexture();
+    depth.setTextureMinMagFilter(GL_LINEAR, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, depth.getTextureData().textureID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    capacity = 64;
+    shadowBuffer.allocate();
+    shadowBuffer.setData(capacity * sizeof(glm::uvec4), nullptr, GL_DYNAMIC_DRAW);
+    shadowTex.allocateAsBufferTexture(shadowBuffer, GL_RGBA32UI);
+}
+
+int PointShadowCache::addCaster(bool dynamic, bool continuous) {
+    Caster caster;
+    caster.dynamic = dynamic;
+    caster.continuous = dynamic && continuous;
+    casters.push_back(caster);
+    return int(casters.size() - 1);
+}
+
+void PointShadowCache::setCasterBounds(int id, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    Caster& caster = casters[id];
+    if (caster.boundsMin != boundsMin || caster.boundsMax != boundsMax) {
+        caster.boundsMin = boundsMin;
+        caster.boundsMax = boundsMax;
+        caster.changed = true;
+    }
+}
+
+void PointShadowCache::setCasterEnabled(int id, bool enable) {
+    Caster& caster = casters[id];
+    if (caster.enabled != enable) {
+        caster.enabled = enable;
+        caster.changed = true;
+    }
+}
+
+void PointShadowCache::markMoved(int id) {
+    casters[id].changed = true;
+}
+
+glm::mat4 PointShadowCache::getFaceViewProj(const glm::vec3& position, float radius, int face, float nearPlane) {
+    glm::mat4 proj = glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, radius);
+    return proj * glm::lookAt(position, position + faceForward[face], faceUp[face]);
+}
+
+//--------------------------------------------------------------
+void PointShadowCache::update(const LightSystem& lights, const glm::mat4& viewProj, const glm::vec3& cameraPos, float projScale, int viewportHeight) {
+    using namespace glm;
+
+    stats = Stats();
+    jobs.clear();
+    candidates.clear();
+    ++frame;
+    if (!enabled) {
+        return;
+    }
+
+    // 지워진 라이트(배열 끝에서 줄어든 인덱스)의 타일을 돌려받음.
+    size_t count = lights.size();
+    for (size_t i = count; i < entries.size(); ++i) {
+        releaseTiles(entries[i]);
+    }
+    if (entries.size() != count) {
+        entries.resize(count);
+        dataDirty = true;
+    }
+    frustum.setFromMatrix(viewProj);
+
+    bool castersChanged = std::any_of(casters.begin(), casters.end(), [](const Caster& c) { return c.changed; });
+    const std::vector<vec3>& positions = lights.getPositions();
+    const std::vector<float>& radii = lights.getRadii();
+    for (size_t i = 0; i < count; ++i) {
+        Entry& e = entries[i];
+        const vec3& position = positions[i];
+        float radius = radii[i];
+        e.visible = frustum.intersectsSphere(position, radius);
+
+        // 라이트가 움직였으면 면 6 개 모두 정적 타일부터 다시 구움.
+        if (position != e.position || radius != e.radius) {
+            e.position = position;
+            e.radius = radius;
+            e.staticDirty = ALL_FACES;
+        }
+
+        // 바뀐 caster 의 (이전 또는 새) 경계에 닿는 면만 표시함.
+        if (castersChanged && e.tileSize > 0) {
+            for (int face = 0; face < NUM_FACES; ++face) {
+                uint8_t bit = uint8_t(1 << face);
+                for (const Caster& c : casters) {
+                    if (!c.changed) {
+                        continue;
+                    }
+                    bool touches = (c.enabled && faceTouchesBox(position, radius, face, c.boundsMin, c.boundsMax))
+                        || (!c.dynamic && c.wasEnabled && faceTouchesBox(position, radius, face, c.previousMin, c.previousMax));
+                    if (touches) {
+                        if (c.continuous) {
+                            e.continuousDirty |= bit;
+                        } else if (c.dynamic) {
+                            e.dynamicDirty |= bit;
+                        } else {
+                            e.staticDirty |= bit;
+                        }
+                    }
+                }
+            }
+        }
+        if (!e.visible) {
+            continue; // 화면 밖 라이트는 그림자가 보이지 않으므로, 표시만 해두고 보일 때 다시 그림.
+        }
+
+        // 화면에서 라이트 구체의 반지름이 차지하는 픽셀 수
+        float distance = glm::length(position - cameraPos);
+        float coverage = distance > radius ? radius * projScale * 0.5f * viewportHeight / distance : float(viewportHeight);
+        int tileSize = chooseTileSize(e, coverage);
+
+        uint32_t oldest = frame;
+        for (int face = 0; face < NUM_FACES; ++face) {
+            oldest = std::min(oldest, e.refreshed[face]);
+        }
+        if (e.validFaces != ALL_FACES) {
+            // 타일을 새로 할당하는 라이트는 면 6 개를 한꺼번에 그림.
+            candidates.push_back({ PRIORITY_NEW + std::min(coverage * (1.0f + (frame - oldest)), PRIORITY_RANGE), uint32_t(i), -1, tileSize });
+            continue;
+        }
+        if (tileSize != e.tileSize) {
+            // 크기 변경은 따로 가장 낮은 우선순위 후보로 두고, 바뀐 면은 아래에서 지금 타일에 그대로 갱신함.
+            // (예산이 모자라거나 아틀라스가 꽉 차서 크기를 못 바꾸는 동안에도 그림자가 라이트와 caster 를 따라가도록)
+            candidates.push_back({ PRIORITY_RESIZE + std::min(coverage, PRIORITY_RANGE), uint32_t(i), -1, tileSize });
+        }
+        for (int face = 0; face < NUM_FACES; ++face) {
+            uint8_t bit = uint8_t(1 << face);
+            if ((e.staticDirty | e.dynamicDirty | e.continuousDirty) & bit) {
+                float base = e.staticDirty & bit ? PRIORITY_MOVED : e.dynamicDirty & bit ? PRIORITY_DYNAMIC : PRIORITY_CONTINUOUS;
+                candidates.push_back({ base + std::min(coverage * (1.0f + (frame - e.refreshed[face])), PRIORITY_RANGE), uint32_t(i), face, tileSize });
+            }
+        }
+    }
+    for (Caster& c : casters) {
+        c.changed = false;
+        c.previousMin = c.boundsMin;
+        c.previousMax = c.boundsMax;
+        c.wasEnabled = c.enabled;
+    }
+
+    // 우선순위가 높은 후보부터 예산 안에서 그릴 면을 고름.
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.priority > b.priority; });
+    int budget = settings.faceBudget;
+    for (const Candidate& c : candidates) {
+        Entry& e = entries[c.light];
+        if (c.face < 0) {
+            // 크기를 바꾸는 라이트의 면 중 이번 프레임에 지금 타일로 이미 고른 면은 새 타일에 다시 그리므로, 그 몫만큼 예산을 돌려받을 수 있음.
+            bool resize = e.validFaces == ALL_FACES;
+            int queued = 0;
+            for (int face = 0; face < NUM_FACES; ++face) {
+                queued += e.refreshed[face] == frame;
+            }
+            if (budget + queued < NUM_FACES || !allocateTiles(e, c.tileSize)) {
+                if (!resize) {
+                    stats.deferredFaces += NUM_FACES;
+                }
+                continue;
+            }
+            if (queued > 0) {
+                auto stale = std::remove_if(jobs.begin(), jobs.end(), [&](const FaceJob& job) { return job.light == c.light; });
+                for (auto it = stale; it != jobs.end(); ++it) {
+                    stats.renderedFaces--;
+                    stats.bakedFaces -= it->bake;
+                }
+                jobs.erase(stale, jobs.end());
+                budget += queued;
+            }
+            for (int face = 0; face < NUM_FACES; ++face) {
+                queueFace(c.light, face, true);
+            }
+            e.validFaces = ALL_FACES;
+            e.staticDirty = 0;
+            e.dynamicDirty = 0;
+            e.continuousDirty = 0;
+            budget -= NUM_FACES;
+        } else {
+            uint8_t bit = uint8_t(1 << c.face);
+            if (budget == 0) {
+                stats.deferredFaces++;
+                continue;
+            }
+            queueFace(c.light, c.face, (e.staticDirty & bit) != 0);
+            e.staticDirty &= ~bit;
+            e.dynamicDirty &= ~bit;
+            e.continuousDirty &= ~bit;
+            budget--;
+        }
+    }
+
+    for (const Entry& e : entries) {
+        if (e.validFaces == ALL_FACES) {
+            stats.shadowedLights++;
+            if (e.visible) {
+                for (int face = 0; face < NUM_FACES; ++face) {
+                    stats.cachedFaces += e.refreshed[face] != frame;
+                }
+            }
+        }
+    }
+    stats.atlasUsage = float(allocator.getUsedTexels()) / (float(settings.atlasSize) * settings.atlasSize);
+    upload();
+}
+
+int PointShadowCache::chooseTileSize(const Entry& entry, float coverage) const {
+    int size = settings.minTileSize;
+    while (size < settings.maxTileSize && size < coverage) {
+        size *= 2;
+    }
+    // 경계 근처에서 크기가 오락가락하지 않도록, 줄이는 것은 두 단계 이상 작아도 될 때만,
+    // 키우는 것은 화면 크기가 지금 타일보다 25% 이상 클 때만 함.
+    if (entry.tileSize > size && size * 4 > entry.tileSize) {
+        return entry.tileSize;
+    }
+    if (entry.tileSize > 0 && size > entry.tileSize && coverage < entry.tileSize * 1.25f) {
+        return entry.tileSize;
+    }
+    return size;
+}
+
+// 새 타일 6 개를 모두 할당하는 데 성공했을 때만 기존 타일을 돌려줌. 새 라이트는 자리가 없으면 화면 밖 라이트들의 타일을 회수하고
+// 그래도 없으면 작은 크기로 다시 시도함. (이미 그림자가 있는 라이트는 실패하면 기존 타일을 그대로 씀)
+bool PointShadowCache::allocateTiles(Entry& entry, int tileSize) {
+    bool hasTiles = entry.tileSize > 0;
+    bool evicted = false;
+    for (int size = tileSize; size >= settings.minTileSize; size /= 2) {
+        int tiles[NUM_FACES];
+        int allocated = 0;
+        while (allocated < NUM_FACES && (tiles[allocated] = allocator.allocate(size)) >= 0) {
+            ++allocated;
+        }
+        if (allocated == NUM_FACES) {
+            releaseTiles(entry);
+            std::copy(tiles, tiles + NUM_FACES, entry.tiles);
+            entry.tileSize = size;
+            dataDirty = true;
+            return true;
+        }
+        for (int i = 0; i < allocated; ++i) {
+            allocator.release(tiles[i]);
+        }
+        if (hasTiles) {
+            return false;
+        }
+        if (!evicted) {
+            evictHidden();
+            evicted = true;
+            size *= 2; // 같은 크기로 한 번 더 시도함.
+        }
+    }
+    return false;
+}
+
+void PointShadowCache::releaseTiles(Entry& entry) {
+    if (entry.tileSize == 0) {
+        return;
+    }
+    for (int& tile : entry.tiles) {
+        allocator.release(tile);
+        tile = -1;
+    }
+    entry.tileSize = 0;
+    entry.validFaces = 0;
+    dataDirty = true;
+}
+
+void PointShadowCache::evictHidden() {
+    for (Entry& e : entries) {
+        if (!e.visible) {
+            releaseTiles(e);
+        }
+    }
+}
+
+void PointShadowCache::queueFace(uint32_t light, int face, bool bake) {
+    Entry& e = entries[light];
+    FaceJob job;
+    job.light = light;
+    job.viewProj = getFaceViewProj(e.position, e.radius, face, settings.nearPlane);
+    job.tile = e.tiles[face];
+    job.bake = bake;
+    job.drawStatic = faceTouchesCasters(e.position, e.radius, face, false);
+    job.drawDynamic = faceTouchesCasters(e.position, e.radius, face, true);
+    jobs.push_back(job);
+    e.refreshed[face] = frame;
+    stats.renderedFaces++;
+    stats.bakedFaces += bake;
+}
+
+// 면의 프러스텀은 라이트 위치에서 앞 방향으로 열린 90도 사각뿔을 반경에서 자른 것이므로,
+// 라이트 구체와 AABB 가 겹치고, 사각뿔의 옆면 4 개(앞 +- 오른쪽, 앞 +- 위 방향 법선) 중 어느 것의 바깥에도 AABB 가 완전히 있지 않으면 닿는 것으로 봄.
+bool PointShadowCache::faceTouchesBox(const glm::vec3& position, float radius, int face, const glm::vec3& boxMin, const glm::vec3& boxMax) const {
+    using namespace glm;
+
+    vec3 d = clamp(position, boxMin, boxMax) - position;
+    if (dot(d, d) > radius * radius) {
+        return false;
+    }
+    const vec3& forward = faceForward[face];
+    const vec3& up = faceUp[face];
+    vec3 right = cross(forward, up);
+    const vec3 normals[4] = { forward + right, forward - right, forward + up, forward - up };
+    for (const vec3& n : normals) {
+        vec3 corner(n.x >= 0.0f ? boxMax.x : boxMin.x, n.y >= 0.0f ? boxMax.y : boxMin.y, n.z >= 0.0f ? boxMax.z : boxMin.z);
+        if (dot(corner - position, n) < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PointShadowCache::faceTouchesCasters(const glm::vec3& position, float radius, int face, bool dynamic) const {
+    for (const Caster& c : casters) {
+        if (c.dynamic == dynamic && c.enabled && faceTouchesBox(position, radius, face, c.boundsMin, c.boundsMax)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 라이트마다 면별 타일 위치와 크기를 텍스쳐 버퍼로 올림. 타일 배치가 바뀐 프레임에만 전체를 다시 올림. (라이트 수백 개면 수 KB)
+void PointShadowCache::upload() {
+    if (!dataDirty || entries.empty()) {
+        return;
+    }
+    dataDirty = false;
+
+    shadowData.assign(entries.size() * 2, glm::uvec4(0));
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const Entry& e = entries[i];
+        if (e.validFaces != ALL_FACES) {
+            continue; // 타일 크기 0 = 그림자 없음
+        }
+        uint32_t packed[NUM_FACES];
+        for (int face = 0; face < NUM_FACES; ++face) {
+            const glm::ivec2& origin = allocator.getOrigin(e.tiles[face]);
+            packed[face] = uint32_t(origin.x) | (uint32_t(origin.y) << 16);
+        }
+        shadowData[i * 2] = glm::uvec4(packed[0], packed[1], packed[2], packed[3]);
+        shadowData[i * 2 + 1] = glm::uvec4(packed[4], packed[5], uint32_t(e.tileSize), 0u);
+    }
+
+    if (shadowData.size() > capacity) {
+        capacity = std::max(shadowData.size(), capacity * 2);
+        shadowBuffer.setData(capacity * sizeof(glm::uvec4), nullptr, GL_DYNAMIC_DRAW); // 텍스쳐 버퍼는 버퍼 이름을 참조하므로 다시 만들 필요 없음.
+    }
+    shadowBuffer.updateData(0, shadowData.size() * sizeof(glm::uvec4), shadowData.data());
+}
+
+//--------------------------------------------------------------
+void PointShadowCache::render() {
+    if (jobs.empty()) {
+        return;
+    }
+    auto setTile = [this](int tile) {
+        const glm::ivec2& origin = allocator.getOrigin(tile);
+        int size = allocator.getSize(tile);
+        glViewport(origin.x, origin.y, size, size);
+        glScissor(origin.x, origin.y, size, size); // glClear 와 blit 이 타일 밖을 건드리지 않도록 함.
+    };
+    glEnable(GL_SCISSOR_TEST);
+
+    // 1. 정적 caster 를 정적 아틀라스에 구움.
+    if (std::any_of(jobs.begin(), jobs.end(), [](const FaceJob& job) { return job.bake; })) {
+        staticAtlas.begin();
+        for (const FaceJob& job : jobs) {
+            if (job.bake) {
+                setTile(job.tile);
+                glClear(GL_DEPTH_BUFFER_BIT);
+                if (job.drawStatic) {
+                    drawCasters(job.viewProj, false);
+                }
+            }
+        }
+        staticAtlas.end();
+    }
+
+    // 2. 구워둔 정적 타일을 최종 아틀라스로 복사한 뒤, 동적 caster 를 그 위에 그림.
+    atlas.begin();
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, staticAtlas.getId());
+    for (const FaceJob& job : jobs) {
+        setTile(job.tile);
+        const glm::ivec2& origin = allocator.getOrigin(job.tile);
+        int size = allocator.getSize(job.tile);
+        glBlitFramebuffer(origin.x, origin.y, origin.x + size, origin.y + size, origin.x, origin.y, origin.x + size, origin.y + size,
+            GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, atlas.getId());
+    for (const FaceJob& job : jobs) {
+        if (job.drawDynamic) {
+            setTile(job.tile);
+            drawCasters(job.viewProj, true);
+        }
+    }
+    atlas.end();
+
+    glDisable(GL_SCISSOR_TEST);
+}
+
+void PointShadowCache::bind(MaterialBinding& mat) const {
+    mat.setTexture(MaterialBinding::ShadowAtlas, atlas.getDepthTexture());
+    mat.setTexture(MaterialBinding::LightShadow, shadowTex);
+    mat.set(MaterialBinding::ShadowParams, glm::vec3(1.0f / settings.atlasSize, settings.nearPlane, enabled ? 1.0f : 0.0f));
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Frustum.hpp"
+#include "LightSystem.hpp"
+#include "MaterialBinding.hpp"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// 포인트라이트의 전방향(큐브 6 면) 셰도우맵을 깊이 아틀라스 하나에 모아두고, 바뀐 면만 다시 그리는 캐시.
+//
+// - 라이트마다 면 6 개를 같은 크기의 정사각형 타일로 아틀라스에 할당함. (사분 트리 할당기, 타일 크기는 화면에서 라이트 구체가 덮는 크기로 정함)
+// - 그림자를 드리우는 물체(caster)는 정적/동적으로 나눠서 등록함.
+//   정적 caster 는 정적 아틀라스(같은 타일 배치)에 면마다 한 번만 구워두고, 면을 갱신할 때는 구워둔 타일을 복사(blit)한 뒤 동적 caster 만 위에 그림.
+//   라이트가 움직이거나 정적 caster 가 바뀌면 정적 타일부터 다시 굽고, 동적 caster 만 움직였으면 복사 + 동적 caster 만 그림.
+// - 면마다 자기 프러스텀(90도 원뿔대, 원평면 = 라이트 반경)에 닿는 caster 가 바뀌었을 때만 다시 그리고, 나머지는 캐시된 타일을 그대로 씀.
+// - 다시 그려야 하는 면이 많으면 프레임당 faceBudget 개까지만 우선순위(새 라이트 > 라이트 이동 > 동적 caster > 타일 크기 변경 > 매 프레임 움직이는 caster, 같은 종류면 화면 크기 * 밀린 프레임 수) 순으로 그림.
+//   밀린 면은 이전 내용으로 그림자를 계산하고 다음 프레임에 다시 후보가 됨. 면 6 개가 한 번씩 모두 그려지기 전의 라이트는 그림자 없이 계산함.
+// - 셰이더는 라이트 인덱스로 lightShadow 텍스쳐 버퍼(라이트당 2 텍셀)에서 면별 타일 위치를 읽고, sampler2DShadow 로 PCF(3 x 3 탭) 샘플링함.
+//   (면 순서와 방향은 pointShadow.glsl 의 pointShadow() 와 같아야 함)
+class PointShadowCache {
+public:
+    static const int NUM_FACES = 6;
+
+    struct Settings {
+        int atlasSize = 4096;
+        int maxTileSize = 512; // 면 하나의 타일 크기 범위 (2 의 거듭제곱)
+        int minTileSize = 64;
+        int faceBudget = 36; // 프레임당 다시 그릴 수 있는 면 수 (정적 굽기와 별개로 아틀라스에 갱신하는 면 수)
+        float nearPlane = 0.02f;
+    };
+
+    struct Stats {
+        uint32_t shadowedLights = 0; // 그림자를 계산하는 라이트 수 (면 6 개가 모두 그려진 라이트)
+        uint32_t renderedFaces = 0; // 이번 프레임에 아틀라스에서 갱신한 면 수
+        uint32_t bakedFaces = 0; // 그 중 정적 caster 도 다시 구운 면 수
+        uint32_t cachedFaces = 0; // 화면에 보이는 라이트의 면 중 캐시된 타일을 그대로 쓴 면 수
+        uint32_t deferredFaces = 0; // 다시 그려야 하지만 예산을 넘어서 다음 프레임으로 밀린 면 수
+        float atlasUsage = 0.0f; // 할당된 타일이 차지하는 아틀라스 비율 (0 ~ 1)
+    };
+
+    // viewProj 는 면의 (투영 * 뷰) 행렬. dynamic 이 false 면 정적 caster 들을, true 면 동적 caster 들을 그림.
+    using DrawCasters = std::function<void(const glm::mat4& viewProj, bool dynamic)>;
+
+    void setup(const Settings& settings, DrawCasters drawCasters); // 아틀라스 FBO 및 텍스쳐 버퍼 생성 (GL 컨텍스트 생성 이후 호출)
+
+    // caster 의 월드공간 경계(AABB). 정적 caster 의 경계나 enabled 가 바뀌면 이전/새 경계에 닿는 면들의 정적 타일을 다시 구움.
+    // continuous 는 매 프레임 모양이 바뀌는 동적 caster (예: 바다 표면). 이 caster 때문에 다시 그리는 면은 가장 낮은 우선순위로 남는 예산만 씀.
+    int addCaster(bool dynamic, bool continuous = false);
+    void setCasterBounds(int caster, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+    void setCasterEnabled(int caster, bool enabled);
+    void markMoved(int caster); // 경계는 그대로지만 모양이 바뀐 caster (예: 바다 표면). 닿는 면들을 다시 그림.
+
+    void setEnabled(bool enabled) { this->enabled = enabled; }
+    bool isEnabled() const { return enabled; }
+    void setFaceBudget(int budget) { settings.faceBudget = std::max(NUM_FACES, budget); } // 새 라이트는 면 6 개를 한 번에 그리므로 최소 6
+    const Settings& getSettings() const { return settings; }
+
+    // 라이트 목록과 카메라로 타일 크기를 정하고 이번 프레임에 다시 그릴 면들을 고름. (render() 전에 호출)
+    // projScale 은 투영행렬의 [1][1] (= 1 / tan(fov / 2)), viewportHeight 는 렌더 타겟 높이.
+    void update(const LightSystem& lights, const glm::mat4& viewProj, const glm::vec3& cameraPos, float projScale, int viewportHeight);
+
+    void render(); // update() 에서 고른 면들을 그림. (렌더 그래프의 셰도우 패스 실행 함수. 깊이 테스트/쓰기가 켜진 상태에서 호출)
+
+    // 셰이더의 shadowAtlas, lightShadow 샘플러와 shadowParams 유니폼 전송
+    void bind(MaterialBinding& mat) const;
+
+    const Stats& getStats() const { return stats; }
+    static glm::mat4 getFaceViewProj(const glm::vec3& position, float radius, int face, float nearPlane);
+
+private:
+    // 아틀라스를 사분 트리로 나눠서 2 의 거듭제곱 크기의 정사각형 타일을 할당함. (노드 i 의 자식은 4i + 1 ~ 4i + 4)
+    class TileAllocator {
+    public:
+        void setup(int atlasSize, int minTileSize);
+        int allocate(int size); // 실패하면 -1
+        void release(int node);
+        const glm::ivec2& getOrigin(int node) const { return origins[node]; }
+        int getSize(int node) const { return sizes[node]; }
+        int getUsedTexels() const { return usedTexels; }
+
+    private:
+        enum State : uint8_t { Free, Split, Used };
+
+        int find(int node, int size, bool allowSplit);
+
+        std::vector<State> states;
+        std::vector<glm::ivec2> origins;
+        std::vector<int> sizes;
+        int usedTexels = 0;
+    };
+
+    struct Caster {
+        glm::vec3 boundsMin = glm::vec3(0.0f);
+        glm::vec3 boundsMax = glm::vec3(0.0f);
+        glm::vec3 previousMin = glm::vec3(0.0f); // 마지막 update() 때의 경계 (정적 caster 가 움직이면 이전 경계에 닿던 면도 다시 구워야 함)
+        glm::vec3 previousMax = glm::vec3(0.0f);
+        bool dynamic = false;
+        bool continuous = false;
+        bool enabled = true;
+        bool changed = false; // 마지막 update() 이후 경계, enabled 가 바뀌었거나 markMoved() 됨
+        bool wasEnabled = false;
+    };
+
+    // 라이트 인덱스별 캐시 상태. 인덱스는 LightSystem 배열 인덱스이므로, 라이트가 지워져서 다른 라이트가 옮겨오면 위치가 달라서 새로 그리게 됨.
+    struct Entry {
+        glm::vec3 position = glm::vec3(0.0f); // 타일을 마지막으로 구운 기준 위치와 반경
+        float radius = 0.0f;
+        int tileSize = 0; // 0 이면 타일 없음
+        int tiles[NUM_FACES] = { -1, -1, -1, -1, -1, -1 };
+        uint8_t validFaces = 0; // 현재 타일에 한 번이라도 그려진 면 (비트)
+        uint8_t staticDirty = 0; // 정적 타일을 다시 구워야 하는 면
+        uint8_t dynamicDirty = 0; // 동적 caster 만 다시 그려야 하는 면
+        uint8_t continuousDirty = 0; // 매 프레임 움직이는 caster 만 바뀐 면
+        uint32_t refreshed[NUM_FACES] = {}; // 면을 마지막으로 그린 프레임
+        bool visible = false;
+    };
+
+    // update() 가 고르고 render() 가 그리는 면 하나
+    struct FaceJob {
+        uint32_t light;
+        glm::mat4 viewProj;
+        int tile;
+        bool bake; // 정적 타일도 다시 구울지
+        bool drawStatic; // 이 면에 닿는 정적/동적 caster 가 있는지
+        bool drawDynamic;
+    };
+
+    // 다시 그릴 후보 (라이트 단위: 타일 새로 할당, 면 단위: 갱신)
+    struct Candidate {
+        float priority;
+        uint32_t light;
+        int face; // -1 이면 라이트의 면 6 개 (타일을 새로 할당하거나 크기를 바꿈)
+        int tileSize;
+    };
+
+    int chooseTileSize(const Entry& entry, float coverage) const;
+    bool allocateTiles(Entry& entry, int tileSize);
+    void releaseTiles(Entry& entry);
+    void evictHidden(); // 아틀라스가 꽉 찼을 때 화면 밖 라이트들의 타일을 돌려받음.
+    void queueFace(uint32_t light, int face, bool bake);
+    bool faceTouchesBox(const glm::vec3& position, float radius, int face, const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+    bool faceTouchesCasters(const glm::vec3& position, float radius, int face, bool dynamic) const;
+    void upload();
+
+    Settings settings;
+    DrawCasters drawCasters;
+    bool enabled = true;
+    TileAllocator allocator;
+    ofFbo atlas; // 셰이더가 샘플링하는 최종 아틀라스 (정적 + 동적)
+    ofFbo staticAtlas; // 정적 caster 만 구워둔 아틀라스 (같은 타일 배치)
+
+    std::vector<Caster> casters;
+    std::vector<Entry> entries;
+    std::vector<Candidate> candidates;
+    std::vector<FaceJob> jobs;
+    uint32_t frame = 0;
+    bool dataDirty = true;
+
+    std::vector<glm::uvec4> shadowData; // 라이트당 2 텍셀: (면 0 ~ 3 타일 위치), (면 4 ~ 5 타일 위치, 타일 크기, 0). 위치는 x | y << 16
+    size_t capacity = 0;
+    ofBufferObject shadowBuffer;
+    ofTexture shadowTex;
+
+    Frustum frustum;
+    Stats stats;
+};
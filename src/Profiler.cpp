@@ -0,0 +1,238 @@
+#include "Profiler.hpp"
+
+#ifdef PROFILER
+
+#include "MaterialBinding.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+
+namespace {
+// 락프리 링버퍼. 쓰는 쪽은 fetch_add 로 슬롯을 예약한 뒤 내용을 쓰고 sequence 를 (인덱스 + 1)로 발행함.
+// 읽는 쪽은 읽기 전후의 sequence 가 기대값과 같을 때만 그 내용을 사용함. (덮어쓰는 중인 슬롯은 건너뜀)
+const uint64_t RING_SIZE = 1 << 15;
+
+struct Slot {
+    std::atomic<uint64_t> sequence{ 0 };
+    Profiler::Event event;
+};
+
+Slot ring[RING_SIZE];
+std::atomic<uint64_t> writeIndex{ 0 };
+uint64_t overlayReadIndex = 0; // 메인 스레드에서만 접근함.
+
+// GPU 쿼리 풀. 프레임마다 번갈아 쓰고, 같은 풀을 다시 쓰기 직전(두 프레임 뒤)에 결과를 읽음.
+const int MAX_GPU_ZONES = 32;
+
+struct PendingQuery {
+    const char* name;
+    uint64_t startNs;
+    uint32_t depth;
+};
+
+GLuint queries[2][MAX_GPU_ZONES];
+PendingQuery pending[2][MAX_GPU_ZONES];
+int numPending[2] = {};
+int pool = 0;
+bool queriesCreated = false;
+bool gpuZoneActive = false;
+bool inFrame = false;
+
+std::thread::id mainThreadId; // beginFrame() 을 처음 호출한 스레드
+std::atomic<uint32_t> nextThreadId{ 0 };
+thread_local uint32_t threadId = nextThreadId++;
+thread_local uint32_t threadDepth = 0;
+
+const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+std::vector<Profiler::ZoneStats> lastStats;
+std::vector<Profiler::ZoneStats> currentStats;
+
+uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void push(const Profiler::Event& event) {
+    uint64_t index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = ring[index & (RING_SIZE - 1)];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event = event;
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+bool read(uint64_t index, Profiler::Event& event) {
+    Slot& slot = ring[index & (RING_SIZE - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+        return false;
+    }
+    event = slot.event;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == index + 1;
+}
+
+// 링버퍼에 아직 남아있는 가장 오래된 인덱스
+uint64_t oldestIndex(uint64_t end) {
+    return end > RING_SIZE ? end - RING_SIZE : 0;
+}
+
+// MaterialBinding 통계는 draw() 시작 시 0 으로 초기화되므로, 그 경계를 걸친 구간은 끝 값만 사용함.
+uint32_t delta(uint32_t end, uint32_t start) {
+    return end >= start ? end - start : end;
+}
+
+Profiler::ZoneStats& findZone(const char* name, uint32_t depth) {
+    for (Profiler::ZoneStats& zone : currentStats) {
+        if (zone.name == name || std::strcmp(zone.name, name) == 0) {
+            return zone;
+        }
+    }
+    currentStats.push_back({ name, depth, 0, 0.0, -1.0, 0, 0, 0 });
+    return currentStats.back();
+}
+}
+
+namespace Profiler {
+    Zone::Zone(const char* name, bool gpu)
+        : name(name), startNs(nowNs()), depth(threadDepth++), gpuQuery(-1), mainThread(std::this_thread::get_id() == mainThreadId) {
+        if (mainThread) {
+            const MaterialBinding::Stats& stats = MaterialBinding::getFrameStats();
+            drawCalls = stats.drawCalls;
+            uniformCalls = stats.uniformCalls;
+            textureCalls = stats.textureCalls;
+        } else {
+            drawCalls = uniformCalls = textureCalls = 0;
+        }
+
+        if (gpu && mainThread && inFrame && !gpuZoneActive && numPending[pool] < MAX_GPU_ZONES) {
+            gpuQuery = numPending[pool]++;
+            pending[pool][gpuQuery] = { name, startNs, depth };
+            glBeginQuery(GL_TIME_ELAPSED, queries[pool][gpuQuery]);
+            gpuZoneActive = true;
+        }
+    }
+
+    Zone::~Zone() {
+        if (gpuQuery >= 0) {
+            glEndQuery(GL_TIME_ELAPSED);
+            gpuZoneActive = false;
+        }
+        threadDepth--;
+
+        Event event = { name, startNs, nowNs() - startNs, threadId, depth, 0, 0, 0 };
+        if (mainThread) {
+            const MaterialBinding::Stats& stats = MaterialBinding::getFrameStats();
+            event.drawCalls = delta(stats.drawCalls, drawCalls);
+            event.uniformCalls = delta(stats.uniformCalls, uniformCalls);
+            event.textureCalls = delta(stats.textureCalls, textureCalls);
+        }
+        push(event);
+    }
+
+    void beginFrame() {
+        if (!queriesCreated) {
+            mainThreadId = std::this_thread::get_id();
+            glGenQueries(2 * MAX_GPU_ZONES, &queries[0][0]);
+            queriesCreated = true;
+        }
+
+        // 두 프레임 전에 이 풀로 잰 쿼리들 중 결과가 나온 것만 기록함. (아직이면 기다리지 않고 버림)
+        pool ^= 1;
+        for (int i = 0; i < numPending[pool]; ++i) {
+            GLint available = 0;
+            glGetQueryObjectiv(queries[pool][i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) {
+                continue;
+            }
+            GLuint64 elapsedNs = 0;
+            glGetQueryObjectui64v(queries[pool][i], GL_QUERY_RESULT, &elapsedNs);
+            const PendingQuery& query = pending[pool][i];
+            // GPU 구간은 시작 시각을 알 수 없으므로, 트레이스에서는 CPU 구간 시작 시각에 GPU 소요 시간만큼 그림.
+            push({ query.name, query.startNs, elapsedNs, GPU_THREAD, query.depth, 0, 0, 0 });
+        }
+        numPending[pool] = 0;
+        inFrame = true;
+    }
+
+    void endFrame() {
+        inFrame = false;
+
+        currentStats.clear();
+        uint64_t end = writeIndex.load(std::memory_order_acquire);
+        for (uint64_t i = std::max(overlayReadIndex, oldestIndex(end)); i < end; ++i) {
+            Event event;
+            if (!read(i, event)) {
+                continue;
+            }
+            ZoneStats& zone = findZone(event.name, event.depth);
+            if (event.thread == GPU_THREAD) {
+                zone.gpuMs = std::max(zone.gpuMs, 0.0) + event.durationNs / 1000000.0;
+            } else {
+                zone.count++;
+                zone.cpuMs += event.durationNs / 1000000.0;
+                zone.drawCalls += event.drawCalls;
+                zone.uniformCalls += event.uniformCalls;
+                zone.textureCalls += event.textureCalls;
+            }
+        }
+        overlayReadIndex = end;
+        lastStats.swap(currentStats);
+    }
+
+    const std::vector<ZoneStats>& getZoneStats() {
+        return lastStats;
+    }
+
+    void drawOverlay(float x, float y) {
+        std::string text = "zone                       cpu ms   gpu ms  draws  unif   tex\n";
+        char line[128];
+        for (const ZoneStats& zone : lastStats) {
+            std::string name = std::string(zone.depth * 2, ' ') + zone.name;
+            std::snprintf(line, sizeof(line), "%-24.24s %8.3f %8s %6u %5u %5u\n", name.c_str(), zone.cpuMs,
+                zone.gpuMs < 0.0 ? "-" : ofToString(zone.gpuMs, 3).c_str(), zone.drawCalls, zone.uniformCalls, zone.textureCalls);
+            text += line;
+        }
+        ofDisableDepthTest();
+        ofDrawBitmapStringHighlight(text, x, y);
+        ofEnableDepthTest();
+    }
+
+    bool exportTrace(const std::filesystem::path& path) {
+        std::ofstream out(path);
+        if (!out) {
+            ofLogError("Profiler") << "can't write " << path;
+            return false;
+        }
+
+        out << std::fixed << std::setprecision(3);
+
+        // Chrome 트레이스 형식: 'X'(완료된 구간) 이벤트의 ts / dur 는 마이크로초 단위
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << GPU_THREAD << ",\"args\":{\"name\":\"GPU\"}}";
+        uint64_t end = writeIndex.load(std::memory_order_acquire);
+        size_t count = 0;
+        for (uint64_t i = oldestIndex(end); i < end; ++i) {
+            Event event;
+            if (!read(i, event)) {
+                continue;
+            }
+            out << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << (event.thread == GPU_THREAD ? "gpu" : "cpu")
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+                << ",\"ts\":" << event.startNs / 1000.0 << ",\"dur\":" << event.durationNs / 1000.0;
+            if (event.thread != GPU_THREAD) {
+                out << ",\"args\":{\"draws\":" << event.drawCalls << ",\"uniforms\":" << event.uniformCalls << ",\"textures\":" << event.textureCalls << "}";
+            }
+            out << "}";
+            count++;
+        }
+        out << "\n]}\n";
+
+        ofLogNotice("Profiler") << count << " zones written to " << path;
+        return bool(out);
+    }
+}
+
+#endif
@@ -0,0 +1,88 @@
+#pragma once
+
+// 구간(zone) 단위 CPU/GPU 프로파일러.
+// PROFILER 매크로를 정의하고 빌드했을 때만 동작하며, 정의하지 않으면 아래 매크로들이 모두 빈 문장이 되어 비용이 전혀 없음.
+// (ALLOCATION_COUNTER, TANGENT_BENCHMARK 와 같은 방식)
+//
+//   PROFILE_ZONE("name");      // 이 스코프가 끝날 때까지의 CPU 시간을 기록함.
+//   PROFILE_GPU_ZONE("name");  // CPU 시간 + GL_TIME_ELAPSED 쿼리로 GPU 시간도 기록함. (메인 스레드 전용)
+//
+// - CPU 시간은 steady_clock 으로 재고, 구간마다 MaterialBinding 통계의 차이(드로우콜, 유니폼, 텍스쳐 호출 수)를 함께 기록함.
+// - GPU 쿼리는 프레임마다 번갈아 쓰는 두 벌의 쿼리 풀을 사용하고, 두 프레임 뒤에 결과가 준비된 것만 읽으므로 GPU 를 기다리지 않음.
+//   GL_TIME_ELAPSED 쿼리는 중첩할 수 없으므로, GPU 구간 안에서 다시 연 GPU 구간은 CPU 시간만 기록함.
+// - 기록은 고정 크기의 락프리 링버퍼에 쌓이고(여러 스레드에서 기록 가능), 가장 오래된 기록부터 덮어씀.
+// - drawOverlay() 로 직전 프레임의 구간별 통계를 화면에 그리고, exportTrace() 로 링버퍼 내용을
+//   Chrome(chrome://tracing) / Perfetto 에서 열 수 있는 트레이스 JSON 으로 저장함.
+
+#ifdef PROFILER
+
+#include "ofMain.h"
+#include <cstdint>
+#include <vector>
+
+namespace Profiler {
+    // 링버퍼에 기록되는 구간 하나
+    struct Event {
+        const char* name; // 문자열 리터럴만 사용할 것 (포인터만 저장함)
+        uint64_t startNs; // 프로파일러 시작 시점 기준
+        uint64_t durationNs;
+        uint32_t thread; // GPU_THREAD 이면 GPU 시간
+        uint32_t depth;
+        uint32_t drawCalls;
+        uint32_t uniformCalls;
+        uint32_t textureCalls;
+    };
+
+    // 오버레이에 보여줄 구간별 합계 (같은 이름의 구간은 합쳐짐)
+    struct ZoneStats {
+        const char* name;
+        uint32_t depth;
+        uint32_t count;
+        double cpuMs;
+        double gpuMs; // 두 프레임 전 결과 (아직 없으면 음수)
+        uint32_t drawCalls;
+        uint32_t uniformCalls;
+        uint32_t textureCalls;
+    };
+
+    const uint32_t GPU_THREAD = 0xffffffff;
+
+    class Zone {
+    public:
+        Zone(const char* name, bool gpu);
+        ~Zone();
+
+    private:
+        const char* name;
+        uint64_t startNs;
+        uint32_t depth;
+        int gpuQuery; // 이 구간이 사용하는 쿼리 인덱스 (-1: GPU 시간 측정 안함)
+        bool mainThread; // MaterialBinding 통계는 메인 스레드에서만 읽을 수 있음.
+        uint32_t drawCalls;
+        uint32_t uniformCalls;
+        uint32_t textureCalls;
+    };
+
+    void beginFrame(); // 프레임 시작 시 메인 스레드에서 호출 (두 프레임 전 GPU 쿼리 결과 수집)
+    void endFrame(); // 프레임 끝에서 메인 스레드에서 호출 (이번 프레임 구간별 통계 집계)
+
+    const std::vector<ZoneStats>& getZoneStats(); // 직전 프레임 구간별 통계
+    void drawOverlay(float x, float y);
+    bool exportTrace(const std::filesystem::path& path); // 링버퍼에 남아있는 구간들을 트레이스 JSON 으로 저장
+}
+
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
+#define PROFILE_ZONE(name) Profiler::Zone PROFILER_CONCAT(profileZone, __LINE__)(name, false)
+#define PROFILE_GPU_ZONE(name) Profiler::Zone PROFILER_CONCAT(profileZone, __LINE__)(name, true)
+#define PROFILE_BEGIN_FRAME() Profiler::beginFrame()
+#define PROFILE_END_FRAME() Profiler::endFrame()
+
+#else
+
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_GPU_ZONE(name) ((void)0)
+#define PROFILE_BEGIN_FRAME() ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+
+#endif
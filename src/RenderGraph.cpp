@@ -0,0 +1,299 @@
+#include "RenderGraph.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <climits>
+
+void RenderGraph::clear() {
+    resources.clear();
+    passes.clear();
+    order.clear();
+    compiled = false;
+}
+
+RenderGraph::Resource RenderGraph::importResource(const char* name) {
+    ResourceInfo info;
+    info.name = name;
+    resources.push_back(info);
+    compiled = false;
+    return Resource(resources.size() - 1);
+}
+
+RenderGraph::Resource RenderGraph::createTarget(const char* name, const TargetDesc& desc) {
+    ResourceInfo info;
+    info.name = name;
+    info.transient = true;
+    info.desc = desc;
+    resources.push_back(info);
+    compiled = false;
+    return Resource(resources.size() - 1);
+}
+
+void RenderGraph::markOutput(Resource resource) {
+    resources[resource].output = true;
+    compiled = false;
+}
+
+void RenderGraph::addPass(const char* name, const State& state, std::initializer_list<Resource> reads, std::initializer_list<Resource> writes,
+    std::function<void()> execute) {
+    Pass pass;
+    pass.name = name;
+    pass.state = state;
+    pass.reads = reads;
+    pass.writes = writes;
+    pass.execute = std::move(execute);
+    passes.push_back(std::move(pass));
+    compiled = false;
+}
+
+void RenderGraph::compile() {
+    cullPasses();
+    sortPasses();
+    assignTargets();
+
+    stats.passes = uint32_t(order.size());
+    stats.culled = uint32_t(passes.size() - order.size());
+    compiled = true;
+}
+
+// 선언 순서의 뒤에서부터, 출력 리소스 또는 이미 필요하다고 표시된 리소스를 쓰는 패스만 남기고
+// 남은 패스가 읽는 리소스들을 다시 필요하다고 표시함. (결과가 아무 데도 쓰이지 않는 패스는 여기서 빠짐)
+void RenderGraph::cullPasses() {
+    std::vector<bool> needed(resources.size(), false);
+    for (size_t i = 0; i < resources.size(); ++i) {
+        needed[i] = resources[i].output;
+    }
+    for (size_t i = passes.size(); i-- > 0;) {
+        Pass& pass = passes[i];
+        pass.culled = std::none_of(pass.writes.begin(), pass.writes.end(), [&](Resource r) { return needed[r]; });
+        if (!pass.culled) {
+            for (Resource r : pass.reads) {
+                needed[r] = true;
+            }
+        }
+    }
+}
+
+// 선언 순서대로 리소스마다 마지막으로 쓴 패스와 그 뒤에 읽은 패스들을 따라가면서 의존성을 만든 뒤,
+// 의존성이 모두 풀린 패스들 중 직전 패스와 상태 차이가 가장 적은 패스를 먼저 실행하도록 정렬함. (같으면 선언 순서)
+void RenderGraph::sortPasses() {
+    size_t numPasses = passes.size();
+    std::vector<std::vector<int>> successors(numPasses);
+    std::vector<int> numPredecessors(numPasses, 0);
+    auto addEdge = [&](int from, int to) {
+        if (from >= 0 && from != to) {
+            successors[from].push_back(to);
+            numPredecessors[to]++;
+        }
+    };
+
+    std::vector<int> lastWriter(resources.size(), -1);
+    std::vector<std::vector<int>> readersSinceWrite(resources.size());
+    for (size_t i = 0; i < numPasses; ++i) {
+        const Pass& pass = passes[i];
+        if (pass.culled) {
+            continue;
+        }
+        for (Resource r : pass.reads) {
+            addEdge(lastWriter[r], int(i)); // 쓰기 -> 읽기
+            readersSinceWrite[r].push_back(int(i));
+        }
+        for (Resource r : pass.writes) {
+            addEdge(lastWriter[r], int(i)); // 쓰기 -> 쓰기
+            for (int reader : readersSinceWrite[r]) {
+                addEdge(reader, int(i)); // 읽기 -> 쓰기 (앞의 패스가 덮어쓰기 전 값을 읽어야 함)
+            }
+            readersSinceWrite[r].clear();
+            lastWriter[r] = int(i);
+        }
+    }
+
+    order.clear();
+    std::vector<int> ready;
+    for (size_t i = 0; i < numPasses; ++i) {
+        if (!passes[i].culled && numPredecessors[i] == 0) {
+            ready.push_back(int(i));
+        }
+    }
+    State state; // execute() 는 기본 상태에서 시작함.
+    while (!ready.empty()) {
+        auto best = ready.begin();
+        int bestCost = countDifferences(state, passes[*best].state);
+        for (auto it = ready.begin() + 1; it != ready.end(); ++it) {
+            int cost = countDifferences(state, passes[*it].state);
+            if (cost < bestCost || (cost == bestCost && *it < *best)) {
+                best = it;
+                bestCost = cost;
+            }
+        }
+        int next = *best;
+        ready.erase(best);
+        order.push_back(next);
+        state = passes[next].state;
+        for (int successor : successors[next]) {
+            if (--numPredecessors[successor] == 0) {
+                ready.push_back(successor);
+            }
+        }
+    }
+}
+
+// 트랜지언트 렌더 타겟을 처음 쓰이는 순서대로 훑으면서, 형식이 같고 이전 사용자의 수명이 이미 끝난 FBO 가 있으면 그것을 배정함.
+// 이번 구성에서 아무 타겟도 배정받지 않은 FBO 는 해제함. (렌더 타겟 크기가 바뀌었을 때 예전 크기의 FBO 가 남지 않도록)
+void RenderGraph::assignTargets() {
+    std::vector<int> firstUse(resources.size(), INT_MAX);
+    std::vector<int> lastUse(resources.size(), -1);
+    for (size_t position = 0; position < order.size(); ++position) {
+        const Pass& pass = passes[order[position]];
+        for (const std::vector<Resource>* list : { &pass.reads, &pass.writes }) {
+            for (Resource r : *list) {
+                firstUse[r] = std::min(firstUse[r], int(position));
+                lastUse[r] = std::max(lastUse[r], int(position));
+            }
+        }
+    }
+
+    std::vector<Resource> transients;
+    for (size_t i = 0; i < resources.size(); ++i) {
+        resources[i].physical = -1;
+        if (resources[i].transient && lastUse[i] >= 0) {
+            transients.push_back(Resource(i));
+        }
+    }
+    std::sort(transients.begin(), transients.end(), [&](Resource a, Resource b) { return firstUse[a] < firstUse[b]; });
+
+    for (PhysicalTarget& target : targetPool) {
+        target.busyUntil = -1;
+    }
+    std::vector<bool> used(targetPool.size(), false);
+    for (Resource r : transients) {
+        ResourceInfo& info = resources[r];
+        int match = -1;
+        for (size_t i = 0; i < targetPool.size(); ++i) {
+            if (targetPool[i].desc == info.desc && targetPool[i].busyUntil < firstUse[r]) {
+                match = int(i);
+                break;
+            }
+        }
+        if (match < 0) {
+            PhysicalTarget target;
+            target.desc = info.desc;
+            target.fbo = std::make_unique<ofFbo>();
+            ofFboSettings settings;
+            settings.width = info.desc.width;
+            settings.height = info.desc.height;
+            settings.internalformat = info.desc.internalFormat;
+            settings.useDepth = info.desc.depth;
+            settings.depthStencilAsTexture = info.desc.depth;
+            target.fbo->allocate(settings);
+            targetPool.push_back(std::move(target));
+            used.push_back(false);
+            match = int(targetPool.size() - 1);
+        }
+        targetPool[match].busyUntil = lastUse[r];
+        used[match] = true;
+        info.physical = match;
+    }
+
+    // 쓰이지 않은 FBO 를 지우고, 남은 FBO 의 인덱스로 배정을 다시 맞춤.
+    std::vector<int> remap(targetPool.size(), -1);
+    size_t kept = 0;
+    for (size_t i = 0; i < targetPool.size(); ++i) {
+        if (used[i]) {
+            remap[i] = int(kept);
+            if (kept != i) {
+                targetPool[kept] = std::move(targetPool[i]);
+            }
+            ++kept;
+        }
+    }
+    targetPool.resize(kept);
+    for (ResourceInfo& info : resources) {
+        if (info.physical >= 0) {
+            info.physical = remap[info.physical];
+        }
+    }
+
+    stats.transientTargets = uint32_t(transients.size());
+    stats.physicalTargets = uint32_t(targetPool.size());
+}
+
+void RenderGraph::execute() {
+    if (!compiled) {
+        compile();
+    }
+    stats.stateChanges = 0;
+    stats.redundantStates = 0;
+
+    // 그래프 밖(오픈프레임웍스, 이전 프레임의 텍스트 출력 등)에서 상태가 바뀌었을 수 있으므로, 처음에는 모든 항목을 한 번 전송함.
+    applyState(State(), true);
+    for (int index : order) {
+        Pass& pass = passes[index];
+        PROFILE_GPU_ZONE(pass.name);
+        applyState(pass.state, false);
+        pass.execute();
+    }
+    applyState(State(), false);
+}
+
+ofFbo& RenderGraph::getTarget(Resource resource) {
+    return *targetPool[resources[resource].physical].fbo;
+}
+
+int RenderGraph::countDifferences(const State& a, const State& b) {
+    return int(a.depthTest != b.depthTest) + int(a.depthFunc != b.depthFunc) + int(a.depthWrite != b.depthWrite)
+        + int(a.colorWrite != b.colorWrite) + int(a.blend != b.blend) + int(a.cull != b.cull) + int(a.depthClamp != b.depthClamp);
+}
+
+// 직전에 전송한 상태와 다른 항목만 GL 함수를 호출함.
+void RenderGraph::applyState(const State& next, bool force) {
+    auto changed = [&](bool differs) {
+        if (differs || force) {
+            stats.stateChanges++;
+            return true;
+        }
+        stats.redundantStates++;
+        return false;
+    };
+
+    if (changed(next.depthTest != current.depthTest)) {
+        if (next.depthTest) {
+            glEnable(GL_DEPTH_TEST);
+        } else {
+            glDisable(GL_DEPTH_TEST);
+        }
+    }
+    if (changed(next.depthFunc != current.depthFunc)) {
+        glDepthFunc(next.depthFunc);
+    }
+    if (changed(next.depthWrite != current.depthWrite)) {
+        glDepthMask(next.depthWrite ? GL_TRUE : GL_FALSE);
+    }
+    if (changed(next.colorWrite != current.colorWrite)) {
+        GLboolean mask = next.colorWrite ? GL_TRUE : GL_FALSE;
+        glColorMask(mask, mask, mask, mask);
+    }
+    if (changed(next.blend != current.blend)) {
+        // 블렌딩은 오픈프레임웍스 함수로 바꿔서, 그래프 밖의 ofEnableAlphaBlending() 등과 상태가 어긋나지 않도록 함.
+        if (next.blend == Blend::Add) {
+            ofEnableBlendMode(OF_BLENDMODE_ADD);
+        } else {
+            ofDisableBlendMode();
+        }
+    }
+    if (changed(next.cull != current.cull)) {
+        if (next.cull == Cull::None) {
+            glDisable(GL_CULL_FACE);
+        } else {
+            glEnable(GL_CULL_FACE);
+            glCullFace(next.cull == Cull::Front ? GL_FRONT : GL_BACK);
+        }
+    }
+    if (changed(next.depthClamp != current.depthClamp)) {
+        if (next.depthClamp) {
+            glEnable(GL_DEPTH_CLAMP);
+        } else {
+            glDisable(GL_DEPTH_CLAMP);
+        }
+    }
+    current = next;
+}
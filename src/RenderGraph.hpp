@@ -0,0 +1,115 @@
+#pragma once
+
+#include "ofMain.h"
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+// draw() 에서 패스 순서와 GL 상태 전환을 직접 나열하는 대신, 프레임을 이루는 패스들을 선언해두고 실행하는 렌더 그래프.
+//
+// - 패스는 이름, 필요한 고정 기능 상태(State), 읽는 리소스, 쓰는 리소스, 실행 함수로 선언함.
+//   실행 함수는 셰이더 바인딩과 드로우콜만 하고, 깊이/블렌딩/컬링 같은 고정 기능 상태는 건드리지 않아야 함.
+// - compile() 은
+//   1. 최종 출력(markOutput)에 닿지 않는 패스를 뒤에서부터 찾아서 빼고(컬링),
+//   2. 리소스 읽기/쓰기로 패스 사이의 의존성(쓰기 -> 읽기, 읽기 -> 쓰기, 쓰기 -> 쓰기)을 만든 뒤,
+//   3. 의존성을 지키는 범위 안에서 직전 패스와 상태가 가장 비슷한 패스부터 고르는 위상 정렬로 실행 순서를 정하고,
+//   4. 트랜지언트 렌더 타겟마다 처음/마지막으로 쓰는 패스를 구해서, 수명이 겹치지 않고 형식이 같은 타겟끼리 FBO 하나를 같이 씀(aliasing).
+// - execute() 는 정해진 순서대로 패스마다 직전 상태와 다른 항목만 GL 로 전송한 뒤 실행 함수를 호출하고, 끝나면 기본 상태로 되돌림.
+// 패스 구성은 설정(렌더링 방식, 깊이 프리패스 등)이 바뀔 때만 다시 선언하고 compile() 하므로, 매 프레임 실행에는 힙 할당이 없음.
+class RenderGraph {
+public:
+    using Resource = int;
+
+    enum class Blend : uint8_t { None, Add };
+    enum class Cull : uint8_t { None, Back, Front };
+
+    // 패스가 요구하는 고정 기능 상태. 기본값은 그래프 밖(오픈프레임웍스 쪽 그리기)에서 기대하는 상태와 같음.
+    struct State {
+        bool depthTest = true;
+        GLenum depthFunc = GL_LESS;
+        bool depthWrite = true;
+        bool colorWrite = true;
+        Blend blend = Blend::None; // Add 는 OF_BLENDMODE_ADD 와 같음 (GL_SRC_ALPHA, GL_ONE)
+        Cull cull = Cull::None;
+        bool depthClamp = false;
+    };
+
+    // 그래프가 할당하는 트랜지언트 렌더 타겟의 형식
+    struct TargetDesc {
+        int width = 0;
+        int height = 0;
+        GLint internalFormat = GL_RGBA8;
+        bool depth = false; // 깊이 텍스쳐도 함께 붙일지 여부
+
+        bool operator==(const TargetDesc& other) const {
+            return width == other.width && height == other.height && internalFormat == other.internalFormat && depth == other.depth;
+        }
+    };
+
+    struct Stats {
+        uint32_t passes = 0; // 실행 순서에 들어간 패스 수
+        uint32_t culled = 0; // 최종 출력에 영향이 없어서 빠진 패스 수
+        uint32_t stateChanges = 0; // 직전 execute() 에서 실제로 GL 로 전송한 상태 항목 수
+        uint32_t redundantStates = 0; // 직전 execute() 에서 이미 같은 값이라서 생략한 상태 항목 수
+        uint32_t transientTargets = 0; // 선언된 트랜지언트 렌더 타겟 수
+        uint32_t physicalTargets = 0; // aliasing 후 실제로 할당된 FBO 수
+    };
+
+    void clear(); // 패스와 리소스 선언을 모두 지움. (할당해둔 FBO 는 다음 compile() 에서 다시 쓸 수 있도록 남겨둠)
+
+    Resource importResource(const char* name); // 그래프 밖에서 관리하는 리소스 (현재 렌더 타겟, G-버퍼 등)
+    Resource createTarget(const char* name, const TargetDesc& desc); // 그래프가 할당하고 재사용하는 트랜지언트 렌더 타겟
+    void markOutput(Resource resource); // 프레임의 최종 결과. 여기에 닿지 않는 패스는 컬링됨.
+
+    // name 은 문자열 리터럴만 사용할 것 (프로파일러 구간 이름으로도 그대로 사용함)
+    void addPass(const char* name, const State& state, std::initializer_list<Resource> reads, std::initializer_list<Resource> writes,
+        std::function<void()> execute);
+
+    void compile();
+    void execute();
+
+    ofFbo& getTarget(Resource resource); // 트랜지언트 렌더 타겟에 배정된 FBO (compile() 이후에만 유효)
+    const char* getPassName(size_t index) const { return passes[order[index]].name; } // 실행 순서상 index 번째 패스 이름
+    bool isCompiled() const { return compiled; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct ResourceInfo {
+        const char* name;
+        bool transient = false;
+        bool output = false;
+        TargetDesc desc;
+        int physical = -1; // 트랜지언트 타겟이면 targetPool 안의 인덱스
+    };
+
+    struct Pass {
+        const char* name;
+        State state;
+        std::vector<Resource> reads;
+        std::vector<Resource> writes;
+        std::function<void()> execute;
+        bool culled = false;
+    };
+
+    struct PhysicalTarget {
+        TargetDesc desc;
+        std::unique_ptr<ofFbo> fbo;
+        int busyUntil = -1; // compile() 중 이 FBO 를 마지막으로 쓰는 패스의 실행 순서 (-1 이면 이번 compile() 에서 아직 배정 안 됨)
+    };
+
+    static int countDifferences(const State& a, const State& b);
+    void cullPasses();
+    void sortPasses();
+    void assignTargets();
+    void applyState(const State& next, bool force);
+
+    std::vector<ResourceInfo> resources;
+    std::vector<Pass> passes;
+    std::vector<int> order; // 컬링되지 않은 패스들의 실행 순서 (passes 인덱스)
+    std::vector<PhysicalTarget> targetPool;
+    State current; // execute() 중 마지막으로 GL 에 전송한 상태
+    Stats stats;
+    bool compiled = false;
+};
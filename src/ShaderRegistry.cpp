@@ -0,0 +1,259 @@
+#include "ShaderRegistry.hpp"
+#include <cstring>
+#include <fstream>
+
+namespace {
+// 프로그램 바이너리 캐시 파일 헤더. 바로 뒤에 length 바이트의 바이너리가 이어짐.
+struct BinaryHeader {
+    char magic[4]; // "SHBC"
+    uint32_t format; // glGetProgramBinary() 가 돌려준 바이너리 포맷
+    uint32_t length;
+};
+
+// 캐시 적중 시에는 ofShader 가 프로그램 객체를 만들고 로드 상태를 관리하도록, 아무것도 안 하는 셰이더로 먼저 링크한 뒤 바이너리로 덮어씀.
+const char* stubVert = "#version 410\nvoid main() { gl_Position = vec4(0.0); }\n";
+const char* stubFrag = "#version 410\nout vec4 outCol;\nvoid main() { outCol = vec4(0.0); }\n";
+
+uint64_t hashString(uint64_t hash, const std::string& text) {
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    hash ^= 0xff; // 소스 경계 구분 (vert 끝부분과 frag 앞부분이 바뀌어도 같은 해시가 나오지 않도록)
+    hash *= 1099511628211ull;
+    return hash;
+}
+
+std::string readText(const std::filesystem::path& path) {
+    if (!ofFile::doesFileExist(path)) {
+        ofLogError("ShaderRegistry") << "can't find " << path;
+        return "";
+    }
+    return ofBufferFromFile(path, false).getText();
+}
+
+// 변형 키에 해당하는 '#version' 및 '#define' 줄들
+std::string makeHeader(const ShaderKey& key) {
+    std::string header = "#version 410\n";
+    if (key.light == LightType::Point) {
+        header += "#define LIGHT_POINT\n";
+    } else if (key.light == LightType::Directional) {
+        header += "#define LIGHT_DIRECTIONAL\n";
+    }
+    if (key.features & NormalMap) {
+        header += "#define NORMAL_MAP\n";
+    }
+    if (key.features & EnvReflection) {
+        header += "#define ENV_REFLECTION\n";
+    }
+    if (key.features & Ocean) {
+        header += "#define OCEAN\n";
+    }
+    if (key.features & Instanced) {
+        header += "#define INSTANCED\n";
+    }
+    return header;
+}
+
+// 셰이더 파일에 직접 적혀있는 '#version' 줄 바로 뒤에 text 를 끼워넣음. ('#version' 은 맨 앞에 있어야 하므로 그냥 앞에 붙일 수 없음)
+std::string insertAfterVersion(const std::string& source, const std::string& text) {
+    size_t pos = source.find("#version");
+    if (pos == std::string::npos) {
+        return text + source;
+    }
+    size_t end = source.find('\n', pos);
+    end = end == std::string::npos ? source.size() : end + 1;
+    std::string result = source.substr(0, end);
+    if (result.back() != '\n') {
+        result += '\n';
+    }
+    return result + text + source.substr(end);
+}
+
+double elapsedMs(uint64_t startMicros) {
+    return (ofGetElapsedTimeMicros() - startMicros) / 1000.0;
+}
+}
+
+void ShaderRegistry::setFragmentPrelude(const std::filesystem::path& path) {
+    fragmentPrelude = readText(path);
+}
+
+void ShaderRegistry::setUberShader(std::initializer_list<ShaderKey> keys, const std::filesystem::path& vert, const std::filesystem::path& frag) {
+    auto source = std::make_shared<UberShader>();
+    source->name = frag.stem().string();
+    source->vert = readText(vert);
+    source->frag = readText(frag);
+    for (const ShaderKey& key : keys) {
+        uberShaders[ShaderKey{ key.mesh, key.light }.packed()] = source;
+    }
+}
+
+MaterialBinding& ShaderRegistry::load(const ShaderKey& key, const std::filesystem::path& vert, const std::filesystem::path& frag) {
+    return build(key, readText(vert), insertAfterVersion(readText(frag), fragmentPrelude), vert.string() + " + " + frag.string());
+}
+
+MaterialBinding* ShaderRegistry::find(const ShaderKey& key) {
+    auto it = entries.find(key.packed());
+    return it == entries.end() ? nullptr : &it->second->binding;
+}
+
+MaterialBinding& ShaderRegistry::get(const ShaderKey& key) {
+    auto it = entries.find(key.packed());
+    if (it != entries.end()) {
+        return it->second->binding;
+    }
+    auto uber = uberShaders.find(ShaderKey{ key.mesh, key.light }.packed());
+    if (uber == uberShaders.end() || uber->second->frag.empty()) {
+        return entries.at(key.packed())->binding; // 우버 셰이더로 만들 수 없는 변형 -> 예외
+    }
+
+    // 처음 요청된 변형이므로 우버 셰이더에 '#define' 을 붙여서 만듦. (이후 프레임부터는 위에서 바로 찾아짐)
+    const UberShader& source = *uber->second;
+    std::string header = makeHeader(key);
+    std::string name = source.name;
+    for (size_t pos = header.find("#define "); pos != std::string::npos; pos = header.find("#define ", pos + 1)) {
+        name += " " + header.substr(pos + 8, header.find('\n', pos) - pos - 8);
+    }
+    return build(key, header + source.vert, header + fragmentPrelude + source.frag, name);
+}
+
+MaterialBinding& ShaderRegistry::build(const ShaderKey& key, const std::string& vertSource, const std::string& fragSource, const std::string& name) {
+    std::unique_ptr<Entry>& entry = entries[key.packed()];
+    if (entry) {
+        entry->shader.unload(); // 이미 있는 키면 다시 로드함.
+    } else {
+        entry = std::make_unique<Entry>();
+    }
+
+    uint64_t start = ofGetElapsedTimeMicros();
+    bool useCache = binaryCacheSupported();
+    std::filesystem::path cachePath;
+    if (useCache) {
+        uint64_t hash = 14695981039346656037ull;
+        hash = hashString(hash, vertSource);
+        hash = hashString(hash, fragSource);
+        hash = hashString(hash, getDriverString());
+        char fileName[32];
+        std::snprintf(fileName, sizeof(fileName), "%016llx.bin", (unsigned long long)hash);
+        cachePath = ofToDataPath(std::filesystem::path("shadercache") / fileName, true);
+
+        if (loadBinary(entry->shader, cachePath)) {
+            ofLogNotice("ShaderRegistry") << name << ": loaded from binary cache in " << ofToString(elapsedMs(start), 2) << "ms";
+            entry->binding.setup(entry->shader);
+            return entry->binding;
+        }
+        entry->shader.unload();
+    }
+
+    if (compile(entry->shader, vertSource, fragSource, useCache)) {
+        ofLogNotice("ShaderRegistry") << name << ": compiled in " << ofToString(elapsedMs(start), 2) << "ms";
+        if (useCache) {
+            saveBinary(entry->shader, cachePath);
+        }
+    } else {
+        ofLogError("ShaderRegistry") << "failed to load " << name;
+    }
+    entry->binding.setup(entry->shader);
+    return entry->binding;
+}
+
+bool ShaderRegistry::compile(ofShader& shader, const std::string& vertSource, const std::string& fragSource, bool retrievable) {
+    if (!shader.setupShaderFromSource(GL_VERTEX_SHADER, vertSource)
+        || !shader.setupShaderFromSource(GL_FRAGMENT_SHADER, fragSource)) {
+        return false;
+    }
+    if (retrievable) {
+        // 링크 전에 힌트를 줘야 드라이버가 glGetProgramBinary() 로 꺼낼 수 있는 바이너리를 남겨둠.
+        glProgramParameteri(shader.getProgram(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    shader.bindDefaults();
+    return shader.linkProgram();
+}
+
+bool ShaderRegistry::loadBinary(ofShader& shader, const std::filesystem::path& cachePath) {
+    if (!std::filesystem::exists(cachePath)) {
+        return false;
+    }
+    ofBuffer file = ofBufferFromFile(cachePath, true);
+    BinaryHeader header;
+    if (file.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, file.getData(), sizeof(header));
+    if (std::memcmp(header.magic, "SHBC", 4) != 0 || file.size() - sizeof(header) != header.length) {
+        return false;
+    }
+
+    if (!compile(shader, stubVert, stubFrag, false)) {
+        return false;
+    }
+    GLuint program = shader.getProgram();
+    glProgramBinary(program, header.format, file.getData() + sizeof(header), header.length);
+
+    // 드라이버가 업데이트되었는데 버전 문자열은 그대로인 경우 등에는 바이너리가 거부될 수 있음. 그러면 소스로 다시 컴파일함.
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE) {
+        ofLogWarning("ShaderRegistry") << "driver rejected " << cachePath << ", recompiling";
+        return false;
+    }
+    return true;
+}
+
+void ShaderRegistry::saveBinary(const ofShader& shader, const std::filesystem::path& cachePath) {
+    GLuint program = shader.getProgram();
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    std::vector<char> blob(sizeof(BinaryHeader) + length);
+    BinaryHeader header = {};
+    std::memcpy(header.magic, "SHBC", 4);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, blob.data() + sizeof(header));
+    header.format = format;
+    header.length = uint32_t(length);
+    std::memcpy(blob.data(), &header, sizeof(header));
+
+    std::error_code ec;
+    std::filesystem::create_directories(cachePath.parent_path(), ec);
+
+    // 쓰는 도중에 실패해도 기존 캐시가 깨지지 않도록, 임시 파일에 쓴 뒤 이름을 바꿈.
+    std::filesystem::path tmpPath = cachePath;
+    tmpPath += ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return;
+        }
+        out.write(blob.data(), sizeof(header) + length);
+        if (!out) {
+            return;
+        }
+    }
+    std::filesystem::rename(tmpPath, cachePath, ec);
+    if (ec) {
+        ofLogWarning("ShaderRegistry") << "can't write " << cachePath;
+    }
+}
+
+bool ShaderRegistry::binaryCacheSupported() {
+    // 바이너리 포맷을 하나도 노출하지 않는 드라이버(macOS 의 GL 4.1 등)에서는 캐시를 쓰지 않고 매번 컴파일함.
+    if (numBinaryFormats < 0) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats);
+    }
+    return numBinaryFormats > 0;
+}
+
+const std::string& ShaderRegistry::getDriverString() {
+    if (driverString.empty()) {
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const GLubyte* value = glGetString(name);
+            driverString += value ? reinterpret_cast<const char*>(value) : "";
+            driverString += '\n';
+        }
+    }
+    return driverString;
+}
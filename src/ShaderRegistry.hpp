@@ -0,0 +1,103 @@
+#pragma once
+
+#include "ofMain.h"
+#include "MaterialBinding.hpp"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+// 셰이더를 적용할 메쉬 종류
+enum class MeshType : uint8_t {
+    Shield,
+    Water,
+    Skybox,
+    LightVolume, // 디퍼드 모드의 조명 패스 (디렉셔널: 화면 전체 사각형, 포인트: 라이트마다 구체 볼륨)
+    ScreenQuad // 화면 전체 사각형으로 그리는 후처리 (동적 해상도의 업스케일)
+};
+
+// 셰이더가 계산하는 조명 종류
+enum class LightType : uint8_t {
+    None, // 조명 계산 없음 (스카이박스, 후처리)
+    Directional,
+    Point,
+    Clustered, // 디렉셔널 라이트 + 클러스터에 할당된 포인트라이트들을 한 패스에서 계산
+    GBuffer, // 조명 계산 없이 디퍼드 모드의 G-버퍼에 재질/노멀만 기록
+    DepthOnly, // 깊이 프리패스 (위치만 변환하고 색상은 기록하지 않음)
+    Shadow // 포인트라이트 셰도우맵 (depthOnly 셰이더를 셰도우 패스 전용 프로그램으로 따로 컴파일해서 프리패스와 유니폼 캐시를 나눔)
+};
+
+// 우버 셰이더의 기능 비트. 켜진 비트마다 같은 이름의 '#define' 을 붙여서 컴파일함. (uber.frag 상단 주석 참고)
+enum ShaderFeature : uint32_t {
+    NormalMap = 1 << 0, // NORMAL_MAP
+    EnvReflection = 1 << 1, // ENV_REFLECTION
+    Ocean = 1 << 2, // OCEAN (OceanSimulation 의 변위맵/기울기맵으로 물 표면을 움직이고 셰이딩함)
+    Instanced = 1 << 3 // INSTANCED
+};
+
+// 셰이더 변형(variant) 하나를 가리키는 키
+struct ShaderKey {
+    MeshType mesh;
+    LightType light;
+    uint32_t features = 0; // 셰이더 기능 비트 (같은 메쉬/조명 조합 안에서의 변형)
+
+    uint64_t packed() const { return (uint64_t(mesh) << 40) | (uint64_t(light) << 32) | features; }
+};
+
+// 셰이더 변형들을 (메쉬 종류, 조명 종류, 기능 비트) 키로 보관하는 저장소.
+// 셰이더와 그 MaterialBinding 은 힙에 한 번만 만들어지고 주소가 바뀌지 않으므로, get() 이 돌려주는 참조자를 계속 들고 있어도 됨.
+// (예전처럼 ofShader 를 값으로 복사하면 참조 카운트와 유니폼 위치 캐시(std::map)까지 매번 복사됨)
+//
+// 디렉셔널/포인트 라이트, G-버퍼 변형들은 setUberShader() 로 (메쉬, 조명) 조합마다 지정해둔 우버 셰이더 소스에 '#define' 을 붙여서 처음 요청될 때 컴파일함.
+// 링크된 프로그램은 glGetProgramBinary() 로 꺼내서 data/shadercache/ 에 저장해두고, 다음 실행부터는 컴파일 없이 바이너리를 그대로 올림.
+// 캐시 파일 이름은 셰이더 소스 전체 + 드라이버 문자열(GL_VENDOR / GL_RENDERER / GL_VERSION)의 해시이므로,
+// 셰이더를 고치거나 드라이버가 바뀌면 자동으로 다시 컴파일됨.
+//
+// setFragmentPrelude() 로 지정한 공용 GLSL 조각(포인트라이트 그림자 등)은 모든 프래그먼트 셰이더의 '#version' 과 '#define' 줄들 바로 뒤에 붙여줌.
+class ShaderRegistry {
+public:
+    // 모든 프래그먼트 셰이더 앞에 붙일 공용 GLSL 소스를 읽어둠. (setUberShader(), load() 보다 먼저 호출)
+    void setFragmentPrelude(const std::filesystem::path& path);
+
+    // keys 의 (메쉬, 조명) 조합들을 만들 때 사용할 우버 셰이더 소스를 읽어둠. (키의 기능 비트는 무시됨)
+    // 실제 컴파일은 get() 으로 변형이 처음 요청될 때 일어남. (setup() 에서 호출)
+    void setUberShader(std::initializer_list<ShaderKey> keys, const std::filesystem::path& vert, const std::filesystem::path& frag);
+
+    // 셰이더를 로드(링크)하고 바인딩 객체를 준비함. 이미 있는 키면 기존 셰이더를 다시 로드함. (setup() 에서 호출)
+    MaterialBinding& load(const ShaderKey& key, const std::filesystem::path& vert, const std::filesystem::path& frag);
+
+    // 등록된 셰이더의 바인딩 객체를 찾음. 힙 할당 없이 찾기만 하므로 draw() 에서 호출해도 됨.
+    MaterialBinding* find(const ShaderKey& key);
+
+    // 등록되지 않은 키면 우버 셰이더로 변형을 만들어서 등록함.
+    // 우버 셰이더가 지정되지 않은 키(스카이박스, 클러스터드)가 등록되지 않았으면 std::out_of_range 예외
+    MaterialBinding& get(const ShaderKey& key);
+
+    size_t size() const { return entries.size(); }
+
+private:
+    struct Entry {
+        ofShader shader;
+        MaterialBinding binding;
+    };
+
+    struct UberShader {
+        std::string name; // 로그에 출력할 이름 (프래그먼트 셰이더 파일 이름)
+        std::string vert;
+        std::string frag;
+    };
+
+    MaterialBinding& build(const ShaderKey& key, const std::string& vertSource, const std::string& fragSource, const std::string& name);
+    bool compile(ofShader& shader, const std::string& vertSource, const std::string& fragSource, bool retrievable);
+    bool loadBinary(ofShader& shader, const std::filesystem::path& cachePath);
+    void saveBinary(const ofShader& shader, const std::filesystem::path& cachePath);
+    bool binaryCacheSupported();
+    const std::string& getDriverString();
+
+    std::map<uint64_t, std::unique_ptr<Entry>> entries;
+
+    std::map<uint64_t, std::shared_ptr<const UberShader>> uberShaders; // 기능 비트를 뺀 (메쉬, 조명) 키 -> 우버 셰이더 소스
+    std::string fragmentPrelude; // 모든 프래그먼트 셰이더의 헤더 뒤에 붙이는 공용 소스
+    std::string driverString; // 캐시 키에 섞을 드라이버 문자열 (처음 필요할 때 GL 에서 읽어옴)
+    int numBinaryFormats = -1; // GL_NUM_PROGRAM_BINARY_FORMATS (-1: 아직 조회 안함)
+};
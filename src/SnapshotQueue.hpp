@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// 생산자 스레드 하나(시뮬레이션)와 소비자 스레드 하나(렌더링) 사이에서 프레임 스냅샷을 넘겨주는 고정 크기 링버퍼.
+//
+// - 슬롯은 미리 만들어두고 재사용하므로, 스냅샷 안의 std::vector 들은 용량이 한 번 늘어난 뒤로는 다시 할당되지 않음.
+// - 슬롯을 넘겨주는 것은 쓰기/읽기 카운터 두 개의 acquire/release 로만 처리하고, 뮤텍스는 큐가 가득 차거나 비어서
+//   상대편을 기다려야 할 때만 잡음. (기다리는 쪽이 없으면 notify 도 하지 않음)
+// - 스냅샷은 쓴 순서대로 하나도 빠짐없이 읽히므로, 고정 타임스텝인 벤치마크 모드에서도 매번 같은 프레임들이 그려짐.
+// - Capacity 가 3 이면 렌더링 중인 슬롯, 대기 중인 슬롯, 시뮬레이션이 쓰고 있는 슬롯으로 트리플 버퍼링이 됨.
+//   시뮬레이션은 렌더링보다 최대 Capacity - 1 프레임까지 앞서갈 수 있음.
+template <typename T, size_t Capacity = 3>
+class SnapshotQueue {
+public:
+    static_assert(Capacity >= 2, "SnapshotQueue needs at least two slots");
+
+    // 생산자: 비어있는 슬롯을 돌려줌. 큐가 가득 차면 소비자가 슬롯을 돌려줄 때까지 기다리며, close() 되면 nullptr
+    T* beginWrite() {
+        uint64_t write = writeCount.load(std::memory_order_relaxed);
+        if (!wait([&] { return write - readCount.load(std::memory_order_acquire) < Capacity; })) {
+            return nullptr;
+        }
+        return &slots[write % Capacity];
+    }
+
+    // 생산자: beginWrite() 로 받은 슬롯을 다 썼으면 소비자에게 넘겨줌.
+    void endWrite() {
+        writeCount.fetch_add(1, std::memory_order_seq_cst);
+        wake();
+    }
+
+    // 소비자: 가장 오래된 스냅샷을 돌려줌. 큐가 비어있으면 생산자가 넘겨줄 때까지 기다리며, close() 되면 nullptr
+    const T* beginRead() {
+        uint64_t read = readCount.load(std::memory_order_relaxed);
+        if (!wait([&] { return writeCount.load(std::memory_order_acquire) != read; })) {
+            return nullptr;
+        }
+        return &slots[read % Capacity];
+    }
+
+    // 소비자: beginRead() 로 받은 스냅샷을 다 썼으면 생산자가 다시 쓸 수 있도록 돌려줌.
+    void endRead() {
+        readCount.fetch_add(1, std::memory_order_seq_cst);
+        wake();
+    }
+
+    // 기다리고 있는 쪽을 모두 깨우고, 이후의 beginWrite() / beginRead() 가 기다리지 않고 nullptr 을 돌려주게 함. (종료용)
+    void close() {
+        closed.store(true, std::memory_order_seq_cst);
+        std::lock_guard<std::mutex> lock(mutex);
+        condition.notify_all();
+    }
+
+    bool isClosed() const { return closed.load(std::memory_order_acquire); }
+
+    // 읽히기를 기다리는 스냅샷 수 (소비자가 들고 있는 것 포함)
+    size_t size() const {
+        return size_t(writeCount.load(std::memory_order_acquire) - readCount.load(std::memory_order_acquire));
+    }
+
+private:
+    // 조건이 만족되면 true, close() 되면 false. 조건을 먼저 확인하고, 안 되면 waiters 를 올린 뒤 다시 확인하고 잠듦.
+    // (카운터 증가와 waiters 읽기를 모두 seq_cst 로 하므로, 상대편이 카운터를 올리고 waiters 를 0 으로 읽는 경우는
+    //  이쪽이 waiters 를 올리기 전이므로 다시 확인할 때 바뀐 카운터를 보게 됨)
+    template <typename Ready>
+    bool wait(Ready ready) {
+        if (ready()) {
+            return true;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        condition.wait(lock, [&] { return ready() || closed.load(std::memory_order_seq_cst); });
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return ready();
+    }
+
+    void wake() {
+        if (waiters.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            condition.notify_all();
+        }
+    }
+
+    T slots[Capacity];
+    std::atomic<uint64_t> writeCount { 0 }; // 지금까지 넘겨준 스냅샷 수
+    std::atomic<uint64_t> readCount { 0 }; // 지금까지 돌려받은 스냅샷 수
+    std::atomic<int> waiters { 0 };
+    std::atomic<bool> closed { false };
+    std::mutex mutex;
+    std::condition_variable condition;
+};
@@ -0,0 +1,728 @@
+#include "SoftwareRenderer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SOFTWARE_RENDERER_USE_SSE 1
+#endif
+
+namespace {
+float elapsedMs(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// IEEE half -> float (비정규 수, 무한대/NaN 포함)
+float halfToFloat(uint16_t half) {
+    uint32_t sign = uint32_t(half & 0x8000u) << 16;
+    uint32_t exponent = (half >> 10) & 0x1fu;
+    uint32_t mantissa = half & 0x3ffu;
+    uint32_t bits;
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            int shift = -1;
+            do {
+                ++shift;
+                mantissa <<= 1;
+            } while (!(mantissa & 0x400u));
+            bits = sign | (uint32_t(127 - 15 - shift) << 23) | ((mantissa & 0x3ffu) << 13);
+        }
+    } else if (exponent == 31) {
+        bits = sign | 0x7f800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// pow(x, 2^n) 를 제곱 n 번으로 계산함. (uber.frag 의 광택지수 4, 512)
+float powSquared(float x, int n) {
+    for (int i = 0; i < n; ++i) {
+        x *= x;
+    }
+    return x;
+}
+
+glm::vec3 saturate(const glm::vec3& c) {
+    return glm::clamp(c, glm::vec3(0.0f), glm::vec3(1.0f));
+}
+}
+
+//--------------------------------------------------------------
+// Texture
+
+void SoftwareRenderer::Texture::setup(const ofPixels& source, Wrap newWrap) {
+    width = int(source.getWidth());
+    height = int(source.getHeight());
+    wrap = newWrap;
+    floats.clear();
+    unorm.resize(size_t(width) * height * 4);
+
+    size_t channels = source.getNumChannels();
+    const uint8_t* src = source.getData();
+    for (size_t i = 0, count = size_t(width) * height; i < count; ++i) {
+        const uint8_t* texel = src + i * channels;
+        uint8_t* dst = &unorm[i * 4];
+        // GL 에 올릴 때와 같게, 1 채널은 회색조로, 3 채널은 알파 1 로 채움.
+        dst[0] = texel[0];
+        dst[1] = channels >= 3 ? texel[1] : texel[0];
+        dst[2] = channels >= 3 ? texel[2] : texel[0];
+        dst[3] = channels == 4 ? texel[3] : channels == 2 ? texel[1] : 255;
+    }
+}
+
+void SoftwareRenderer::Texture::setupHalfFloat(int newWidth, int newHeight, int channels, const uint16_t* data, Wrap newWrap) {
+    width = newWidth;
+    height = newHeight;
+    wrap = newWrap;
+    unorm.clear();
+    floats.resize(size_t(width) * height * 4); // 크기가 같으면 다시 할당하지 않음. (프레임마다 바다 결과를 옮겨옴)
+
+    for (size_t i = 0, count = size_t(width) * height; i < count; ++i) {
+        const uint16_t* texel = data + i * channels;
+        float* dst = &floats[i * 4];
+        for (int c = 0; c < 4; ++c) {
+            dst[c] = c < channels ? halfToFloat(texel[c]) : c == 3 ? 1.0f : 0.0f;
+        }
+    }
+}
+
+glm::vec4 SoftwareRenderer::Texture::fetch(int x, int y) const {
+    if (wrap == Repeat) {
+        x %= width;
+        y %= height;
+        x += x < 0 ? width : 0;
+        y += y < 0 ? height : 0;
+    } else {
+        x = std::min(std::max(x, 0), width - 1);
+        y = std::min(std::max(y, 0), height - 1);
+    }
+    size_t offset = (size_t(y) * width + x) * 4;
+    if (!floats.empty()) {
+        const float* t = &floats[offset];
+        return glm::vec4(t[0], t[1], t[2], t[3]);
+    }
+    const uint8_t* t = &unorm[offset];
+    return glm::vec4(t[0], t[1], t[2], t[3]) * (1.0f / 255.0f);
+}
+
+// GL_LINEAR 와 같은 규칙: 텍셀 중심이 (i + 0.5) / 크기 에 있음.
+glm::vec4 SoftwareRenderer::Texture::sample(float u, float v) const {
+    if (width == 0) {
+        return glm::vec4(0.0f);
+    }
+    float x = u * width - 0.5f;
+    float y = v * height - 0.5f;
+    float fx = std::floor(x);
+    float fy = std::floor(y);
+    float tx = x - fx;
+    float ty = y - fy;
+    int ix = int(fx);
+    int iy = int(fy);
+    glm::vec4 top = glm::mix(fetch(ix, iy), fetch(ix + 1, iy), tx);
+    glm::vec4 bottom = glm::mix(fetch(ix, iy + 1), fetch(ix + 1, iy + 1), tx);
+    return glm::mix(top, bottom, ty);
+}
+
+//--------------------------------------------------------------
+// Cubemap
+
+void SoftwareRenderer::Cubemap::setup(const ofPixels source[6]) {
+    for (int i = 0; i < 6; ++i) {
+        faces[i].setup(source[i], Texture::Clamp);
+    }
+}
+
+// GL 명세의 큐브맵 면 선택 표와 같은 규칙으로 면과 (s, t) 를 구함.
+glm::vec3 SoftwareRenderer::Cubemap::sample(const glm::vec3& r) const {
+    glm::vec3 a = glm::abs(r);
+    int face;
+    float sc, tc, ma;
+    if (a.x >= a.y && a.x >= a.z) {
+        face = r.x >= 0.0f ? 0 : 1;
+        sc = r.x >= 0.0f ? -r.z : r.z;
+        tc = -r.y;
+        ma = a.x;
+    } else if (a.y >= a.z) {
+        face = r.y >= 0.0f ? 2 : 3;
+        sc = r.x;
+        tc = r.y >= 0.0f ? r.z : -r.z;
+        ma = a.y;
+    } else {
+        face = r.z >= 0.0f ? 4 : 5;
+        sc = r.z >= 0.0f ? r.x : -r.x;
+        tc = -r.y;
+        ma = a.z;
+    }
+    if (ma <= 0.0f) {
+        return glm::vec3(0.0f);
+    }
+    return glm::vec3(faces[face].sample((sc / ma + 1.0f) * 0.5f, (tc / ma + 1.0f) * 0.5f));
+}
+
+//--------------------------------------------------------------
+// SoftwareRenderer
+
+SoftwareRenderer::SoftwareRenderer(size_t threads) {
+    setNumThreads(threads);
+}
+
+size_t SoftwareRenderer::getMaxThreads() {
+    return std::min(MAX_THREADS, size_t(std::max(1u, std::thread::hardware_concurrency())));
+}
+
+void SoftwareRenderer::setNumThreads(size_t threads) {
+    threads = threads == 0 ? getMaxThreads() : std::min(threads, MAX_THREADS);
+    if (threads == numThreads && triangles.size() == threads) {
+        return;
+    }
+    numThreads = threads;
+    pool.reset(); // 기존 워커들을 먼저 종료함.
+    if (numThreads > 1) {
+        pool.reset(new ThreadPool(numThreads - 1));
+    }
+    triangles.resize(numThreads);
+    clipped.resize(numThreads);
+    scratch.resize(numThreads);
+    chunkShaded.resize(numThreads);
+    for (TileScratch& s : scratch) {
+        s.fragments.resize(TILE_SIZE * TILE_SIZE);
+    }
+    bins.clear();
+    width = height = 0; // 다음 beginFrame() 에서 분배 목록을 다시 만듦.
+}
+
+void SoftwareRenderer::parallelFor(size_t count, size_t minChunkSize, const std::function<void(size_t chunk, size_t begin, size_t end)>& body) {
+    if (pool) {
+        pool->parallelFor(count, minChunkSize, body);
+    } else if (count > 0) {
+        body(0, 0, count);
+    }
+}
+
+void SoftwareRenderer::beginFrame(int newWidth, int newHeight, const glm::mat4& newViewProj, const glm::vec3& newCameraPos,
+    const glm::vec3& newLightDir, const glm::vec3& newLightColor, const LightSystem& pointLights) {
+    if (newWidth != width || newHeight != height) {
+        width = newWidth;
+        height = newHeight;
+        tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+        tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+        pixels.allocate(width, height, 4);
+        bins.assign(numThreads * tilesX * tilesY, std::vector<uint32_t>());
+    }
+    viewProj = newViewProj;
+    invViewProj = glm::inverse(viewProj);
+    cameraPos = newCameraPos;
+    lightDir = glm::normalize(newLightDir);
+    lightColor = newLightColor;
+    lightPositions = pointLights.getPositions();
+    lightColors = pointLights.getColors();
+    lightRadii = pointLights.getRadii();
+    skybox = nullptr;
+    draws.clear();
+
+    // 용량은 유지하므로 첫 몇 프레임 이후에는 다시 할당하지 않음.
+    vertices.clear();
+    for (size_t i = 0; i < numThreads; ++i) {
+        triangles[i].clear();
+        clipped[i].clear();
+        scratch[i].lights.reserve(lightPositions.size());
+    }
+    for (std::vector<uint32_t>& bin : bins) {
+        bin.clear();
+    }
+    stats = Stats();
+    stats.threads = numThreads;
+}
+
+void SoftwareRenderer::drawShield(const ofMesh& mesh, const glm::mat4& model, const glm::mat3& normalMatrix,
+    const Texture& diffuse, const Texture& spec, const Texture& normal, const Cubemap& env) {
+    auto start = std::chrono::steady_clock::now();
+    draws.push_back({ Material::Shield, { &diffuse, &spec, &normal }, &env });
+
+    // uber.vert 의 방패 경로 (NORMAL_MAP, 인스턴싱 없음)
+    size_t first = vertices.size();
+    size_t count = mesh.getNumVertices();
+    vertices.resize(first + count);
+    glm::mat4 mvp = viewProj * model;
+    const std::vector<glm::vec3>& positions = mesh.getVertices();
+    const std::vector<glm::vec3>& normals = mesh.getNormals();
+    const std::vector<ofFloatColor>& tangents = mesh.getColors(); // 탄젠트는 버텍스 컬러 자리에 들어있음.
+    const std::vector<glm::vec2>& texCoords = mesh.getTexCoords();
+    parallelFor(count, 1024, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Vertex& v = vertices[first + i];
+            glm::vec4 pos(positions[i], 1.0f);
+            glm::vec3 nrm = i < normals.size() ? normals[i] : glm::vec3(0, 0, 1);
+            glm::vec4 tan = i < tangents.size() ? glm::vec4(tangents[i].r, tangents[i].g, tangents[i].b, tangents[i].a) : glm::vec4(1, 0, 0, 1);
+            glm::vec2 uv = i < texCoords.size() ? texCoords[i] : glm::vec2(0.0f);
+            v.clip = mvp * pos;
+            v.world = glm::vec3(model * pos);
+            v.uv = glm::vec2(uv.x, 1.0f - uv.y);
+            v.tangent = glm::normalize(normalMatrix * glm::vec3(tan));
+            v.bitangent = glm::normalize(normalMatrix * glm::cross(glm::vec3(tan), nrm) * (tan.w < 0.0f ? -1.0f : 1.0f));
+            v.normal = glm::normalize(normalMatrix * nrm);
+        }
+    });
+    submit(mesh, first);
+    stats.geometryMs += elapsedMs(start);
+}
+
+void SoftwareRenderer::drawWater(const ofMesh& mesh, const glm::mat4& model, const Texture& displacement, const Texture& slope, float oceanScale, const Cubemap& env) {
+    auto start = std::chrono::steady_clock::now();
+    draws.push_back({ Material::Water, { &displacement, &slope, nullptr }, &env });
+
+    // uber.vert 의 OCEAN 경로: 변위 전 월드 xz 로 변위맵을 샘플링해서 더함.
+    size_t first = vertices.size();
+    size_t count = mesh.getNumVertices();
+    vertices.resize(first + count);
+    const std::vector<glm::vec3>& positions = mesh.getVertices();
+    parallelFor(count, 1024, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Vertex& v = vertices[first + i];
+            glm::vec3 world = glm::vec3(model * glm::vec4(positions[i], 1.0f));
+            v.uv = glm::vec2(world.x, world.z) * oceanScale;
+            v.world = world + glm::vec3(displacement.sample(v.uv.x, v.uv.y));
+            v.clip = viewProj * glm::vec4(v.world, 1.0f);
+            v.tangent = v.bitangent = v.normal = glm::vec3(0.0f);
+        }
+    });
+    submit(mesh, first);
+    stats.geometryMs += elapsedMs(start);
+}
+
+void SoftwareRenderer::drawSkybox(const Cubemap& env) {
+    skybox = &env;
+}
+
+// 인덱스 순서대로 삼각형을 나눠서 설정하고, 구간별 분배 목록에 넣음.
+void SoftwareRenderer::submit(const ofMesh& mesh, size_t firstVertex) {
+    const std::vector<ofIndexType>& indices = mesh.getIndices();
+    size_t numTriangles = indices.empty() ? mesh.getNumVertices() / 3 : indices.size() / 3;
+    parallelFor(numTriangles, 1024, [&](size_t chunk, size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+            uint32_t i0 = uint32_t(firstVertex + (indices.empty() ? t * 3 : indices[t * 3]));
+            uint32_t i1 = uint32_t(firstVertex + (indices.empty() ? t * 3 + 1 : indices[t * 3 + 1]));
+            uint32_t i2 = uint32_t(firstVertex + (indices.empty() ? t * 3 + 2 : indices[t * 3 + 2]));
+            clipAndSetup(chunk, i0, i1, i2);
+        }
+    });
+}
+
+const SoftwareRenderer::Vertex& SoftwareRenderer::getVertex(size_t chunk, uint32_t id) const {
+    return id & CLIPPED_BIT ? clipped[chunk][id & ~CLIPPED_BIT] : vertices[id];
+}
+
+// 프러스텀 한 평면의 바깥에 세 버텍스가 모두 있으면 버리고, 근평면(z = -w)에 걸치면 잘라서 삼각형 1 ~ 2 개로 만듦.
+// 나머지 평면들은 잘라내지 않고 화면 경계로 픽셀 범위만 제한함. (에지 함수를 double 로 설정하므로 화면 밖 좌표가 커도 정밀도가 충분함)
+void SoftwareRenderer::clipAndSetup(size_t chunk, uint32_t i0, uint32_t i1, uint32_t i2) {
+    uint32_t ids[3] = { i0, i1, i2 };
+    const Vertex* v[3] = { &vertices[i0], &vertices[i1], &vertices[i2] };
+
+    int outside[5] = { 0, 0, 0, 0, 0 };
+    for (const Vertex* p : v) {
+        const glm::vec4& c = p->clip;
+        outside[0] += c.x > c.w;
+        outside[1] += c.x < -c.w;
+        outside[2] += c.y > c.w;
+        outside[3] += c.y < -c.w;
+        outside[4] += c.z > c.w;
+    }
+    for (int count : outside) {
+        if (count == 3) {
+            return;
+        }
+    }
+
+    float d[3];
+    int inside = 0;
+    for (int i = 0; i < 3; ++i) {
+        d[i] = v[i]->clip.z + v[i]->clip.w;
+        inside += d[i] >= 0.0f;
+    }
+    if (inside == 0) {
+        return;
+    }
+    if (inside == 3) {
+        setupTriangle(chunk, v, ids);
+        return;
+    }
+
+    // 교차점은 항상 안쪽 버텍스에서 바깥쪽 버텍스 방향으로 보간해서, 에지를 공유하는 이웃 삼각형과 같은 점이 나오도록 함.
+    auto intersect = [&](int in, int out) {
+        float t = d[in] / (d[in] - d[out]);
+        const Vertex& a = *v[in];
+        const Vertex& b = *v[out];
+        Vertex r;
+        r.clip = glm::mix(a.clip, b.clip, t);
+        r.world = glm::mix(a.world, b.world, t);
+        r.uv = glm::mix(a.uv, b.uv, t);
+        r.tangent = glm::mix(a.tangent, b.tangent, t);
+        r.bitangent = glm::mix(a.bitangent, b.bitangent, t);
+        r.normal = glm::mix(a.normal, b.normal, t);
+        clipped[chunk].push_back(r);
+        return uint32_t(clipped[chunk].size() - 1) | CLIPPED_BIT;
+    };
+
+    // 감기 순서를 유지하면서 다각형(3 ~ 4 개 버텍스)을 만든 뒤 부채꼴로 나눔.
+    uint32_t polygon[4];
+    int n = 0;
+    for (int i = 0; i < 3; ++i) {
+        int j = (i + 1) % 3;
+        if (d[i] >= 0.0f) {
+            polygon[n++] = ids[i];
+        }
+        if ((d[i] >= 0.0f) != (d[j] >= 0.0f)) {
+            polygon[n++] = d[i] >= 0.0f ? intersect(i, j) : intersect(j, i);
+        }
+    }
+    for (int i = 1; i + 1 < n; ++i) {
+        uint32_t tri[3] = { polygon[0], polygon[i], polygon[i + 1] };
+        const Vertex* tv[3] = { &getVertex(chunk, tri[0]), &getVertex(chunk, tri[1]), &getVertex(chunk, tri[2]) };
+        setupTriangle(chunk, tv, tri);
+    }
+}
+
+void SoftwareRenderer::setupTriangle(size_t chunk, const Vertex* v[3], const uint32_t ids[3]) {
+    double sx[3], sy[3], sz[3];
+    float invW[3];
+    for (int i = 0; i < 3; ++i) {
+        const glm::vec4& c = v[i]->clip;
+        double w = 1.0 / double(c.w);
+        invW[i] = float(w);
+        sx[i] = (double(c.x) * w * 0.5 + 0.5) * width;
+        sy[i] = (double(c.y) * w * 0.5 + 0.5) * height;
+        sz[i] = double(c.z) * w * 0.5 + 0.5;
+    }
+
+    Triangle tri;
+    double area = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        int p = (i + 1) % 3;
+        int q = (i + 2) % 3;
+        tri.a[i] = sy[p] - sy[q];
+        tri.b[i] = sx[q] - sx[p];
+        tri.c[i] = sx[p] * sy[q] - sx[q] * sy[p];
+        area += tri.a[i] * sx[i] + tri.b[i] * sy[i] + tri.c[i];
+    }
+    area /= 3.0;
+    if (area == 0.0 || !std::isfinite(area)) {
+        return;
+    }
+    // 면 컬링은 하지 않으므로(GL 경로와 같음) 시계 방향이면 에지 방향만 뒤집음. (부호만 바뀌므로 공유 에지의 값은 정확히 반대가 됨)
+    if (area < 0.0) {
+        area = -area;
+        for (int i = 0; i < 3; ++i) {
+            tri.a[i] = -tri.a[i];
+            tri.b[i] = -tri.b[i];
+            tri.c[i] = -tri.c[i];
+        }
+    }
+    tri.invArea = 1.0 / area;
+    tri.za = tri.zb = tri.zc = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        tri.za += tri.a[i] * sz[i] * tri.invArea;
+        tri.zb += tri.b[i] * sz[i] * tri.invArea;
+        tri.zc += tri.c[i] * sz[i] * tri.invArea;
+        tri.topLeft[i] = tri.a[i] > 0.0 || (tri.a[i] == 0.0 && tri.b[i] > 0.0);
+        tri.invW[i] = invW[i];
+        tri.vertices[i] = ids[i];
+    }
+    tri.draw = uint16_t(draws.size() - 1);
+
+    // 픽셀 중심(i + 0.5)이 들어갈 수 있는 범위
+    double minX = std::min({ sx[0], sx[1], sx[2] });
+    double maxX = std::max({ sx[0], sx[1], sx[2] });
+    double minY = std::min({ sy[0], sy[1], sy[2] });
+    double maxY = std::max({ sy[0], sy[1], sy[2] });
+    tri.minX = int(std::max(0.0, std::ceil(minX - 0.5)));
+    tri.minY = int(std::max(0.0, std::ceil(minY - 0.5)));
+    tri.maxX = int(std::min(double(width - 1), std::floor(maxX - 0.5)));
+    tri.maxY = int(std::min(double(height - 1), std::floor(maxY - 0.5)));
+    if (tri.minX > tri.maxX || tri.minY > tri.maxY) {
+        return;
+    }
+
+    std::vector<Triangle>& list = triangles[chunk];
+    uint32_t id = uint32_t(chunk << CHUNK_SHIFT) | uint32_t(list.size());
+    list.push_back(tri);
+
+    // 경계 상자가 겹치는 타일 중, 타일 안의 픽셀 중심들이 모두 한 에지의 바깥에 있는 타일은 빼고 분배함.
+    size_t numTiles = size_t(tilesX) * tilesY;
+    for (int ty = tri.minY / TILE_SIZE; ty <= tri.maxY / TILE_SIZE; ++ty) {
+        double y0 = std::max(ty * TILE_SIZE, tri.minY) + 0.5;
+        double y1 = std::min(ty * TILE_SIZE + TILE_SIZE - 1, tri.maxY) + 0.5;
+        for (int tx = tri.minX / TILE_SIZE; tx <= tri.maxX / TILE_SIZE; ++tx) {
+            double x0 = std::max(tx * TILE_SIZE, tri.minX) + 0.5;
+            double x1 = std::min(tx * TILE_SIZE + TILE_SIZE - 1, tri.maxX) + 0.5;
+            bool rejected = false;
+            for (int i = 0; i < 3 && !rejected; ++i) {
+                double e = tri.a[i] * (tri.a[i] > 0.0 ? x1 : x0) + tri.b[i] * (tri.b[i] > 0.0 ? y1 : y0) + tri.c[i];
+                rejected = e < 0.0;
+            }
+            if (!rejected) {
+                bins[chunk * numTiles + size_t(ty) * tilesX + tx].push_back(id);
+            }
+        }
+    }
+}
+
+void SoftwareRenderer::endFrame() {
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < numThreads; ++i) {
+        stats.triangles += triangles[i].size();
+        chunkShaded[i] = 0;
+    }
+    for (const std::vector<uint32_t>& bin : bins) {
+        stats.binned += bin.size();
+    }
+
+    // 스레드마다 타일을 하나씩 가져가서 처리함. 타일마다 삼각형 수가 크게 다르므로, 미리 나눠주지 않고 먼저 끝난 스레드가 다음 타일을 가져감.
+    int numTiles = tilesX * tilesY;
+    nextTile = 0;
+    parallelFor(numThreads, 1, [&](size_t chunk, size_t, size_t) {
+        for (int tile = nextTile++; tile < numTiles; tile = nextTile++) {
+            rasterizeTile(chunk, tile);
+        }
+    });
+
+    for (size_t shaded : chunkShaded) {
+        stats.shadedPixels += shaded;
+    }
+    stats.rasterMs = elapsedMs(begin);
+}
+
+void SoftwareRenderer::rasterizeTile(size_t chunk, int tile) {
+    TileScratch& s = scratch[chunk];
+    int x0 = (tile % tilesX) * TILE_SIZE;
+    int y0 = (tile / tilesX) * TILE_SIZE;
+    int x1 = std::min(x0 + TILE_SIZE, width);
+    int y1 = std::min(y0 + TILE_SIZE, height);
+    std::fill(std::begin(s.depth), std::end(s.depth), 1.0f);
+    std::fill(std::begin(s.ids), std::end(s.ids), NO_TRIANGLE);
+
+    // 가시성 패스: 타일 원점 기준으로 에지 함수와 깊이 평면의 상수항을 double 로 옮긴 뒤, 타일 안에서는 float 로 4 x 2 픽셀씩 계산함.
+    size_t numTiles = size_t(tilesX) * tilesY;
+    double ox = x0 + 0.5;
+    double oy = y0 + 0.5;
+    for (size_t c = 0; c < numThreads; ++c) {
+        for (uint32_t id : bins[c * numTiles + tile]) {
+            const Triangle& tri = triangles[id >> CHUNK_SHIFT][id & ((1u << CHUNK_SHIFT) - 1)];
+            float ea[3], eb[3], ec[3];
+            for (int i = 0; i < 3; ++i) {
+                ea[i] = float(tri.a[i]);
+                eb[i] = float(tri.b[i]);
+                ec[i] = float(tri.a[i] * ox + tri.b[i] * oy + tri.c[i]);
+            }
+            float za = float(tri.za);
+            float zb = float(tri.zb);
+            float zc = float(tri.za * ox + tri.zb * oy + tri.zc);
+
+            // 타일 안 좌표. 시작점은 4 x 2 묶음에 맞춰 내림함. (묶음이 타일 밖으로 나가지 않음)
+            int bx0 = (std::max(tri.minX, x0) - x0) & ~3;
+            int by0 = (std::max(tri.minY, y0) - y0) & ~1;
+            int bx1 = std::min(tri.maxX, x1 - 1) - x0;
+            int by1 = std::min(tri.maxY, y1 - 1) - y0;
+
+#ifdef SOFTWARE_RENDERER_USE_SSE
+            __m128 zero = _mm_setzero_ps();
+            __m128 va[3], vb[3], vc[3], tl[3];
+            for (int i = 0; i < 3; ++i) {
+                va[i] = _mm_set1_ps(ea[i]);
+                vb[i] = _mm_set1_ps(eb[i]);
+                vc[i] = _mm_set1_ps(ec[i]);
+                tl[i] = _mm_castsi128_ps(_mm_set1_epi32(tri.topLeft[i] ? -1 : 0));
+            }
+            __m128 vza = _mm_set1_ps(za);
+            __m128 vzb = _mm_set1_ps(zb);
+            __m128 vzc = _mm_set1_ps(zc);
+            __m128i vid = _mm_set1_epi32(int(id));
+            for (int y = by0; y <= by1; y += 2) {
+                for (int x = bx0; x <= bx1; x += 4) {
+                    __m128 px = _mm_setr_ps(float(x), float(x + 1), float(x + 2), float(x + 3));
+                    for (int row = 0; row < 2; ++row) {
+                        __m128 py = _mm_set1_ps(float(y + row));
+                        __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                        for (int i = 0; i < 3; ++i) {
+                            __m128 e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(va[i], px), _mm_mul_ps(vb[i], py)), vc[i]);
+                            __m128 inside = _mm_or_ps(_mm_cmpgt_ps(e, zero), _mm_and_ps(_mm_cmpeq_ps(e, zero), tl[i]));
+                            mask = _mm_and_ps(mask, inside);
+                        }
+                        if (_mm_movemask_ps(mask) == 0) {
+                            continue;
+                        }
+                        int index = (y + row) * TILE_SIZE + x;
+                        __m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vza, px), _mm_mul_ps(vzb, py)), vzc);
+                        __m128 oldZ = _mm_loadu_ps(&s.depth[index]);
+                        mask = _mm_and_ps(mask, _mm_cmplt_ps(z, oldZ));
+                        __m128i imask = _mm_castps_si128(mask);
+                        _mm_storeu_ps(&s.depth[index], _mm_or_ps(_mm_and_ps(mask, z), _mm_andnot_ps(mask, oldZ)));
+                        __m128i oldId = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&s.ids[index]));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(&s.ids[index]), _mm_or_si128(_mm_and_si128(imask, vid), _mm_andnot_si128(imask, oldId)));
+                    }
+                }
+            }
+#else
+            for (int y = by0; y <= by1; ++y) {
+                for (int x = bx0; x <= bx1; ++x) {
+                    bool inside = true;
+                    for (int i = 0; i < 3; ++i) {
+                        float e = ea[i] * float(x) + eb[i] * float(y) + ec[i];
+                        inside = inside && (e > 0.0f || (e == 0.0f && tri.topLeft[i]));
+                    }
+                    int index = y * TILE_SIZE + x;
+                    float z = za * float(x) + zb * float(y) + zc;
+                    if (inside && z < s.depth[index]) {
+                        s.depth[index] = z;
+                        s.ids[index] = id;
+                    }
+                }
+            }
+#endif
+        }
+    }
+
+    shadeTile(chunk, x0, y0, x1, y1);
+}
+
+void SoftwareRenderer::shadeTile(size_t chunk, int x0, int y0, int x1, int y1) {
+    TileScratch& s = scratch[chunk];
+
+    // 1. 보이는 픽셀마다 원근 보정 보간으로 셰이더 입력을 구하고, 타일의 월드공간 경계를 모음.
+    glm::vec3 boundsMin(std::numeric_limits<float>::max());
+    glm::vec3 boundsMax(-std::numeric_limits<float>::max());
+    size_t visible = 0;
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            int index = (y - y0) * TILE_SIZE + (x - x0);
+            uint32_t id = s.ids[index];
+            if (id == NO_TRIANGLE) {
+                continue;
+            }
+            size_t triChunk = id >> CHUNK_SHIFT;
+            const Triangle& tri = triangles[triChunk][id & ((1u << CHUNK_SHIFT) - 1)];
+            double px = x + 0.5;
+            double py = y + 0.5;
+            float w[3];
+            float sum = 0.0f;
+            for (int i = 0; i < 3; ++i) {
+                w[i] = float((tri.a[i] * px + tri.b[i] * py + tri.c[i]) * tri.invArea) * tri.invW[i];
+                sum += w[i];
+            }
+            for (float& weight : w) {
+                weight /= sum;
+            }
+            const Vertex& v0 = getVertex(triChunk, tri.vertices[0]);
+            const Vertex& v1 = getVertex(triChunk, tri.vertices[1]);
+            const Vertex& v2 = getVertex(triChunk, tri.vertices[2]);
+            Fragment& f = s.fragments[index];
+            f.world = v0.world * w[0] + v1.world * w[1] + v2.world * w[2];
+            f.uv = v0.uv * w[0] + v1.uv * w[1] + v2.uv * w[2];
+            f.tangent = v0.tangent * w[0] + v1.tangent * w[1] + v2.tangent * w[2];
+            f.bitangent = v0.bitangent * w[0] + v1.bitangent * w[1] + v2.bitangent * w[2];
+            f.normal = v0.normal * w[0] + v1.normal * w[1] + v2.normal * w[2];
+            f.draw = tri.draw;
+            boundsMin = glm::min(boundsMin, f.world);
+            boundsMax = glm::max(boundsMax, f.world);
+            ++visible;
+        }
+    }
+
+    // 2. 타일의 경계 상자에 닿는 포인트라이트만 고름.
+    s.lights.clear();
+    if (visible > 0) {
+        for (size_t i = 0; i < lightPositions.size(); ++i) {
+            glm::vec3 closest = glm::clamp(lightPositions[i], boundsMin, boundsMax);
+            glm::vec3 d = closest - lightPositions[i];
+            if (glm::dot(d, d) < lightRadii[i] * lightRadii[i]) {
+                s.lights.push_back(uint32_t(i));
+            }
+        }
+    }
+    chunkShaded[chunk] += visible;
+
+    // 3. 셰이딩. 메쉬가 없는 픽셀은 스카이박스(또는 검은색)
+    for (int y = y0; y < y1; ++y) {
+        uint8_t* row = pixels.getData() + (size_t(y) * width + x0) * 4;
+        for (int x = x0; x < x1; ++x, row += 4) {
+            int index = (y - y0) * TILE_SIZE + (x - x0);
+            glm::vec3 color(0.0f);
+            if (s.ids[index] != NO_TRIANGLE) {
+                const Fragment& f = s.fragments[index];
+                const DrawCall& draw = draws[f.draw];
+                color = draw.material == Material::Shield ? shadeShield(f, draw, s.lights) : shadeWater(f, draw, s.lights);
+            } else if (skybox) {
+                // 원평면 위의 점으로 역투영해서 카메라 -> 픽셀 방향을 구함. (skybox.vert 의 fromCam 과 같은 방향)
+                glm::vec4 farPoint = invViewProj * glm::vec4((x + 0.5f) / width * 2.0f - 1.0f, (y + 0.5f) / height * 2.0f - 1.0f, 1.0f, 1.0f);
+                color = saturate(skybox->sample(glm::vec3(farPoint) / farPoint.w - cameraPos));
+            }
+            row[0] = uint8_t(color.x * 255.0f + 0.5f);
+            row[1] = uint8_t(color.y * 255.0f + 0.5f);
+            row[2] = uint8_t(color.z * 255.0f + 0.5f);
+            row[3] = 255;
+        }
+    }
+}
+
+// uber.frag 의 방패 변형 (NORMAL_MAP | ENV_REFLECTION). 라이트마다 [0, 1] 로 자른 뒤 더함. (RGBA8 에 가산 블렌딩하는 멀티패스와 같음)
+glm::vec3 SoftwareRenderer::shadeShield(const Fragment& f, const DrawCall& draw, const std::vector<uint32_t>& lights) const {
+    using namespace glm;
+    vec3 tangentNormal = normalize(vec3(draw.textures[2]->sample(f.uv.x, f.uv.y)) * 2.0f - 1.0f);
+    vec3 normal = normalize(f.tangent * tangentNormal.x + f.bitangent * tangentNormal.y + f.normal * tangentNormal.z);
+    vec3 viewDir = normalize(cameraPos - f.world);
+    vec3 envSample = draw.env->sample(reflect(-viewDir, normal));
+    vec3 diffuseColor = vec3(draw.textures[0]->sample(f.uv.x, f.uv.y));
+    float specMask = draw.textures[1]->sample(f.uv.x, f.uv.y).x;
+
+    auto light = [&](const vec3& dir, const vec3& color, float falloff, bool directional) {
+        float diffAmt = std::max(0.0f, dot(normal, dir)) * falloff;
+        float specAmt = powSquared(std::max(0.0f, dot(normalize(viewDir + dir), normal)), 2) * falloff;
+        vec3 sceneLight = mix(color, envSample + color * 0.5f, 0.5f);
+        vec3 specCol = specMask * sceneLight * specAmt;
+        return saturate(diffuseColor * diffAmt * sceneLight + (directional ? specCol * color : specCol));
+    };
+
+    vec3 result = light(lightDir, lightColor, 1.0f, true);
+    for (uint32_t i : lights) {
+        vec3 toLight = lightPositions[i] - f.world;
+        float distance = length(toLight);
+        float falloff = 1.0f - distance / lightRadii[i];
+        if (falloff > 0.0f && distance > 0.0f) {
+            result += light(toLight / distance, lightColors[i], falloff, false);
+        }
+    }
+    return saturate(result);
+}
+
+// uber.frag 의 물 변형 (OCEAN | ENV_REFLECTION)
+glm::vec3 SoftwareRenderer::shadeWater(const Fragment& f, const DrawCall& draw, const std::vector<uint32_t>& lights) const {
+    using namespace glm;
+    vec4 slope = draw.textures[1]->sample(f.uv.x, f.uv.y);
+    vec3 normal = normalize(vec3(-slope.x, 1.0f, -slope.y));
+    vec3 viewDir = normalize(cameraPos - f.world);
+    vec3 envSample = draw.env->sample(reflect(-viewDir, normal));
+
+    auto light = [&](const vec3& dir, const vec3& color, float falloff) {
+        float diffAmt = std::max(0.0f, dot(normal, dir)) * falloff;
+        float specAmt = powSquared(std::max(0.0f, dot(normalize(viewDir + dir), normal)), 9) * falloff;
+        return saturate(envSample * color * diffAmt + color * specAmt);
+    };
+
+    vec3 result = light(lightDir, lightColor, 1.0f);
+    for (uint32_t i : lights) {
+        vec3 toLight = lightPositions[i] - f.world;
+        float distance = length(toLight);
+        float falloff = 1.0f - distance / lightRadii[i];
+        if (falloff > 0.0f && distance > 0.0f) {
+            result += light(toLight / distance, lightColors[i], falloff);
+        }
+    }
+    return saturate(result);
+}
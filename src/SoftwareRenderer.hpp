@@ -0,0 +1,190 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ThreadPool.hpp"
+#include "LightSystem.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// GPU 가 없는 노드(렌더팜, CI)에서 같은 씬을 그리기 위한 CPU 타일 기반 래스터라이저.
+//
+// 멀티패스 우버 셰이더(uber.vert / uber.frag)의 방패, 물 변형과 스카이박스를 그대로 옮겨서 계산하며,
+// 라이트마다 결과를 [0, 1] 로 자른 뒤 더하므로 RGBA8 프레임버퍼에 가산 블렌딩하는 멀티패스 모드와 같은 색이 나옴.
+//
+// 1. drawShield() / drawWater() : 버텍스 변환을 스레드들이 나눠서 계산한 뒤, 삼각형마다 근평면 클리핑과 에지 함수 설정을 하고
+//    32 x 32 픽셀 타일들에 분배(binning)함. 분배 목록은 스레드(구간)별로 따로 모으므로 잠금이 필요없음.
+// 2. endFrame() : 스레드들이 타일 번호를 원자적 카운터로 하나씩 가져가면서(먼저 끝난 스레드가 남은 타일을 계속 가져감) 처리함.
+//    - 가시성 패스: 4 x 2 픽셀(8 개)씩 SSE 로 에지 함수와 깊이를 계산해서, early-Z(GL_LESS) 를 통과한 픽셀의 깊이와 삼각형 번호만 기록함.
+//    - 셰이딩 패스: 보이는 픽셀마다 원근 보정 보간으로 속성을 구하고, 타일의 월드공간 경계에 닿는 포인트라이트만 골라서 조명을 계산함.
+//      (셰이딩은 픽셀당 한 번뿐이므로 가려진 프래그먼트는 셰이딩하지 않음. 텍스쳐/큐브맵 샘플링이 픽셀마다 다른 주소를 읽으므로 이 패스는 픽셀 단위 스칼라 코드임)
+// 출력 픽셀은 glReadPixels 와 같이 0 번 행이 화면 맨 아래임.
+//
+// beginFrame() 부터 endFrame() 까지 넘겨준 메쉬, 텍스쳐는 살아있어야 함.
+class SoftwareRenderer {
+public:
+    static const int TILE_SIZE = 32;
+
+    // RGBA 텍스쳐. 8비트 이미지는 그대로, half float 데이터는 float 로 바꿔서 보관하고 GL_LINEAR 와 같은 바이리니어 필터로 샘플링함. (밉맵 없음)
+    // 0 번 행이 t = 0 이므로, ofTexture::loadData() 로 올린 GL 텍스쳐와 같은 uv 로 샘플링하면 됨.
+    class Texture {
+    public:
+        enum Wrap { Repeat, Clamp };
+
+        void setup(const ofPixels& pixels, Wrap wrap = Repeat);
+        void setupHalfFloat(int width, int height, int channels, const uint16_t* data, Wrap wrap = Repeat); // OceanSimulation::getCpuData() 배치
+        bool isAllocated() const { return width > 0; }
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+
+        glm::vec4 sample(float u, float v) const;
+
+    private:
+        glm::vec4 fetch(int x, int y) const;
+
+        std::vector<uint8_t> unorm; // 8비트 텍셀 (RGBA)
+        std::vector<float> floats; // float 텍셀 (RGBA)
+        int width = 0;
+        int height = 0;
+        Wrap wrap = Repeat;
+    };
+
+    // 큐브맵. 면 순서와 면별 좌표계는 GL_TEXTURE_CUBE_MAP_POSITIVE_X 부터의 순서 (right, left, top, bottom, front, back)
+    class Cubemap {
+    public:
+        void setup(const ofPixels faces[6]);
+        bool isAllocated() const { return faces[0].isAllocated(); }
+        glm::vec3 sample(const glm::vec3& direction) const;
+
+    private:
+        Texture faces[6];
+    };
+
+    struct Stats {
+        size_t threads = 0;
+        size_t triangles = 0; // 클리핑 후 래스터화 대상 삼각형 수
+        size_t binned = 0; // 타일 분배 항목 수 (삼각형 x 겹치는 타일)
+        size_t shadedPixels = 0; // 셰이딩한 픽셀 수 (early-Z 이후)
+        float geometryMs = 0.0f; // 버텍스 변환 + 삼각형 설정 + 분배
+        float rasterMs = 0.0f; // 타일 래스터화 + 셰이딩
+        float totalMs() const { return geometryMs + rasterMs; }
+    };
+
+    explicit SoftwareRenderer(size_t numThreads = 0); // 0 이면 CPU 코어 개수만큼
+    SoftwareRenderer(const SoftwareRenderer&) = delete;
+    SoftwareRenderer& operator=(const SoftwareRenderer&) = delete;
+
+    void setNumThreads(size_t numThreads); // 호출한 스레드를 포함한 스레드 수 (0 이면 CPU 코어 개수만큼). 프레임 사이에서만 호출할 것.
+    size_t getNumThreads() const { return numThreads; }
+    static size_t getMaxThreads();
+
+    // lightDir 은 표면 -> 라이트 방향 (DirectionalLight::direction 의 반대), lightColor 는 색상 * 강도
+    void beginFrame(int width, int height, const glm::mat4& viewProj, const glm::vec3& cameraPos,
+        const glm::vec3& lightDir, const glm::vec3& lightColor, const LightSystem& pointLights);
+
+    // 방패 재질 (NORMAL_MAP | ENV_REFLECTION)
+    void drawShield(const ofMesh& mesh, const glm::mat4& model, const glm::mat3& normalMatrix,
+        const Texture& diffuse, const Texture& spec, const Texture& normal, const Cubemap& env);
+
+    // 물 재질 (OCEAN | ENV_REFLECTION). displacement, slope 는 월드공간 xz * oceanScale 로 샘플링함.
+    void drawWater(const ofMesh& mesh, const glm::mat4& model, const Texture& displacement, const Texture& slope, float oceanScale, const Cubemap& env);
+
+    // 메쉬가 그려지지 않은 픽셀에 큐브맵을 그림. (그리는 순서와 상관없이 endFrame() 에서 처리됨)
+    void drawSkybox(const Cubemap& env);
+
+    void endFrame();
+
+    const ofPixels& getPixels() const { return pixels; } // RGBA8, 0 번 행이 화면 맨 아래
+    const Stats& getStats() const { return stats; }
+
+private:
+    enum class Material { Shield, Water };
+
+    // 버텍스 셰이더 출력 (uber.vert 의 out 변수들)
+    struct Vertex {
+        glm::vec4 clip;
+        glm::vec3 world;
+        glm::vec2 uv;
+        glm::vec3 tangent, bitangent, normal; // 방패의 TBN 열 (정규화된 값을 보간함)
+    };
+
+    // 래스터화할 삼각형. 에지 함수 e = a * x + b * y + c 는 반대편 버텍스의 무게중심 좌표에 비례함.
+    struct Triangle {
+        double a[3], b[3], c[3]; // 화면 픽셀 좌표 기준 에지 함수 (안쪽이 양수가 되도록 방향을 맞춤)
+        double za, zb, zc; // 창 깊이(0 ~ 1) 평면
+        double invArea; // 1 / (e0 + e1 + e2)
+        float invW[3];
+        uint32_t vertices[3]; // 상위 비트가 켜져 있으면 clipped[chunk] 안의 번호
+        bool topLeft[3]; // 에지 위의 픽셀을 이 삼각형이 가질지 (공유 에지에서 한 쪽만 그리도록)
+        uint16_t draw; // draws 안의 번호
+        int minX, minY, maxX, maxY; // 픽셀 경계 (포함)
+    };
+
+    struct DrawCall {
+        Material material;
+        const Texture* textures[3]; // 방패: diffuse, spec, normal / 물: displacement, slope
+        const Cubemap* env;
+    };
+
+    // 셰이딩 패스에서 보간한 픽셀 입력
+    struct Fragment {
+        glm::vec3 world;
+        glm::vec2 uv;
+        glm::vec3 tangent, bitangent, normal;
+        uint16_t draw;
+    };
+
+    // 타일 하나를 처리하는 스레드별 작업 공간
+    struct TileScratch {
+        float depth[TILE_SIZE * TILE_SIZE];
+        uint32_t ids[TILE_SIZE * TILE_SIZE];
+        std::vector<Fragment> fragments;
+        std::vector<uint32_t> lights; // 이 타일에 닿는 포인트라이트 번호
+    };
+
+    static const uint32_t CLIPPED_BIT = 0x80000000u;
+    static const uint32_t NO_TRIANGLE = 0xffffffffu;
+    static const int CHUNK_SHIFT = 26; // 삼각형 번호 = (구간 << CHUNK_SHIFT) | 구간 안의 번호
+    static const size_t MAX_THREADS = 63; // CHUNK_SHIFT 로 구분할 수 있는 구간 수
+
+    void parallelFor(size_t count, size_t minChunkSize, const std::function<void(size_t chunk, size_t begin, size_t end)>& body);
+    void submit(const ofMesh& mesh, size_t firstVertex); // 삼각형 설정과 분배
+    void setupTriangle(size_t chunk, const Vertex* v[3], const uint32_t ids[3]);
+    void clipAndSetup(size_t chunk, uint32_t i0, uint32_t i1, uint32_t i2);
+    const Vertex& getVertex(size_t chunk, uint32_t id) const;
+    void rasterizeTile(size_t chunk, int tile);
+    void shadeTile(size_t chunk, int x0, int y0, int x1, int y1);
+    glm::vec3 shadeShield(const Fragment& f, const DrawCall& draw, const std::vector<uint32_t>& lights) const;
+    glm::vec3 shadeWater(const Fragment& f, const DrawCall& draw, const std::vector<uint32_t>& lights) const;
+
+    size_t numThreads = 1;
+    std::unique_ptr<ThreadPool> pool; // 호출한 스레드 외의 워커 스레드들 (스레드가 1개면 없음)
+
+    // 프레임 상태
+    int width = 0;
+    int height = 0;
+    int tilesX = 0;
+    int tilesY = 0;
+    glm::mat4 viewProj;
+    glm::mat4 invViewProj;
+    glm::vec3 cameraPos;
+    glm::vec3 lightDir;
+    glm::vec3 lightColor;
+    std::vector<glm::vec3> lightPositions;
+    std::vector<glm::vec3> lightColors;
+    std::vector<float> lightRadii;
+    const Cubemap* skybox = nullptr;
+    std::vector<DrawCall> draws;
+
+    std::vector<Vertex> vertices; // 이번 프레임의 모든 변환된 버텍스
+    std::vector<std::vector<Triangle>> triangles; // 구간별 삼각형
+    std::vector<std::vector<Vertex>> clipped; // 구간별 클리핑으로 새로 생긴 버텍스
+    std::vector<std::vector<uint32_t>> bins; // [구간 * 타일 수 + 타일] 삼각형 번호 목록
+    std::vector<TileScratch> scratch; // 스레드별
+    std::vector<size_t> chunkShaded; // 스레드별 셰이딩한 픽셀 수
+    std::atomic<int> nextTile { 0 };
+
+    ofPixels pixels;
+    Stats stats;
+};
@@ -0,0 +1,329 @@
+#include "TangentGenerator.hpp"
+#include <vector>
+#include <chrono>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TANGENT_USE_SSE 1
+#endif
+
+namespace {
+
+const float DEGENERATE_EPSILON = 1e-12f; // uv 넓이(또는 탄젠트 길이)가 이보다 작으면 degenerate 삼각형으로 보고 건너뜀.
+
+// 구간 하나가 맡는 최소 삼각형(또는 버텍스) 수. 이보다 작은 메쉬는 나눠서 넘기는 비용이 더 크므로 한 스레드에서 처리함.
+const size_t MIN_CHUNK_SIZE = 16384;
+
+// 위치와 uv 를 컴포넌트별 배열로 나눠둔 SoA 입력
+struct MeshSoA {
+    std::vector<float> px, py, pz, u, v;
+};
+
+// 스레드 하나가 담당하는 누적 버퍼 (버텍스별 탄젠트/바이탄젠트 합계)
+struct Accumulator {
+    std::vector<glm::vec3> tan;
+    std::vector<glm::vec3> bitan;
+};
+
+inline void addToVertex(Accumulator& acc, ofIndexType i, float tx, float ty, float tz, float bx, float by, float bz) {
+    acc.tan[i] += glm::vec3(tx, ty, tz);
+    acc.bitan[i] += glm::vec3(bx, by, bz);
+}
+
+// 삼각형 하나의 탄젠트/바이탄젠트를 스칼라 코드로 계산해서 누적함. (SSE 경로의 나머지 삼각형 처리 및 SSE 미지원 CPU 용)
+void accumulateFace(const MeshSoA& m, const ofIndexType* idx, Accumulator& acc) {
+    ofIndexType i0 = idx[0], i1 = idx[1], i2 = idx[2];
+
+    float e1x = m.px[i1] - m.px[i0], e1y = m.py[i1] - m.py[i0], e1z = m.pz[i1] - m.pz[i0];
+    float e2x = m.px[i2] - m.px[i0], e2y = m.py[i2] - m.py[i0], e2z = m.pz[i2] - m.pz[i0];
+    float d1u = m.u[i1] - m.u[i0], d1v = m.v[i1] - m.v[i0];
+    float d2u = m.u[i2] - m.u[i0], d2v = m.v[i2] - m.v[i0];
+
+    float det = d1u * d2v - d2u * d1v;
+    if (std::abs(det) < DEGENERATE_EPSILON) {
+        return; // uv 가 한 점이나 한 선 위에 모여있으면 탄젠트 방향을 정할 수 없음.
+    }
+    float r = 1.0f / det;
+
+    float tx = (d2v * e1x - d1v * e2x) * r, ty = (d2v * e1y - d1v * e2y) * r, tz = (d2v * e1z - d1v * e2z) * r;
+    float bx = (d1u * e2x - d2u * e1x) * r, by = (d1u * e2y - d2u * e1y) * r, bz = (d1u * e2z - d2u * e1z) * r;
+
+    float tLen = std::sqrt(tx * tx + ty * ty + tz * tz);
+    float bLen = std::sqrt(bx * bx + by * by + bz * bz);
+    if (tLen < DEGENERATE_EPSILON || bLen < DEGENERATE_EPSILON) {
+        return; // 위치가 한 선 위에 모여있는 삼각형
+    }
+    tx /= tLen; ty /= tLen; tz /= tLen;
+    bx /= bLen; by /= bLen; bz /= bLen;
+
+    addToVertex(acc, i0, tx, ty, tz, bx, by, bz);
+    addToVertex(acc, i1, tx, ty, tz, bx, by, bz);
+    addToVertex(acc, i2, tx, ty, tz, bx, by, bz);
+}
+
+#ifdef TANGENT_USE_SSE
+// 삼각형 4개를 SSE 레지스터의 4개 레인에 하나씩 올려서 한꺼번에 계산함.
+void accumulateFaces4(const MeshSoA& m, const ofIndexType* idx, Accumulator& acc) {
+    // 인덱스를 따라 SoA 배열에서 각 레인의 값을 모아옴(gather).
+    auto gather = [&](const std::vector<float>& a, int corner) {
+        return _mm_set_ps(a[idx[9 + corner]], a[idx[6 + corner]], a[idx[3 + corner]], a[idx[corner]]);
+    };
+    __m128 e1x = _mm_sub_ps(gather(m.px, 1), gather(m.px, 0));
+    __m128 e1y = _mm_sub_ps(gather(m.py, 1), gather(m.py, 0));
+    __m128 e1z = _mm_sub_ps(gather(m.pz, 1), gather(m.pz, 0));
+    __m128 e2x = _mm_sub_ps(gather(m.px, 2), gather(m.px, 0));
+    __m128 e2y = _mm_sub_ps(gather(m.py, 2), gather(m.py, 0));
+    __m128 e2z = _mm_sub_ps(gather(m.pz, 2), gather(m.pz, 0));
+    __m128 u0 = gather(m.u, 0), v0 = gather(m.v, 0);
+    __m128 d1u = _mm_sub_ps(gather(m.u, 1), u0), d1v = _mm_sub_ps(gather(m.v, 1), v0);
+    __m128 d2u = _mm_sub_ps(gather(m.u, 2), u0), d2v = _mm_sub_ps(gather(m.v, 2), v0);
+
+    __m128 det = _mm_sub_ps(_mm_mul_ps(d1u, d2v), _mm_mul_ps(d2u, d1v));
+    __m128 absDet = _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+    __m128 eps = _mm_set1_ps(DEGENERATE_EPSILON);
+    __m128 valid = _mm_cmpgt_ps(absDet, eps);
+    __m128 r = _mm_div_ps(_mm_set1_ps(1.0f), _mm_or_ps(_mm_and_ps(valid, det), _mm_andnot_ps(valid, _mm_set1_ps(1.0f)))); // degenerate 레인은 1로 나눠서 inf/nan 을 피함.
+
+    __m128 tx = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(d2v, e1x), _mm_mul_ps(d1v, e2x)), r);
+    __m128 ty = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(d2v, e1y), _mm_mul_ps(d1v, e2y)), r);
+    __m128 tz = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(d2v, e1z), _mm_mul_ps(d1v, e2z)), r);
+    __m128 bx = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(d1u, e2x), _mm_mul_ps(d2u, e1x)), r);
+    __m128 by = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(d1u, e2y), _mm_mul_ps(d2u, e1y)), r);
+    __m128 bz = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(d1u, e2z), _mm_mul_ps(d2u, e1z)), r);
+
+    __m128 tLen = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, tx), _mm_mul_ps(ty, ty)), _mm_mul_ps(tz, tz)));
+    __m128 bLen = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(bx, bx), _mm_mul_ps(by, by)), _mm_mul_ps(bz, bz)));
+    valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpgt_ps(tLen, eps), _mm_cmpgt_ps(bLen, eps)));
+
+    // 정규화 후 degenerate 레인은 0으로 만들어서 누적해도 영향이 없도록 함.
+    __m128 tInv = _mm_and_ps(valid, _mm_div_ps(_mm_set1_ps(1.0f), _mm_max_ps(tLen, eps)));
+    __m128 bInv = _mm_and_ps(valid, _mm_div_ps(_mm_set1_ps(1.0f), _mm_max_ps(bLen, eps)));
+
+    alignas(16) float t[3][4], b[3][4];
+    _mm_store_ps(t[0], _mm_mul_ps(tx, tInv));
+    _mm_store_ps(t[1], _mm_mul_ps(ty, tInv));
+    _mm_store_ps(t[2], _mm_mul_ps(tz, tInv));
+    _mm_store_ps(b[0], _mm_mul_ps(bx, bInv));
+    _mm_store_ps(b[1], _mm_mul_ps(by, bInv));
+    _mm_store_ps(b[2], _mm_mul_ps(bz, bInv));
+
+    // 각 레인의 결과를 삼각형의 세 버텍스에 흩뿌려서(scatter) 더함.
+    for (int lane = 0; lane < 4; ++lane) {
+        for (int corner = 0; corner < 3; ++corner) {
+            addToVertex(acc, idx[lane * 3 + corner], t[0][lane], t[1][lane], t[2][lane], b[0][lane], b[1][lane], b[2][lane]);
+        }
+    }
+}
+#endif
+
+} // namespace
+
+void calcTangents(ofMesh& mesh, ThreadPool* pool) {
+    using namespace glm;
+
+    size_t numVertices = mesh.getNumVertices();
+    size_t numFaces = mesh.getNumIndices() / 3;
+    if (numVertices == 0 || numFaces == 0 || mesh.getNumTexCoords() < numVertices) {
+        return;
+    }
+
+    const vec3* vertices = mesh.getVerticesPointer();
+    const vec2* uvs = mesh.getTexCoordsPointer();
+    const vec3* normals = mesh.getNumNormals() >= numVertices ? mesh.getNormalsPointer() : nullptr;
+    const ofIndexType* indices = mesh.getIndexPointer();
+
+    // [0, count) 를 pool 의 구간들로 나눠서 body(chunk, begin, end) 를 실행함. (pool 이 없으면 구간 하나)
+    auto parallelFor = [pool](size_t count, const std::function<void(size_t chunk, size_t begin, size_t end)>& body) {
+        if (pool) {
+            pool->parallelFor(count, MIN_CHUNK_SIZE, body);
+        } else {
+            body(0, 0, count);
+        }
+    };
+    size_t numChunks = pool ? pool->getNumChunks(numFaces, MIN_CHUNK_SIZE) : 1;
+
+    // 1. 위치와 uv 를 컴포넌트별 SoA 배열로 옮겨둠.
+    MeshSoA soa;
+    soa.px.resize(numVertices); soa.py.resize(numVertices); soa.pz.resize(numVertices);
+    soa.u.resize(numVertices); soa.v.resize(numVertices);
+    parallelFor(numVertices, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            soa.px[i] = vertices[i].x; soa.py[i] = vertices[i].y; soa.pz[i] = vertices[i].z;
+            soa.u[i] = uvs[i].x; soa.v[i] = uvs[i].y;
+        }
+    });
+
+    // 2. 삼각형을 구간별로 나눠서 각자의 누적 버퍼에 탄젠트/바이탄젠트를 더함. (버퍼가 따로라서 atomic 이 필요없음)
+    std::vector<Accumulator> partials(numChunks);
+    parallelFor(numFaces, [&](size_t chunk, size_t begin, size_t end) {
+        Accumulator& acc = partials[chunk];
+        acc.tan.assign(numVertices, vec3(0.0f));
+        acc.bitan.assign(numVertices, vec3(0.0f));
+
+        size_t f = begin;
+#ifdef TANGENT_USE_SSE
+        for (; f + 4 <= end; f += 4) {
+            accumulateFaces4(soa, indices + f * 3, acc);
+        }
+#endif
+        for (; f < end; ++f) {
+            accumulateFace(soa, indices + f * 3, acc);
+        }
+    });
+
+    // 3. 버텍스 구간별로 누적 버퍼들을 합친 뒤, 노말벡터 기준으로 직교화하고 handedness 를 구해서 컬러 배열에 바로 써넣음.
+    // 컬러 배열은 addColor() 로 하나씩 늘리지 않고 한 번에 크기를 맞춤. (ofFloatColor 는 float 4개라서 vec4 탄젠트와 메모리 구조가 같음)
+    std::vector<ofFloatColor>& colors = mesh.getColors();
+    colors.resize(numVertices);
+    ofFloatColor* out = colors.data();
+
+    parallelFor(numVertices, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            vec3 t = partials[0].tan[i];
+            vec3 b = partials[0].bitan[i];
+            for (size_t p = 1; p < partials.size(); ++p) {
+                t += partials[p].tan[i];
+                b += partials[p].bitan[i];
+            }
+
+            vec3 n = normals ? normals[i] : cross(t, b);
+            float nLen = length(n);
+            n = nLen > DEGENERATE_EPSILON ? n / nLen : vec3(0, 0, 1);
+
+            // Gram-Schmidt 직교화: 탄젠트에서 노말 방향 성분을 빼서 노말과 수직이 되도록 함.
+            t = t - n * dot(n, t);
+            float tLen = length(t);
+            if (tLen < DEGENERATE_EPSILON) {
+                // 이 버텍스에 연결된 삼각형이 모두 degenerate 였다면, 노말에 수직인 임의의 방향을 탄젠트로 사용함.
+                t = std::abs(n.x) < 0.9f ? cross(n, vec3(1, 0, 0)) : cross(n, vec3(0, 1, 0));
+                tLen = length(t);
+            }
+            t = t / tLen;
+
+            // uv 가 뒤집혀 있는(mirrored) 부분은 바이탄젠트가 cross(N, T) 의 반대 방향을 가리키므로, 그 부호를 w 에 저장함.
+            float w = dot(cross(n, t), b) < 0.0f ? -1.0f : 1.0f;
+            out[i] = ofFloatColor(t.x, t.y, t.z, w);
+        }
+    });
+}
+
+// 예전 방식의 탄젠트 계산 함수 (벤치마크 비교용)
+void calcTangentsReference(ofMesh& mesh) {
+    using namespace glm;
+    std::vector<vec4> tangents;
+    tangents.resize(mesh.getNumVertices());
+
+    uint indexCount = mesh.getNumIndices();
+
+    const vec3* vertices = mesh.getVerticesPointer();
+    const vec2* uvs = mesh.getTexCoordsPointer();
+    const uint* indices = mesh.getIndexPointer();
+
+    for (uint i = 0; i < indexCount - 2; i += 3) {
+        const vec3& v0 = vertices[indices[i]];
+        const vec3& v1 = vertices[indices[i + 1]];
+        const vec3& v2 = vertices[indices[i + 2]];
+        const vec2& uv0 = uvs[indices[i]];
+        const vec2& uv1 = uvs[indices[i + 1]];
+        const vec2& uv2 = uvs[indices[i + 2]];
+
+        vec3 edge1 = v1 - v0;
+        vec3 edge2 = v2 - v0;
+        vec2 dUV1 = uv1 - uv0;
+        vec2 dUV2 = uv2 - uv0;
+
+        float f = 1.0f / (dUV1.x * dUV2.y - dUV2.x * dUV1.y);
+
+        vec4 tan;
+        tan.x = f * (dUV2.y * edge1.x - dUV1.y * edge2.x);
+        tan.y = f * (dUV2.y * edge1.y - dUV1.y * edge2.y);
+        tan.z = f * (dUV2.y * edge1.z - dUV1.y * edge2.z);
+        tan.w = 0;
+        tan = normalize(tan);
+
+        tangents[indices[i]] += (tan);
+        tangents[indices[i + 1]] += (tan);
+        tangents[indices[i + 2]] += (tan);
+    }
+
+    int numColors = mesh.getNumColors();
+
+    for (int i = 0; i < tangents.size(); ++i) {
+        vec3 t = normalize(tangents[i]);
+        if (i >= numColors) {
+            mesh.addColor(ofFloatColor(t.x, t.y, t.z, 0.0));
+        } else {
+            mesh.setColor(i, ofFloatColor(t.x, t.y, t.z, 0.0));
+        }
+    }
+}
+
+namespace {
+
+// 벤치마크용 합성 메쉬: (n + 1) * (n + 1) 버텍스, 2 * n * n 삼각형으로 이뤄진 살짝 울퉁불퉁한 격자
+ofMesh makeBenchmarkGrid(int n) {
+    ofMesh mesh;
+    std::vector<glm::vec3>& vertices = mesh.getVertices();
+    std::vector<glm::vec3>& normals = mesh.getNormals();
+    std::vector<glm::vec2>& uvs = mesh.getTexCoords();
+    std::vector<ofIndexType>& indices = mesh.getIndices();
+    vertices.reserve((n + 1) * (n + 1));
+    normals.reserve((n + 1) * (n + 1));
+    uvs.reserve((n + 1) * (n + 1));
+    indices.reserve(n * n * 6);
+
+    for (int y = 0; y <= n; ++y) {
+        for (int x = 0; x <= n; ++x) {
+            float u = float(x) / n;
+            float v = float(y) / n;
+            vertices.push_back(glm::vec3(u, v, 0.05f * std::sin(u * 40.0f) * std::cos(v * 40.0f)));
+            normals.push_back(glm::vec3(0, 0, 1));
+            uvs.push_back(glm::vec2(u, v));
+        }
+    }
+    for (int y = 0; y < n; ++y) {
+        for (int x = 0; x < n; ++x) {
+            ofIndexType i0 = y * (n + 1) + x;
+            ofIndexType i1 = i0 + 1;
+            ofIndexType i2 = i0 + (n + 1);
+            ofIndexType i3 = i2 + 1;
+            indices.insert(indices.end(), { i0, i1, i2, i1, i3, i2 });
+        }
+    }
+    return mesh;
+}
+
+template<typename Fn>
+double measureMs(const ofMesh& source, int iterations, Fn fn) {
+    double best = 1e30;
+    for (int i = 0; i < iterations; ++i) {
+        ofMesh mesh = source;
+        mesh.getColors().clear(); // 매번 컬러(탄젠트) 배열이 비어있는 상태에서 다시 시작함.
+        auto start = std::chrono::steady_clock::now();
+        fn(mesh);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+void benchmarkMesh(const std::string& name, const ofMesh& mesh, int iterations, ThreadPool* pool) {
+    double reference = measureMs(mesh, iterations, calcTangentsReference);
+    double batched = measureMs(mesh, iterations, [pool](ofMesh& m) { calcTangents(m, pool); });
+    ofLogNotice("benchmarkTangents") << name << " (" << mesh.getNumIndices() / 3 << " triangles): "
+        << "reference " << reference << " ms, batched " << batched << " ms, speedup " << reference / batched << "x";
+}
+
+} // namespace
+
+void benchmarkTangents(const ofMesh& sample, ThreadPool* pool) {
+    ofLogNotice("benchmarkTangents") << "threads: " << (pool ? pool->size() + 1 : 1)
+#ifdef TANGENT_USE_SSE
+        << ", SSE";
+#else
+        << ", scalar";
+#endif
+    benchmarkMesh("sample", sample, 20, pool);
+    benchmarkMesh("grid 1M", makeBenchmarkGrid(708), 3, pool); // 약 100만 개 삼각형
+    benchmarkMesh("grid 4M", makeBenchmarkGrid(1415), 3, pool); // 약 400만 개 삼각형
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ThreadPool.hpp"
+
+// 메쉬의 버텍스별 탄젠트 벡터를 계산해서 버텍스 컬러 자리(셰이더의 location = 1)에 저장하는 함수.
+// 오픈프레임웍스의 ofMesh 에는 탄젠트 어트리뷰트가 따로 없으므로, 기존처럼 컬러 배열을 탄젠트 배열로 사용함.
+//
+// - 삼각형 단위의 탄젠트/바이탄젠트 계산은 SSE 로 4개씩 묶어서 처리함. (SSE 를 지원하지 않는 CPU 에서는 스칼라 코드로 처리)
+// - pool 을 주면 삼각형들을 pool 의 구간(워커 수 + 1 개까지)으로 나눈 뒤, 구간마다 자기 누적 버퍼에 더하고 마지막에 합치므로 atomic 연산이 필요 없음.
+//   (pool 이 없거나 메쉬가 작으면 호출한 스레드에서 모두 처리함)
+// - UV 가 겹쳐서 넓이가 0 인(degenerate) 삼각형은 누적에서 제외함. (기존 함수는 여기서 0으로 나누기가 발생했음)
+// - 최종 탄젠트는 노말벡터에 대해 직교화(Gram-Schmidt)하고, w 컴포넌트에 바이탄젠트 방향 부호(handedness, +1 또는 -1)를 저장함.
+//   셰이더에서는 B = cross(T, N) * tan.w 로 바이탄젠트를 복원함.
+void calcTangents(ofMesh& mesh, ThreadPool* pool = nullptr);
+
+// 예전 방식(스칼라 루프 + addColor)의 탄젠트 계산 함수. 벤치마크 비교용으로만 남겨둠.
+void calcTangentsReference(ofMesh& mesh);
+
+// TANGENT_BENCHMARK 매크로를 정의하고 빌드하면 ofApp::setup() 에서 호출되는 마이크로벤치마크.
+// 인자로 받은 메쉬와 수백만 개의 삼각형으로 이뤄진 합성 메쉬에서 두 함수의 실행시간을 비교해서 로그로 출력함. (calcTangents() 는 pool 로 나눠서 계산함)
+void benchmarkTangents(const ofMesh& sample, ThreadPool* pool);
@@ -0,0 +1,85 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t numThreads) {
+    if (numThreads == 0) {
+        numThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    workers.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    condition.notify_one();
+}
+
+size_t ThreadPool::getNumChunks(size_t count, size_t minChunkSize) const {
+    size_t chunks = (count + std::max<size_t>(minChunkSize, 1) - 1) / std::max<size_t>(minChunkSize, 1);
+    return std::min(chunks, workers.size() + 1);
+}
+
+void ThreadPool::parallelFor(size_t count, size_t minChunkSize, const std::function<void(size_t chunk, size_t begin, size_t end)>& body) {
+    size_t chunks = getNumChunks(count, minChunkSize);
+    if (chunks <= 1) {
+        if (count > 0) {
+            body(0, 0, count);
+        }
+        return;
+    }
+
+    // 남은 구간 수가 0 이 되면 기다리던 호출 스레드를 깨움. (이 함수가 리턴하기 전까지는 스택의 상태를 참조해도 안전함)
+    std::mutex doneMutex;
+    std::condition_variable done;
+    size_t remaining = chunks - 1;
+
+    // 올림한 구간 크기로 자르면 뒤쪽 구간이 count 를 넘어서 시작할 수 있으므로 (예: count 64, 12 구간이면 11 번 구간이 66 ~ 64),
+    // 구간 경계를 count * chunk / chunks 로 고르게 나눠서 모든 구간이 비어있지 않고 [0, count) 를 정확히 덮도록 함. (chunks <= count)
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        size_t begin = count * chunk / chunks;
+        size_t end = count * (chunk + 1) / chunks;
+        submit([&, chunk, begin, end] {
+            body(chunk, begin, end);
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--remaining == 0) {
+                done.notify_one();
+            }
+        });
+    }
+    body(0, 0, count / chunks); // 첫 구간은 호출한 스레드가 직접 처리함.
+
+    std::unique_lock<std::mutex> lock(doneMutex);
+    done.wait(lock, [&] { return remaining == 0; });
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return; // stopping 이면서 남은 작업도 없으면 스레드 종료
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
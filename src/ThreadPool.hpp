@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// 작업(task)을 큐에 넣어두면 미리 만들어둔 워커 스레드들이 꺼내서 실행하는 간단한 스레드 풀.
+// 에셋 디코딩처럼 메인 스레드를 막으면 안 되는 작업들을 여기로 넘겨서 처리함.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t numThreads = 0); // 0 이면 CPU 코어 개수만큼 스레드를 만듦.
+    ~ThreadPool(); // 큐에 남은 작업을 모두 끝낸 뒤 스레드들을 종료함.
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+    size_t size() const { return workers.size(); }
+
+    // [0, count) 를 구간(chunk)들로 나눠서 워커 스레드들과 호출한 스레드가 함께 처리하고, 모두 끝날 때까지 기다림.
+    // 구간은 minChunkSize 개 이상씩, 최대 (워커 수 + 1) 개로 나눔. body(chunk, begin, end) 의 chunk 는 0 ~ getNumChunks() - 1
+    // (큐에 다른 작업이 쌓여있으면 그만큼 늦어지므로, 오래 걸리는 작업을 넣는 풀과는 따로 만들어서 사용할 것)
+    void parallelFor(size_t count, size_t minChunkSize, const std::function<void(size_t chunk, size_t begin, size_t end)>& body);
+    size_t getNumChunks(size_t count, size_t minChunkSize) const;
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+};
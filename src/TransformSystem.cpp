@@ -0,0 +1,49 @@
+#include "TransformSystem.hpp"
+
+int TransformSystem::create(const glm::mat4& local, int parent) {
+    parents.push_back(parent);
+    flags.push_back(LocalDirty);
+    locals.push_back(local);
+    worlds.push_back(glm::mat4(1.0f));
+    normalMatrices.push_back(glm::mat3(1.0f));
+    mvps.push_back(glm::mat4(1.0f));
+    return int(locals.size()) - 1;
+}
+
+void TransformSystem::setLocal(int object, const glm::mat4& local) {
+    if (locals[object] != local) {
+        locals[object] = local;
+        flags[object] |= LocalDirty;
+    }
+}
+
+void TransformSystem::update(const glm::mat4& viewProj) {
+    stats = Stats();
+    stats.objects = uint32_t(locals.size());
+
+    // 1. 월드행렬 + 노말행렬: 배열 순서대로 훑으면서 자신의 로컬행렬이나 부모의 월드행렬이 바뀐 오브젝트만 다시 계산함.
+    for (size_t i = 0; i < locals.size(); ++i) {
+        int parent = parents[i];
+        bool dirty = (flags[i] & LocalDirty) || (parent >= 0 && (flags[parent] & WorldChanged));
+        if (!dirty) {
+            flags[i] = 0;
+            continue;
+        }
+        worlds[i] = parent >= 0 ? worlds[parent] * locals[i] : locals[i];
+
+        // 노말행렬은 '모델행렬의 상단 3*3 역행렬의 전치행렬'. 이동 성분은 노말에 영향이 없으므로 4x4 대신 3x3 역행렬만 구함.
+        normalMatrices[i] = glm::transpose(glm::inverse(glm::mat3(worlds[i])));
+        flags[i] = WorldChanged;
+        stats.worldUpdates++;
+    }
+
+    // 2. mvp: 카메라가 움직였으면 전부, 아니면 월드행렬이 바뀐 오브젝트만 다시 곱함.
+    bool cameraChanged = viewProj != this->viewProj;
+    this->viewProj = viewProj;
+    for (size_t i = 0; i < locals.size(); ++i) {
+        if (cameraChanged || (flags[i] & WorldChanged)) {
+            mvps[i] = viewProj * worlds[i];
+            stats.mvpUpdates++;
+        }
+    }
+}
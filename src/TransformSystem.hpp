@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ofMain.h"
+#include <cstdint>
+#include <vector>
+
+// 씬 오브젝트들의 변환행렬(월드, mvp, 노말행렬)을 프레임마다 한 번씩만 계산해서 캐시해두는 클래스.
+//
+// - 오브젝트는 create() 로 만들고, 부모를 지정하면 부모의 월드행렬 * 자신의 로컬행렬이 월드행렬이 됨.
+//   부모는 항상 자식보다 먼저 만들어지므로, 배열 순서대로 한 번만 훑으면 부모가 자식보다 먼저 갱신됨.
+// - setLocal() 은 더티 플래그만 세워두고, 실제 계산은 update() 에서 몰아서 함.
+//   월드/노말행렬은 자신 또는 조상의 로컬행렬이 바뀐 오브젝트만, mvp 는 월드행렬이나 투영 * 뷰 행렬이 바뀐 오브젝트만 다시 계산함.
+// - 행렬들은 오브젝트 구조체 배열이 아니라 종류별 배열(SoA)에 나눠서 저장하므로, 갱신 루프는 필요한 배열만 연속으로 읽고 씀.
+// 그리는 함수들(drawWater(), drawShield() 등)은 라이트 패스마다 행렬을 다시 계산하지 않고 여기서 캐시된 값을 가져다 씀.
+class TransformSystem {
+public:
+    // 직전 update() 에서 다시 계산한 행렬 개수
+    struct Stats {
+        uint32_t objects = 0;
+        uint32_t worldUpdates = 0; // 월드행렬 + 노말행렬
+        uint32_t mvpUpdates = 0;
+    };
+
+    // 오브젝트를 만들고 번호를 리턴함. parent 가 -1 이면 루트 오브젝트.
+    int create(const glm::mat4& local = glm::mat4(1.0f), int parent = -1);
+    void setLocal(int object, const glm::mat4& local);
+
+    // 더티 플래그가 선 오브젝트들의 행렬을 다시 계산함. draw() 에서 투영/뷰 행렬을 구한 직후 한 번 호출.
+    void update(const glm::mat4& viewProj);
+
+    const glm::mat4& getLocal(int object) const { return locals[object]; }
+    const glm::mat4& getWorld(int object) const { return worlds[object]; }
+    const glm::mat4& getMvp(int object) const { return mvps[object]; }
+    const glm::mat3& getNormalMatrix(int object) const { return normalMatrices[object]; }
+    size_t size() const { return locals.size(); }
+    const Stats& getStats() const { return stats; }
+
+private:
+    enum Flags : uint8_t {
+        LocalDirty = 1 << 0, // 로컬행렬이 바뀜 -> 월드/노말행렬 재계산
+        WorldChanged = 1 << 1 // 이번 update() 에서 월드행렬이 바뀜 -> 자식들과 mvp 재계산
+    };
+
+    std::vector<int> parents;
+    std::vector<uint8_t> flags;
+    std::vector<glm::mat4> locals;
+    std::vector<glm::mat4> worlds;
+    std::vector<glm::mat3> normalMatrices;
+    std::vector<glm::mat4> mvps;
+
+    glm::mat4 viewProj = glm::mat4(0.0f); // 직전 update() 의 투영 * 뷰 행렬 (처음에는 어떤 행렬과도 다르도록 0으로 둠)
+    Stats stats;
+};
@@ -1,8 +1,57 @@
 #include "ofMain.h"
 #include "ofApp.h"
+#include "MeshCache.hpp"
+#include "CubemapBuilder.hpp"
+#include "Benchmark.hpp"
+#include "ofAppNoWindow.h"
 
 //========================================================================
-int main( ){
+int main(int argc, char* argv[]){
+    // 오프라인 메쉬 변환기: 'variableMultiLight --build-mesh-cache plane.ply shield.ply ...' 처럼 실행하면
+    // 윈도우를 열지 않고 data 폴더의 PLY 파일들을 바이너리 메쉬 캐시(.meshcache)로 변환한 뒤 종료함.
+    if (argc > 1 && std::string(argv[1]) == "--build-mesh-cache") {
+        bool ok = true;
+        ThreadPool pool; // 탄젠트 계산을 나눠서 할 워커 스레드들
+        for (int i = 2; i < argc; ++i) {
+            ok = MeshCache::build(argv[i], &pool) && ok;
+        }
+        return ok ? 0 : 1;
+    }
+    
+    // 오프라인 큐브맵 변환기: 'variableMultiLight --build-cubemap night.ktx right.jpg left.jpg top.jpg bottom.jpg front.jpg back.jpg' 처럼 실행하면
+    // 6면 이미지를 밉맵 체인까지 포함된 BC1 압축 KTX 파일로 변환한 뒤 종료함.
+    if (argc > 1 && std::string(argv[1]) == "--build-cubemap") {
+        if (argc != 9) {
+            ofLogError() << "usage: --build-cubemap out.ktx right left top bottom front back";
+            return 1;
+        }
+        std::filesystem::path faces[6];
+        for (int i = 0; i < 6; ++i) {
+            faces[i] = argv[3 + i];
+        }
+        return CubemapBuilder::buildKTX(argv[2], faces) ? 0 : 1;
+    }
+    
+    // 벤치마크 모드: 'variableMultiLight --benchmark frames=600 lights=256 mode=clustered png=60 out=bench/run' 처럼 실행하면
+    // 윈도우를 숨긴 채 FBO 에 정해진 프레임 수만큼 그리면서 프레임 시간을 기록한 뒤 종료함. (옵션은 Benchmark.hpp 참고)
+    Benchmark::Settings benchmarkSettings;
+    if (Benchmark::parseArgs(argc, argv, benchmarkSettings)) {
+        if (benchmarkSettings.backend == "software") {
+            // GPU 가 없는 노드: GL 컨텍스트를 만들지 않는 윈도우로 실행하고, ofApp 은 SoftwareRenderer 로만 그림.
+            ofSetupOpenGL(std::make_shared<ofAppNoWindow>(), benchmarkSettings.width, benchmarkSettings.height, OF_WINDOW);
+        } else {
+            ofGLFWWindowSettings glSettings;
+            glSettings.setSize(benchmarkSettings.width, benchmarkSettings.height);
+            glSettings.setGLVersion(4, 1);
+            glSettings.visible = false;
+            ofCreateWindow(glSettings);
+        }
+        
+        ofApp* app = new ofApp();
+        app->benchmark.configure(benchmarkSettings);
+        return ofRunApp(app);
+    }
+    
     // 아래 5줄은 초기의 main() 함수에서 원하는 버전의 OpenGL 을 사용하기 위해 수정해줘야 하는 부분들
     ofGLWindowSettings glSettings;
     glSettings.setSize(1024, 768);
@@ -1,84 +1,29 @@
 #include "ofApp.h"
-#include <vector> // calcTangents() 함수에서 동적 배열인 std::vector 컨테이너 클래스 템플릿을 사용하기 위해 해당 클래스를 include 시킴.
-
-// 탄젠트 벡터 계산 후, 메쉬의 버텍스 컬러 데이터에 임시로 저장해두는 함수
-void calcTangents(ofMesh& mesh) { // mesh 함수인자는 'ofMesh' 타입을 참조한다는 뜻. (diffuse-lighting 레포지토리 참조자 관련 설명 참고)
-    using namespace glm;
-    std::vector<vec4> tangents; // c++ 에 정의된 표준 라이브러리 사용 시, std:: 접두어를 항상 붙여주도록 함. 여기서는 동적 배열인 std::vector 컨테이너 클래스 템플릿을 사용함.
-    tangents.resize(mesh.getNumVertices()); // 버텍스 개수만큼 탄젠트 벡터를 담는 동적 배열의 길이 생성
-    
-    uint indexCount = mesh.getNumIndices(); // 버텍스의 인덱스 개수만큼 인덱스 카운트 개수 지정
-    
-    const vec3* vertices = mesh.getVerticesPointer();
-    const vec2* uvs = mesh.getTexCoordsPointer();
-    const uint* indices = mesh.getIndexPointer();
-    
-    for (uint i = 0; i < indexCount - 2; i += 3) {
-        // 3개의 인접한 버텍스들 -> 즉, 하나의 삼각형 안의 3개의 버텍스들의 위치데이터와 uv데이터를 각각 구함
-        // 왜 삼각형일까? 삼각형만이 온전한 평면을 구성하고, 같은 평면안에 존재한다면 탄젠트 공간 내의 탄젠트 벡터도 동일한 걸 공유한다고 가정하기 때문인 것 같음.
-        // 왜냐, 같은 평면 안에 존재하는 버텍스라면, 그 버텍스들은 동일한 노말벡터를 공유하기 때문에, 탄젠트 벡터도 동일하다고 봄.
-        const vec3& v0 = vertices[indices[i]];
-        const vec3& v1 = vertices[indices[i + 1]];
-        const vec3& v2 = vertices[indices[i + 2]];
-        const vec2& uv0 = uvs[indices[i]];
-        const vec2& uv1 = uvs[indices[i + 1]];
-        const vec2& uv2 = uvs[indices[i + 2]];
-        
-        // v0 버텍스에 연결된 2개의 선분(벡터)을 구함 -> 3차원 공간 상의 선분(벡터)
-        vec3 edge1 = v1 - v0; // 선분(벡터)1
-        vec3 edge2 = v2 - v0; // 선분(벡터)2
-        // v0 버텍스의 uv좌표에 연결된 uv좌표계 상의 2개의 선분(벡터)도 구함 (아마 distance UV 의 줄임말인 듯.) -> 2차원 공간(uv좌표계) 상의 선분(벡터)
-        vec2 dUV1 = uv1 - uv0; // uv좌표계 선분1
-        vec2 dUV2 = uv2 - uv0; // uv좌표계 선분2
-        
-        // 위에서 구한 두 벡터를 기저 벡터로 삼아(?) 탄젠트 벡터를 구하는 과정같음.. (아직 자세히는 모르겠음ㅜ)
-        float f = 1.0f / (dUV1.x * dUV2.y - dUV2.x * dUV1.y);
-        
-        vec4 tan;
-        tan.x = f * (dUV2.y * edge1.x - dUV1.y * edge2.x);
-        tan.y = f * (dUV2.y * edge1.y - dUV1.y * edge2.y);
-        tan.z = f * (dUV2.y * edge1.z - dUV1.y * edge2.z);
-        tan.w = 0;
-        tan = normalize(tan); // 계산한 탄젠트 벡터를 정규화하여 길이를 1로 맞춤.
-        
-        // 서로 인접하는 3개의 버텍스, 즉 한 삼각형 안의 버텍스들은 모두 동일한 탄젠트 벡터를 갖도록
-        // tangents 동적배열에 인접한 3개의 인덱스에 동일한 탄젠트 벡터를 넣어줌..
-        tangents[indices[i]] += (tan);
-        tangents[indices[i + 1]] += (tan);
-        tangents[indices[i + 2]] += (tan);
-    }
-    
-    int numColors = mesh.getNumColors(); // 오픈프레임웍스가 버텍스 탄젠트 데이터를 지원하지 않아서 버텍스 컬러데이터에 대신 넣어주려는 것.
-
-    for (int i = 0; i < tangents.size(); ++i) {
-        vec3 t = normalize(tangents[i]); // 위에 반복문에서 저장해 둔 각 인덱스의 탄젠트 벡터를 가져온 뒤, vec3에 할당함으로써 각 탄젠트벡터의 x, y, z 컴포넌트만 가져옴.
-        
-        // 탄젠트벡터 데이터가 컬러데이터와 개수가 안맞을 수 있기 때문에,
-        // i가 전체 컬러데이터 수보다 적으면 기존 i번쩨 컬러데이터를 setColor() 로 탄젠트 벡터 데이터로 덮어쓰고,
-        // i가 전체 컬러데이터 수보다 크다면, addColor() 로 탄젠트 벡터 데이터를 전달해서 컬러데이터를 새로 추가함.
-        if (i >= numColors) {
-            mesh.addColor(ofFloatColor(t.x, t.y, t.z, 0.0));
-        } else {
-            mesh.setColor(i, ofFloatColor(t.x, t.y, t.z, 0.0));
-        }
-    }
-}
+#include "TangentGenerator.hpp" // 메쉬의 탄젠트 벡터를 계산해서 버텍스 컬러 자리에 저장하는 calcTangents() 함수
+#include "MeshCache.hpp" // 파싱 및 탄젠트 계산이 끝난 메쉬를 바이너리 캐시로 저장/로드하는 모듈
+#include "AllocationCounter.hpp" // draw() 에서 힙 할당이 일어나는지 확인하기 위한 할당 카운터
+#include "Profiler.hpp" // PROFILER 매크로를 정의하고 빌드했을 때만 동작하는 구간별 CPU/GPU 프로파일러
+#include "MeshOptimizer.hpp" // 물 격자 메쉬의 인덱스 순서를 버텍스 캐시에 맞게 정렬하기 위한 최적화 함수
+#include <random> // 인스턴스 배치를 고정된 시드로 만들기 위한 std::mt19937
 
 // 조명계산 최적화를 위해, 쉐이더에서 반복계산하지 않도록, c++ 에서 한번만 계산해줘도 되는 작업들을 수행하는 보조함수들
-glm::vec3 getLightDirection(DirectionalLight& l) {
+glm::vec3 getLightDirection(const DirectionalLight& l) {
     // 조명벡터 direction에 -1을 곱해서 조명벡터의 방향을 뒤집어주고, 셰이더에서 내적계산을 해주기 위해 길이를 1로 정규화해서 맞춰줌.
     return glm::normalize(l.direction * -1.0f);
 }
 
-glm::vec3 getLightColor(DirectionalLight& l) {
+glm::vec3 getLightColor(const DirectionalLight& l) {
     // 디렉셔널라이트 구조체에서 vec3 값인 조명색상에 float 값인 조명강도를 스칼라배로 곱해줘서 조명색상의 밝기를 지정함.
     return l.color * l.intensity;
 }
 
-glm::vec3 getLightColor(PointLight& l) {
-    // 포인트라이트 구조체에서 vec3 값인 조명색상에 float 값인 조명강도를 스칼라배로 곱해줘서 조명색상의 밝기를 지정함.
-    return l.color * l.intensity;
-}
+// 멀티패스 우버 셰이더에서 메쉬마다 켜는 기능 비트
+const uint32_t SHIELD_FEATURES = NormalMap | EnvReflection;
+const uint32_t WATER_FEATURES = EnvReflection | Ocean;
+
+// 카메라 원근투영의 근평면, 원평면. 시뮬레이션 컬링, 화면 렌더링, 클러스터 분할, 소프트웨어 렌더러가 모두 같은 값을 써야 함.
+const float NEAR_PLANE = 0.01f;
+const float FAR_PLANE = 10.0f;
 
 //--------------------------------------------------------------
 void ofApp::setup(){
@@ -88,87 +33,438 @@ void ofApp::setup(){
     // 이번에는 ofApp 맨 처음 설정에서 shieldMesh 를 바라보기 적당한 카메라 위치와 시야각을 지정함.
     cam.pos = glm::vec3(0, 0.75f, 1.0f); // 카메라 위치는 z축으로 1.0만큼 안쪽으로 들어가게 하고, 조명 연산 결과를 확인하기 위해 y축으로도 살짝 올려줌
     cam.fov = glm::radians(90.0f); // 원근 프러스텀의 시야각은 일반 PC 게임에서는 90도 전후의 값을 사용함. -> 라디안 각도로 변환하는 glm 내장함수 radians() 를 사용함.
+    
+    // 'backend=software' 벤치마크는 GL 컨텍스트 없이(ofAppNoWindow) 실행되므로, 아래에서 GL 객체를 만드는 부분은 모두 건너뛰고 CPU 데이터만 준비함.
+    gpuAvailable = !(benchmark.isEnabled() && benchmark.isSoftware());
+    softwareBackend = !gpuAvailable;
         
-    planeMesh.load("plane.ply"); // planeMesh 메쉬로 사용할 모델링 파일 로드
-    calcTangents(planeMesh); // plane 메쉬의 버텍스들을 이용해서 각 버텍스의 탄젠트 벡터를 구한 뒤 버텍스 컬러데이터 자리에 저장하는 함수 실행
-        
-    shieldMesh.load("shield.ply"); // shieldMesh 메쉬로 사용할 모델링 파일 로드
-    calcTangents(shieldMesh); // shield 메쉬에 탄젠트 벡터를 구한 뒤 버텍스 컬러 자리에 저장하는 함수 실행
+    // 모델링 파일은 MeshCache 를 통해 로드함. 처음 실행할 때(또는 원본 .ply 가 바뀌었을 때)만 PLY 를 파싱하고 탄젠트를 계산해서
+    // 바이너리 캐시 파일(.meshcache)로 저장해두고, 그 다음부터는 캐시 파일을 메모리 매핑해서 버텍스 스트림을 통째로 가져옴.
+    // 탄젠트 벡터는 캐시 안에 버텍스 컬러데이터 자리로 이미 들어있으므로 calcTangents() 를 다시 호출할 필요가 없음.
+    // 캐시에 들어있는 메쉬는 이미 최적화(버텍스 병합, 캐시/오버드로우 순서 정렬)가 끝난 상태이고, GPU 로 올릴 때 압축 포맷으로 변환함.
+    ofMesh loaded;
+    MeshCache::load("shield.ply", loaded, true, &lightWorkers); // shieldMesh 메쉬로 사용할 모델링 파일 로드 (캐시를 다시 만들 때는 탄젠트 계산을 워커 스레드들과 나눠서 함)
+    if (gpuAvailable) {
+        shieldMesh.setup(loaded);
+    } else {
+        shieldMesh.setupCpu(loaded);
+    }
+    
+    // 물 표면은 바다 변위맵으로 버텍스를 움직이므로, 사각형 하나짜리 plane.ply 대신 촘촘한 격자를 만들어서 씀. (plane.ply 와 같은 xy 평면 [-1, 1] 범위)
+    // 255 x 255 버텍스면 16비트 인덱스 범위에 들어감. 격자는 런타임에 만들므로 MeshCache 를 거치지 않고 여기서 바로 최적화함.
+    ofMesh waterGrid = ofMesh::plane(2.0f, 2.0f, 255, 255, OF_PRIMITIVE_TRIANGLES);
+    MeshOptimizer::optimize(waterGrid);
+    calcTangents(waterGrid, &lightWorkers);
+    if (gpuAvailable) {
+        waterMesh.setup(waterGrid);
+    } else {
+        waterMesh.setupCpu(waterGrid);
+    }
+    
+    // 바다 시뮬레이션. 변위맵/기울기맵 텍스쳐와 PBO 를 만들고 스펙트럼을 계산해둠. (시뮬레이션 자체는 update() 에서 전용 스레드로 돌아감)
+    // GL 이 없으면 텍스쳐 대신 CPU 버퍼에 결과를 남겨두고 renderSoftware() 가 읽어감.
+    ocean.setUseTextures(gpuAvailable);
+    ocean.setup(OceanSimulation::Settings());
     
-    cubeMesh.load("cube.ply"); // cubeMesh 메쉬로 사용할 모델링 파일 로드
+#ifdef TANGENT_BENCHMARK
+    benchmarkTangents(shieldMesh.getMesh(), &lightWorkers); // 탄젠트 계산 함수 벤치마크 (TANGENT_BENCHMARK 매크로를 정의하고 빌드했을 때만 실행됨)
+#endif
+    
+    MeshCache::load("cube.ply", cubeMesh, false); // cubeMesh 메쉬로 사용할 모델링 파일 로드 (스카이박스는 노말맵을 쓰지 않으므로 탄젠트는 필요없음)
+    
+    // 디퍼드 모드의 라이트 볼륨. 면 80개짜리 icosphere 는 면까지의 거리가 반경의 약 0.934 배뿐이므로,
+    // 반경을 1.08 로 키워서 라이트 구체(반경 1)를 완전히 감싸도록 함.
+    lightVolumeMesh = ofMesh::icosphere(1.08f, 1);
+    screenQuadMesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
+    screenQuadMesh.addVertices({ { -1, -1, 0 }, { 1, -1, 0 }, { -1, 1, 0 }, { 1, 1, 0 } }); // 정규화 장치 좌표 그대로 사용함.
 
-    dirLightShaders[0].load("mesh.vert", "dirLight.frag"); // 방패메쉬에 적용할 디렉셔널 라이트 쉐이더 파일 로드
-    pointLightShaders[0].load("mesh.vert", "pointLight.frag"); // 방패메쉬에 적용할 포인트라이트 쉐이더 파일 로드
+    // 멀티패스 디렉셔널/포인트라이트 셰이더들은 우버 셰이더 하나에서 '#define' 으로 만들어냄.
+    // 여기서는 소스만 읽어두고, 각 변형은 buildDrawPackets() 에서 처음 요청될 때 컴파일(또는 바이너리 캐시에서 로드)됨.
+    if (gpuAvailable) {
+        shaders.setFragmentPrelude("pointShadow.glsl"); // 포인트라이트 그림자 함수는 여러 조명 셰이더가 같이 쓰므로 한 파일에만 두고 모든 프래그먼트 셰이더 앞에 붙임.
+        shaders.setUberShader({ { MeshType::Shield, LightType::Directional }, { MeshType::Shield, LightType::Point },
+            { MeshType::Water, LightType::Directional }, { MeshType::Water, LightType::Point } }, "uber.vert", "uber.frag");
     
-    dirLightShaders[1].load("water.vert", "dirLightWater.frag"); // plane 메쉬에 적용할 디렉셔널 라이트 쉐이더 파일 로드
-    pointLightShaders[1].load("water.vert", "pointLightWater.frag"); // plane 메쉬에 적용할 포인트라이트 쉐이더 파일 로드
+        // 디퍼드 모드의 G-버퍼 패스는 같은 버텍스 셰이더에 재질만 기록하는 프래그먼트 셰이더를, 조명 패스는 라이트 볼륨용 셰이더를 사용함.
+        shaders.setUberShader({ { MeshType::Shield, LightType::GBuffer }, { MeshType::Water, LightType::GBuffer } }, "uber.vert", "gbuffer.frag");
+        shaders.setUberShader({ { MeshType::LightVolume, LightType::Directional }, { MeshType::LightVolume, LightType::Point } }, "deferredLight.vert", "deferredLight.frag");
+        shaders.setUberShader({ { MeshType::Shield, LightType::DepthOnly }, { MeshType::Water, LightType::DepthOnly } }, "depthOnly.vert", "depthOnly.frag"); // 깊이 프리패스
+        shaders.setUberShader({ { MeshType::Shield, LightType::Shadow }, { MeshType::Water, LightType::Shadow } }, "depthOnly.vert", "depthOnly.frag"); // 포인트라이트 셰도우맵
+    
+        shaders.load({ MeshType::Shield, LightType::Clustered }, "mesh.vert", "clusteredLight.frag"); // 방패메쉬에 적용할 클러스터드 라이팅 쉐이더 파일 로드
+        shaders.load({ MeshType::Water, LightType::Clustered }, "water.vert", "clusteredLightWater.frag"); // plane 메쉬에 적용할 클러스터드 라이팅 쉐이더 파일 로드
+        lightBuffer.setup(); // 포인트라이트 데이터를 올려둘 텍스쳐 버퍼 생성
+        lightClusters.setup(); // 클러스터드 모드에서 사용할 클러스터 버퍼 생성
+    }
     
-    skyboxShader.load("skybox.vert", "skybox.frag"); // cubeMesh 에 큐브맵 텍스쳐를 적용한 셰이더를 적용하기 위한 셰이더 파일 로드
+    // 메쉬들의 모델행렬은 여기서 한 번만 지정하고, 월드/mvp/노말행렬은 draw() 에서 transforms.update() 가 바뀐 것만 다시 계산함.
+    // waterMesh 는 x축 기준으로 -90도 회전시킨 뒤 크기를 키우고 (열 우선 행렬이므로 회전행렬 * 크기행렬 순으로 곱함), shieldMesh 는 위로 살짝 올려줌.
+    waterTransform = transforms.create(glm::rotate(glm::radians(-90.0f), glm::vec3(1, 0, 0)) * glm::scale(glm::vec3(5.0, 4.0, 4.0)));
+    shieldTransform = transforms.create(glm::translate(glm::vec3(0.0, 0.75, 0.0f)));
+    skyboxTransform = transforms.create();
+    transforms.update(glm::mat4(1.0f)); // 아래의 라이트 컬링 등록에서 월드행렬을 사용하기 위해 미리 한 번 계산해둠.
+    
+    // 멀티패스 모드의 라이트 컬링 대상 메쉬 등록.
+    waterReceiver = lightCulling.addReceiver(waterMesh.getMesh(), transforms.getWorld(waterTransform));
+    LightCulling::computeBounds(waterMesh.getMesh(), transforms.getWorld(waterTransform), waterBoundsMin, waterBoundsMax); // 변위를 더하기 전의 경계 (update() 에서 넓혀서 씀)
+    shieldReceiver = lightCulling.addReceiver(shieldMesh.getMesh(), transforms.getWorld(shieldTransform));
+    if (gpuAvailable) {
+        shieldInstances.setup(shieldMesh); // 방패 메쉬의 VAO 에 인스턴스 속성(모델행렬, 노말행렬)을 연결함.
         
-    waterNrm.load("water_nrm.png"); // planeMesh 의 조명계산에서 노말맵으로 사용할 텍스쳐 로드
-    waterNrm.getTexture().setTextureWrap(GL_REPEAT, GL_REPEAT); // 프래그먼트 셰이더에서 노말맵 텍스쳐를 타일링하여 샘플링할 것이므로, 노말맵의 랩 모드를 반복으로 지정함.
+        // 포인트라이트 그림자. 방패(1개)는 정적 caster 로 등록해서 면마다 한 번만 굽고, 바다 시간값마다 모양이 바뀌는 물 표면은 동적 caster 로 등록함.
+        pointShadows.setup(PointShadowCache::Settings(), [this](const glm::mat4& viewProj, bool dynamic) { drawShadowCasters(viewProj, dynamic); });
+        shieldCaster = pointShadows.addCaster(false);
+        waterCaster = pointShadows.addCaster(true, true); // 바다는 매 프레임 움직이므로, 다른 변경이 예산을 다 쓰면 밀려나는 가장 낮은 우선순위로 갱신함.
+        glm::vec3 shieldBoundsMin, shieldBoundsMax;
+        LightCulling::computeBounds(shieldMesh.getMesh(), transforms.getWorld(shieldTransform), shieldBoundsMin, shieldBoundsMax);
+        pointShadows.setCasterBounds(shieldCaster, shieldBoundsMin, shieldBoundsMax);
+    
+        shaders.load({ MeshType::Skybox, LightType::None }, "skybox.vert", "skybox.frag"); // cubeMesh 에 큐브맵 텍스쳐를 적용한 셰이더를 적용하기 위한 셰이더 파일 로드
         
-    diffuseTex.load("shield_diffuse.png"); // shieldMesh 의 조명계산에서 디퓨즈 라이팅 계산에 사용할 텍스쳐 로드
-    specTex.load("shield_spec.png"); // shieldMesh 의 조명계산에서 스펙큘러 라이팅 계산에 사용할 텍스쳐 로드
-    nrmTex.load("shield_normal.png"); // shieldMesh 의 조명계산에서 노말맵으로 사용할 텍스쳐 로드
+        // 텍스쳐들은 AssetLoader 로 비동기 로드함. 디코딩은 워커 스레드들이 병렬로 처리하고,
+        // GPU 업로드는 update() 에서 assetLoader.update() 를 호출할 때 메인 스레드에서 처리됨. (로드가 끝나기 전까지는 로딩 화면을 그림)
+        assetLoader.loadTexture("shield_diffuse.png", diffuseTex); // shieldMesh 의 조명계산에서 디퓨즈 라이팅 계산에 사용할 텍스쳐 로드
+        assetLoader.loadTexture("shield_spec.png", specTex); // shieldMesh 의 조명계산에서 스펙큘러 라이팅 계산에 사용할 텍스쳐 로드
+        assetLoader.loadTexture("shield_normal.png", nrmTex); // shieldMesh 의 조명계산에서 노말맵으로 사용할 텍스쳐 로드
     
-    // 큐브맵 텍스쳐를 로드함.
-    cubemap.load("night_front.jpg", "night_back.jpg",
-            "night_right.jpg", "night_left.jpg",
-            "night_top.jpg", "night_bottom.jpg");
+        // 큐브맵 텍스쳐를 로드함.
+        // 오프라인 변환기(--build-cubemap)로 만들어둔 압축 KTX 파일이 있고 드라이버가 그 포맷을 지원하면,
+        // 밉맵 체인까지 들어있는 압축 데이터를 그대로 업로드함. (디코딩 및 glGenerateMipmap 불필요)
+        // 그렇지 않으면 6개 면 이미지를 각각 병렬로 디코딩한 뒤, 6개가 모두 모이면 한꺼번에 큐브맵으로 업로드함.
+        // (배열 순서는 GL_TEXTURE_CUBE_MAP_POSITIVE_X 부터의 순서: right, left, top, bottom, front, back)
+        if (!(ofFile::doesFileExist("night.ktx") && cubemap.loadKTX("night.ktx"))) {
+            const char* cubemapFiles[6] = {
+                "night_right.jpg", "night_left.jpg",
+                "night_top.jpg", "night_bottom.jpg",
+                "night_front.jpg", "night_back.jpg"
+            };
+            for (int i = 0; i < 6; ++i) {
+                assetLoader.loadPixels(cubemapFiles[i], [this, i](ofPixels& pixels) {
+                    cubemapFaces[i].swap(pixels);
+                    if (++numCubemapFaces == 6) {
+                        cubemap.loadFromPixels(cubemapFaces);
+                        for (ofPixels& face : cubemapFaces) {
+                            face.clear(); // 업로드가 끝난 CPU 측 픽셀은 바로 해제함.
+                        }
+                    }
+                });
+            }
+        }
+    } else {
+        loadSoftwareAssets(); // GL 이 없으면 텍스쳐를 올릴 곳이 없으므로 SoftwareRenderer 가 쓸 CPU 사본만 바로 로드함.
+    }
     
     // 이전 예제들과 다르게 draw() 함수가 아닌 setup() 함수에서 조명구조체에 조명데이터를 할당해 줌.
     // 근데 사실 생각하면 원래부터 setup() 함수에서 세팅을 해줘야하는게 맞음. 조명데이터를 draw() 함수에서 반복적으로 할당해줄 필요는 없으니까...
-    // 원하는 개수만큼 포인트라이트 구조체를 생성하여 조명데이터 할당.
-    PointLight pl0;
+    // 원하는 개수만큼 포인트라이트 설명(Desc)을 만들어서 LightSystem 에 추가함. (add() 는 나중에 지우거나 수정할 때 쓸 핸들을 돌려줌)
+    LightSystem::Desc pl0;
     pl0.color = glm::vec3(1, 0, 0);
     pl0.radius = 1.0f;
     pl0.position = glm::vec3(-0.5, 0.35, 0.25);
     pl0.intensity = 3.0f;
     
-    PointLight pl1;
+    LightSystem::Desc pl1;
     pl1.color = glm::vec3(0, 1, 0);
     pl1.radius = 1.0f;
     pl1.position = glm::vec3(0.5, 0.35, 0.25);
     pl1.intensity = 3.0f;
     
-    PointLight pl2;
+    LightSystem::Desc pl2;
     pl2.color = glm::vec3(0, 0, 1);
     pl2.radius = 1.0f;
     pl2.position = glm::vec3(0.0, 0.7, 0.25);
     pl2.intensity = 3.0f;
     
-    // 원하는 개수만큼 생성한 포인트라이트 구조체를 pointLights 동적배열에 push함
-    // 참고로, 동적배열.push_back() 은 요소를 동적배열 맨뒤에 추가할 때 사용하는 함수임.
-    pointLights.push_back(pl0);
-    pointLights.push_back(pl1);
-    pointLights.push_back(pl2);
+    pointLights.add(pl0);
+    pointLights.add(pl1);
+    pointLights.add(pl2);
     
     // 디렉셔널 라이트 구조체 생성하여 조명데이터 할당
     dirLight.color = glm::vec3(1, 1, 0);
     dirLight.intensity = 0.25f;
     dirLight.direction = glm::vec3(0, 0, -1);
+    
+    drawPackets.reserve(2 * (pointLights.size() + 1)); // 라이트(디렉셔널 1개 + 포인트라이트) x 메쉬 2개
+    if (gpuAvailable) {
+        fragmentCounter.setup(); // 프래그먼트 수를 셀 쿼리 객체 생성
+        shaders.load({ MeshType::ScreenQuad, LightType::None }, "upscale.vert", "upscale.frag"); // 동적 해상도에서 줄여 그린 씬을 늘려 그리는 셰이더
+        dynamicResolution.setup();
+        dynamicResolution.setEnabled(true);
+    }
+    
+    // 시뮬레이션 스레드가 라이트 컬링에 쓸 종횡비. (렌더링 쪽의 투영행렬은 draw() 에서 그릴 때의 크기로 다시 계산함)
+    targetAspect = benchmark.isEnabled() ? float(benchmark.getSettings().width) / benchmark.getSettings().height : float(ofGetWidth()) / ofGetHeight();
+    
+    // 벤치마크 모드에서는 FBO 에 그리면서, 수직동기화 및 프레임 제한 없이 최대한 빨리 프레임을 돌림.
+    // 추가 포인트라이트도 고정된 시드로 만들어서 실행할 때마다 같은 씬이 되도록 함.
+    if (benchmark.isEnabled()) {
+        benchmark.setup();
+        ofSetVerticalSync(false);
+        ofSetFrameRate(0);
+        ofSeedRandom(1234);
+        addRandomPointLights(benchmark.getSettings().extraLights);
+        const std::string& mode = benchmark.getSettings().mode;
+        renderMode = mode == "clustered" ? RenderMode::Clustered : mode == "deferred" ? RenderMode::Deferred : RenderMode::Multipass;
+        naiveInstancing = benchmark.getSettings().naive;
+        depthPrepass = benchmark.getSettings().prepass;
+        // 동적 해상도는 측정값에 따라 그리는 크기가 바뀌어서 같은 이미지가 나오지 않으므로, 'dynres=1' 을 줄 때만 켬.
+        dynamicResolution.setEnabled(benchmark.getSettings().dynamicResolution);
+        dynamicResolution.setTargetMs(benchmark.getSettings().budgetMs);
+        pointShadows.setEnabled(benchmark.getSettings().shadows); // 그림자는 기존 결과와 이미지가 달라지므로 'shadows=1' 을 줄 때만 켬.
+        pointShadows.setFaceBudget(benchmark.getSettings().shadowBudget);
+        layoutShieldInstances(benchmark.getSettings().instances);
+        softwareRenderer.setNumThreads(benchmark.getSettings().threads);
+        // 벤치마크 경로: 모든 포인트라이트가 초기 위치를 기준으로 y축 둘레를 번갈아가며 반대 방향으로 돔. (맥동/깜빡임은 끄고 위치만 움직임)
+        for (size_t i = 0; i < pointLights.size(); ++i) {
+            LightSystem::Animation animation;
+            animation.orbitSpeed = i % 2 == 0 ? 0.6f : -0.6f;
+            pointLights.setAnimation(pointLights.getHandle(i), animation);
+        }
+    }
 }
 
 //--------------------------------------------------------------
 void ofApp::update(){
+    // 직전 프레임의 구간 통계를 집계하고 새 프레임을 시작함. (draw() 는 중간에 return 하는 경로가 있으므로 프레임 경계를 여기서 처리함)
+    // 프로파일러는 GPU 쿼리를 만들므로 GL 컨텍스트가 없으면 프레임 경계를 넘기지 않음. (CPU 구간만 링버퍼에 쌓임)
+    if (gpuAvailable) {
+        PROFILE_END_FRAME();
+        PROFILE_BEGIN_FRAME();
+    }
+    PROFILE_ZONE("update");
+    
+    if (benchmark.isEnabled()) {
+        if (benchmark.isFinished()) {
+            if (softwareBackend) {
+                measureSoftwareThroughput(); // 마지막 프레임 상태 그대로 스레드 수만 바꿔서 다시 그림.
+            }
+            ofExit(benchmark.writeResults() ? 0 : 1); // 기준 이미지와 다르면 실패로 종료함.
+            return;
+        }
+        benchmark.beginFrame();
+    }
+    
+    {
+        PROFILE_ZONE("asset upload");
+        assetLoader.update(); // 워커 스레드에서 디코딩이 끝난 텍스쳐들을 GPU 로 업로드함.
+    }
+    
+    // 에셋 로드가 끝나기 전에는 로딩 화면만 그리므로 시뮬레이션도 시작하지 않음. (벤치마크의 첫 스냅샷이 항상 0 번 프레임이 되도록)
+    if (!assetLoader.isDone()) {
+        return;
+    }
+    if (!simulationThread.joinable()) {
+        simulationThread = std::thread(&ofApp::simulationLoop, this);
+    }
+    
+    // 직전 프레임에 그린 스냅샷을 시뮬레이션 스레드에 돌려주고, 다음 스냅샷을 받아옴. (시뮬레이션이 늦으면 여기서 기다림)
+    if (scene) {
+        snapshots.endRead();
+        scene = nullptr;
+    }
+    {
+        PROFILE_ZONE("wait for snapshot");
+        uint64_t waitBegin = ofGetElapsedTimeMicros();
+        scene = snapshots.beginRead();
+        pipelineStats.renderWaitMs = (ofGetElapsedTimeMicros() - waitBegin) / 1000.0f;
+        pipelineStats.queued = snapshots.size();
+    }
+    if (!scene) {
+        return;
+    }
+    pipelineStats.simulateMs = scene->simulateMs;
+    pipelineStats.simulationWaitMs = scene->waitMs;
+    
+    // 직전 프레임에 시작해둔 바다 시뮬레이션 결과를 텍스쳐로 올리고, 다음 프레임 시뮬레이션을 시작시킴.
+    // 물 메쉬의 라이트 컬링 경계를 넓힐 변위 크기는 시뮬레이션 스레드가 다음 스냅샷부터 가져다 씀.
+    {
+        PROFILE_ZONE("ocean upload");
+        ocean.update(scene->waterTime);
+        waterMargin.store(ocean.getMaxDisplacement(), std::memory_order_relaxed);
+    }
+    
+    // 포인트라이트 데이터 중 이 스냅샷에서 바뀌었다고 표시된 구간만 GPU 텍스쳐 버퍼로 업로드함. (두 렌더링 방식 모두 라이트 인덱스로 이 버퍼를 읽어감)
+    // 스냅샷은 빠짐없이 한 번씩 받아오므로, 로딩 화면 등으로 draw() 가 씬을 그리지 않는 프레임이 있어도 바뀐 구간을 놓치지 않도록 여기서 올림.
+    if (gpuAvailable) {
+        PROFILE_ZONE("light buffer sync");
+        lightBuffer.sync(scene->lights);
+    }
+    
+    // draw() 에서 드로우콜 목록이 늘어나면서 재할당되지 않도록 라이트 개수에 맞춰 미리 용량을 늘려둠. (라이트 x 메쉬 2개)
+    if (drawPackets.capacity() < 2 * (scene->lights.size() + 1)) {
+        drawPackets.reserve(2 * (scene->lights.size() + 1));
+    }
+}
 
+// 시뮬레이션 스레드. 렌더링(메인 스레드)이 이전 스냅샷을 그리는 동안 다음 프레임의 씬 상태를 계산해서 빈 슬롯에 채워 넘겨줌.
+// 큐가 가득 차면(렌더링이 더 느리면) 슬롯이 빌 때까지 기다리고, exit() 에서 큐를 닫으면 종료함.
+void ofApp::simulationLoop() {
+    lastSimulationTime = ofGetElapsedTimef();
+    while (true) {
+        uint64_t waitBegin = ofGetElapsedTimeMicros();
+        SceneSnapshot* snapshot = snapshots.beginWrite();
+        if (!snapshot) {
+            break;
+        }
+        uint64_t begin = ofGetElapsedTimeMicros();
+        snapshot->waitMs = (begin - waitBegin) / 1000.0f;
+        snapshot->simulationBeginMicros = begin;
+        simulate(*snapshot);
+        snapshot->simulateMs = (ofGetElapsedTimeMicros() - begin) / 1000.0f;
+        snapshots.endWrite();
+    }
 }
 
-// waterMesh 의 각종 변환행렬을 계산한 뒤, 유니폼 변수들을 전송해주면서 드로우콜을 호출하는 함수
-void ofApp::drawWater(Light& light, glm::mat4& proj, glm::mat4& view) {
+// 다음 프레임의 씬 상태(카메라, 포인트라이트 애니메이션, 메쉬별 라이트 컬링)를 계산해서 snapshot 에 기록하는 함수. (시뮬레이션 스레드 전용)
+// 카메라, 포인트라이트, 라이트 컬링은 이 스레드만 고치므로 잠금 없이 사용하고, 렌더링 쪽은 스냅샷에 복사된 값만 읽음.
+void ofApp::simulate(SceneSnapshot& snapshot) {
+    using namespace glm;
+    PROFILE_ZONE("simulate");
+    
+    // 입력 이벤트 등 메인 스레드에서 넘겨준 작업들을 먼저 처리함.
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        runningCommands.swap(simulationCommands);
+    }
+    for (std::function<void()>& command : runningCommands) {
+        command();
+    }
+    runningCommands.clear();
+    
+    // 벤치마크 모드에서는 벽시계 대신 스냅샷 번호로 정해지는 시간값을 쓰므로 매번 같은 결과가 나옴.
+    float time;
+    if (benchmark.isEnabled()) {
+        time = benchmark.getTime(int(simulationFrame));
+        animateBenchmark(time);
+    } else {
+        // 바다 시뮬레이션 시간값은 스냅샷마다 지난 시간만큼 증가시킴.
+        time = ofGetElapsedTimef();
+        waterTime += time - lastSimulationTime;
+        lastSimulationTime = time;
+    }
+    
+    {
+        PROFILE_ZONE("light animation");
+        pointLights.update(time, &lightWorkers);
+    }
+    
+    // 멀티패스 모드의 메쉬별 라이트 컬링. 물 메쉬의 경계는 변위맵이 움직일 수 있는 최대 거리만큼 넓혀줌.
+    // (렌더링 방식과 상관없이 항상 계산해두므로 'm' 키로 전환한 프레임에도 바로 쓸 수 있음)
+    {
+        PROFILE_ZONE("light culling");
+        vec3 margin(waterMargin.load(std::memory_order_relaxed));
+        lightCulling.setReceiverBounds(waterReceiver, waterBoundsMin - margin, waterBoundsMax + margin);
+        mat4 viewProj = perspective(cam.fov, targetAspect.load(std::memory_order_relaxed), NEAR_PLANE, FAR_PLANE) * inverse(translate(cam.pos));
+        lightCulling.update(pointLights, viewProj); // 프러스텀 밖이거나 메쉬에 닿지 않는 포인트라이트는 그 메쉬의 패스에서 제외함.
+        snapshot.waterLights = lightCulling.getLights(waterReceiver);
+        snapshot.shieldLights = lightCulling.getLights(shieldReceiver);
+        snapshot.culling = lightCulling.getStats();
+    }
+    
+    snapshot.frame = simulationFrame++;
+    snapshot.waterTime = waterTime;
+    snapshot.cam = cam;
+    snapshot.dirLight = dirLight;
+    pointLights.copyRenderData(snapshot.lights);
+    pointLights.clearDirty(); // 바뀐 구간은 이 스냅샷이 가져갔으므로 다음 스냅샷은 여기서부터 다시 모음.
+}
+
+// 메인 스레드(입력 이벤트 등)에서 시뮬레이션 스레드가 가진 상태를 바꿔야 할 때, 다음 스냅샷을 만들기 전에 실행되도록 넘겨주는 함수
+void ofApp::runOnSimulation(std::function<void()> command) {
+    std::lock_guard<std::mutex> lock(commandMutex);
+    simulationCommands.push_back(std::move(command));
+}
+
+// 시뮬레이션 스레드를 종료함. (기다리고 있으면 큐를 닫아서 깨움)
+void ofApp::exit() {
+    snapshots.close();
+    if (simulationThread.joinable()) {
+        simulationThread.join();
+    }
+}
+
+// 벤치마크 모드에서 고정 타임스텝 시간값으로 카메라와 포인트라이트를 움직이는 함수. (시뮬레이션 스레드에서 호출)
+// 카메라는 방패 앞을 좌우/앞뒤로 천천히 오감. (포인트라이트들은 setup() 에서 지정한 공전 애니메이션대로 LightSystem 이 움직임)
+void ofApp::animateBenchmark(float t) {
+    waterTime = t;
+    
+    cam.pos = glm::vec3(0.4f * sin(t * 0.5f), 0.75f + 0.1f * sin(t * 0.8f), 1.0f + 0.3f * cos(t * 0.5f));
+}
+
+// 비교 테스트를 위해 씬 주변에 무작위 포인트라이트를 count 개 추가하는 함수
+// 벤치마크가 아닐 때는 라이트마다 공전 속도, 맥동, 깜빡임을 무작위로 줘서 LightSystem::update() 의 부하도 함께 볼 수 있도록 함.
+void ofApp::addRandomPointLights(int count) {
+    for (int i = 0; i < count; ++i) {
+        LightSystem::Desc pl;
+        pl.color = glm::vec3(ofRandom(1.0f), ofRandom(1.0f), ofRandom(1.0f));
+        pl.radius = ofRandom(0.3f, 1.0f);
+        pl.position = glm::vec3(ofRandom(-2.0f, 2.0f), ofRandom(0.1f, 1.2f), ofRandom(-2.0f, 0.5f));
+        pl.intensity = ofRandom(1.0f, 3.0f);
+        if (!benchmark.isEnabled()) {
+            pl.animation.orbitSpeed = ofRandom(-0.5f, 0.5f);
+            pl.animation.pulseAmount = ofRandom(0.3f);
+            pl.animation.pulseRate = ofRandom(0.2f, 1.0f);
+            pl.animation.flickerAmount = ofRandom(0.5f);
+            pl.animation.flickerRate = ofRandom(2.0f, 10.0f);
+            pl.animation.phase = ofRandom(100.0f);
+        }
+        randomLights.push_back(pointLights.add(pl));
+    }
+}
+
+// addRandomPointLights() 로 추가한 라이트를 최근 것부터 count 개 지우는 함수 (LightSystem 은 빈자리를 마지막 라이트로 채워서 배열을 촘촘하게 유지함)
+void ofApp::removeRandomPointLights(int count) {
+    for (int i = 0; i < count && !randomLights.empty(); ++i) {
+        pointLights.remove(randomLights.back());
+        randomLights.pop_back();
+    }
+}
+
+// 방패 메쉬 인스턴스 count 개를 물 메쉬 위에 격자로 배치하는 함수.
+// 인스턴스마다 크기는 격자 간격에 맞추고, y축 회전은 고정된 시드의 무작위 값으로 줘서 실행할 때마다 같은 배치가 되도록 함.
+void ofApp::layoutShieldInstances(int count) {
     using namespace glm;
     
-    static float t = 0.0f; // static 을 특정 함수 내에서 사용하는 것을 '정적 지역 변수'라고 하며, 이 할당문은 drawWater() 함수 최초 호출 시 1번만 실행됨.
-    t += ofGetLastFrameTime(); // 이전 프레임과 현재 프레임의 시간 간격인 '델타타임'을 리턴받는 함수를 호출해서 유니폼 변수로 전송할 시간값 t에 매 프레임마다 더해줌.
+    numShieldInstances = count;
+    if (count == 0) {
+        shieldInstances.clear();
+        vec3 boundsMin, boundsMax;
+        LightCulling::computeBounds(shieldMesh.getMesh(), transforms.getWorld(shieldTransform), boundsMin, boundsMax); // 방패 1개일 때의 경계로 되돌림.
+        runOnSimulation([this, boundsMin, boundsMax] { lightCulling.setReceiverBounds(shieldReceiver, boundsMin, boundsMax); });
+        return;
+    }
+    
+    // 카메라 앞쪽 8 x 8 영역에 정사각형 격자로 깔아줌.
+    int side = int(ceil(sqrt(float(count))));
+    float spacing = 8.0f / side;
+    float size = spacing * 0.5f;
+    
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> angle(0.0f, glm::two_pi<float>());
+    
+    std::vector<mat4> instanceTransforms; // 멤버 transforms(TransformSystem) 와 구분되도록 이름을 따로 둠.
+    instanceTransforms.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        vec3 position((i % side + 0.5f) * spacing - 4.0f, 0.75f * size, -(i / side + 0.5f) * spacing + 0.5f);
+        instanceTransforms.push_back(translate(position) * rotate(angle(rng), vec3(0, 1, 0)) * scale(vec3(size)));
+    }
+    shieldInstances.setTransforms(instanceTransforms);
     
-    // waterMesh 의 모델행렬 계산 (회전행렬 및 크기행렬만 적용)
-    vec3 right = vec3(1, 0, 0); // waterMesh 모델의 회전행렬을 계산할 시, x축 방향으로만 회전할 수 있도록 회전축 벡터를 구해놓음.
-    mat4 rotation = rotate(radians(-90.0f), right); // waterMesh 회전행렬은 x축 기준으로 cAngle(-90도) 회전시킴.
-    mat4 model = rotation * scale(vec3(5.0, 4.0, 4.0)); // 열 우선 행렬이므로, 원하는 행렬 곱셈과 반대순서인 회전행렬 * 크기행렬 순으로 곱해줌
+    // 멀티패스 라이트 컬링에서는 인스턴스 전체를 감싸는 AABB 를 방패 메쉬의 경계로 사용함. (라이트 컬링은 시뮬레이션 스레드가 하므로 넘겨줌)
+    vec3 boundsMin, boundsMax;
+    shieldInstances.getBounds(boundsMin, boundsMax);
+    runOnSimulation([this, boundsMin, boundsMax] { lightCulling.setReceiverBounds(shieldReceiver, boundsMin, boundsMax); });
+}
+
+// waterMesh 의 각종 변환행렬을 계산한 뒤, 유니폼 변수들을 전송해주면서 드로우콜을 호출하는 함수
+void ofApp::drawWater(MaterialBinding& mat, int pointLight, glm::mat4& proj, glm::mat4& view) {
+    using namespace glm;
     
-    // 최적화를 위해 c++ 단에서 투영 * 뷰 * 모델행렬을 한꺼번에 곱해서 버텍스 셰이더에 전송함.
-    mat4 mvp = proj * view * model; // 열 우선 행렬이라 원래의 곱셈 순서인 '모델 -> 뷰 -> 투영'의 반대 순서로 곱해줘야 함.
+    // waterMesh 의 모델행렬 (setup() 에서 지정한 회전행렬 * 크기행렬). 라이트 패스마다 다시 계산하지 않고 transforms 에 캐시된 값을 씀.
+    const mat4& model = transforms.getWorld(waterTransform);
+    
+    // 최적화를 위해 c++ 단에서 투영 * 뷰 * 모델행렬을 한꺼번에 곱해서 버텍스 셰이더에 전송함. (transforms.update() 에서 프레임마다 한 번만 곱해둠)
+    const mat4& mvp = transforms.getMvp(waterTransform); // 열 우선 행렬이라 원래의 곱셈 순서인 '모델 -> 뷰 -> 투영'의 반대 순서로 곱해줘야 함.
     
     /**
          모델의 버텍스가 갖고있는 기본 노말벡터는 오브젝트공간을 기준으로 되어있음.
@@ -183,147 +479,934 @@ void ofApp::drawWater(Light& light, glm::mat4& proj, glm::mat4& view) {
                  
          역행렬, 전치행렬, 상단 3*3 행렬에 대한 각각의 개념은 위키백과, 구글링, 북마크한거 참고...
                  
-         어쨋든 위의 정의에 따라 아래와 같이 노말행렬을 구하고, 버텍스 셰이더로 쏴주면 됨.
+         어쨋든 위의 정의에 따라 노말행렬을 구하고, 버텍스 셰이더로 쏴주면 됨. (역행렬 계산은 TransformSystem::update() 에서 모델행렬이 바뀔 때만 함)
     */
-    mat3 normalMatrix = mat3(transpose(inverse(model)));
+    const mat3& normalMatrix = transforms.getNormalMatrix(waterTransform);
+    
+    // 인자로 받아온 mat 은 조명 종류에 맞는 셰이더(포인트라이트 또는 디렉셔널 라이트)의 바인딩 객체이며, 이미 submitDrawRange() 에서 바인딩(begin)된 상태임.
     
-    // 인자로 받아온 Light 구조체의 isPointLight() 함수 리턴값에 따라 포인트라이트 셰이더 또는 디렉셔널라이트 셰이더 중에서 참조자 shd 가 어떤 셰이더 객체를 참조하도록 할 지 결정함.
-    ofShader shd = light.isPointLight() ? pointLightShaders[1] : dirLightShaders[1];
+    // 텍스쳐는 유닛 단위의 전역 상태이므로 매번 요청하되, 이미 같은 텍스쳐가 바인딩되어 있으면 MaterialBinding 이 생략함.
+    ocean.bind(mat); // 바다 변위맵 / 기울기맵 텍스쳐와 샘플링 배율 전송
+    mat.setTexture(MaterialBinding::EnvMap, cubemap.getTexture()); // 환경맵 반사를 적용하기 위해 사용할 큐브맵 텍스쳐 유니폼 변수로 전송
+    if (pointLight >= 0) {
+        lightBuffer.bind(mat); // 포인트라이트 셰이더는 라이트 데이터를 텍스쳐 버퍼에서 읽어오므로 바인딩해줌.
+        pointShadows.bind(mat); // 포인트라이트 그림자 아틀라스와 라이트별 타일 위치도 같이 바인딩해줌.
+    }
     
-    // shd 를 바인딩하여 사용 시작
-    shd.begin();
-    light.apply(shd); // 인자로 전달받는 각 조명구조체는 부모구조체 Light 로부터 상속받은 apply 함수에서 유니폼 변수에 자신의 멤버변수 값을 전송하는 로직이 override 되어있음. 이걸 여기서 호출함으로써 유니폼 변수에 멤버변수값을 전송하려는 것.
+    // 프레임마다 한 번만 바뀌는 값들
+    if (mat.update(MaterialBinding::PerFrame)) {
+        mat.set(MaterialBinding::ViewProj, proj * view); // 변위는 월드공간에서 더하므로, 버텍스 셰이더에서 mvp 대신 투영 * 뷰 행렬을 곱함.
+        mat.set(MaterialBinding::AmbientCol, glm::vec3(0.0, 0.0, 0.0)); // 환경광으로 사용할 앰비언트 라이트 색상값을 유니폼 변수로 전송.
+        mat.set(MaterialBinding::CameraPos, scene->cam.pos); // 프래그먼트 셰이더에서 뷰 벡터를 계산하기 위해 카메라 좌표(카메라 월드좌표)를 프래그먼트 셰이더 유니폼 변수로 전송
+    }
     
-    shd.setUniformMatrix4f("mvp", mvp); // 위에서 한꺼번에 합쳐준 mvp 행렬을 버텍스 셰이더 유니폼 변수로 전송
-    shd.setUniformMatrix4f("model", model); // 버텍스 좌표를 월드좌표로 변환하기 위해 모델행렬만 따로 버텍스 셰이더 유니폼 변수로 전송
-    shd.setUniformMatrix3f("normalMatrix", normalMatrix); // 노말행렬을 버텍스 셰이더 유니폼 변수로 전송
-    shd.setUniform3f("meshSpecCol", glm::vec3(1, 1, 1)); // 스펙큘러 색상을 흰색으로 지정하여 유니폼 변수로 전송
-    shd.setUniformTexture("normTex", waterNrm, 0); // 노말 매핑에 사용할 텍스쳐 유니폼 변수로 전송
-    shd.setUniformTexture("envMap", cubemap.getTexture(), 1); // 환경맵 반사를 적용하기 위해 사용할 큐브맵 텍스쳐 유니폼 변수로 전송
-    shd.setUniform1f("time", t); // uv 스크롤링에 사용할 시간값 유니폼 변수로 전송
-    shd.setUniform3f("ambientCol", glm::vec3(0.0, 0.0, 0.0)); // 환경광으로 사용할 앰비언트 라이트 색상값을 유니폼 변수로 전송.
-    shd.setUniform3f("cameraPos", cam.pos); // 프래그먼트 셰이더에서 뷰 벡터를 계산하기 위해 카메라 좌표(카메라 월드좌표)를 프래그먼트 셰이더 유니폼 변수로 전송
+    // 오브젝트마다 바뀌는 값들 (같은 물 메쉬를 라이트 개수만큼 반복해서 그리는 멀티패스에서는 첫 패스에서만 전송됨)
+    if (mat.update(MaterialBinding::PerObject, &waterMesh)) {
+        mat.set(MaterialBinding::Mvp, mvp); // 위에서 한꺼번에 합쳐준 mvp 행렬을 버텍스 셰이더 유니폼 변수로 전송
+        mat.set(MaterialBinding::Model, model); // 버텍스 좌표를 월드좌표로 변환하기 위해 모델행렬만 따로 버텍스 셰이더 유니폼 변수로 전송
+        mat.set(MaterialBinding::NormalMatrix, normalMatrix); // 노말행렬을 버텍스 셰이더 유니폼 변수로 전송
+        mat.set(MaterialBinding::MeshSpecCol, glm::vec3(1, 1, 1)); // 스펙큘러 색상을 흰색으로 지정하여 유니폼 변수로 전송
+    }
     
-    planeMesh.draw(); // planeMesh(waterMesh) 메쉬 드로우콜 호출하여 그려줌.
+    applyLight(mat, pointLight); // 라이트(패스)마다 바뀌는 값들
     
-    shd.end();
-    // shd 사용 중단
+    mat.draw(waterMesh); // waterMesh 메쉬 드로우콜 호출하여 그려줌.
 }
 
-void ofApp::drawSkybox(glm::mat4& proj, glm::mat4& view) {
+void ofApp::drawSkybox() {
     using namespace glm; // 이제부터 이 함수블록 내에서 glm 라이브러리에서 꺼내 쓸 함수 및 객체들은 'glm::' 을 생략해서 사용해도 됨.
     
     // cubeMesh 의 모델행렬 계산 (이동행렬만 적용)
-    mat4 model = translate(cam.pos); // 큐브맵의 위치(즉, 큐브맵의 오브젝트공간 원점)를 카메라 위치와 일치시킴으로써, 큐브맵 안쪽 중앙에 카메라가 위치하도록 함 -> 큐브맵을 skybox 로 만들기 위함!
+    // 큐브맵의 위치(즉, 큐브맵의 오브젝트공간 원점)를 카메라 위치와 일치시킴으로써, 큐브맵 안쪽 중앙에 카메라가 위치하도록 함 -> 큐브맵을 skybox 로 만들기 위함!
+    // 이 모델행렬은 draw() 에서 카메라 위치로 갱신되고, 투영 * 뷰 * 모델행렬도 transforms.update() 에서 한꺼번에 곱해둠.
+    const mat4& mvp = transforms.getMvp(skyboxTransform);
+    
+    MaterialBinding& mat = shaders.get({ MeshType::Skybox, LightType::None }); // 참조자 mat 은 스카이박스 셰이더의 바인딩 객체를 참조하도록 함.
+    
+    // 깊이비교모드는 렌더 그래프의 스카이박스 패스가 GL_LEQUAL 로 바꿔두고, 다음 패스 또는 프레임 끝에서 GL_LESS 로 되돌림. (깊이비교모드 관련 필기 하단 참고)
+    
+    // mat(스카이박스 셰이더의 바인딩 객체) 을 바인딩하여 사용 시작
+    mat.begin();
+    mat.set(MaterialBinding::Mvp, mvp); // 위에서 한꺼번에 합쳐준 mvp 행렬을 버텍스 셰이더 유니폼 변수로 전송
+    mat.setTexture(MaterialBinding::EnvMap, cubemap.getTexture()); // 커스텀 큐브맵 클래스로 셰이더의 유니폼 변수에 큐브맵 텍스쳐를 전송할 경우, 명시적으로 getTexture() 를 호출해야 함.
     
-    // 최적화를 위해 c++ 단에서 투영 * 뷰 * 모델행렬을 한꺼번에 곱해서 버텍스 셰이더에 전송함.
-    mat4 mvp = proj * view * model; // 열 우선 행렬이라 원래의 곱셈 순서인 '모델 -> 뷰 -> 투영'의 반대 순서로 곱해줘야 함.
+    mat.draw(cubeMesh); // cubeMesh 메쉬 드로우콜 호출하여 그림.
     
-    ofShader& shd = skyboxShader; // 참조자 shd 는 ofShader 타입의 멤버변수 skyboxShader 를 참조하도록 함.
+    mat.end();
+    // mat(스카이박스 셰이더) 사용 중단
+}
+
+void ofApp::drawShield(MaterialBinding& mat, int pointLight, glm::mat4& proj, glm::mat4& view) {
+    using namespace glm;
     
-    glDepthFunc(GL_LEQUAL); // 스카이박스를 그리기 전 깊이비교모드를 변경함 (깊이비교모드 관련 필기 하단 참고) Less Equal 의 줄임말. 즉, >= (보다 작거나 같음. 이하)을 의미
+    // shieldMesh 의 모델행렬(이동행렬만 적용), mvp, 노말행렬은 transforms 에 프레임마다 한 번씩만 계산해둔 값을 씀.
+    const mat4& model = transforms.getWorld(shieldTransform);
+    const mat4& mvp = transforms.getMvp(shieldTransform);
+    const mat3& normalMatrix = transforms.getNormalMatrix(shieldTransform);
     
-    // shd(skyboxShader 를 참조) 를 바인딩하여 사용 시작
-    shd.begin();
-    shd.setUniformMatrix4f("mvp", mvp); // 위에서 한꺼번에 합쳐준 mvp 행렬을 버텍스 셰이더 유니폼 변수로 전송
-    shd.setUniformTexture("envMap", cubemap.getTexture(), 0); // 커스텀 큐브맵 클래스로 셰이더의 유니폼 변수에 큐브맵 텍스쳐를 전송할 경우, 명시적으로 getTexture() 를 호출해야 함.
+    // 인자로 받아온 mat 은 조명 종류에 맞는 셰이더의 바인딩 객체이며, 이미 submitDrawRange() 에서 바인딩(begin)된 상태임.
+    
+    mat.setTexture(MaterialBinding::DiffuseTex, diffuseTex); // 디퓨즈 라이팅 계산에 사용할 텍스쳐 유니폼 변수로 전송
+    mat.setTexture(MaterialBinding::SpecTex, specTex); // 스펙큘러 라이팅 계산에 사용할 텍스쳐 유니폼 변수로 전송
+    mat.setTexture(MaterialBinding::NrmTex, nrmTex); // 노말 매핑에 사용할 텍스쳐 유니폼 변수로 전송
+    mat.setTexture(MaterialBinding::EnvMap, cubemap.getTexture()); // 환경맵 반사를 적용하기 위해 사용할 큐브맵 텍스쳐 유니폼 변수로 전송
+    if (pointLight >= 0) {
+        lightBuffer.bind(mat); // 포인트라이트 셰이더는 라이트 데이터를 텍스쳐 버퍼에서 읽어오므로 바인딩해줌.
+        pointShadows.bind(mat); // 포인트라이트 그림자 아틀라스와 라이트별 타일 위치도 같이 바인딩해줌.
+    }
+    
+    if (mat.update(MaterialBinding::PerFrame)) {
+        mat.set(MaterialBinding::AmbientCol, glm::vec3(0.0, 0.0, 0.0)); // 배경색과 동일한 앰비언트 라이트 색상값을 유니폼 변수로 전송.
+        mat.set(MaterialBinding::CameraPos, scene->cam.pos); // 프래그먼트 셰이더에서 뷰 벡터를 계산하기 위해 카메라 좌표(카메라 월드좌표)를 프래그먼트 셰이더 유니폼 변수로 전송
+        mat.set(MaterialBinding::ViewProj, proj * view); // 인스턴싱 변형에서는 모델행렬을 셰이더에서 곱하므로 투영 * 뷰 행렬만 전송함. (다른 변형에는 이 유니폼이 없으므로 생략됨)
+    }
+    
+    if (numShieldInstances > 0) {
+        if (mat.update(MaterialBinding::PerObject, &shieldInstances)) {
+            mat.set(MaterialBinding::MeshSpecCol, glm::vec3(1, 1, 1)); // 행렬들은 인스턴스 버퍼(또는 아래의 인스턴스별 루프)에서 넘어가므로 공통 값만 전송함.
+        }
+        applyLight(mat, pointLight);
+        
+        if (!naiveInstancing) {
+            shieldInstances.draw(mat); // 프러스텀 컬링을 통과한 인스턴스들을 드로우콜 한 번으로 그림.
+            return;
+        }
+        
+        // 비교용 경로: 인스턴스마다 행렬 유니폼을 전송하고 드로우콜을 하나씩 호출함.
+        for (const InstanceBuffer::Instance& instance : shieldInstances.getVisible()) {
+            mat.set(MaterialBinding::Mvp, proj * view * instance.model);
+            mat.set(MaterialBinding::Model, instance.model);
+            mat.set(MaterialBinding::NormalMatrix, instance.normalMatrix);
+            mat.draw(shieldMesh);
+        }
+        return;
+    }
     
-    cubeMesh.draw(); // cubeMesh 메쉬 드로우콜 호출하여 그림.
+    if (mat.update(MaterialBinding::PerObject, &shieldMesh)) {
+        mat.set(MaterialBinding::Mvp, mvp); // 위에서 한꺼번에 합쳐준 mvp 행렬을 버텍스 셰이더 유니폼 변수로 전송
+        mat.set(MaterialBinding::Model, model); // 버텍스 좌표를 월드좌표로 변환하기 위해 모델행렬만 따로 버텍스 셰이더 유니폼 변수로 전송
+        mat.set(MaterialBinding::NormalMatrix, normalMatrix); // 노말행렬을 버텍스 셰이더 유니폼 변수로 전송
+        mat.set(MaterialBinding::MeshSpecCol, glm::vec3(1, 1, 1)); // 스펙큘러 색상을 흰색으로 지정하여 유니폼 변수로 전송
+    }
     
-    shd.end();
-    // shd(cubemapShader) 사용 중단
+    applyLight(mat, pointLight);
     
-    glDepthFunc(GL_LESS); // 스카이박스를 다 그린 뒤 깊이비교모드를 원래대로 원상복구함. (깊이비교모드 관련 필기 하단 참고) Less 의 줄임말. 즉, > (보다 작음. 미만)을 의미
+    mat.draw(shieldMesh); // shieldMesh 메쉬 드로우콜 호출하여 그려줌.
 }
 
-void ofApp::drawShield(Light& light, glm::mat4& proj, glm::mat4& view) {
+// 라이트(패스)마다 바뀌는 조명 유니폼을 전송하는 함수. 같은 라이트로 여러 메쉬를 이어서 그릴 때는 첫 번째 메쉬에서만 전송됨.
+// 포인트라이트의 위치, 색상, 반경은 LightBuffer 가 텍스쳐 버퍼로 한꺼번에 올려두므로, 셰이더에는 몇 번째 라이트인지만 알려주면 됨.
+void ofApp::applyLight(MaterialBinding& mat, int pointLight) {
+    // 갱신 여부를 판단하는 키는 라이트마다 달라야 하므로, 포인트라이트는 LightSystem 위치 배열의 원소 주소를 키로 사용함.
+    const void* key = pointLight >= 0 ? static_cast<const void*>(&scene->lights.getPositions()[pointLight]) : &scene->dirLight;
+    if (!mat.update(MaterialBinding::PerLight, key)) {
+        return;
+    }
+    if (pointLight >= 0) {
+        mat.set(MaterialBinding::LightIndex, pointLight);
+    } else {
+        scene->dirLight.apply(mat);
+    }
+}
+
+// 방패 인스턴스가 있으면 인스턴스 속성에서 행렬을 읽는 변형으로 바꿔줌. (비교용 경로는 기존 변형으로 인스턴스마다 그림)
+uint32_t ofApp::getShieldFeatures() const {
+    return numShieldInstances > 0 && !naiveInstancing ? SHIELD_FEATURES | Instanced : SHIELD_FEATURES;
+}
+
+// 멀티패스 드로우콜 목록을 만든 뒤 정렬하는 함수.
+// 기존에는 라이트마다 물 -> 방패 순으로 그려서 드로우콜마다 셰이더 프로그램이 바뀌었는데,
+// 가산 블렌딩은 그리는 순서와 상관없이 결과가 같으므로 같은 프로그램(그리고 같은 머티리얼)끼리 모아서 그리도록 정렬함.
+// (단, 깊이값을 먼저 채우는 디렉셔널 라이트 패스는 항상 포인트라이트 패스보다 먼저 그려야 하므로 정렬키의 최상위 비트로 구분함)
+void ofApp::buildDrawPackets() {
+    MaterialBinding& dirWater = shaders.get({ MeshType::Water, LightType::Directional, WATER_FEATURES });
+    MaterialBinding& pointWater = shaders.get({ MeshType::Water, LightType::Point, WATER_FEATURES });
+    uint32_t shieldFeatures = getShieldFeatures();
+    MaterialBinding& dirShield = shaders.get({ MeshType::Shield, LightType::Directional, shieldFeatures });
+    MaterialBinding& pointShield = shaders.get({ MeshType::Shield, LightType::Point, shieldFeatures });
+    
+    auto makeKey = [](uint64_t phase, MaterialBinding& mat, MeshType mesh, uint64_t lightOrder) {
+        return (phase << 63) | (uint64_t(mat.getProgram()) << 32) | (uint64_t(mesh) << 24) | (lightOrder & 0xffffff);
+    };
+    
+    drawPackets.clear(); // clear() 는 용량을 유지하므로 재할당이 일어나지 않음.
+    drawPackets.push_back({ makeKey(0, dirWater, MeshType::Water, 0), &dirWater, MeshType::Water, -1 });
+    drawPackets.push_back({ makeKey(0, dirShield, MeshType::Shield, 0), &dirShield, MeshType::Shield, -1 });
+    // 포인트라이트 패스는 LightCulling 이 고른, 실제로 그 메쉬에 닿는 라이트들만 그림.
+    for (uint32_t i : scene->waterLights) {
+        drawPackets.push_back({ makeKey(1, pointWater, MeshType::Water, i), &pointWater, MeshType::Water, int(i) });
+    }
+    for (uint32_t i : scene->shieldLights) {
+        drawPackets.push_back({ makeKey(1, pointShield, MeshType::Shield, i), &pointShield, MeshType::Shield, int(i) });
+    }
+    
+    std::sort(drawPackets.begin(), drawPackets.end(), [](const DrawPacket& a, const DrawPacket& b) {
+        return a.sortKey < b.sortKey;
+    });
+    
+    // 정렬키의 최상위 비트로 디렉셔널 라이트 패스와 포인트라이트 패스가 나뉘므로, 경계를 찾아서 렌더 그래프의 두 패스가 각자 자기 구간만 그리도록 함.
+    auto firstPointPacket = std::partition_point(drawPackets.begin(), drawPackets.end(), [](const DrawPacket& packet) {
+        return (packet.sortKey >> 63) == 0;
+    });
+    numDirectionalPackets = size_t(firstPointPacket - drawPackets.begin());
+}
+
+// 드로우콜 목록의 [first, last) 구간을 그리는 함수. 셰이더 프로그램은 바뀔 때만 다시 바인딩함.
+void ofApp::submitDrawRange(std::vector<DrawPacket>::iterator first, std::vector<DrawPacket>::iterator last, glm::mat4& proj, glm::mat4& view) {
+    MaterialBinding* current = nullptr;
+    
+    for (auto it = first; it != last; ++it) {
+        DrawPacket& packet = *it;
+        if (packet.material != current) {
+            if (current) {
+                current->end();
+            }
+            current = packet.material;
+            current->begin();
+        }
+        
+        if (packet.mesh == MeshType::Water) {
+            drawWater(*current, packet.light, proj, view);
+        } else {
+            drawShield(*current, packet.light, proj, view);
+        }
+    }
+    if (current) {
+        current->end();
+    }
+}
+
+// 클러스터드 모드에서 물 메쉬를 그리는 함수. 디렉셔널 라이트와 클러스터에 할당된 포인트라이트들을 한 패스 안에서 모두 계산함.
+void ofApp::drawWaterClustered(glm::mat4& proj, glm::mat4& view) {
     using namespace glm;
     
-    mat4 model = translate(vec3(0.0, 0.75, 0.0f)); // shieldMesh 의 모델행렬 계산 (이동행렬만 적용)
-    mat4 mvp = proj * view * model; // 최적화를 위해 c++ 단에서 투영 * 뷰 * 모델행렬을 한꺼번에 곱해서 버텍스 셰이더에 전송함.
-    mat3 normalMatrix = mat3(transpose(inverse(model))); // 노말행렬은 '모델행렬의 상단 3*3 역행렬의 전치행렬' 로 계산함.
+    const mat4& model = transforms.getWorld(waterTransform); // drawWater() 와 동일한 캐시된 모델행렬
+    
+    MaterialBinding& mat = shaders.get({ MeshType::Water, LightType::Clustered });
+    
+    mat.begin();
+    ocean.bind(mat);
+    mat.setTexture(MaterialBinding::EnvMap, cubemap.getTexture());
+    lightBuffer.bind(mat); // 포인트라이트 데이터는 텍스쳐 버퍼로 전송
+    lightClusters.bind(mat); // 클러스터별 라이트 인덱스 목록도 텍스쳐 버퍼로 전송
+    pointShadows.bind(mat); // 포인트라이트 그림자 아틀라스
+    
+    if (mat.update(MaterialBinding::PerFrame)) {
+        scene->dirLight.apply(mat); // 디렉셔널 라이트는 기존처럼 유니폼 변수로 전송
+        mat.set(MaterialBinding::View, view); // 프래그먼트 셰이더에서 클러스터의 깊이 슬라이스를 찾기 위해 뷰행렬도 전송
+        mat.set(MaterialBinding::ViewProj, proj * view);
+        mat.set(MaterialBinding::AmbientCol, glm::vec3(0.0, 0.0, 0.0));
+        mat.set(MaterialBinding::CameraPos, scene->cam.pos);
+    }
+    if (mat.update(MaterialBinding::PerObject, &waterMesh)) {
+        mat.set(MaterialBinding::Model, model); // 버텍스 노멀은 쓰지 않으므로 모델행렬만 전송함.
+    }
+    
+    mat.draw(waterMesh);
     
-    // 인자로 받아온 Light 구조체의 isPointLight() 함수 리턴값에 따라 포인트라이트 셰이더 또는 디렉셔널라이트 셰이더 중에서 참조자 shd 가 어떤 셰이더 객체를 참조하도록 할 지 결정함.
-    ofShader shd = light.isPointLight() ? pointLightShaders[0] : dirLightShaders[0];
+    mat.end();
+}
 
-    // shd 를 바인딩하여 사용 시작
-    shd.begin();
-    light.apply(shd); // 인자로 전달받는 각 조명구조체는 부모구조체 Light 로부터 상속받은 apply 함수에서 유니폼 변수에 자신의 멤버변수 값을 전송하는 로직이 override 되어있음. 이걸 여기서 호출함으로써 유니폼 변수에 멤버변수값을 전송하려는 것.
+// 클러스터드 모드에서 방패 메쉬를 그리는 함수. 디렉셔널 라이트와 클러스터에 할당된 포인트라이트들을 한 패스 안에서 모두 계산함.
+void ofApp::drawShieldClustered(glm::mat4& view) {
+    using namespace glm;
+    
+    const mat4& model = transforms.getWorld(shieldTransform); // drawShield() 와 동일한 캐시된 행렬들
+    const mat4& mvp = transforms.getMvp(shieldTransform);
+    const mat3& normalMatrix = transforms.getNormalMatrix(shieldTransform);
+    
+    MaterialBinding& mat = shaders.get({ MeshType::Shield, LightType::Clustered });
+    
+    mat.begin();
+    mat.setTexture(MaterialBinding::DiffuseTex, diffuseTex);
+    mat.setTexture(MaterialBinding::SpecTex, specTex);
+    mat.setTexture(MaterialBinding::NrmTex, nrmTex);
+    mat.setTexture(MaterialBinding::EnvMap, cubemap.getTexture());
+    lightBuffer.bind(mat); // 포인트라이트 데이터는 텍스쳐 버퍼로 전송
+    lightClusters.bind(mat); // 클러스터별 라이트 인덱스 목록도 텍스쳐 버퍼로 전송
+    pointShadows.bind(mat); // 포인트라이트 그림자 아틀라스
+    
+    if (mat.update(MaterialBinding::PerFrame)) {
+        scene->dirLight.apply(mat); // 디렉셔널 라이트는 기존처럼 유니폼 변수로 전송
+        mat.set(MaterialBinding::View, view); // 프래그먼트 셰이더에서 클러스터의 깊이 슬라이스를 찾기 위해 뷰행렬도 전송
+        mat.set(MaterialBinding::AmbientCol, glm::vec3(0.0, 0.0, 0.0));
+        mat.set(MaterialBinding::CameraPos, scene->cam.pos);
+    }
+    if (mat.update(MaterialBinding::PerObject, &shieldMesh)) {
+        mat.set(MaterialBinding::Mvp, mvp);
+        mat.set(MaterialBinding::Model, model);
+        mat.set(MaterialBinding::NormalMatrix, normalMatrix);
+    }
+    
+    mat.draw(shieldMesh);
+    
+    mat.end();
+}
 
-    shd.setUniformMatrix4f("mvp", mvp); // 위에서 한꺼번에 합쳐준 mvp 행렬을 버텍스 셰이더 유니폼 변수로 전송
-    shd.setUniformMatrix4f("model", model); // 버텍스 좌표를 월드좌표로 변환하기 위해 모델행렬만 따로 버텍스 셰이더 유니폼 변수로 전송
-    shd.setUniformMatrix3f("normalMatrix", normalMatrix); // 노말행렬을 버텍스 셰이더 유니폼 변수로 전송
-    shd.setUniform3f("meshSpecCol", glm::vec3(1, 1, 1)); // 스펙큘러 색상을 흰색으로 지정하여 유니폼 변수로 전송
-    shd.setUniformTexture("diffuseTex", diffuseTex, 0); // 디퓨즈 라이팅 계산에 사용할 텍스쳐 유니폼 변수로 전송
-    shd.setUniformTexture("specTex", specTex, 1); // 스펙큘러 라이팅 계산에 사용할 텍스쳐 유니폼 변수로 전송
-    shd.setUniformTexture("nrmTex", nrmTex, 2); // 노말 매핑에 사용할 텍스쳐 유니폼 변수로 전송
-    shd.setUniformTexture("envMap", cubemap.getTexture(), 3); // 환경맵 반사를 적용하기 위해 사용할 큐브맵 텍스쳐 유니폼 변수로 전송
-    shd.setUniform3f("ambientCol", glm::vec3(0.0, 0.0, 0.0)); // 배경색과 동일한 앰비언트 라이트 색상값을 유니폼 변수로 전송.
-    shd.setUniform3f("cameraPos", cam.pos); // 프래그먼트 셰이더에서 뷰 벡터를 계산하기 위해 카메라 좌표(카메라 월드좌표)를 프래그먼트 셰이더 유니폼 변수로 전송
+// 디퍼드 모드의 G-버퍼 패스. 방패/물 메쉬를 한 번씩만 그리면서 재질, 노멀, 깊이를 G-버퍼에 기록함. (텍스쳐 샘플링도 여기서 한 번만 함)
+// 이후 조명 패스들이 디렉셔널 라이트는 화면 전체, 포인트라이트는 라이트 볼륨이 덮는 픽셀만 G-버퍼를 읽어서 조명을 누적하고,
+// 스카이박스는 G-버퍼의 깊이를 그대로 사용해서 포워드로 그린 뒤, 결과를 현재 렌더 타겟(윈도우 또는 벤치마크 FBO)으로 옮김. (buildRenderGraph() 참고)
+void ofApp::drawDeferredGeometry(glm::mat4& proj, glm::mat4& view) {
+    MaterialBinding& gbufferWater = shaders.get({ MeshType::Water, LightType::GBuffer, WATER_FEATURES });
+    MaterialBinding& gbufferShield = shaders.get({ MeshType::Shield, LightType::GBuffer, getShieldFeatures() });
     
-    shieldMesh.draw(); // shieldMesh 메쉬 드로우콜 호출하여 그려줌.
+    // G-버퍼 셰이더에는 조명 유니폼이 없으므로, 멀티패스와 같은 그리기 함수에 디렉셔널 라이트를 넘겨도 조명 값은 전송되지 않고 무시됨.
+    gbufferWater.begin();
+    drawWater(gbufferWater, -1, proj, view);
+    gbufferWater.end();
+    gbufferShield.begin();
+    drawShield(gbufferShield, -1, proj, view);
+    gbufferShield.end();
+}
+
+// 디렉셔널 라이트 + 앰비언트: 화면 전체 사각형으로 G-버퍼를 읽어서 Light 타겟에 누적함. (메쉬가 없는 픽셀은 셰이더에서 버림)
+void ofApp::drawDeferredDirectionalLight(glm::mat4& proj, glm::mat4& view) {
+    MaterialBinding& dirMat = shaders.get({ MeshType::LightVolume, LightType::Directional });
+    dirMat.begin();
+    gbuffer.bind(dirMat);
+    if (dirMat.update(MaterialBinding::PerFrame)) {
+        scene->dirLight.apply(dirMat);
+        dirMat.set(MaterialBinding::AmbientCol, glm::vec3(0.0, 0.0, 0.0));
+        dirMat.set(MaterialBinding::CameraPos, scene->cam.pos);
+        dirMat.set(MaterialBinding::InvViewProj, glm::inverse(proj * view));
+    }
+    dirMat.draw(screenQuadMesh);
+    dirMat.end();
+}
+
+// 포인트라이트: 라이트마다 구체 볼륨을 인스턴싱으로 한꺼번에 그림. (인스턴스 번호 = LightBuffer 의 라이트 인덱스)
+// 구체의 뒷면만 GL_GEQUAL 로 그리면, 볼륨 뒷면보다 앞에 메쉬가 있는 픽셀만 남으므로 카메라가 볼륨 안에 있어도 빠짐없이 그려짐.
+// 원평면 뒤로 넘어가는 볼륨이 잘리지 않도록 깊이 클램핑도 켜줌. (이 상태들은 렌더 그래프의 패스 선언에서 지정)
+void ofApp::drawDeferredPointLights(glm::mat4& proj, glm::mat4& view) {
+    if (scene->lights.empty()) {
+        return;
+    }
+    glm::mat4 viewProj = proj * view;
     
-    shd.end();
-    // shd 사용 중단
+    MaterialBinding& pointMat = shaders.get({ MeshType::LightVolume, LightType::Point });
+    pointMat.begin();
+    gbuffer.bind(pointMat);
+    lightBuffer.bind(pointMat);
+    pointShadows.bind(pointMat);
+    if (pointMat.update(MaterialBinding::PerFrame)) {
+        pointMat.set(MaterialBinding::ViewProj, viewProj);
+        pointMat.set(MaterialBinding::InvViewProj, glm::inverse(viewProj));
+        pointMat.set(MaterialBinding::CameraPos, scene->cam.pos);
+    }
+    pointMat.drawInstanced(lightVolumeMesh, int(scene->lights.size()));
+    pointMat.end();
 }
 
-// 포인트라이트 패스 렌더링 시, 블렌딩모드와 깊이테스트 모드를 재설정하는 함수
-void ofApp::beginRenderingPointLights() {
-    // 동적 멀티라이팅 기법에서는 멀티패스 셰이딩, 즉 물체 하나에 여러 개의 셰이더가 적용된 동일한 메쉬를 반복해서 그려주는 방식을 사용함.
-    // 따라서, 이전에 그려진 동일한 메쉬의 색상(기존 버퍼 색상)과 새로 그려진 동일한 메쉬(새 색상)을 가산 블렌딩할 수 있도록 활성화한 것.
-    ofEnableAlphaBlending();
-    ofEnableBlendMode(ofBlendMode::OF_BLENDMODE_ADD);
+// 깊이 프리패스. 물/방패 메쉬를 위치만 변환하는 셰이더로 한 번씩 그려서 보이는 표면의 깊이만 먼저 채워둠.
+// 이후 셰이딩 패스들은 GL_EQUAL + 깊이 쓰기를 끈 상태로 그리므로, 가려진 프래그먼트는 early-Z 에서 버려져서 조명 셰이더를 실행하지 않음.
+// (라이트마다 메쉬를 다시 그리는 멀티패스 모드에서는 포인트라이트 패스마다 같은 오버드로우가 반복되므로 효과가 가장 큼)
+// 깊이값이 셰이딩 패스와 정확히 같아야 하므로, 셰이딩 패스와 같은 그리기 함수(= 같은 캐시 행렬)로 그림. (depthOnly.vert 의 invariant 참고)
+void ofApp::drawDepthPrepass(glm::mat4& proj, glm::mat4& view) {
+    // 클러스터드 모드는 인스턴스 없이 방패 1개만 그리므로 프리패스도 같게 맞춤.
+    bool clustered = renderMode == RenderMode::Clustered;
+    MaterialBinding& water = shaders.get({ MeshType::Water, LightType::DepthOnly, Ocean });
+    MaterialBinding& shield = shaders.get({ MeshType::Shield, LightType::DepthOnly, clustered ? 0u : getShieldFeatures() & Instanced });
     
-    // 깊이 테스트 모드를 GL_LEQUAL 로 변경함. (관련 설명 하단 필기 참고)
-    glDepthFunc(GL_LEQUAL);
+    water.begin();
+    drawWater(water, -1, proj, view);
+    water.end();
+    shield.begin();
+    if (clustered) {
+        shield.set(MaterialBinding::Mvp, transforms.getMvp(shieldTransform));
+        shield.draw(shieldMesh);
+    } else {
+        drawShield(shield, -1, proj, view);
+    }
+    shield.end();
+}
+
+// 포인트라이트 셰도우맵의 면 하나에 caster 들을 그리는 함수. (PointShadowCache::render() 가 면마다 뷰포트를 타일에 맞춘 뒤 호출함)
+// 깊이 프리패스와 같은 depthOnly 셰이더를 쓰지만, 면마다 행렬이 바뀌므로 프리패스와 유니폼 캐시가 섞이지 않도록 LightType::Shadow 로 따로 컴파일한 프로그램을 씀.
+void ofApp::drawShadowCasters(const glm::mat4& viewProj, bool dynamic) {
+    if (dynamic) {
+        MaterialBinding& water = shaders.get({ MeshType::Water, LightType::Shadow, Ocean });
+        water.begin();
+        ocean.bind(water);
+        water.set(MaterialBinding::Model, transforms.getWorld(waterTransform));
+        water.set(MaterialBinding::ViewProj, viewProj);
+        water.draw(waterMesh);
+        water.end();
+    } else {
+        MaterialBinding& shield = shaders.get({ MeshType::Shield, LightType::Shadow });
+        shield.begin();
+        shield.set(MaterialBinding::Mvp, viewProj * transforms.getWorld(shieldTransform));
+        shield.draw(shieldMesh);
+        shield.end();
+    }
 }
 
-// 포인트라이트 패스 렌더링 완료 후, 블렌딩모드와 깊이테스트 모드를 원래대로 초기화하는 함수
-void ofApp::endRenderingPointLights() {
-    // 알파블렌딩 모드를 비활성화함.
-    ofDisableAlphaBlending();
-    ofDisableBlendMode();
+// 그림자 caster 들의 상태를 pointShadows 에 알려주는 함수. (바뀐 게 없으면 아무 면도 다시 그리지 않음)
+// 방패는 1개만 그릴 때(클러스터드 모드는 항상 1개)만 그림자를 드리움. 인스턴스 버퍼에는 카메라 프러스텀을 통과한 인스턴스만 올라가므로 caster 로 쓰지 않음.
+// 물 표면은 바다 시간값이 바뀔 때마다 모양이 바뀌므로, 변위만큼 넓힌 경계에 닿는 면들을 다시 그리게 함.
+// (continuous caster 로 등록했으므로 이 면들은 새 라이트, 라이트 이동 등으로 다시 그릴 면을 밀어내지 않고 남는 예산으로만 갱신됨)
+void ofApp::updateShadowCasters() {
+    pointShadows.setCasterEnabled(shieldCaster, numShieldInstances == 0 || renderMode == RenderMode::Clustered);
+    glm::vec3 margin(ocean.getMaxDisplacement());
+    pointShadows.setCasterBounds(waterCaster, waterBoundsMin - margin, waterBoundsMax + margin);
+    if (scene->waterTime != shadowWaterTime) {
+        shadowWaterTime = scene->waterTime;
+        pointShadows.markMoved(waterCaster);
+    }
+}
+
+// 현재 렌더링 방식과 깊이 프리패스 설정으로 프레임의 패스들을 선언하는 함수.
+// 각 패스는 읽고 쓰는 리소스와 필요한 고정 기능 상태(깊이, 블렌딩, 컬링)만 선언하고, 실행 순서와 상태 전환은 RenderGraph 가 맡음.
+// 실행 함수들은 this 만 캡쳐하고 투영/뷰행렬은 frameProj, frameView 에서 읽으므로, 설정이 바뀔 때만 다시 만들면 됨.
+// 씬을 그리는 크기(graphRenderWidth, graphRenderHeight)가 출력 크기보다 작으면 씬을 그래프의 렌더 타겟(디퍼드 모드는 G-버퍼)에 그린 뒤
+// 마지막 업스케일 패스에서 출력으로 늘려 그림. (DynamicResolution 의 스케일은 step 단위로만 바뀌므로 다시 만드는 일은 드묾)
+void ofApp::buildRenderGraph() {
+    using Resource = RenderGraph::Resource;
+    using State = RenderGraph::State;
+    
+    renderGraph.clear();
+    graphRenderMode = renderMode;
+    graphDepthPrepass = depthPrepass;
+    graphShadows = pointShadows.isEnabled();
+    bool scaled = graphRenderWidth != graphTargetWidth || graphRenderHeight != graphTargetHeight;
     
-    // 깊이테스트 모드를 원래의 GL_LESS 로 초기화함.
-    glDepthFunc(GL_LESS);
+    Resource output = renderGraph.importResource("target color"); // 현재 렌더 타겟 (윈도우 또는 벤치마크 FBO)
+    Resource color = output;
+    Resource depth = renderGraph.importResource("target depth");
+    renderGraph.markOutput(output);
+    
+    // 화면 전체 사각형이나 텍스쳐로 출력 전체를 덮어쓰는 패스 (합성, 업스케일)
+    State screen;
+    screen.depthTest = false;
+    screen.depthWrite = false;
+    
+    sceneTarget = -1;
+    if (scaled && renderMode != RenderMode::Deferred) {
+        // 색상과 깊이 텍스쳐를 한 FBO 에 붙여서 만들므로, 포워드 패스들이 쓰던 색상/깊이 리소스를 이 타겟 하나로 바꿔서 선언함.
+        sceneTarget = renderGraph.createTarget("scene", { graphRenderWidth, graphRenderHeight, GL_RGBA8, true });
+        color = sceneTarget;
+        depth = sceneTarget;
+        // 윈도우와 벤치마크 FBO 는 오픈프레임웍스와 Benchmark 가 프레임마다 지워주지만, 그래프의 렌더 타겟은 직접 지워야 함.
+        renderGraph.addPass("clear scene", State(), {}, { sceneTarget }, [this] {
+            beginSceneTarget();
+            ofClear(0, 0, 0, 255);
+            endSceneTarget();
+        });
+    }
+    
+    // 포인트라이트 셰도우맵. update() 에서 고른 면들만 아틀라스에 다시 그리고, 포인트라이트를 계산하는 패스들이 읽어감. (모든 모드 공통)
+    Resource shadowAtlas = renderGraph.importResource("shadow atlas");
+    if (graphShadows) {
+        State shadow;
+        shadow.colorWrite = false;
+        renderGraph.addPass("point shadows", shadow, {}, { shadowAtlas }, [this] {
+            pointShadows.render();
+        });
+    }
+    
+    State prepass;
+    prepass.colorWrite = false; // 깊이만 기록함.
+    
+    // 깊이 프리패스를 그렸다면, 첫 셰이딩 패스는 프리패스가 채워둔 깊이와 같은 프래그먼트만 셰이딩하고 깊이는 다시 쓰지 않음.
+    State shading;
+    if (depthPrepass) {
+        shading.depthFunc = GL_EQUAL;
+        shading.depthWrite = false;
+    }
+    
+    // 스카이박스는 z / w = 1.0 이므로 GL_LEQUAL 로 그림. (깊이비교모드 관련 필기 하단 참고) 스카이박스 뒤에 깊이를 읽는 패스는 없으므로 깊이는 기록하지 않음.
+    State skybox;
+    skybox.depthFunc = GL_LEQUAL;
+    skybox.depthWrite = false;
+    
+    if (renderMode == RenderMode::Deferred) {
+        Resource gbufferColor = renderGraph.importResource("gbuffer");
+        Resource gbufferDepth = renderGraph.importResource("gbuffer depth");
+        Resource lightAccum = renderGraph.importResource("gbuffer light");
+        
+        // 프리패스가 G-버퍼의 깊이만 지우고 채우면, 지오메트리 패스는 색상만 지움. (glClear 도 쓰기 마스크를 따르므로 각자 쓰는 버퍼만 지움)
+        if (depthPrepass) {
+            renderGraph.addPass("depth prepass", prepass, {}, { gbufferDepth }, [this] {
+                gbuffer.beginGeometryPass(GL_DEPTH_BUFFER_BIT);
+                drawDepthPrepass(frameProj, frameView);
+                gbuffer.end();
+            });
+        }
+        renderGraph.addPass("geometry pass", shading, { gbufferDepth }, { gbufferColor, gbufferDepth, lightAccum }, [this] {
+            gbuffer.beginGeometryPass(depthPrepass ? GL_COLOR_BUFFER_BIT : GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            drawDeferredGeometry(frameProj, frameView);
+            gbuffer.end();
+        });
+        
+        // 조명 패스들은 G-버퍼에 기록된 깊이를 읽기만 하고, 결과는 Light 타겟에 가산 블렌딩으로 누적함.
+        State directional;
+        directional.depthTest = false;
+        directional.depthWrite = false;
+        directional.blend = RenderGraph::Blend::Add;
+        renderGraph.addPass("deferred directional light", directional, { gbufferColor, gbufferDepth, lightAccum }, { lightAccum }, [this] {
+            gbuffer.beginLightingPass();
+            drawDeferredDirectionalLight(frameProj, frameView);
+            gbuffer.end();
+        });
+        
+        State volumes;
+        volumes.depthFunc = GL_GEQUAL;
+        volumes.depthWrite = false;
+        volumes.blend = RenderGraph::Blend::Add;
+        volumes.cull = RenderGraph::Cull::Front;
+        volumes.depthClamp = true;
+        renderGraph.addPass("deferred point lights", volumes, { gbufferColor, gbufferDepth, lightAccum, shadowAtlas }, { lightAccum }, [this] {
+            gbuffer.beginLightingPass();
+            drawDeferredPointLights(frameProj, frameView);
+            gbuffer.end();
+        });
+        
+        renderGraph.addPass("skybox", skybox, { gbufferDepth, lightAccum }, { lightAccum }, [this] {
+            gbuffer.beginLightingPass();
+            drawSkybox();
+            gbuffer.end();
+        });
+        
+        if (scaled) {
+            renderGraph.addPass("upscale", screen, { lightAccum }, { output }, [this] {
+                drawUpscale();
+            });
+        } else {
+            renderGraph.addPass("composite", screen, { lightAccum }, { output }, [this] {
+                gbuffer.getLightTexture().draw(0, 0, gbuffer.getWidth(), gbuffer.getHeight());
+            });
+        }
+    } else {
+        // 패스 실행 함수들은 씬 렌더 타겟을 쓰고 있으면 각자 바인딩해서 그림. (ofFbo::begin() 이 뷰포트도 타겟 크기로 맞춤)
+        if (depthPrepass) {
+            renderGraph.addPass("depth prepass", prepass, {}, { depth }, [this] {
+                beginSceneTarget();
+                drawDepthPrepass(frameProj, frameView);
+                endSceneTarget();
+            });
+        }
+        
+        if (renderMode == RenderMode::Clustered) {
+            // 클러스터드 모드에서는 방패메쉬 및 물 메쉬를 한 번씩만 그리면서 모든 조명을 한 패스 안에서 계산함.
+            renderGraph.addPass("clustered shading", shading, { depth, shadowAtlas }, { color, depth }, [this] {
+                beginSceneTarget();
+                drawWaterClustered(frameProj, frameView);
+                drawShieldClustered(frameView);
+                endSceneTarget();
+            });
+        } else {
+            // 디렉셔널 라이트 패스 -> 포인트라이트 패스 순서는 유지하면서, 각 패스 안에서는 같은 셰이더 프로그램끼리 모아서 그림.
+            renderGraph.addPass("directional pass", shading, { depth }, { color, depth }, [this] {
+                beginSceneTarget();
+                submitDrawRange(drawPackets.begin(), drawPackets.begin() + numDirectionalPackets, frameProj, frameView);
+                endSceneTarget();
+            });
+            
+            // 동적 멀티라이팅 기법에서는 멀티패스 셰이딩, 즉 물체 하나에 여러 개의 셰이더가 적용된 동일한 메쉬를 반복해서 그려주는 방식을 사용함.
+            // 따라서, 이전에 그려진 동일한 메쉬의 색상(기존 버퍼 색상)과 새로 그려진 동일한 메쉬(새 색상)를 가산 블렌딩하고,
+            // 같은 깊이의 프래그먼트도 통과하도록 깊이테스트 모드를 GL_LEQUAL 로 바꿈. (관련 설명 하단 필기 참고)
+            // 깊이 프리패스를 그렸다면 GL_EQUAL 을 그대로 씀. (프리패스가 보이는 표면의 깊이를 모두 채워뒀으므로 같은 결과가 나옴)
+            State pointPasses;
+            pointPasses.depthFunc = depthPrepass ? GL_EQUAL : GL_LEQUAL;
+            pointPasses.depthWrite = false;
+            pointPasses.blend = RenderGraph::Blend::Add;
+            renderGraph.addPass("point light passes", pointPasses, { color, depth, shadowAtlas }, { color }, [this] {
+                beginSceneTarget();
+                submitDrawRange(drawPackets.begin() + numDirectionalPackets, drawPackets.end(), frameProj, frameView);
+                endSceneTarget();
+            });
+        }
+        
+        // 스카이박스는 메쉬들을 모두 그린 뒤 마지막에 그려서, 메쉬에 가려지지 않은 픽셀에서만 셰이딩되도록 함.
+        // (먼저 그리면 화면 전체를 셰이딩한 뒤 메쉬가 그 위를 덮어씀)
+        renderGraph.addPass("skybox", skybox, { depth }, { color }, [this] {
+            beginSceneTarget();
+            drawSkybox();
+            endSceneTarget();
+        });
+        
+        if (scaled) {
+            renderGraph.addPass("upscale", screen, { sceneTarget }, { output }, [this] {
+                drawUpscale();
+            });
+        }
+    }
+    
+    renderGraph.compile();
+}
+
+void ofApp::beginSceneTarget() {
+    if (sceneTarget >= 0) {
+        renderGraph.getTarget(sceneTarget).begin();
+    }
+}
+
+void ofApp::endSceneTarget() {
+    if (sceneTarget >= 0) {
+        renderGraph.getTarget(sceneTarget).end();
+    }
+}
+
+// 업스케일 패스. 씬 텍스쳐(포워드 모드는 씬 렌더 타겟, 디퍼드 모드는 G-버퍼의 Light)를 화면 전체 사각형으로 늘려 그림.
+// 필터링은 upscale.frag 에서 바이리니어 + 주변 텍셀 범위로 자른 샤프닝으로 처리함.
+void ofApp::drawUpscale() {
+    const ofTexture& source = renderMode == RenderMode::Deferred ? gbuffer.getLightTexture() : renderGraph.getTarget(sceneTarget).getTexture();
+    MaterialBinding& mat = shaders.get({ MeshType::ScreenQuad, LightType::None });
+    mat.begin();
+    mat.setTexture(MaterialBinding::SceneColor, source);
+    mat.set(MaterialBinding::Sharpness, dynamicResolution.getSettings().sharpness);
+    mat.draw(screenQuadMesh);
+    mat.end();
 }
 
 //--------------------------------------------------------------
 void ofApp::draw(){
     using namespace glm; // 이제부터 현재 블록 내에서 glm 라이브러리에서 꺼내 쓸 함수 및 객체들은 'glm::' 을 생략해서 사용해도 됨.
+    
+    // ofExit() 을 호출한 프레임에도 draw() 가 한 번 더 불리므로, 측정이 끝난 뒤에는 아무것도 그리지 않음.
+    if (benchmark.isFinished()) {
+        return;
+    }
         
     // 투영행렬 계산
-    float aspect = 1024.0f / 768.0f; // main.cpp 에서 정의한 윈도우 실행창 사이즈를 기준으로 원근투영행렬의 종횡비(aspect)값을 계산함.
-    mat4 proj = perspective(cam.fov, aspect, 0.01f, 10.0f); // glm::perspective() 내장함수를 사용해 원근투영행렬 계산.
+    // 렌더 타겟(윈도우 또는 벤치마크 FBO) 크기를 기준으로 원근투영행렬의 종횡비(aspect)값을 계산함.
+    int targetWidth = benchmark.isEnabled() ? benchmark.getSettings().width : ofGetWidth();
+    int targetHeight = benchmark.isEnabled() ? benchmark.getSettings().height : ofGetHeight();
+    
+    // 텍스쳐가 아직 다 로드되지 않았으면 (아직 시뮬레이션 스냅샷도 없으므로) 씬 대신 로딩 화면(placeholder)을 그림.
+    if (!scene) {
+        drawLoadingScreen();
+        return;
+    }
+    
+    if (softwareBackend) {
+        drawSoftware(targetWidth, targetHeight);
+        return;
+    }
+    float aspect = float(targetWidth) / targetHeight;
+    mat4 proj = perspective(scene->cam.fov, aspect, NEAR_PLANE, FAR_PLANE); // glm::perspective() 내장함수를 사용해 원근투영행렬 계산.
     
     // 카메라 변환시키는 뷰행렬 계산. 이동행렬만 적용
-    mat4 view = inverse(translate(cam.pos)); // 뷰행렬은 카메라 움직임에 반대방향으로 나머지 대상들을 움직이는 변환행렬이므로, glm::inverse() 내장함수로 역행렬을 구해야 함.
+    mat4 view = inverse(translate(scene->cam.pos)); // 뷰행렬은 카메라 움직임에 반대방향으로 나머지 대상들을 움직이는 변환행렬이므로, glm::inverse() 내장함수로 역행렬을 구해야 함.
+    
+    if (benchmark.isEnabled()) {
+        benchmark.beginDraw(); // 씬을 윈도우 대신 FBO 에 그리고 GPU 시간을 재기 시작함.
+    }
+    
+    PROFILE_ZONE("draw");
+    
+    // 이전 프레임들의 GPU 시간으로 이번 프레임의 렌더 스케일을 정하고, 씬을 그리는 크기를 구함. (투영행렬의 종횡비는 출력 크기 기준 그대로)
+    dynamicResolution.beginFrame();
+    int renderWidth = dynamicResolution.getRenderWidth(targetWidth);
+    int renderHeight = dynamicResolution.getRenderHeight(targetHeight);
+    
+    if (renderMode == RenderMode::Deferred) {
+        gbuffer.allocate(renderWidth, renderHeight); // 크기가 바뀌었을 때만 다시 할당함. (텍스쳐가 바뀌므로 텍스쳐 유닛 캐시를 비우는 beginFrame() 보다 먼저)
+    }
+    
+    // 패스 구성은 렌더링 방식, 깊이 프리패스/그림자 설정, 출력 크기나 렌더 스케일이 바뀌었을 때만 다시 선언함. (패스 목록을 만드는 힙 할당은 측정 구간에서 제외)
+    if (!renderGraph.isCompiled() || graphRenderMode != renderMode || graphDepthPrepass != depthPrepass || graphShadows != pointShadows.isEnabled()
+        || graphTargetWidth != targetWidth || graphTargetHeight != targetHeight || graphRenderWidth != renderWidth || graphRenderHeight != renderHeight) {
+        graphTargetWidth = targetWidth;
+        graphTargetHeight = targetHeight;
+        graphRenderWidth = renderWidth;
+        graphRenderHeight = renderHeight;
+        buildRenderGraph();
+    }
+    frameProj = proj;
+    frameView = view;
+    
+    uint64_t allocationsBefore = AllocationCounter::getThreadAllocations(); // 씬 렌더링 구간의 힙 할당 횟수를 재기 위한 시작값
+    
+    MaterialBinding::beginFrame(); // 프레임별 유니폼 갱신 및 GL 호출 수 집계를 새로 시작함.
+    
+    // 메쉬들의 월드/mvp/노말행렬을 여기서 한 번만 갱신함. 이후 라이트 패스마다 호출되는 그리기 함수들은 캐시된 행렬만 가져다 씀.
+    {
+        PROFILE_ZONE("transforms");
+        transforms.setLocal(skyboxTransform, translate(scene->cam.pos));
+        transforms.update(proj * view);
+    }
     
-    drawSkybox(proj, view); // cubeMesh 메쉬 드로우 함수를 추출하여 정의한 뒤 호출함.
+    if (!benchmark.isEnabled()) {
+        fragmentCounter.begin(); // 씬을 그리는 동안 실행된 프래그먼트 수를 셈. (벤치마크 모드에서는 Benchmark 가 같은 쿼리로 셈)
+    }
 
-    // 이제 동일한 방패메쉬 및 물 메쉬에 대해 여러 개의 멀티패스 셰이딩이 적용된 메쉬들을 반복적으로 렌더링함.
-    // 디렉셔널 라이트 셰이더가 적용된 방패메쉬 및 물 메쉬 렌더링함.
-    drawWater(dirLight, proj, view);
-    drawShield(dirLight, proj, view);
+    // 패스들이 읽어갈 CPU 쪽 데이터(보이는 인스턴스, 라이트 목록, 다시 그릴 셰도우맵 면)를 먼저 준비함.
+    {
+        PROFILE_ZONE("shadow update");
+        updateShadowCasters(); // 그림자를 끈 동안 바뀐 caster 도 다시 켰을 때 반영되도록 항상 알려줌.
+        pointShadows.update(scene->lights, proj * view, scene->cam.pos, proj[1][1], renderHeight); // 꺼져 있으면 통계만 비움.
+    }
+    if (renderMode == RenderMode::Clustered) {
+        // 클러스터드 모드에서는 CPU 에서 포인트라이트를 클러스터에 할당해둠.
+        PROFILE_ZONE("cluster assignment");
+        lightClusters.update(scene->lights, view, proj, NEAR_PLANE, FAR_PLANE); // 근평면, 원평면 값은 위의 원근투영행렬과 동일하게 맞춰줘야 함.
+    } else {
+        if (numShieldInstances > 0) {
+            PROFILE_ZONE("instance culling");
+            shieldInstances.cull(proj * view); // 프러스텀 밖의 방패 인스턴스를 걸러내고 보이는 것만 인스턴스 버퍼로 올림.
+        }
+        if (renderMode == RenderMode::Multipass) {
+            // 메쉬별 라이트 컬링은 시뮬레이션 스레드가 스냅샷을 만들 때 이미 끝내뒀으므로, 그 목록으로 드로우콜만 만듦.
+            PROFILE_ZONE("build draw packets");
+            buildDrawPackets();
+        }
+    }
+    
+    renderGraph.execute(); // 선언된 패스들을 정해진 순서대로 실행하면서, 패스마다 바뀐 GL 상태만 전송함.
+    fragmentCounter.end();
+    dynamicResolution.endFrame();
+    
+    // 통계 텍스트를 만드는 drawStats() 는 문자열 할당이 필요하므로 측정 구간에서 제외함.
+    drawAllocations = AllocationCounter::getThreadAllocations() - allocationsBefore;
+    
+    measureLatency();
+    
+    // 벤치마크 모드에서는 통계 텍스트가 측정값과 PNG 에 섞이지 않도록 그리지 않음.
+    if (benchmark.isEnabled()) {
+        benchmark.endDraw();
+        return;
+    }
+    
+    drawStats();
+#ifdef PROFILER
+    if (showProfiler) {
+        Profiler::drawOverlay(ofGetWidth() - 520, 20); // 직전 프레임의 구간별 CPU/GPU 시간 및 호출 수
+    }
+#endif
+}
 
-    // 포인트라이트 셰이더가 적용된 방패메쉬 및 물 메쉬 렌더링함.
-    // 이때, 이전에 그린 방패메쉬 및 물 메쉬의 프래그먼트들과 색상을 가산블렌딩하기 위해 알파블렌딩 및 깊이테스트 설정을 변경함
-    beginRenderingPointLights();
+// 이번 프레임 스냅샷의 시뮬레이션 시작부터 그리기(GL 명령 제출)가 끝날 때까지 걸린 시간을 기록하는 함수
+void ofApp::measureLatency() {
+    pipelineStats.latencyMs = (ofGetElapsedTimeMicros() - scene->simulationBeginMicros) / 1000.0f;
+    if (benchmark.isEnabled()) {
+        benchmark.setLatency(pipelineStats.latencyMs);
+        benchmark.setRenderScale(dynamicResolution.getScale());
+        benchmark.setShadowFaces(pointShadows.getStats().renderedFaces, pointShadows.getStats().cachedFaces);
+    }
+}
 
-    // 포인트라이트 구조체가 담긴 동적배열을 for loop 로 돌리면서
-    // 원하는 개수만큼의 포인트라이트 셰이더가 적용된 방패메쉬 및 물 메쉬를 반복해서 렌더링함.
-    for (int i = 0; i < pointLights.size(); ++i) {
-        drawWater(pointLights[i], proj, view);
-        drawShield(pointLights[i], proj, view);
+// 에셋 로드가 끝나기 전에 씬 대신 그리는 로딩 화면
+void ofApp::drawLoadingScreen() {
+    ofClear(0, 0, 0);
+    
+    float progress = assetLoader.getProgress();
+    ofDisableDepthTest();
+    ofPushStyle();
+    ofSetColor(60);
+    ofDrawRectangle(ofGetWidth() * 0.25f, ofGetHeight() * 0.5f - 4, ofGetWidth() * 0.5f, 8);
+    ofSetColor(255);
+    ofDrawRectangle(ofGetWidth() * 0.25f, ofGetHeight() * 0.5f - 4, ofGetWidth() * 0.5f * progress, 8);
+    ofPopStyle();
+    ofDrawBitmapString("loading assets... " + ofToString(int(progress * 100)) + "%", ofGetWidth() * 0.25f, ofGetHeight() * 0.5f - 16);
+    ofEnableDepthTest();
+}
+
+// SoftwareRenderer 가 샘플링할 방패 텍스쳐와 큐브맵 면들을 CPU 메모리로 로드하는 함수. (GL 경로와 같은 파일, 큐브맵 면 순서도 같음)
+void ofApp::loadSoftwareAssets() {
+    ofPixels pixels;
+    ofLoadImage(pixels, "shield_diffuse.png");
+    softwareDiffuse.setup(pixels);
+    ofLoadImage(pixels, "shield_spec.png");
+    softwareSpec.setup(pixels);
+    ofLoadImage(pixels, "shield_normal.png");
+    softwareNormal.setup(pixels);
+    
+    const char* cubemapFiles[6] = {
+        "night_right.jpg", "night_left.jpg",
+        "night_top.jpg", "night_bottom.jpg",
+        "night_front.jpg", "night_back.jpg"
+    };
+    ofPixels faces[6];
+    for (int i = 0; i < 6; ++i) {
+        ofLoadImage(faces[i], cubemapFiles[i]);
+    }
+    softwareCubemap.setup(faces);
+}
+
+// 멀티패스 모드의 방패 1개 + 물 + 스카이박스를 SoftwareRenderer 로 그리는 함수. 행렬과 조명은 draw() 의 GL 경로와 같은 값을 사용함.
+void ofApp::renderSoftware(int width, int height) {
+    using namespace glm;
+    
+    mat4 proj = perspective(scene->cam.fov, float(width) / height, NEAR_PLANE, FAR_PLANE);
+    mat4 view = inverse(translate(scene->cam.pos));
+    
+    softwareRenderer.beginFrame(width, height, proj * view, scene->cam.pos, getLightDirection(scene->dirLight), getLightColor(scene->dirLight), scene->lights);
+    softwareRenderer.drawSkybox(softwareCubemap);
+    
+    // 바다 결과는 half float 그대로 CPU 버퍼에 있으므로 float 텍셀로 바꿔서 샘플링함. (변위 텍셀 뒤에 기울기 텍셀이 이어짐)
+    const uint8_t* oceanData = ocean.getCpuData();
+    if (oceanData) {
+        int n = ocean.getSettings().resolution;
+        const uint16_t* texels = reinterpret_cast<const uint16_t*>(oceanData);
+        softwareDisplacement.setupHalfFloat(n, n, 4, texels);
+        softwareSlope.setupHalfFloat(n, n, 2, texels + size_t(n) * n * 4);
+        softwareRenderer.drawWater(waterMesh.getMesh(), transforms.getWorld(waterTransform), softwareDisplacement, softwareSlope,
+            1.0f / ocean.getSettings().patchSize, softwareCubemap);
+    }
+    
+    softwareRenderer.drawShield(shieldMesh.getMesh(), transforms.getWorld(shieldTransform), transforms.getNormalMatrix(shieldTransform),
+        softwareDiffuse, softwareSpec, softwareNormal, softwareCubemap);
+    softwareRenderer.endFrame();
+}
+
+// 소프트웨어 백엔드의 draw(). 벤치마크 모드에서는 결과 픽셀을 그대로 Benchmark 에 넘기고, 윈도우 모드에서는 텍스쳐로 올려서 화면에 그림.
+void ofApp::drawSoftware(int width, int height) {
+    if (benchmark.isEnabled()) {
+        benchmark.beginDraw();
+        renderSoftware(width, height);
+        measureLatency();
+        benchmark.endDraw(softwareRenderer.getPixels(), softwareRenderer.getStats().shadedPixels);
+        return;
+    }
+    
+    renderSoftware(width, height);
+    measureLatency();
+    softwareFrame.loadData(softwareRenderer.getPixels());
+    ofDisableDepthTest();
+    softwareFrame.draw(0, ofGetHeight(), ofGetWidth(), -ofGetHeight()); // 결과는 0 번 행이 화면 맨 아래이므로 위아래를 뒤집어서 그림.
+    ofEnableDepthTest();
+    drawStats();
+}
+
+// 벤치마크가 끝난 뒤 마지막 프레임을 스레드 수 1, 2, 4, ... (와 최대 스레드 수) 로 다시 그려서 코어 수에 따른 처리량을 기록하는 함수.
+// 스레드 수마다 몇 번 반복해서 가장 빠른 값을 씀. (스레드 풀을 새로 만든 직후의 첫 프레임이 느린 것을 빼기 위함)
+void ofApp::measureSoftwareThroughput() {
+    const int repeats = 3;
+    int width = benchmark.getSettings().width;
+    int height = benchmark.getSettings().height;
+    size_t maxThreads = SoftwareRenderer::getMaxThreads();
+    size_t threads = 1;
+    while (true) {
+        softwareRenderer.setNumThreads(threads);
+        double best = 0.0;
+        for (int i = 0; i < repeats; ++i) {
+            renderSoftware(width, height);
+            double ms = softwareRenderer.getStats().totalMs();
+            best = i == 0 ? ms : std::min(best, ms);
+        }
+        benchmark.addThroughput(threads, best);
+        if (threads == maxThreads) {
+            break;
+        }
+        threads = std::min(threads * 2, maxThreads);
     }
+    softwareRenderer.setNumThreads(benchmark.getSettings().threads);
+}
 
-    // 포인트라이트가 적용된 방패메쉬 및 물 메쉬 렌더링이 모두 끝나면, 알파블렌딩 및 깊이테스트 관련 설정을 초기화함.
-    endRenderingPointLights();
+// 현재 렌더링 방식, 라이트 개수, 프레임 시간을 화면 좌상단에 출력하는 함수 (두 렌더링 방식의 결과와 속도를 비교하기 위함)
+void ofApp::drawStats() {
+    std::string mode = renderMode == RenderMode::Clustered ? "clustered" : renderMode == RenderMode::Deferred ? "deferred" : "multipass";
+    std::string stats = "mode: " + mode + " ('m' to toggle)\n";
+    if (gpuAvailable) {
+        stats += "backend: " + std::string(softwareBackend ? "software" : "gl") + " ('b' to toggle)\n";
+    }
+    if (softwareBackend) {
+        const SoftwareRenderer::Stats& software = softwareRenderer.getStats();
+        stats += "software: " + ofToString(software.threads) + " threads, " + ofToString(software.triangles) + " triangles, " + ofToString(software.binned)
+            + " binned, " + ofToString(software.shadedPixels) + " shaded pixels, geometry " + ofToString(software.geometryMs, 2) + " ms, raster "
+            + ofToString(software.rasterMs, 2) + " ms (multipass scene, single shield)\n";
+    }
+    stats += "point lights: " + ofToString(scene->lights.size()) + " ('l' to add 32, 'k' to remove 32)\n";
+    stats += "shield instances: " + ofToString(numShieldInstances) + " ('i' to cycle)\n";
+    stats += "depth prepass: " + std::string(depthPrepass ? "on" : "off") + " ('z' to toggle)\n";
+    if (!softwareBackend) {
+        const DynamicResolution::Stats& dynres = dynamicResolution.getStats();
+        stats += "dynamic resolution: " + std::string(dynamicResolution.isEnabled() ? "on" : "off") + ", scale " + ofToString(dynamicResolution.getScale(), 2)
+            + " (" + ofToString(graphRenderWidth) + "x" + ofToString(graphRenderHeight) + "), gpu " + ofToString(dynres.gpuMs, 2) + " ms / "
+            + ofToString(dynamicResolution.getSettings().targetMs, 2) + " ms target, " + ofToString(dynres.changes) + " changes ('r' to toggle)\n";
+        const PointShadowCache::Stats& shadows = pointShadows.getStats();
+        stats += "point shadows: " + std::string(pointShadows.isEnabled() ? "on" : "off") + ", " + ofToString(shadows.shadowedLights) + " lights, rendered "
+            + ofToString(shadows.renderedFaces) + " faces (baked " + ofToString(shadows.bakedFaces) + "), cached " + ofToString(shadows.cachedFaces)
+            + ", deferred " + ofToString(shadows.deferredFaces) + ", atlas " + ofToString(int(shadows.atlasUsage * 100)) + "% ('h' to toggle)\n";
+    }
+    stats += "frame: " + ofToString(ofGetLastFrameTime() * 1000.0, 2) + " ms";
+    stats += "\npipeline: simulate " + ofToString(pipelineStats.simulateMs, 2) + " ms (waited " + ofToString(pipelineStats.simulationWaitMs, 2)
+        + " ms for a free slot), render waited " + ofToString(pipelineStats.renderWaitMs, 2) + " ms, latency " + ofToString(pipelineStats.latencyMs, 2)
+        + " ms, " + ofToString(pipelineStats.queued) + " snapshots queued";
+    stats += "\n" + std::string(FragmentCounter::getQueryName()) + ": " + ofToString(fragmentCounter.getLastResult());
+    const RenderGraph::Stats& graph = renderGraph.getStats();
+    stats += "\nrender graph: " + ofToString(graph.passes) + " passes (" + ofToString(graph.culled) + " culled), state changes "
+        + ofToString(graph.stateChanges) + ", skipped " + ofToString(graph.redundantStates);
+    stats += "\nlight buffer upload: " + ofToString(lightBuffer.getLastUploadBytes()) + " bytes";
+    const MaterialBinding::Stats& gl = MaterialBinding::getStats();
+    stats += "\ndraw calls: " + ofToString(gl.drawCalls);
+    stats += "\nGL calls: " + ofToString(gl.total()) + " (programs " + ofToString(gl.programBinds) + ", uniforms " + ofToString(gl.uniformCalls)
+        + ", textures " + ofToString(gl.textureCalls) + ", skipped " + ofToString(gl.skipped) + ")";
+    if (AllocationCounter::isEnabled()) {
+        stats += "\ndraw() heap allocations: " + ofToString(drawAllocations);
+    }
+    stats += "\nshield mesh: ACMR " + ofToString(shieldMesh.getAcmr(), 3) + ", " + ofToString(shieldMesh.getBytesPerVertex()) + " bytes/vertex (float "
+        + ofToString(shieldMesh.getFloatBytesPerVertex()) + ")";
+    const OceanSimulation::Stats& oceanStats = ocean.getStats();
+    stats += "\nocean: " + ofToString(ocean.getSettings().resolution) + "^2 ('o' to cycle), simulate " + ofToString(oceanStats.simulateMs, 2) + " ms, wait "
+        + ofToString(oceanStats.waitMs, 2) + " ms, upload " + ofToString(oceanStats.uploadMs, 2) + " ms (" + ofToString(oceanStats.uploadBytes / 1024) + " KB)";
+    stats += "\ncubemap memory: CPU " + ofToString(cubemap.getCpuBytes() / 1024) + " KB, GPU " + ofToString(cubemap.getGpuBytes() / 1024) + " KB";
+    if (renderMode == RenderMode::Multipass) {
+        const LightCulling::Stats& culling = scene->culling;
+        stats += "\nlight culling: tested " + ofToString(culling.tested) + ", visible " + ofToString(culling.visible)
+            + ", affecting " + ofToString(culling.affecting) + " of " + ofToString(culling.lights * 2) + " light/mesh pairs";
+    }
+    if (renderMode == RenderMode::Multipass && numShieldInstances > 0) {
+        const InstanceBuffer::Stats& instancing = shieldInstances.getStats();
+        stats += "\nshield instances: " + ofToString(instancing.visible) + " visible of " + ofToString(instancing.total)
+            + ", upload " + ofToString(instancing.uploadBytes / 1024) + " KB" + (naiveInstancing ? " (naive, 'n' to toggle)" : " ('n' for naive loop)");
+    }
+    if (renderMode == RenderMode::Deferred) {
+        stats += "\nG-buffer: " + ofToString(gbuffer.getWidth()) + "x" + ofToString(gbuffer.getHeight()) + ", " + ofToString(GBuffer::getBytesPerPixel())
+            + " bytes/pixel (" + ofToString(gbuffer.getWidth() * gbuffer.getHeight() * GBuffer::getBytesPerPixel() / (1024 * 1024)) + " MB)";
+    }
+    if (renderMode == RenderMode::Clustered) {
+        stats += "\ncluster light indices: " + ofToString(lightClusters.getNumLightIndices());
+        stats += " (max " + ofToString((int)lightClusters.getMaxLightsPerCluster()) + " per cluster)";
+    }
+    
+    ofDisableDepthTest(); // 텍스트가 씬의 깊이값에 가려지지 않도록 잠시 깊이테스트를 끔.
+    ofDrawBitmapStringHighlight(stats, 10, 20);
+    ofEnableDepthTest();
 }
 
 //--------------------------------------------------------------
 void ofApp::keyPressed(int key){
-
+    if (key == 'm') {
+        // 멀티패스 -> 클러스터드 -> 디퍼드 렌더링 방식 순환
+        renderMode = renderMode == RenderMode::Multipass ? RenderMode::Clustered
+            : renderMode == RenderMode::Clustered ? RenderMode::Deferred : RenderMode::Multipass;
+    } else if (key == 'l') {
+        runOnSimulation([this] { addRandomPointLights(32); }); // 포인트라이트 32개 추가 (포인트라이트는 시뮬레이션 스레드가 가지고 있으므로 넘겨줌)
+    } else if (key == 'k') {
+        runOnSimulation([this] { removeRandomPointLights(32); }); // 'l' 키로 추가한 포인트라이트 32개 제거
+    } else if (key == 'i') {
+        // 방패 인스턴스 개수 순환 (0 -> 1000 -> 10000 -> 100000 -> 0)
+        layoutShieldInstances(numShieldInstances == 0 ? 1000 : numShieldInstances >= 100000 ? 0 : numShieldInstances * 10);
+    } else if (key == 'n') {
+        naiveInstancing = !naiveInstancing; // 인스턴싱 <-> 인스턴스별 드로우콜 전환
+    } else if (key == 'z') {
+        depthPrepass = !depthPrepass; // 깊이 프리패스 켜기/끄기
+    } else if (key == 'r' && gpuAvailable) {
+        dynamicResolution.setEnabled(!dynamicResolution.isEnabled()); // 동적 해상도 켜기/끄기 (끄면 출력 크기로 바로 그림)
+    } else if (key == 'h' && gpuAvailable) {
+        pointShadows.setEnabled(!pointShadows.isEnabled()); // 포인트라이트 그림자 켜기/끄기
+    } else if (key == 'b' && gpuAvailable) {
+        // GL <-> 소프트웨어 렌더러 전환. 소프트웨어 렌더러는 바다 결과를 CPU 버퍼에서 읽으므로 바다 시뮬레이션도 다시 설정함.
+        softwareBackend = !softwareBackend;
+        if (softwareBackend && !softwareCubemap.isAllocated()) {
+            loadSoftwareAssets();
+        }
+        ocean.setUseTextures(!softwareBackend);
+        ocean.setup(ocean.getSettings());
+    } else if (key == 'o') {
+        // 바다 시뮬레이션 해상도 순환 (256 -> 512 -> 1024 -> 256)
+        OceanSimulation::Settings settings = ocean.getSettings();
+        settings.resolution = settings.resolution >= 1024 ? 256 : settings.resolution * 2;
+        ocean.setup(settings);
+    }
+#ifdef PROFILER
+    if (key == 'p') {
+        showProfiler = !showProfiler; // 프로파일러 오버레이 표시 전환
+    } else if (key == 't') {
+        Profiler::exportTrace(ofToDataPath("profile_trace.json", true)); // chrome://tracing 또는 ui.perfetto.dev 에서 열어볼 수 있음.
+    }
+#endif
 }
 
 //--------------------------------------------------------------
@@ -363,6 +1446,9 @@ void ofApp::mouseExited(int x, int y){
 
 //--------------------------------------------------------------
 void ofApp::windowResized(int w, int h){
+    if (!benchmark.isEnabled() && h > 0) {
+        targetAspect.store(float(w) / h, std::memory_order_relaxed); // 시뮬레이션 스레드의 라이트 컬링 프러스텀에 반영됨.
+    }
 
 }
 
@@ -2,6 +2,28 @@
 
 #include "ofMain.h"
 #include "ofxEasyCubemap.hpp"
+#include "LightClusters.hpp"
+#include "LightBuffer.hpp"
+#include "LightCulling.hpp"
+#include "InstanceBuffer.hpp"
+#include "PackedMesh.hpp"
+#include "OceanSimulation.hpp"
+#include "TransformSystem.hpp"
+#include "GBuffer.hpp"
+#include "RenderGraph.hpp"
+#include "FragmentCounter.hpp"
+#include "AssetLoader.hpp"
+#include "MaterialBinding.hpp"
+#include "ShaderRegistry.hpp"
+#include "Benchmark.hpp"
+#include "SoftwareRenderer.hpp"
+#include "SnapshotQueue.hpp"
+#include "DynamicResolution.hpp"
+#include "PointShadowCache.hpp"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <vector> // 동적 배열을 사용하기 위해 std::vector c++ 표준 라이브러리를 사용하기 위해 해당 템플릿을 include 시킴.
 
 // 카메라의 현재 위치 및 fov(시야각)값을 받는 구조체 타입 지정. (구조체 타입은 ts interface 랑 비슷한 개념이라고 생각하면 될 것 같음.)
@@ -10,50 +32,49 @@ struct CameraData {
     float fov;
 };
 
-// DirectionalLight 와 PointLight 구조체를 다형성으로 상속시킬 때 사용할 부모 구조체 Light 정의
-struct Light {
-    virtual bool isPointLight() { // virtual 키워드로 가상함수 정의 (가상함수 관련 필기 하단 참고)
-        // ofApp.cpp 의 drawWater(), drawShield() 에서 인자로 전달받은 조명구조체가 포인트라이트인지 아닌지 여부를 체크하는 메서드
-        // 기본값은 false, 즉 포인트라이트가 아님을 의미하는 불리언 값을 리턴함.
-        return false;
-    }
-    virtual void apply(ofShader& shd) {
-        // 상속받는 구조체에서 각 구조체에 포함된 멤버변수들을 유니폼 변수로 전송하는 로직들이 override 될 것임.
-        // drawWater(), drawShield() 내에서 호출됨.
-    };
-};
-
-// Light 부모 구조체로부터 상속받은 뒤, 각 조명구조체에 따라 세부사항들을 따로 추가하거나 override 하고 있음 -> '다형성' 으로 구성됨.
-// ofApp.cpp 에서 유니폼 변수에 값을 전송하는 렌더링 로직을 단순화하기 위해 이렇게 구성했다고 함.
-struct DirectionalLight : public Light {
+// 디렉셔널 라이트는 하나뿐이므로 구조체로 두고, 포인트라이트들은 LightSystem 이 종류별 배열로 관리함.
+struct DirectionalLight {
     glm::vec3 direction;
     glm::vec3 color;
     float intensity;
-    
-    // 자식 구조체의 멤버 함수에도 virtual 을 붙여서 부모 구조체의 가상함수로부터 override 한 것임을 명시하는 게 좋음.
-    virtual void apply(ofShader& shd) override {
-        // 구조체의 멤버변수 값들을 셰이더 코드의 유니폼 변수로 전송하는 로직들로 override 해줌.
-        shd.setUniform3f("lightDir", -direction);
-        shd.setUniform3f("lightCol", color * intensity);
+
+    void apply(MaterialBinding& mat) const {
+        // 구조체의 멤버변수 값들을 셰이더 코드의 유니폼 변수로 전송함.
+        mat.set(MaterialBinding::LightDir, -direction);
+        mat.set(MaterialBinding::LightCol, color * intensity);
     }
 };
 
-struct PointLight : public Light { // 상속 접근 지정자를 public 으로 지정함. (상속 접근 지정자 관련 필기 하단 참고)
-    glm::vec3 position;
-    glm::vec3 color;
-    float intensity;
-    float radius;
-    
-    virtual bool isPointLight() override {
-        // 포인트라이트 여부를 체크하는 부모구조체의 가상함수를 override 해서 true를 리턴하도록 함. (이 구조체는 포인트라이트 구조체니까 당연하지?)
-        return true;
-    }
-    virtual void apply(ofShader& shd) override {
-        // 구조체의 멤버변수 값들을 셰이더 코드의 유니폼 변수로 전송하는 로직들로 override 해줌.
-        shd.setUniform3f("lightPos", position);
-        shd.setUniform3f("lightCol", color * intensity);
-        shd.setUniform1f("lightRadius", radius);
-    }
+// 시뮬레이션 스레드가 프레임마다 만들어서 렌더링(메인 스레드)에 넘겨주는 읽기 전용 씬 상태.
+// 렌더링 쪽은 카메라, 라이트 등을 ofApp 멤버 대신 여기서만 읽으므로, 그리는 동안 시뮬레이션 스레드가 다음 프레임을 계산해도 됨.
+struct SceneSnapshot {
+    uint64_t frame = 0; // 시뮬레이션 스레드가 만든 순서 (벤치마크 모드에서는 그리는 프레임 번호와 같음)
+    float waterTime = 0.0f; // 바다 시뮬레이션 시간값
+    CameraData cam;
+    DirectionalLight dirLight;
+    LightSystem lights; // 포인트라이트 결과 배열과 직전 스냅샷 이후 바뀐 구간 (LightSystem::copyRenderData)
+    std::vector<uint32_t> waterLights; // 멀티패스 모드에서 물 메쉬에 닿는 포인트라이트 인덱스 (LightCulling 결과)
+    std::vector<uint32_t> shieldLights; // 멀티패스 모드에서 방패 메쉬에 닿는 포인트라이트 인덱스
+    LightCulling::Stats culling;
+    uint64_t simulationBeginMicros = 0; // 지연시간 측정용 (시뮬레이션 시작 시각)
+    float simulateMs = 0.0f; // 이 스냅샷을 계산하는 데 걸린 시간
+    float waitMs = 0.0f; // 시뮬레이션 스레드가 빈 슬롯을 기다린 시간 (렌더링이 더 느리면 늘어남)
+};
+
+// 포인트라이트를 그리는 방식. 키보드 'm' 키로 전환해서 각 방식의 결과와 프레임 시간을 비교할 수 있음.
+enum class RenderMode {
+    Multipass, // 라이트마다 메쉬를 다시 그려서 가산 블렌딩하는 기존 방식 (레퍼런스)
+    Clustered, // 라이트를 화면/깊이 클러스터에 할당한 뒤, 메쉬를 한 번만 그리면서 클러스터 안의 라이트들만 순회하는 방식
+    Deferred // 메쉬를 한 번만 그려서 G-버퍼에 재질/노멀을 기록한 뒤, 라이트마다 라이트 볼륨이 덮는 픽셀들만 조명을 계산하는 방식
+};
+
+// 멀티패스 모드에서 드로우콜 하나를 그리는 데 필요한 정보.
+// 프레임마다 목록을 만든 뒤 sortKey 로 정렬해서, 같은 프로그램/머티리얼을 쓰는 드로우콜끼리 모아서 그림.
+struct DrawPacket {
+    uint64_t sortKey; // 상위 비트부터 패스 단계(디렉셔널 -> 포인트) | 셰이더 프로그램 | 메쉬(머티리얼) | 라이트 순서
+    MaterialBinding* material;
+    MeshType mesh;
+    int light; // LightSystem 안의 포인트라이트 인덱스 (-1 이면 디렉셔널 라이트)
 };
 
 class ofApp : public ofBaseApp{
@@ -76,74 +97,151 @@ class ofApp : public ofBaseApp{
         void gotMessage(ofMessage msg);
     
         // ofApp.cpp 에서 물 메쉬와 방패 메쉬를 그리는 함수를 분할해서 쪼개줄 것이므로, 각 함수의 메서드를 미리 선언해놓음.
-        // 조명구조체는 결국 Light 구조체로부터 상속받은 애들 중 하나를 인자로 전달할 것이므로, 부모 구조체인 Light 로 타입을 지정해도 됨.
-        void drawWater(Light& light, glm::mat4& proj, glm::mat4& view);
-        void drawShield(Light& light, glm::mat4& proj, glm::mat4& view);
-        void drawSkybox(glm::mat4& proj, glm::mat4& view); // ofApp.cpp 에서 큐브메쉬를 그리는 함수를 따로 추출하기 위해 선언한 메서드.
-        void beginRenderingPointLights(); // 포인트라이트 패스 렌더링 시, 블렌딩모드와 깊이테스트 모드를 재설정하는 함수
-        void endRenderingPointLights(); // 포인트라이트 패스 렌더링 완료 후, 블렌딩모드와 깊이테스트 모드를 초기화하는 함수 (자세한 설명은 ofApp.cpp 에서...)
+        // pointLight 는 LightSystem 안의 포인트라이트 인덱스이며, -1 이면 디렉셔널 라이트로 그림.
+        // 셰이더 바인딩(begin/end)은 호출하는 쪽에서 같은 프로그램끼리 묶어서 한 번만 해줌.
+        void drawWater(MaterialBinding& mat, int pointLight, glm::mat4& proj, glm::mat4& view);
+        void drawShield(MaterialBinding& mat, int pointLight, glm::mat4& proj, glm::mat4& view);
+        void applyLight(MaterialBinding& mat, int pointLight); // drawWater(), drawShield() 에서 조명 유니폼을 전송하는 함수
+        void buildDrawPackets(); // 멀티패스 드로우콜 목록을 만들고 프로그램/머티리얼 순으로 정렬하는 함수
+        void submitDrawRange(std::vector<DrawPacket>::iterator first, std::vector<DrawPacket>::iterator last, glm::mat4& proj, glm::mat4& view); // 드로우콜 목록의 일부를 프로그램 전환을 최소화하면서 그리는 함수
+        void drawSkybox(); // ofApp.cpp 에서 큐브메쉬를 그리는 함수를 따로 추출하기 위해 선언한 메서드. (mvp 는 transforms 에 캐시된 값을 씀)
+        void drawDepthPrepass(glm::mat4& proj, glm::mat4& view); // 물/방패 메쉬의 깊이만 먼저 기록해서, 이후 셰이딩 패스가 GL_EQUAL 로 보이는 프래그먼트만 셰이딩하도록 하는 함수
+        void drawWaterClustered(glm::mat4& proj, glm::mat4& view); // 클러스터드 모드에서 모든 조명을 한 패스로 계산하며 물 메쉬를 그리는 함수
+        void drawShieldClustered(glm::mat4& view); // 클러스터드 모드에서 모든 조명을 한 패스로 계산하며 방패 메쉬를 그리는 함수 (view 는 클러스터 깊이 슬라이스 계산용)
+        void drawDeferredGeometry(glm::mat4& proj, glm::mat4& view); // 디퍼드 모드에서 방패/물 메쉬의 재질과 노멀을 G-버퍼에 기록하는 함수
+        void drawDeferredDirectionalLight(glm::mat4& proj, glm::mat4& view); // G-버퍼를 읽어서 디렉셔널 라이트를 화면 전체에 가산 블렌딩하는 함수
+        void drawDeferredPointLights(glm::mat4& proj, glm::mat4& view); // G-버퍼를 읽어서 포인트라이트 볼륨들을 가산 블렌딩하는 함수
+        void drawShadowCasters(const glm::mat4& viewProj, bool dynamic); // 포인트라이트 셰도우맵 면 하나에 정적(방패) 또는 동적(물) caster 를 그리는 함수
+        void updateShadowCasters(); // 물 표면과 방패의 caster 상태를 pointShadows 에 알려주는 함수
+        void buildRenderGraph(); // 현재 렌더링 방식과 깊이 프리패스 설정에 맞게 프레임의 패스들을 선언하고 compile() 하는 함수
+        void beginSceneTarget(); // 렌더 스케일로 줄인 씬 렌더 타겟을 쓰고 있으면 바인딩하는 함수 (포워드 모드의 패스 실행 함수들이 호출함)
+        void endSceneTarget();
+        void drawUpscale(); // 줄여서 그린 씬을 현재 렌더 타겟(윈도우 또는 벤치마크 FBO) 크기로 늘려 그리는 함수
+        uint32_t getShieldFeatures() const; // 방패 인스턴싱 여부에 맞는 방패 셰이더 기능 비트
+        void drawStats(); // 렌더링 방식 및 프레임 시간 등을 화면에 출력하는 함수
+        void drawLoadingScreen(); // 에셋 로드가 끝나기 전에 씬 대신 그리는 로딩 화면
+        void addRandomPointLights(int count); // 비교 테스트를 위해 무작위 포인트라이트를 추가하는 함수 (공전/맥동/깜빡임 애니메이션 포함)
+        void removeRandomPointLights(int count); // addRandomPointLights() 로 추가한 라이트를 최근 것부터 지우는 함수
+        void animateBenchmark(float t); // 벤치마크 모드에서 카메라와 포인트라이트를 정해진 경로대로 움직이는 함수
+        void layoutShieldInstances(int count); // 방패 메쉬 인스턴스 count 개를 바닥에 격자로 배치하는 함수 (0 이면 방패 1개만 그림)
+        void loadSoftwareAssets(); // SoftwareRenderer 가 샘플링할 텍스쳐/큐브맵 이미지를 CPU 메모리로 로드하는 함수
+        void renderSoftware(int width, int height); // 현재 씬(방패 1개 + 물 + 스카이박스)을 SoftwareRenderer 로 그리는 함수
+        void drawSoftware(int width, int height); // renderSoftware() 결과를 벤치마크에 넘기거나 윈도우에 그리는 함수
+        void measureSoftwareThroughput(); // 벤치마크가 끝난 뒤 스레드 수별로 같은 프레임을 다시 그려서 처리량을 기록하는 함수
+        void simulationLoop(); // 시뮬레이션 스레드 본체 (빈 스냅샷 슬롯을 받아서 simulate() 로 채운 뒤 넘겨줌)
+        void simulate(SceneSnapshot& snapshot); // 다음 프레임의 카메라, 라이트 애니메이션, 라이트 컬링을 계산해서 스냅샷에 기록하는 함수
+        void runOnSimulation(std::function<void()> command); // 시뮬레이션 스레드가 가진 상태를 바꾸는 작업을 다음 스냅샷 전에 실행되도록 넘겨주는 함수
+        void measureLatency(); // 이번 프레임 스냅샷의 시뮬레이션 시작 ~ 그리기 끝 시간을 기록하는 함수
+        void exit();
 
         
-        ofMesh shieldMesh; // shield.ply 모델링 파일을 로드해서 사용할 메쉬 객체 변수 선언
-        ofMesh planeMesh; // plane.ply 모델링 파일을 로드해서 사용할 메쉬 객체 변수 선언
-        ofMesh cubeMesh; // cube.ply 모델링 파일을 로드해서 사용할 메쉬 객체 변수 선언
+        // ofMesh 를 그대로 draw() 하면 매 드로우콜마다 버텍스 데이터를 GPU 로 다시 올리므로,
+        // 데이터가 바뀌었을 때만 VBO 를 갱신하는 ofVboMesh 를 사용함.
+        // 방패와 물 메쉬는 위치 16비트, 노멀/탄젠트 10:10:10:2, uv half float 로 압축한 버텍스 포맷으로 올림. (PackedMesh 참고)
+        PackedMesh shieldMesh; // shield.ply 모델링 파일을 로드해서 사용할 메쉬 객체 변수 선언
+        PackedMesh waterMesh; // 바다 변위맵으로 움직일 물 표면 격자 메쉬
+        ofVboMesh cubeMesh; // cube.ply 모델링 파일을 로드해서 사용할 메쉬 객체 변수 선언
+        ofVboMesh lightVolumeMesh; // 디퍼드 모드에서 포인트라이트 볼륨으로 그릴 단위 구체 메쉬
+        ofVboMesh screenQuadMesh; // 디퍼드 모드에서 디렉셔널 라이트 패스로 화면 전체를 덮을 사각형 메쉬
         
-        ofImage waterNrm; // plane.ply 에 씌워줄 노말맵을 로드하기 위한 이미지 객체 변수 선언
+        // 텍스쳐들은 AssetLoader 가 비동기로 디코딩/업로드하므로, CPU 측 픽셀 사본을 들고있는 ofImage 대신 ofTexture 로 선언함.
+        ofTexture diffuseTex; // shield.ply 에 씌워줄 디퓨즈 맵 텍스쳐 객체 변수 선언
+        ofTexture nrmTex; // shield.ply 에 씌워줄 노말맵 텍스쳐 객체 변수 선언
+        ofTexture specTex; // shield.ply 에 씌워줄 스펙 맵 텍스쳐 객체 변수 선언
         
-        ofImage diffuseTex; // shield.ply 에 씌워줄 디퓨즈 맵을 로드하기 위한 이미지 객체 변수 선언
-        ofImage nrmTex; // shield.ply 에 씌워줄 스펙 맵을 로드하기 위한 이미지 객체 변수 선언
-        ofImage specTex; // shield.ply 에 씌워줄 노말맵을 로드하기 위한 이미지 객체 변수 선언
-        
-        ofShader skyboxShader; // cube.ply 에 큐브맵 텍스쳐를 적용하기 위해 사용할 셰이더 객체 변수 선언
-        ofShader dirLightShaders[2]; // 방패 및 물 메쉬에 각각 적용할 디렉셔널 라이트 쉐이더 객체 변수들이 담긴 배열 선언
-        ofShader pointLightShaders[2]; // 방패 및 물 메쉬에 각각 적용할 포인트 라이트 쉐이더 객체 변수들이 담긴 배열 선언
+        // 스카이박스, 디렉셔널 라이트, 포인트라이트, 클러스터드 라이팅 셰이더들을 (메쉬, 조명, 기능 비트) 키로 보관하는 저장소.
+        // 유니폼/텍스쳐는 항상 저장소가 돌려주는 MaterialBinding 을 거쳐서 전송함.
+        ShaderRegistry shaders;
+    
+        std::vector<DrawPacket> drawPackets; // 멀티패스 드로우콜 목록 (용량은 라이트 개수가 바뀔 때만 늘려서 draw() 에서는 힙 할당이 없도록 함)
+        size_t numDirectionalPackets = 0; // drawPackets 앞쪽의 디렉셔널 라이트 패스 드로우콜 개수 (나머지는 포인트라이트 패스)
+        uint64_t drawAllocations = 0; // 직전 프레임 draw() 의 씬 렌더링 구간에서 일어난 힙 할당 횟수 (ALLOCATION_COUNTER 빌드에서만 집계)
 
         CameraData cam; // 카메라 위치 및 fov(시야각)의 현재 상태값을 나타내는 구조체를 타입으로 갖는 멤버변수 cam 선언
     
         ofxEasyCubemap cubemap; // 오픈프레임웍스는 큐브맵을 지원하지 않으므로, 큐브맵 로드 및 유니폼 변수 전송에 필요한 커스텀 클래스 객체 변수 선언
+        ofPixels cubemapFaces[6]; // 비동기로 디코딩된 큐브맵 면들을 6개가 모두 모일 때까지 잠시 보관해두는 배열
+        int numCubemapFaces = 0; // 지금까지 디코딩이 끝난 큐브맵 면 개수
     
-        // 각 조명 유형별 구조체 / 구조체 동적배열을 해더파일에 선언함. (이제 ofApp.cpp 내의 함수에서는 이 구조체/구조체 동적배열을 가져다가 써주면 됨.)
+        AssetLoader assetLoader; // 텍스쳐 디코딩을 워커 스레드 풀에서 처리하고, 업로드는 메인 스레드로 넘겨받는 비동기 에셋 로더
+    
+        // 각 조명 유형별 구조체 / 라이트 시스템을 해더파일에 선언함. (이제 ofApp.cpp 내의 함수에서는 이 구조체/라이트 시스템을 가져다가 써주면 됨.)
         DirectionalLight dirLight; // 디렉셔널 라이트 구조체 선언
-        std::vector<PointLight> pointLights; // 포인트라이트 구조체를 담을 동적배열 선언 (동적배열 관련 필기 하단 참고)
+        LightSystem pointLights; // 포인트라이트들을 종류별 동적배열로 저장하고 애니메이션하는 시스템 (동적배열 관련 필기 하단 참고)
+        std::vector<LightSystem::Handle> randomLights; // 'l' 키로 추가한 라이트들의 핸들 ('k' 키로 최근 것부터 지움)
+        ThreadPool lightWorkers; // 라이트가 많을 때 LightSystem::update() 를 나눠서 계산하는 워커 스레드 풀 (에셋 로더와 따로 둠). setup() 에서는 탄젠트 계산에도 씀.
+    
+        LightBuffer lightBuffer; // 포인트라이트 데이터를 GPU 텍스쳐 버퍼에 패킹해서 올려두는 객체 (셰이더는 라이트 인덱스로 읽어감)
+        LightClusters lightClusters; // 클러스터드 모드에서 포인트라이트를 클러스터에 할당하고 GPU 버퍼로 올려주는 객체
+        TransformSystem transforms; // 메쉬들의 월드/mvp/노말행렬을 프레임마다 한 번씩만 계산해두는 캐시
+        int waterTransform = 0; // transforms 에 등록된 물 메쉬 번호
+        int shieldTransform = 0; // transforms 에 등록된 방패 메쉬 번호
+        int skyboxTransform = 0; // transforms 에 등록된 스카이박스 번호 (카메라를 따라다님)
+        GBuffer gbuffer; // 디퍼드 모드의 G-버퍼 (렌더 타겟 크기가 바뀌면 다시 할당됨)
+        LightCulling lightCulling; // 멀티패스 모드에서 메쉬별로 실제로 닿는 포인트라이트 목록을 만드는 객체
+        int waterReceiver = 0; // lightCulling 에 등록된 물 메쉬 번호
+        int shieldReceiver = 0; // lightCulling 에 등록된 방패 메쉬 번호
+        InstanceBuffer shieldInstances; // 멀티패스 모드에서 방패 메쉬를 여러 개 그릴 때 사용하는 인스턴스 버퍼
+        int numShieldInstances = 0; // 배치된 방패 인스턴스 개수 ('i' 키로 0 -> 1000 -> 10000 -> 100000 순환)
+        bool naiveInstancing = false; // true 면 인스턴싱 대신 인스턴스마다 드로우콜을 하나씩 호출함 ('n' 키로 전환, 비교용)
+        bool depthPrepass = false; // true 면 셰이딩 전에 깊이 프리패스를 그림 ('z' 키로 전환)
+        FragmentCounter fragmentCounter; // 프레임당 프래그먼트 셰이더 호출 수를 세는 GPU 쿼리 (벤치마크 모드에서는 Benchmark 가 직접 셈)
+        RenderMode renderMode = RenderMode::Multipass; // 현재 렌더링 방식
+        RenderGraph renderGraph; // 프레임의 패스 순서와 패스별 GL 고정 기능 상태를 관리하는 렌더 그래프
+        RenderMode graphRenderMode = RenderMode::Multipass; // renderGraph 를 마지막으로 만들 때의 렌더링 방식 (바뀌면 다시 만듦)
+        bool graphDepthPrepass = false; // renderGraph 를 마지막으로 만들 때의 깊이 프리패스 설정
+        int graphTargetWidth = 0, graphTargetHeight = 0; // renderGraph 를 마지막으로 만들 때의 출력 크기
+        int graphRenderWidth = 0, graphRenderHeight = 0; // renderGraph 를 마지막으로 만들 때의 씬 렌더링 크기 (출력 크기와 같으면 줄이지 않고 바로 그림)
+        RenderGraph::Resource sceneTarget = -1; // 줄여서 그리는 포워드 모드의 씬 렌더 타겟 (-1 이면 현재 렌더 타겟에 바로 그림)
+        DynamicResolution dynamicResolution; // GPU 프레임 시간에 맞춰 씬을 그리는 해상도를 조절하는 컨트롤러 ('r' 키로 전환)
+        PointShadowCache pointShadows; // 포인트라이트 큐브 셰도우맵을 아틀라스에 캐시해두고 바뀐 면만 다시 그리는 객체 ('h' 키로 전환)
+        bool graphShadows = false; // renderGraph 를 마지막으로 만들 때의 그림자 설정
+        int shieldCaster = -1; // pointShadows 에 등록된 방패(정적) / 물(동적) caster 번호
+        int waterCaster = -1;
+        float shadowWaterTime = -1.0f; // 물 caster 를 마지막으로 다시 그리게 한 바다 시간값
+        glm::mat4 frameProj; // 이번 프레임의 투영행렬 (렌더 그래프의 패스 실행 함수들이 읽어감)
+        glm::mat4 frameView; // 이번 프레임의 뷰행렬
+        float waterTime = 0.0f; // 바다 시뮬레이션 시간값 (시뮬레이션 스레드가 스냅샷마다 한 번만 증가시킴)
+        OceanSimulation ocean; // 물 표면의 변위맵 / 기울기맵을 만드는 FFT 바다 시뮬레이션 ('o' 키로 해상도 전환)
+        glm::vec3 waterBoundsMin, waterBoundsMax; // 변위를 더하기 전 물 메쉬의 월드공간 경계
+    
+        // GPU 가 없는 노드에서 같은 씬을 CPU 로 그리는 소프트웨어 렌더러 ('b' 키로 GL 과 전환, 'backend=software' 벤치마크는 윈도우 없이 실행됨)
+        SoftwareRenderer softwareRenderer;
+        bool softwareBackend = false; // true 면 draw() 에서 GL 대신 softwareRenderer 로 그림.
+        bool gpuAvailable = true; // false 면 GL 컨텍스트가 없으므로 (ofAppNoWindow) GL 객체를 전혀 만들지 않음.
+        SoftwareRenderer::Texture softwareDiffuse, softwareSpec, softwareNormal; // 방패 텍스쳐들의 CPU 사본
+        SoftwareRenderer::Texture softwareDisplacement, softwareSlope; // 바다 시뮬레이션 결과 (프레임마다 CPU 버퍼에서 변환함)
+        SoftwareRenderer::Cubemap softwareCubemap;
+        ofTexture softwareFrame; // 윈도우 모드에서 소프트웨어 렌더링 결과를 화면에 그리기 위한 텍스쳐
+    
+        // 시뮬레이션 / 렌더링 스레드 분리.
+        // cam, dirLight, pointLights, randomLights, lightCulling, waterTime 은 시뮬레이션 스레드가 시작된 뒤로는 그 스레드만 고치고,
+        // 메인 스레드는 snapshots 에서 받아온 scene 만 읽음. (메인 스레드에서 바꿔야 하면 runOnSimulation() 으로 넘겨줌)
+        struct PipelineStats {
+            float simulateMs = 0.0f; // 스냅샷 하나를 계산하는 데 걸린 시간 (렌더링과 겹쳐서 실행됨)
+            float simulationWaitMs = 0.0f; // 시뮬레이션 스레드가 빈 슬롯을 기다린 시간
+            float renderWaitMs = 0.0f; // 메인 스레드가 스냅샷을 기다린 시간 (0 보다 크면 시뮬레이션이 렌더링보다 느린 것)
+            float latencyMs = 0.0f; // 스냅샷 시뮬레이션 시작 ~ 그리기 끝
+            size_t queued = 0; // 스냅샷을 받아온 시점에 큐에 있던 스냅샷 수 (받아온 것 포함)
+        };
+        SnapshotQueue<SceneSnapshot> snapshots; // 트리플 버퍼링 (그리는 중, 대기 중, 계산 중)
+        const SceneSnapshot* scene = nullptr; // 이번 프레임에 그리는 스냅샷 (다음 update() 에서 돌려줌)
+        std::thread simulationThread;
+        std::mutex commandMutex;
+        std::vector<std::function<void()>> simulationCommands; // runOnSimulation() 으로 넘겨받은 작업들
+        std::vector<std::function<void()>> runningCommands; // 시뮬레이션 스레드가 실행 중인 작업들 (simulationCommands 와 교환해서 씀)
+        std::atomic<float> targetAspect { 1.0f }; // 라이트 컬링 프러스텀의 종횡비 (메인 스레드가 씀)
+        std::atomic<float> waterMargin { 0.0f }; // 바다 변위 크기 최댓값 (메인 스레드가 OceanSimulation 결과를 올린 뒤 씀)
+        uint64_t simulationFrame = 0; // 지금까지 만든 스냅샷 수
+        float lastSimulationTime = 0.0f; // 직전 스냅샷의 시간값 (벤치마크가 아닐 때 바다 시간값을 늘리는 데 사용)
+        PipelineStats pipelineStats;
+    
+        Benchmark benchmark; // 벤치마크 모드 설정 및 프레임 시간 기록 (main() 에서 '--benchmark' 인자가 있을 때만 켜짐)
+#ifdef PROFILER
+        bool showProfiler = true; // 프로파일러 오버레이 표시 여부 ('p' 키로 전환, 't' 키로 트레이스 저장)
+#endif
 };
 
-/**
- virtual (가상함수)
- 
- cpp 에서 virtual 키워드는
- 자식 클래스에서 재정의(override) 할 것으로 예상되는
- 부모 클래스의 멤버함수를 정의할 때 사용함,
- 
- 이런 걸 '가상함수' 라고 함.
- 
- 꼭 부모 클래스에만 붙이는 건 아니고,
- 자식 클래스에도 멤버함수에 virtual 을 붙여서
- 가상함수를 물려받아서 override 하고 있음을
- 명시하기도 함.
- */
-
-/**
- 상속 접근 지정자 (public, protected, private)
- 
- 상속 접근 지정자는 자식 클래스에서 부모 클래스를 상속받을 때,
- 부모 클래스 이름 왼쪽에 지정해주는 접근자임.
- 
- 이는 부모 클래스로부터 물려받는 멤버변수 및 함수들의
- 접근 지정자를 어떻게 물려받을지 결정함.
- 
- 예를 들어, public 이라고 지정하면,
- public 보다 접근 범위가 넓은 애들(cpp 에서는 사실상 없음. public 이 접근 범위가 가장 넓으니까)을
- public 으로 접근하도록 하는 것이지.
- 
- 이 말은 결국, public 보다 접근 범위가 넓은 애들은
- 사실상 없기 때문에, 부모 클래스에서 public, private, protected 로 지정한
- 애들을 자식 클래스에서도 각각 동일한 접근자로 지정하도록 한 것.
- 
- 또 예를 들어, protected 라고 지정하면,
- protected 보다 접근 범위가 넓은 애들, 즉, 'public'을
- 자식 클래스에서는 protected 로 물려받도록 지정해주는 것임.
- */
-
 /**
  std::vector (동적배열)
  
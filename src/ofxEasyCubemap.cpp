@@ -1,5 +1,92 @@
 #include "ofxEasyCubemap.hpp"
 #include "ofGLUtils.h"
+#include "ofFileUtils.h"
+#include <cstring>
+
+namespace
+{
+    const unsigned char KTX_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    const uint32_t KTX_ENDIANNESS = 0x04030201;
+
+    struct KTXHeader
+    {
+        unsigned char identifier[12];
+        uint32_t endianness;
+        uint32_t glType;
+        uint32_t glTypeSize;
+        uint32_t glFormat;
+        uint32_t glInternalFormat;
+        uint32_t glBaseInternalFormat;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t numberOfArrayElements;
+        uint32_t numberOfFaces;
+        uint32_t numberOfMipmapLevels;
+        uint32_t bytesOfKeyValueData;
+    };
+
+    size_t alignTo4(size_t n)
+    {
+        return (n + 3) & ~size_t(3);
+    }
+
+    // bytes per pixel of an uncompressed KTX level, 0 if the format/type pair isn't one we know how to size
+    size_t bytesPerPixel(uint32_t glFormat, uint32_t glType)
+    {
+        switch (glType)
+        {
+        case GL_UNSIGNED_SHORT_5_6_5:
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+            return 2;
+        case GL_UNSIGNED_INT_8_8_8_8:
+        case GL_UNSIGNED_INT_8_8_8_8_REV:
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_10F_11F_11F_REV:
+        case GL_UNSIGNED_INT_5_9_9_9_REV:
+            return 4;
+        }
+
+        size_t components = 0;
+        switch (glFormat)
+        {
+        case GL_RED: case GL_RED_INTEGER: components = 1; break;
+        case GL_RG: case GL_RG_INTEGER: components = 2; break;
+        case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: components = 3; break;
+        case GL_RGBA: case GL_BGRA: case GL_RGBA_INTEGER: components = 4; break;
+        default: return 0;
+        }
+        switch (glType)
+        {
+        case GL_UNSIGNED_BYTE: case GL_BYTE: return components;
+        case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: return components * 2;
+        case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: return components * 4;
+        default: return 0;
+        }
+    }
+
+    // bytes per 4x4 block of a compressed KTX level, 0 for formats we don't know
+    size_t blockBytes(uint32_t glInternalFormat)
+    {
+        switch (glInternalFormat)
+        {
+        case 0x83F0: case 0x83F1: case 0x8C4C: case 0x8C4D: // BC1 (S3TC DXT1 RGB/RGBA, sRGB)
+        case 0x8DBB: case 0x8DBC: // BC4 (RGTC1 unsigned/signed)
+        case 0x9270: case 0x9271: // EAC R11 unsigned/signed
+        case 0x9274: case 0x9275: case 0x9276: case 0x9277: // ETC2 RGB8, sRGB8, punchthrough alpha
+            return 8;
+        case 0x83F2: case 0x83F3: case 0x8C4E: case 0x8C4F: // BC2/BC3 (S3TC DXT3/DXT5, sRGB)
+        case 0x8DBD: case 0x8DBE: // BC5 (RGTC2 unsigned/signed)
+        case 0x8E8C: case 0x8E8D: case 0x8E8E: case 0x8E8F: // BC7 (BPTC unorm/sRGB), BC6H (signed/unsigned float)
+        case 0x9272: case 0x9273: // EAC RG11 unsigned/signed
+        case 0x9278: case 0x9279: // ETC2 RGBA8 EAC, sRGB8 alpha8
+            return 16;
+        default:
+            return 0;
+        }
+    }
+}
 
 ofxEasyCubemap::ofxEasyCubemap()
 {
@@ -13,7 +100,9 @@ ofxEasyCubemap::ofxEasyCubemap()
 
 ofxEasyCubemap::~ofxEasyCubemap()
 {
-    glDeleteTextures(1, &glTexId);
+    if (glTexId != 0) {
+        glDeleteTextures(1, &glTexId); // GL 컨텍스트 없이 실행한 경우(소프트웨어 렌더러)에는 만든 텍스쳐가 없음.
+    }
 }
 
 bool ofxEasyCubemap::load(const std::filesystem::path& front,
@@ -23,53 +112,311 @@ bool ofxEasyCubemap::load(const std::filesystem::path& front,
                             const std::filesystem::path& top,
                             const std::filesystem::path& bottom)
 {
-    
-    bool success = images[0].load(right);
-    success |= images[1].load(left);
-    success |= images[2].load(top);
-    success |= images[3].load(bottom);
-    success |= images[4].load(front);
-    success |= images[5].load(back);
+    const std::filesystem::path* paths[6] = { &right, &left, &top, &bottom, &front, &back };
+
+    beginUpload();
 
-    if (!success)
+    // decode one face at a time so that at most one face is resident in RAM
+    ofPixels pixels;
+    for (int i = 0; i < 6; ++i)
     {
-        fprintf(stderr, "ERROR: EasyCubemap failed to load an image");
+        if (!ofLoadImage(pixels, *paths[i]))
+        {
+            fprintf(stderr, "ERROR: EasyCubemap failed to load an image");
+            abortUpload();
+            return false;
+        }
+        if (!uploadFace(i, pixels))
+        {
+            abortUpload();
+            return false;
+        }
+        if (keepCpuCopy)
+        {
+            cpuFaces[i].swap(pixels);
+        }
+        pixels.clear();
+    }
+
+    endUpload();
+    return true;
+}
+
+bool ofxEasyCubemap::loadFromPixels(const ofPixels* faces)
+{
+    for (int i = 0; i < 6; ++i)
+    {
+        if (!faces[i].isAllocated())
+        {
+            fprintf(stderr, "ERROR: EasyCubemap failed to load an image");
+            return false;
+        }
+    }
+
+    beginUpload();
+    for (int i = 0; i < 6; ++i)
+    {
+        if (!uploadFace(i, faces[i]))
+        {
+            abortUpload();
+            return false;
+        }
+        if (keepCpuCopy)
+        {
+            cpuFaces[i] = faces[i];
+        }
+    }
+    endUpload();
+
+    return true;
+}
+
+bool ofxEasyCubemap::loadKTX(const std::filesystem::path& path)
+{
+    ofBuffer file = ofBufferFromFile(path, true);
+    if (file.size() < sizeof(KTXHeader))
+    {
+        fprintf(stderr, "ERROR: EasyCubemap failed to load %s\n", path.string().c_str());
         return false;
     }
 
-    unsigned int faceWidth = images[0].getWidth();
-    unsigned int faceHeight = images[0].getHeight();
+    KTXHeader header;
+    memcpy(&header, file.getData(), sizeof(KTXHeader));
+    if (memcmp(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) != 0 || header.endianness != KTX_ENDIANNESS)
+    {
+        fprintf(stderr, "ERROR: EasyCubemap %s is not a little-endian KTX 1.1 file\n", path.string().c_str());
+        return false;
+    }
+    if (header.numberOfFaces != 6 || header.numberOfArrayElements != 0 || header.pixelDepth != 0 || header.pixelWidth != header.pixelHeight)
+    {
+        fprintf(stderr, "ERROR: EasyCubemap %s is not a cubemap\n", path.string().c_str());
+        return false;
+    }
 
+    bool compressed = header.glType == 0;
+    if (compressed && !isCompressedFormatSupported(header.glInternalFormat))
+    {
+        fprintf(stderr, "ERROR: EasyCubemap %s uses compressed format 0x%x which this driver doesn't support\n", path.string().c_str(), header.glInternalFormat);
+        return false;
+    }
+
+    uint32_t numLevels = std::max<uint32_t>(1, header.numberOfMipmapLevels);
+    uint32_t maxLevels = 1;
+    while ((header.pixelWidth >> maxLevels) > 0)
+    {
+        ++maxLevels; // floor(log2(pixelWidth)) + 1
+    }
+    size_t pixelBytes = compressed ? 0 : bytesPerPixel(header.glFormat, header.glType);
+    size_t blockSize = compressed ? blockBytes(header.glInternalFormat) : 0;
+    if (header.pixelWidth == 0 || numLevels > maxLevels || (pixelBytes == 0 && blockSize == 0))
+    {
+        fprintf(stderr, "ERROR: EasyCubemap %s has an invalid size, mip count or pixel format\n", path.string().c_str());
+        return false;
+    }
+
+    const char* data = file.getData();
+    size_t offset = sizeof(KTXHeader) + header.bytesOfKeyValueData;
+
+    clear();
     glGenTextures(1, &glTexId);
     glBindTexture(GL_TEXTURE_CUBE_MAP, glTexId);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, numLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, numLevels - 1); // the container may stop before 1x1
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // KTX rows are 4-byte aligned
 
-    unsigned char* faceData[6];
-
-    for (int i = 0; i < 6; ++i)
+    for (uint32_t level = 0; level < numLevels; ++level)
     {
-        if (images[i].getWidth() != faceWidth || images[i].getHeight() != faceHeight)
+        GLsizei size = std::max<uint32_t>(1, header.pixelWidth >> level);
+        if (offset + sizeof(uint32_t) > file.size())
         {
-            fprintf(stderr, "ERROR: EasyCubemap couldn't load because not all source textures are the same size\n");
+            fprintf(stderr, "ERROR: EasyCubemap %s is truncated\n", path.string().c_str());
+            abortUpload();
             return false;
         }
+        uint32_t imageSize; // for non-array cubemaps: bytes of one face
+        memcpy(&imageSize, data + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
 
-        faceData[i] = images[i].getPixels().getData();
+        // the driver reads exactly this many bytes per face, whatever imageSize claims
+        size_t expected = compressed
+            ? size_t((size + 3) / 4) * ((size + 3) / 4) * blockSize
+            : alignTo4(size_t(size) * pixelBytes) * size;
+        if (imageSize != expected)
+        {
+            fprintf(stderr, "ERROR: EasyCubemap %s level %u has %u bytes per face, expected %zu\n", path.string().c_str(), level, imageSize, expected);
+            abortUpload();
+            return false;
+        }
 
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X+i, 0, images[i].getTexture().texData.glInternalFormat, faceWidth, faceHeight, 0, ofGetGLFormat(images[i].getPixels()), GL_UNSIGNED_BYTE, faceData[i]);
+        for (int face = 0; face < 6; ++face)
+        {
+            if (offset + imageSize > file.size())
+            {
+                fprintf(stderr, "ERROR: EasyCubemap %s is truncated\n", path.string().c_str());
+                abortUpload();
+                return false;
+            }
+            if (compressed)
+            {
+                glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X+face, level, header.glInternalFormat, size, size, 0, imageSize, data + offset);
+            }
+            else
+            {
+                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X+face, level, header.glInternalFormat, size, size, 0, header.glFormat, header.glType, data + offset);
+            }
+            gpuBytes += imageSize;
+            offset += alignTo4(imageSize);
+        }
     }
-    glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
+    faceWidth = header.pixelWidth;
+    faceHeight = header.pixelHeight;
+    textureData.texData.glInternalFormat = header.glInternalFormat;
     textureData.texData.textureID = glTexId;
+    textureData.texData.width = faceWidth;
+    textureData.texData.height = faceHeight;
+    textureData.texData.tex_w = faceWidth;
+    textureData.texData.tex_h = faceHeight;
     textureData.texData.bAllocated = true;
 
     return true;
 }
 
+bool ofxEasyCubemap::isCompressedFormatSupported(int glInternalFormat)
+{
+    GLint numFormats = 0;
+    glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &numFormats);
+    std::vector<GLint> formats(numFormats);
+    if (numFormats > 0)
+    {
+        glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+    }
+    return std::find(formats.begin(), formats.end(), glInternalFormat) != formats.end();
+}
+
+void ofxEasyCubemap::beginUpload()
+{
+    clear();
+
+    glGenTextures(1, &glTexId);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, glTexId);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+}
+
+bool ofxEasyCubemap::uploadFace(int face, const ofPixels& pixels)
+{
+    if (face == 0)
+    {
+        faceWidth = pixels.getWidth();
+        faceHeight = pixels.getHeight();
+    }
+    else if (pixels.getWidth() != faceWidth || pixels.getHeight() != faceHeight)
+    {
+        fprintf(stderr, "ERROR: EasyCubemap couldn't load because not all source textures are the same size\n");
+        return false;
+    }
+
+    GLint internalFormat = ofGetGLInternalFormat(pixels);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, glTexId);
+    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X+face, 0, internalFormat, faceWidth, faceHeight, 0, ofGetGLFormat(pixels), GL_UNSIGNED_BYTE, pixels.getData());
+
+    textureData.texData.glInternalFormat = internalFormat;
+    gpuBytes += size_t(faceWidth) * faceHeight * pixels.getBytesPerPixel();
+    return true;
+}
+
+void ofxEasyCubemap::endUpload()
+{
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, glTexId);
+    glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+    // full mip chain adds ~1/3 on top of the base level
+    gpuBytes += gpuBytes / 3;
+
+    textureData.texData.textureID = glTexId;
+    textureData.texData.width = faceWidth;
+    textureData.texData.height = faceHeight;
+    textureData.texData.tex_w = faceWidth;
+    textureData.texData.tex_h = faceHeight;
+    textureData.texData.bAllocated = true;
+}
+
+void ofxEasyCubemap::abortUpload()
+{
+    // GL_UNPACK_ALIGNMENT is global state, so every exit after beginUpload() has to put it back
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    clear();
+}
+
+void ofxEasyCubemap::clear()
+{
+    if (glTexId != 0)
+    {
+        glDeleteTextures(1, &glTexId);
+        glTexId = 0;
+    }
+    for (ofPixels& face : cpuFaces)
+    {
+        face.clear();
+    }
+    faceWidth = 0;
+    faceHeight = 0;
+    gpuBytes = 0;
+    textureData.texData.textureID = 0;
+    textureData.texData.bAllocated = false;
+}
+
+void ofxEasyCubemap::setKeepCpuCopy(bool keep)
+{
+    keepCpuCopy = keep;
+    if (!keepCpuCopy)
+    {
+        for (ofPixels& face : cpuFaces)
+        {
+            face.clear();
+        }
+    }
+}
+
+bool ofxEasyCubemap::getKeepCpuCopy() const
+{
+    return keepCpuCopy;
+}
+
+const ofPixels& ofxEasyCubemap::getPixels(int face) const
+{
+    return cpuFaces[face];
+}
+
+size_t ofxEasyCubemap::getCpuBytes() const
+{
+    size_t bytes = 0;
+    for (const ofPixels& face : cpuFaces)
+    {
+        bytes += face.getTotalBytes();
+    }
+    return bytes;
+}
+
+size_t ofxEasyCubemap::getGpuBytes() const
+{
+    return gpuBytes;
+}
+
 const ofTexture& ofxEasyCubemap::getTexture() const
 {
     return textureData;
@@ -20,12 +20,44 @@ public:
               const std::filesystem::path& top,
               const std::filesystem::path& bottom);
 
+    // faces: already decoded faces in GL order (right, left, top, bottom, front, back)
+    bool loadFromPixels(const ofPixels* faces);
+
+    // Loads a KTX (v1) cubemap container holding the complete mip chain.
+    // Block-compressed formats (BC1, BC6H, ETC2, ...) are uploaded as-is with glCompressedTexImage2D,
+    // uncompressed ones with glTexImage2D. No mipmaps are generated at runtime.
+    // Returns false if the file is invalid or the driver doesn't support its internal format.
+    bool loadKTX(const std::filesystem::path& path);
+
+    static bool isCompressedFormatSupported(int glInternalFormat);
+
+    // Faces are decoded into a transient buffer and freed right after upload.
+    // Enable before load() when the pixels are needed afterwards (e.g. readback).
+    void setKeepCpuCopy(bool keep);
+    bool getKeepCpuCopy() const;
+    const ofPixels& getPixels(int face) const; // empty unless keepCpuCopy was set while loading
+
+    void clear();
+
+    // Memory accounting
+    size_t getCpuBytes() const; // bytes of kept face pixels in system RAM
+    size_t getGpuBytes() const; // estimated bytes of the cube texture incl. mip chain
+
     ofTexture& getTexture();
     const ofTexture& getTexture() const;
 
 private:
+    void beginUpload();
+    bool uploadFace(int face, const ofPixels& pixels);
+    void endUpload();
+    void abortUpload(); // error path: restores the unpack alignment set by beginUpload() and drops the texture
+
     ofTexture textureData;
-    unsigned int glTexId;
-    ofImage images[6];
+    unsigned int glTexId = 0;
+    unsigned int faceWidth = 0;
+    unsigned int faceHeight = 0;
+    size_t gpuBytes = 0;
+    bool keepCpuCopy = false;
+    ofPixels cpuFaces[6];
 
 };
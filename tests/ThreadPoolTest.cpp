@@ -0,0 +1,62 @@
+// ThreadPool::parallelFor 구간 분할 테스트. (오픈프레임웍스 없이 표준 라이브러리만으로 빌드됨)
+//
+//   g++ -std=c++17 -O1 -pthread -I../src ThreadPoolTest.cpp ../src/ThreadPool.cpp -o ThreadPoolTest && ./ThreadPoolTest
+//
+// 워커 수 1 ~ 32 와 여러 count / minChunkSize 조합에서, 모든 구간이 비어있지 않고 begin < end <= count 이며
+// 구간 번호가 0 ~ getNumChunks() - 1 을 한 번씩만 쓰고, [0, count) 의 모든 인덱스를 정확히 한 번씩 덮는지 확인함.
+// (바다 시뮬레이션의 열 FFT 처럼 64 개를 12 구간으로 나누는 경우도 포함. 예전에는 마지막 구간이 66 ~ 64 가 됐음)
+#include "ThreadPool.hpp"
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+int main() {
+    const size_t counts[] = { 0, 1, 2, 3, 5, 7, 12, 13, 31, 63, 64, 65, 100, 128, 255, 256, 257, 1000, 1024, 4097 };
+    const size_t minChunkSizes[] = { 0, 1, 2, 3, 4, 8, 16, 1024 };
+    int failures = 0;
+
+    for (size_t workers = 1; workers <= 32; ++workers) {
+        ThreadPool pool(workers);
+        for (size_t count : counts) {
+            for (size_t minChunkSize : minChunkSizes) {
+                size_t chunks = std::max<size_t>(1, pool.getNumChunks(count, minChunkSize));
+                std::unique_ptr<std::atomic<int>[]> covered(new std::atomic<int>[count + 1]);
+                std::unique_ptr<std::atomic<int>[]> chunkCalls(new std::atomic<int>[chunks]);
+                for (size_t i = 0; i <= count; ++i) {
+                    covered[i] = 0;
+                }
+                for (size_t i = 0; i < chunks; ++i) {
+                    chunkCalls[i] = 0;
+                }
+                std::atomic<int> badRanges { 0 };
+
+                pool.parallelFor(count, minChunkSize, [&](size_t chunk, size_t begin, size_t end) {
+                    if (chunk >= chunks || begin >= end || end > count) {
+                        badRanges++;
+                        return;
+                    }
+                    chunkCalls[chunk]++;
+                    for (size_t i = begin; i < end; ++i) {
+                        covered[i]++;
+                    }
+                });
+
+                bool ok = badRanges == 0;
+                for (size_t i = 0; i < count; ++i) {
+                    ok = ok && covered[i] == 1;
+                }
+                for (size_t i = 0; i < chunks && count > 0; ++i) {
+                    ok = ok && chunkCalls[i] == 1;
+                }
+                if (!ok) {
+                    std::printf("FAIL: workers %zu, count %zu, minChunkSize %zu\n", workers, count, minChunkSize);
+                    failures++;
+                }
+            }
+        }
+    }
+
+    std::printf(failures == 0 ? "ThreadPool: all parallelFor splits passed\n" : "ThreadPool: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}